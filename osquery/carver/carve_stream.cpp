@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <osquery/utils/system/system.h>
+
+// This define is required for Windows static linking of libarchive
+#define LIBARCHIVE_STATIC
+#include <archive.h>
+#include <archive_entry.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+
+#include <osquery/carver/carve_stream.h>
+#include <osquery/filesystem/fileops.h>
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/hashing/hashing.h>
+#include <osquery/logger/logger.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+namespace {
+
+/// The stages after the tar framing: compression, hashing and blocking.
+class PassOutput : private boost::noncopyable {
+ public:
+  PassOutput(size_t block_size,
+             bool compress,
+             const CarveStream::BlockCallback* callback)
+      : block_size_(block_size),
+        compress_(compress),
+        callback_(callback),
+        hash_(HASH_TYPE_SHA256) {}
+
+  ~PassOutput() {
+    if (cstream_ != nullptr) {
+      ZSTD_freeCStream(cstream_);
+    }
+  }
+
+  Status init() {
+    if (!compress_) {
+      return Status::success();
+    }
+
+    cstream_ = ZSTD_createCStream();
+    if (cstream_ == nullptr) {
+      return Status::failure("Couldn't create compression stream");
+    }
+
+    auto ret = ZSTD_initCStream(cstream_, 1);
+    if (ZSTD_isError(ret)) {
+      return Status::failure("Couldn't initialize compression stream");
+    }
+    buffer_.resize(ZSTD_CStreamOutSize());
+    return Status::success();
+  }
+
+  /// Add bytes of the tar archive.
+  Status write(const void* data, size_t length) {
+    if (!compress_) {
+      return emit(static_cast<const char*>(data), length);
+    }
+
+    ZSTD_inBuffer input = {data, length, 0};
+    while (input.pos < input.size) {
+      ZSTD_outBuffer output = {buffer_.data(), buffer_.size(), 0};
+      auto ret = ZSTD_compressStream(cstream_, &output, &input);
+      if (ZSTD_isError(ret)) {
+        return Status::failure("ZSTD_compressStream() error : " +
+                               std::string(ZSTD_getErrorName(ret)));
+      }
+
+      auto s = emit(buffer_.data(), output.pos);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return Status::success();
+  }
+
+  /// Flush the compression stream and the last, partial, block.
+  Status finish() {
+    if (compress_) {
+      size_t remaining = 0;
+      do {
+        ZSTD_outBuffer output = {buffer_.data(), buffer_.size(), 0};
+        remaining = ZSTD_endStream(cstream_, &output);
+        if (ZSTD_isError(remaining)) {
+          return Status::failure("ZSTD_endStream() error : " +
+                                 std::string(ZSTD_getErrorName(remaining)));
+        }
+
+        auto s = emit(buffer_.data(), output.pos);
+        if (!s.ok()) {
+          return s;
+        }
+      } while (remaining > 0);
+    }
+
+    if (callback_ != nullptr && !block_.empty()) {
+      auto s = (*callback_)(block_id_++, block_);
+      block_.clear();
+      return s;
+    }
+    return Status::success();
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  std::string digest() {
+    return hash_.digest();
+  }
+
+  /// The first failure of a write made by libarchive.
+  Status status;
+
+ private:
+  Status emit(const char* data, size_t length) {
+    size_ += length;
+    hash_.update(data, length);
+
+    if (callback_ == nullptr) {
+      return Status::success();
+    }
+
+    while (length > 0) {
+      auto count = std::min(length, block_size_ - block_.size());
+      block_.append(data, count);
+      data += count;
+      length -= count;
+
+      if (block_.size() == block_size_) {
+        auto s = (*callback_)(block_id_++, block_);
+        block_.clear();
+        if (!s.ok()) {
+          return s;
+        }
+      }
+    }
+    return Status::success();
+  }
+
+ private:
+  size_t block_size_;
+
+  bool compress_;
+
+  const CarveStream::BlockCallback* callback_;
+
+  Hash hash_;
+
+  ZSTD_CStream* cstream_{nullptr};
+
+  /// Compressed output of the zstd stream.
+  std::vector<char> buffer_;
+
+  /// The block being filled.
+  std::string block_;
+
+  size_t block_id_{0};
+
+  size_t size_{0};
+};
+
+la_ssize_t writeArchive(struct archive* arch,
+                        void* client_data,
+                        const void* buffer,
+                        size_t length) {
+  auto output = static_cast<PassOutput*>(client_data);
+  auto s = output->write(buffer, length);
+  if (!s.ok()) {
+    output->status = s;
+    archive_set_error(arch, EIO, "%s", s.getMessage().c_str());
+    return -1;
+  }
+  return static_cast<la_ssize_t>(length);
+}
+
+/// Write up to size bytes of a file, libarchive pads missing bytes.
+Status writeFile(struct archive* arch,
+                 const fs::path& path,
+                 size_t size,
+                 std::vector<char>& buffer) {
+  PlatformFile file(path, PF_OPEN_EXISTING | PF_READ);
+  if (!file.isValid()) {
+    VLOG(1) << "Carved file can no longer be read: " << path;
+    return Status::success();
+  }
+
+  while (size > 0) {
+    auto r = file.read(buffer.data(), std::min(size, buffer.size()));
+    if (r <= 0) {
+      break;
+    }
+
+    if (archive_write_data(arch, buffer.data(), static_cast<size_t>(r)) < 0) {
+      return Status::failure("Failed to write carved file to archive: " +
+                             std::string(archive_error_string(arch)));
+    }
+    size -= static_cast<size_t>(r);
+  }
+  return Status::success();
+}
+
+} // namespace
+
+CarveStream::CarveStream(const std::set<fs::path>& paths,
+                         size_t block_size,
+                         bool compress)
+    : block_size_(std::max<size_t>(block_size, 1)), compress_(compress) {
+  for (const auto& path : paths) {
+    // Ensure the file is a flat file on disk before carving
+    PlatformFile file(path, PF_OPEN_EXISTING | PF_READ);
+    if (!file.isValid() || isDirectory(path).ok()) {
+      VLOG(1) << "File does not exist on disk or is subdirectory: " << path;
+      continue;
+    }
+
+    files_.push_back(path);
+    sizes_.push_back(file.size());
+  }
+}
+
+Status CarveStream::measure() {
+  auto s = pass(nullptr, size_, sha256_);
+  measured_ = s.ok();
+  return s;
+}
+
+Status CarveStream::stream(const BlockCallback& callback) {
+  if (!measured_) {
+    auto s = measure();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  size_t size = 0;
+  std::string sha256;
+  auto s = pass(&callback, size, sha256);
+  if (!s.ok()) {
+    return s;
+  }
+
+  if (size != size_ || sha256 != sha256_) {
+    return Status(kFilesChanged,
+                  "Carved files changed while they were streamed");
+  }
+  return Status::success();
+}
+
+Status CarveStream::pass(const BlockCallback* callback,
+                         size_t& size,
+                         std::string& sha256) {
+  PassOutput output(block_size_, compress_, callback);
+  auto s = output.init();
+  if (!s.ok()) {
+    return s;
+  }
+
+  auto arch = archive_write_new();
+  if (arch == nullptr) {
+    return Status::failure("Failed to create tar archive");
+  }
+
+  archive_write_set_format_pax_restricted(arch);
+  auto ret = archive_write_open(arch, &output, nullptr, writeArchive, nullptr);
+  if (ret != ARCHIVE_OK) {
+    archive_write_free(arch);
+    return Status::failure("Failed to open tar archive for writing");
+  }
+
+  std::vector<char> buffer(block_size_);
+  for (size_t i = 0; i < files_.size() && s.ok(); i++) {
+    auto entry = archive_entry_new();
+    archive_entry_set_pathname(entry, files_[i].leaf().string().c_str());
+    archive_entry_set_size(entry, static_cast<la_int64_t>(sizes_[i]));
+    archive_entry_set_filetype(entry, AE_IFREG);
+    archive_entry_set_perm(entry, 0644);
+    if (archive_write_header(arch, entry) < ARCHIVE_WARN) {
+      s = Status::failure("Failed to write tar header: " +
+                          std::string(archive_error_string(arch)));
+    } else {
+      s = writeFile(arch, files_[i], sizes_[i], buffer);
+    }
+    archive_entry_free(entry);
+  }
+
+  // Closing pads the last entry and writes the end of the archive.
+  if (archive_write_close(arch) != ARCHIVE_OK && s.ok()) {
+    s = Status::failure("Failed to close tar archive");
+  }
+  archive_write_free(arch);
+
+  if (!output.status.ok()) {
+    return output.status;
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  s = output.finish();
+  if (!s.ok()) {
+    return s;
+  }
+
+  size = output.size();
+  sha256 = output.digest();
+  return Status::success();
+}
+
+} // namespace osquery
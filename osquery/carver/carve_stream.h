@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <osquery/utils/status/status.h>
+
+namespace osquery {
+
+/**
+ * @brief The archive of a carve, produced as a stream of upload blocks.
+ *
+ * Carved files are read and framed as a tar archive, optionally compressed
+ * with zstd, hashed, and split into blocks of a fixed size in a single pass.
+ * No intermediate files are written, and memory use is bounded by the block
+ * size and the compression buffers.
+ *
+ * The size of each file is fixed when the stream is created. Files that grow
+ * afterwards are truncated, and files that shrink are padded with zeros. Every
+ * pass produces the same blocks, numbered from 0, as long as the contents of
+ * the files do not change.
+ */
+class CarveStream : private boost::noncopyable {
+ public:
+  /// Called with each block in order, a failure stops the pass.
+  using BlockCallback =
+      std::function<Status(size_t block_id, const std::string& block)>;
+
+  /// Status code of a pass whose files changed since the stream was measured.
+  static constexpr int kFilesChanged = 2;
+
+  /**
+   * @brief Create a stream of the regular files within a set of paths.
+   *
+   * @param paths the files to carve, missing files and directories are
+   * skipped.
+   * @param block_size the size of each block except the last.
+   * @param compress true to compress the archive with zstd.
+   */
+  CarveStream(const std::set<boost::filesystem::path>& paths,
+              size_t block_size,
+              bool compress);
+
+  /// The files that are archived.
+  const std::vector<boost::filesystem::path>& files() const {
+    return files_;
+  }
+
+  /**
+   * @brief Compute the size and SHA256 of the stream before it is uploaded.
+   *
+   * The stream is produced once without emitting blocks, so the files are
+   * read and hashed in every mode. An upload is only resumed if the hash of
+   * its stream did not change.
+   */
+  Status measure();
+
+  /**
+   * @brief Produce every block of the stream.
+   *
+   * The stream is measured first if needed. A failure with the code
+   * kFilesChanged is returned if the size or SHA256 of the pass differs from
+   * the measured stream, such as when a file was rewritten at the same size.
+   * The blocks already produced are then a mix of both contents.
+   */
+  Status stream(const BlockCallback& callback);
+
+  /// The number of bytes in the stream, known once it is measured.
+  size_t size() const {
+    return size_;
+  }
+
+  /// The number of blocks in the stream, known once it is measured.
+  size_t blocks() const {
+    return (size_ + block_size_ - 1) / block_size_;
+  }
+
+  size_t blockSize() const {
+    return block_size_;
+  }
+
+  /// The hex SHA256 of the stream, known once it is measured.
+  const std::string& sha256() const {
+    return sha256_;
+  }
+
+ private:
+  /**
+   * @brief Produce the stream once.
+   *
+   * @param callback the receiver of blocks, or nullptr.
+   * @param size the output number of bytes in the stream.
+   * @param sha256 the output hash of the stream.
+   */
+  Status pass(const BlockCallback* callback, size_t& size, std::string& sha256);
+
+ private:
+  std::vector<boost::filesystem::path> files_;
+
+  /// The size of each file when the stream was created.
+  std::vector<size_t> sizes_;
+
+  size_t block_size_{0};
+
+  bool compress_{false};
+
+  bool measured_{false};
+
+  size_t size_{0};
+
+  std::string sha256_;
+};
+
+} // namespace osquery
@@ -28,6 +28,14 @@
 #include <osquery/utils/system/system.h>
 #include <osquery/utils/system/time.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 namespace fs = boost::filesystem;
 
 namespace osquery {
@@ -65,12 +73,82 @@ CLI_FLAG(uint32,
          86400,
          "Seconds to store successful carve result metadata (in carves table)");
 
+/// Number of blocks POSTed concurrently.
+CLI_FLAG(uint32,
+         carver_upload_concurrency,
+         4,
+         "Number of carve blocks uploaded concurrently (default 4)");
+
 DECLARE_bool(disable_carver);
-DECLARE_uint64(read_max);
+
+/// Number of times a block is POSTed before the upload is interrupted.
+const size_t kCarveBlockAttempts = 3;
+
+/// Milliseconds to wait before the first retry of a block, then doubled.
+const size_t kCarveBlockRetryDelay = 1000;
+
+/// Number of times a carve is restarted because its files changed.
+const size_t kCarveStreamAttempts = 3;
+
+/// Number of acknowledged blocks between persisting the upload progress.
+const size_t kCarveUploadPersistBlocks = 64;
 
 std::atomic<bool> CarverRunnable::running_{false};
 
+namespace {
+
+/**
+ * @brief Check if a carve has an interrupted upload to resume.
+ *
+ * Uploads are resumed until carver_expiry seconds after their session
+ * started, then their progress is dropped.
+ */
+bool isResumable(const std::string& guid, const std::string& status) {
+  if (status == kCarverStatusSuccess || status == kCarverStatusScheduled) {
+    return false;
+  }
+
+  CarveUpload upload;
+  if (!getCarveUpload(guid, upload).ok()) {
+    return false;
+  }
+
+  if (getUnixTime() - upload.time > FLAGS_carver_expiry) {
+    VLOG(1) << "Expiring carve upload for GUID: " << guid;
+    deleteCarveUpload(guid);
+    return false;
+  }
+  return true;
+}
+
+/// POST a single block, with retries.
+Status postBlock(Request<TLSTransport, JSONSerializer>& request,
+                 const JSON& params,
+                 size_t block_id) {
+  Status s;
+  auto delay = kCarveBlockRetryDelay;
+  for (size_t attempt = 1; attempt <= kCarveBlockAttempts; attempt++) {
+    s = request.call(params);
+    if (s.ok()) {
+      break;
+    }
+
+    VLOG(1) << "Post of carved block " << block_id
+            << " failed: " << s.getMessage();
+    if (attempt < kCarveBlockAttempts) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+      delay *= 2;
+    }
+  }
+  return s;
+}
+
+} // namespace
+
 void CarverRunnable::start() {
+  // Failed uploads that may be resumed mark the carves pending again.
+  kCarverPendingCarves = false;
+
   std::vector<std::string> carves;
   scanDatabaseKeys(kCarves, carves, kCarverDBPrefix);
 
@@ -106,11 +184,12 @@ void CarverRunnable::start() {
       if (delta > FLAGS_carver_expiry) {
         VLOG(1) << "Expiring successful carve metadata for GUID: " << guid;
         deleteDatabaseValue(kCarves, key);
+        deleteCarveUpload(guid);
         continue;
       }
     }
 
-    if (status != kCarverStatusScheduled) {
+    if (status != kCarverStatusScheduled && !isResumable(guid, status)) {
       continue;
     }
 
@@ -131,9 +210,6 @@ void CarverRunnable::start() {
 
     doCarve(paths, guid, requestId);
   }
-
-  // All pending carves have been started.
-  kCarverPendingCarves = false;
 }
 
 Carver::Carver(const std::set<std::string>& paths,
@@ -150,139 +226,99 @@ Carver::Carver(const std::set<std::string>& paths,
   requestId_ = requestId;
 }
 
-Status Carver::createPaths() {
-  // TODO: Adding in a manifest file of all carved files might be nice.
-  carveDir_ =
-      fs::temp_directory_path() / fs::path(kCarvePathPrefix + carveGuid_);
-  auto ret = fs::create_directory(carveDir_);
-  if (!ret) {
-    return Status::failure("Failed to create carve file store");
-  }
-
-  // Store the path to our archive for later exfiltration
-  archivePath_ = carveDir_ / fs::path(kCarveNamePrefix + carveGuid_ + ".tar");
-  compressPath_ =
-      carveDir_ / fs::path(kCarveNamePrefix + carveGuid_ + ".tar.zst");
-
+Status Carver::carve() {
   // Update the DB to reflect that the carve is pending.
   updateCarveValue(carveGuid_, "status", "PENDING");
-  return Status::success();
-};
 
-Carver::~Carver() {
-  fs::remove_all(carveDir_);
-}
-
-Status Carver::carve() {
-  auto s = createPaths();
-  if (!s.ok()) {
-    updateCarveValue(carveGuid_, "status", "CREATE PATHS FAILED");
-    return s;
-  }
-
-  const auto carvedFiles = carveAll();
-  s = archive(carvedFiles, archivePath_, FLAGS_carver_block_size);
-  if (!s.ok()) {
-    VLOG(1) << "Failed to create carve archive: " << s.getMessage();
-    updateCarveValue(carveGuid_, "status", "ARCHIVE FAILED");
-    return s;
-  }
-
-  fs::path uploadPath;
-  if (FLAGS_carver_compression) {
-    uploadPath = compressPath_;
-    s = compress(archivePath_, compressPath_);
+  Status s;
+  for (size_t attempt = 1; attempt <= kCarveStreamAttempts; attempt++) {
+    CarveStream stream(
+        carvePaths_, FLAGS_carver_block_size, FLAGS_carver_compression);
+    s = stream.measure();
     if (!s.ok()) {
-      VLOG(1) << "Failed to compress carve archive: " << s.getMessage();
-      updateCarveValue(carveGuid_, "status", "COMPRESS FAILED");
+      VLOG(1) << "Failed to create carve archive: " << s.getMessage();
+      updateCarveValue(carveGuid_, "status", "ARCHIVE FAILED");
       return s;
     }
-  } else {
-    uploadPath = archivePath_;
-  }
 
-  PlatformFile uploadFile(uploadPath, PF_OPEN_EXISTING | PF_READ);
-  updateCarveValue(carveGuid_, "size", std::to_string(uploadFile.size()));
+    updateCarveValue(carveGuid_, "size", std::to_string(stream.size()));
+    updateCarveValue(carveGuid_, "sha256", stream.sha256());
+
+    s = postCarve(stream);
+    if (s.getCode() != CarveStream::kFilesChanged) {
+      break;
+    }
 
-  std::string uploadHash =
-      (uploadFile.size() > FLAGS_read_max)
-          ? "-1"
-          : hashFromFile(HashType::HASH_TYPE_SHA256, uploadPath.string());
-  if (uploadHash == "-1") {
-    VLOG(1)
-        << "Archive file size exceeds read max, skipping integrity computation";
+    // The blocks sent mix old and new content, start a new session.
+    VLOG(1) << "Restarting carve " << carveGuid_ << ": " << s.getMessage();
   }
-  updateCarveValue(carveGuid_, "sha256", uploadHash);
 
-  s = postCarve(uploadPath);
   if (!s.ok()) {
     VLOG(1) << "Failed to post carve: " << s.getMessage();
     updateCarveValue(carveGuid_, "status", "DATA POST FAILED");
+
+    // The next carver runner resumes the upload from its acknowledged blocks.
+    CarveUpload upload;
+    if (getCarveUpload(carveGuid_, upload).ok()) {
+      kCarverPendingCarves = true;
+    }
     return s;
   }
   return Status::success();
 };
 
 std::set<fs::path> Carver::carveAll() {
-  std::set<fs::path> carvedFiles;
-  for (const auto& srcPath : carvePaths_) {
-    // Ensure the file is a flat file on disk before carving
-    PlatformFile src(srcPath, PF_OPEN_EXISTING | PF_READ);
-    if (!src.isValid() || isDirectory(srcPath)) {
-      VLOG(1) << "File does not exist on disk or is subdirectory: " << srcPath;
-      continue;
-    }
-    const auto dstPath = carveDir_ / srcPath.leaf();
-    PlatformFile dst(dstPath, PF_CREATE_NEW | PF_WRITE);
-    if (!dst.isValid()) {
-      VLOG(1) << "Destination temporary file is invalid: " << dstPath;
-      continue;
+  CarveStream stream(carvePaths_, FLAGS_carver_block_size, false);
+  return std::set<fs::path>(stream.files().begin(), stream.files().end());
+}
+
+Status Carver::postCarve(CarveStream& stream) {
+  CarveUpload upload;
+  auto status = getCarveUpload(carveGuid_, upload);
+  if (status.ok() && upload.size == stream.size() &&
+      upload.block_size == stream.blockSize() &&
+      upload.sha256 == stream.sha256()) {
+    VLOG(1) << "Resuming upload of carve " << carveGuid_ << " after block "
+            << upload.acknowledged;
+  } else {
+    upload = CarveUpload();
+    status = startUpload(stream, upload.session_id);
+    if (!status.ok()) {
+      return status;
     }
-    Status s = blockwiseCopy(src, dst);
-    if (s.ok()) {
-      carvedFiles.insert(dstPath);
-    } else {
-      VLOG(1) << "Failed to copy file from " << srcPath << " to " << dstPath
-              << " " << s.getMessage();
+
+    upload.time = getUnixTime();
+    upload.size = stream.size();
+    upload.block_size = stream.blockSize();
+    upload.sha256 = stream.sha256();
+    status = setCarveUpload(carveGuid_, upload);
+    if (!status.ok()) {
+      return status;
     }
   }
-  return carvedFiles;
-}
 
-Status Carver::blockwiseCopy(PlatformFile& src, PlatformFile& dst) {
-  auto blkCount = ceil(static_cast<double>(src.size()) /
-                       static_cast<double>(FLAGS_carver_block_size));
-
-  std::vector<char> inBuff(FLAGS_carver_block_size, 0);
-  for (size_t i = 0; i < blkCount; i++) {
-    auto bytesRead = src.read(inBuff.data(), FLAGS_carver_block_size);
-    if (bytesRead > 0) {
-      auto bytesWritten = dst.write(inBuff.data(), bytesRead);
-      if (bytesWritten < 0) {
-        return Status(1, "Error writing bytes to tmp fs");
-      }
-    }
+  status = postBlocks(stream, upload);
+  if (!status.ok()) {
+    return status;
   }
 
+  deleteCarveUpload(carveGuid_);
+  updateCarveValue(carveGuid_, "status", kCarverStatusSuccess);
   return Status::success();
-};
+}
 
-Status Carver::postCarve(const boost::filesystem::path& path) {
+Status Carver::startUpload(CarveStream& stream, std::string& session_id) {
   // Construct the uri we post our data back to:
   auto startUri = TLSRequestHelper::makeURI(FLAGS_carver_start_endpoint);
   Request<TLSTransport, JSONSerializer> startRequest(startUri);
   startRequest.setOption("hostname", FLAGS_tls_hostname);
 
   // Perform the start request to get the session id
-  PlatformFile pFile(path, PF_OPEN_EXISTING | PF_READ);
-  auto blkCount =
-      static_cast<size_t>(ceil(static_cast<double>(pFile.size()) /
-                               static_cast<double>(FLAGS_carver_block_size)));
   JSON startParams;
 
-  startParams.add("block_count", blkCount);
-  startParams.add("block_size", size_t(FLAGS_carver_block_size));
-  startParams.add("carve_size", pFile.size());
+  startParams.add("block_count", stream.blocks());
+  startParams.add("block_size", stream.blockSize());
+  startParams.add("carve_size", stream.size());
   startParams.add("carve_id", carveGuid_);
   startParams.add("request_id", requestId_);
   startParams.add("node_key", getNodeKey("tls"));
@@ -307,41 +343,120 @@ Status Carver::postCarve(const boost::filesystem::path& path) {
     return Status(1, "Invalid session_id received from remote endpoint");
   }
 
-  std::string session_id = it->value.GetString();
+  session_id = it->value.GetString();
   if (session_id.empty()) {
     return Status(1, "Empty session_id received from remote endpoint");
   }
+  return Status::success();
+}
 
+Status Carver::postBlocks(CarveStream& stream, CarveUpload& upload) {
   auto contUri = TLSRequestHelper::makeURI(FLAGS_carver_continue_endpoint);
-  Request<TLSTransport, JSONSerializer> contRequest(contUri);
-  contRequest.setOption("hostname", FLAGS_tls_hostname);
-  for (size_t i = 0; i < blkCount; i++) {
-    std::vector<char> block(FLAGS_carver_block_size, 0);
-    auto r = pFile.read(block.data(), FLAGS_carver_block_size);
-
-    if (r != FLAGS_carver_block_size && r > 0) {
-      // resize the buffer to size we read as last block is likely smaller
-      block.resize(r);
+  auto concurrency = std::max<size_t>(FLAGS_carver_upload_concurrency, 1);
+
+  // Blocks produced by the stream wait here for an upload thread.
+  std::deque<std::pair<size_t, std::string>> pending;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+
+  // The first block that could not be POSTed interrupts the upload.
+  Status failure;
+
+  // Blocks acknowledged since the upload progress was persisted.
+  size_t unpersisted = 0;
+  auto persist = [&]() {
+    auto s = setCarveUpload(carveGuid_, upload);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to persist carve upload: " << s.getMessage();
     }
+    unpersisted = 0;
+  };
+
+  auto post = [&]() {
+    // Each thread keeps its own connection alive between blocks.
+    Request<TLSTransport, JSONSerializer> contRequest(contUri);
+    contRequest.setOption("hostname", FLAGS_tls_hostname);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [&] { return !pending.empty() || done || !failure.ok(); });
+      if (pending.empty() || !failure.ok()) {
+        break;
+      }
 
-    JSON params;
-    params.add("block_id", i);
-    params.add("session_id", session_id);
-    params.add("request_id", requestId_);
-    params.add("data", base64::encode(std::string(block.begin(), block.end())));
+      auto block = std::move(pending.front());
+      pending.pop_front();
+      cv.notify_all();
+      lock.unlock();
+
+      JSON params;
+      params.add("block_id", block.first);
+      params.add("session_id", upload.session_id);
+      params.add("request_id", requestId_);
+      params.add("data", base64::encode(block.second));
+      auto s = postBlock(contRequest, params, block.first);
+      lock.lock();
+      if (!s.ok()) {
+        if (failure.ok()) {
+          failure = s;
+        }
+        cv.notify_all();
+        break;
+      }
 
-    // TODO: Error sending files.
-    status = contRequest.call(params);
-    if (!status.ok()) {
-      VLOG(1) << "Post of carved block " << i
-              << " failed: " << status.getMessage();
-      continue;
+      upload.acknowledge(block.first);
+      if (++unpersisted >= kCarveUploadPersistBlocks) {
+        persist();
+      }
     }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < concurrency; i++) {
+    threads.emplace_back(post);
   }
 
-  updateCarveValue(carveGuid_, "status", kCarverStatusSuccess);
-  return Status::success();
-};
+  auto status = stream.stream([&](size_t block_id, const std::string& block) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (upload.isAcknowledged(block_id)) {
+      return Status::success();
+    }
+
+    cv.wait(lock,
+            [&] { return pending.size() < concurrency || !failure.ok(); });
+    if (!failure.ok()) {
+      return failure;
+    }
+
+    pending.emplace_back(block_id, block);
+    cv.notify_all();
+    return Status::success();
+  });
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  cv.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (!failure.ok()) {
+    // The next attempt resumes after every acknowledged block.
+    if (unpersisted > 0) {
+      persist();
+    }
+    return failure;
+  }
+
+  if (!status.ok()) {
+    // The acknowledged blocks no longer match the carved files.
+    deleteCarveUpload(carveGuid_);
+  }
+  return status;
+}
 
 void scheduleCarves() {
   if (!FLAGS_disable_carver && kCarverPendingCarves &&
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <osquery/carver/carve_stream.h>
 #include <osquery/dispatcher/dispatcher.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/utils/status/status.h>
@@ -19,6 +20,8 @@
 
 namespace osquery {
 
+struct CarveUpload;
+
 class CarverRunnable : public InternalRunnable {
  public:
   CarverRunnable() : InternalRunnable("CarverRunnable") {
@@ -91,61 +94,46 @@ class Carver {
          const std::string& guid,
          const std::string& requestId);
 
-  virtual ~Carver();
+  virtual ~Carver() = default;
 
   /**
    * @brief A helper function to perform a start to finish carve.
    *
-   * This function walks through the carve, compress, and post functions
-   * in one fell swoop. Use of this class should largely happen through
-   * this function.
+   * This function streams the carved files through the archive, compression,
+   * and post functions in one fell swoop. Use of this class should largely
+   * happen through this function.
    */
   Status carve();
 
-  /// Create the archive and compression paths.
-  Status createPaths();
-
  protected:
   /**
-   * @brief A helper function that 'carves' all files from disk.
+   * @brief A helper function that selects all files to carve from disk.
    *
-   * This function copies all source files to a temporary directory and returns
-   * a list of all destination files.
+   * This function returns the requested paths that are flat files on disk.
    */
   std::set<boost::filesystem::path> carveAll();
 
-  /**
-   * @brief A helper function that does a blockwise copy from src to dst.
-   *
-   * This function copies the source file to the destination file, doing so
-   * by blocks specified with FLAGS_carver_block_size (defaults to 8K).
-   */
-  Status blockwiseCopy(PlatformFile& src, PlatformFile& dst);
-
   /**
    * @brief Helper function to POST a carve to the graph endpoint.
    *
-   * Once all of the files have been carved and the tgz has been
-   * created, we POST the carved file to an endpoint specified by the
-   * carver_start_endpoint and carver_continue_endpoint.
+   * Once the carve stream has been measured, we POST its blocks to an
+   * endpoint specified by the carver_start_endpoint and
+   * carver_continue_endpoint, as they are produced.
+   *
+   * Blocks are POSTed concurrently, and each acknowledged block is persisted.
+   * If a previous attempt of the carve was interrupted, its session is
+   * resumed and only the blocks that were not acknowledged are sent.
    */
-  virtual Status postCarve(const boost::filesystem::path& path);
+  virtual Status postCarve(CarveStream& stream);
 
-  /// Helper function to return the carve directory.
-  boost::filesystem::path getCarveDir() {
-    return carveDir_;
-  }
+ private:
+  /// Request a new upload session from the carver_start_endpoint.
+  Status startUpload(CarveStream& stream, std::string& session_id);
 
- protected:
-  /**
-   * @brief a variable to keep track of the temp path used in carving.
-   *
-   * This variable represents the location in which we store all of our carved
-   * files. When a carve has completed all of the desired files, as well
-   * as the tar archive should reside in this directory.
-   */
-  boost::filesystem::path carveDir_;
+  /// POST the blocks of the stream that were not acknowledged yet.
+  Status postBlocks(CarveStream& stream, CarveUpload& upload);
 
+ protected:
   /**
    * @brief a variable tracking all of the paths we attempt to carve.
    *
@@ -154,22 +142,6 @@ class Carver {
    */
   std::set<boost::filesystem::path> carvePaths_;
 
-  /**
-   * @brief a helper variable for keeping track of the posix tar archive.
-   *
-   * This variable is the absolute location of the tar archive created from
-   * tar'ing all of the carved files from the carve temp dir.
-   */
-  boost::filesystem::path archivePath_;
-
-  /**
-   * @brief a helper variable for keeping track of the compressed tar.
-   *
-   * This variable is the absolute location of the tar archive created from
-   * zstd of the archive.
-   */
-  boost::filesystem::path compressPath_;
-
   /**
    * @brief a unique ID identifying the 'carve'.
    *
@@ -61,6 +61,93 @@ void updateCarveValue(const std::string& guid,
   }
 }
 
+bool CarveUpload::isAcknowledged(size_t block_id) const {
+  return block_id < acknowledged || acknowledged_after.count(block_id) > 0;
+}
+
+void CarveUpload::acknowledge(size_t block_id) {
+  if (block_id != acknowledged) {
+    if (block_id > acknowledged) {
+      acknowledged_after.insert(block_id);
+    }
+    return;
+  }
+
+  // Advance past the blocks that were acknowledged out of order.
+  acknowledged++;
+  auto it = acknowledged_after.begin();
+  while (it != acknowledged_after.end() && *it == acknowledged) {
+    acknowledged++;
+    it = acknowledged_after.erase(it);
+  }
+}
+
+Status getCarveUpload(const std::string& guid, CarveUpload& upload) {
+  std::string content;
+  auto s = getDatabaseValue(kCarves, kCarverUploadDBPrefix + guid, content);
+  if (!s.ok()) {
+    return s;
+  }
+
+  JSON tree;
+  s = tree.fromString(content);
+  if (!s.ok() || !tree.doc().IsObject()) {
+    return Status::failure("Failed to parse carve upload: " + guid);
+  }
+
+  const auto& doc = tree.doc();
+  for (const auto& key :
+       {"time", "size", "block_size", "acknowledged", "acknowledged_after"}) {
+    if (!doc.HasMember(key)) {
+      return Status::failure("Malformed carve upload: " + guid);
+    }
+  }
+  if (!doc.HasMember("session_id") || !doc["session_id"].IsString() ||
+      !doc.HasMember("sha256") || !doc["sha256"].IsString() ||
+      !doc["acknowledged_after"].IsArray()) {
+    return Status::failure("Malformed carve upload: " + guid);
+  }
+
+  upload.session_id = doc["session_id"].GetString();
+  upload.sha256 = doc["sha256"].GetString();
+  upload.time = JSON::valueToSize(doc["time"]);
+  upload.size = JSON::valueToSize(doc["size"]);
+  upload.block_size = JSON::valueToSize(doc["block_size"]);
+  upload.acknowledged = JSON::valueToSize(doc["acknowledged"]);
+  upload.acknowledged_after.clear();
+  for (const auto& block_id : doc["acknowledged_after"].GetArray()) {
+    upload.acknowledged_after.insert(JSON::valueToSize(block_id));
+  }
+  return Status::success();
+}
+
+Status setCarveUpload(const std::string& guid, const CarveUpload& upload) {
+  JSON tree;
+  tree.add("session_id", upload.session_id);
+  tree.add("time", upload.time);
+  tree.add("size", upload.size);
+  tree.add("block_size", upload.block_size);
+  tree.add("sha256", upload.sha256);
+  tree.add("acknowledged", upload.acknowledged);
+
+  auto blocks = tree.getArray();
+  for (const auto& block_id : upload.acknowledged_after) {
+    tree.push(block_id, blocks);
+  }
+  tree.add("acknowledged_after", blocks);
+
+  std::string out;
+  auto s = tree.toString(out);
+  if (!s.ok()) {
+    return s;
+  }
+  return setDatabaseValue(kCarves, kCarverUploadDBPrefix + guid, out);
+}
+
+void deleteCarveUpload(const std::string& guid) {
+  deleteDatabaseValue(kCarves, kCarverUploadDBPrefix + guid);
+}
+
 std::string createCarveGuid() {
   return boost::uuids::to_string(boost::uuids::random_generator()());
 }
@@ -12,20 +12,19 @@
 #include <osquery/utils/status/status.h>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <set>
 #include <string>
 
 namespace osquery {
 
-/// Prefix used for the temp FS where carved files are stored.
-const std::string kCarvePathPrefix = "osquery_carve_";
-
-/// Prefix applied to the file carve tar archive.
-const std::string kCarveNamePrefix = "carve_";
-
 /// Database prefix used to directly access and manipulate our carver entries.
 const std::string kCarverDBPrefix = "carves.";
 
+/// Database prefix used to store the upload progress of carves.
+const std::string kCarverUploadDBPrefix = "carve_uploads.";
+
 /// Internal carver 'status' indicating a completed carve.
 const std::string kCarverStatusSuccess = "SUCCESS";
 
@@ -45,6 +44,51 @@ const std::string kCarverStatusScheduled = "SCHEDULED";
  */
 extern std::atomic<bool> kCarverPendingCarves;
 
+/**
+ * @brief The upload progress of a carve.
+ *
+ * Blocks acknowledged by the remote endpoint are persisted in the carves
+ * domain. A carve that is interrupted resumes the same session and only sends
+ * the blocks that were not acknowledged.
+ */
+struct CarveUpload {
+  /// The session returned by the carve start endpoint.
+  std::string session_id;
+
+  /// The time the session was started.
+  uint64_t time{0};
+
+  /// The size of the carve stream.
+  size_t size{0};
+
+  /// The block size of the carve stream.
+  size_t block_size{0};
+
+  /// The SHA256 of the carve stream, if it was known when the session started.
+  std::string sha256;
+
+  /// The number of blocks acknowledged in order, from the first block.
+  size_t acknowledged{0};
+
+  /// Blocks acknowledged out of order, after the first missing block.
+  std::set<size_t> acknowledged_after;
+
+  /// Check if a block was acknowledged.
+  bool isAcknowledged(size_t block_id) const;
+
+  /// Record the acknowledgement of a block.
+  void acknowledge(size_t block_id);
+};
+
+/// Read the upload progress of a carve.
+Status getCarveUpload(const std::string& guid, CarveUpload& upload);
+
+/// Persist the upload progress of a carve.
+Status setCarveUpload(const std::string& guid, const CarveUpload& upload);
+
+/// Remove the upload progress of a carve.
+void deleteCarveUpload(const std::string& guid);
+
 /// Update an attribute for a given carve GUID.
 void updateCarveValue(const std::string& guid,
                       const std::string& key,
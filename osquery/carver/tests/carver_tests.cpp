@@ -7,26 +7,32 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+// clang-format off
+// Keep it on top of all other includes to fix double include WinSock.h header file
+// which is windows specific boost build problem
+#include <osquery/remote/utility.h>
+// clang-format on
+
 #include <boost/filesystem.hpp>
 
 #include <gtest/gtest.h>
 
 #include <osquery/carver/carver.h>
 #include <osquery/carver/carver_utils.h>
+#include <osquery/core/flags.h>
 #include <osquery/core/system.h>
 #include <osquery/database/database.h>
 #include <osquery/filesystem/fileops.h>
 #include <osquery/hashing/hashing.h>
 #include <osquery/registry/registry.h>
+#include <osquery/remote/serializers/json.h>
+#include <osquery/remote/tests/test_utils.h>
 #include <osquery/utils/json/json.h>
 
 namespace osquery {
 
 namespace fs = boost::filesystem;
 
-/// Prefix used for posix tar archive.
-const std::string kTestCarveNamePrefix = "carve_";
-
 class FakeCarver : public Carver {
  public:
   FakeCarver(const std::set<std::string>& paths,
@@ -35,11 +41,23 @@ class FakeCarver : public Carver {
       : Carver(paths, guid, requestId) {}
 
  protected:
-  Status postCarve(const boost::filesystem::path&) override {
+  Status postCarve(CarveStream& stream) override {
+    auto s = stream.stream([this](size_t, const std::string& block) {
+      uploaded_ += block;
+      return Status::success();
+    });
+    if (!s.ok()) {
+      return s;
+    }
+
     updateCarveValue(carveGuid_, "status", kCarverStatusSuccess);
     return Status::success();
   }
 
+ public:
+  /// The concatenated blocks of the carve.
+  std::string uploaded_;
+
  private:
   friend class CarverTests;
   FRIEND_TEST(CarverTests, test_carve_files_locally);
@@ -114,12 +132,10 @@ TEST_F(CarverTests, test_carve_files_locally) {
   std::string requestId = createCarveGuid();
   FakeCarver carve(getCarvePaths(), guid, requestId);
 
-  ASSERT_TRUE(carve.createPaths());
   const auto carves = carve.carveAll();
   EXPECT_EQ(carves.size(), 3U);
 
-  const auto carveFSPath = carve.getCarveDir();
-  const auto tarPath = carveFSPath / (kTestCarveNamePrefix + guid + ".tar");
+  const auto tarPath = getWorkingDir() / ("carve_" + guid + ".tar");
   const auto s = archive(carves, tarPath);
   EXPECT_TRUE(s.ok());
 
@@ -134,6 +150,329 @@ TEST_F(CarverTests, test_carve) {
   FakeCarver carve(getCarvePaths(), guid, requestId);
   auto s = carve.carve();
   ASSERT_TRUE(s.ok());
+  EXPECT_FALSE(carve.uploaded_.empty());
+}
+
+TEST_F(CarverTests, test_carve_stream) {
+  std::set<fs::path> paths;
+  for (const auto& path : getCarvePaths()) {
+    paths.insert(path);
+  }
+  paths.insert(getFilesToCarveDir() / "not_exists");
+
+  CarveStream stream(paths, 1000, false);
+  ASSERT_EQ(stream.files().size(), 3U);
+
+  // The stream has the same content as an archive of the files.
+  const auto tarPath = getWorkingDir() / "carve.tar";
+  const std::set<fs::path> files(stream.files().begin(), stream.files().end());
+  ASSERT_TRUE(archive(files, tarPath).ok());
+  std::string expected;
+  ASSERT_TRUE(readFile(tarPath, expected).ok());
+
+  ASSERT_TRUE(stream.measure().ok());
+  EXPECT_EQ(stream.size(), expected.size());
+  auto expected_sha256 =
+      hashFromFile(HashType::HASH_TYPE_SHA256, tarPath.string());
+  EXPECT_EQ(stream.sha256(), expected_sha256);
+
+  std::string uploaded;
+  size_t next_block = 0;
+  auto s = stream.stream([&](size_t block_id, const std::string& block) {
+    EXPECT_EQ(block_id, next_block++);
+    EXPECT_LE(block.size(), 1000U);
+    uploaded += block;
+    return Status::success();
+  });
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  EXPECT_EQ(next_block, stream.blocks());
+  EXPECT_EQ(uploaded, expected);
+  EXPECT_EQ(stream.sha256(), expected_sha256);
+
+  // A compressed stream is also known before it is uploaded.
+  CarveStream compressed(paths, 1000, true);
+  ASSERT_TRUE(compressed.measure().ok());
+  auto sha256 = compressed.sha256();
+  EXPECT_FALSE(sha256.empty());
+
+  uploaded.clear();
+  s = compressed.stream([&](size_t, const std::string& block) {
+    uploaded += block;
+    return Status::success();
+  });
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  EXPECT_EQ(uploaded.size(), compressed.size());
+  EXPECT_EQ(compressed.sha256(), sha256);
+
+  const auto zstPath = getWorkingDir() / "carve.tar.zst";
+  const auto extractPath = getWorkingDir() / "carve.tar.extract";
+  ASSERT_TRUE(writeTextFile(zstPath, uploaded).ok());
+  ASSERT_TRUE(decompress(zstPath, extractPath).ok());
+  std::string extracted;
+  ASSERT_TRUE(readFile(extractPath, extracted).ok());
+  EXPECT_EQ(extracted, expected);
+
+  // A failed block upload stops the stream.
+  s = compressed.stream([](size_t, const std::string&) {
+    return Status::failure("Upload failed");
+  });
+  EXPECT_FALSE(s.ok());
+}
+
+TEST_F(CarverTests, test_carve_stream_rewritten_file) {
+  auto path = getFilesToCarveDir() / "secrets.txt";
+  CarveStream stream({path}, 512, false);
+  ASSERT_TRUE(stream.measure().ok());
+
+  // The file is rewritten at the same size while it is streamed.
+  auto s = stream.stream([&](size_t, const std::string&) {
+    writeTextFile(path, "This is a message I'd rather no two saw.");
+    return Status::success();
+  });
+  ASSERT_FALSE(s.ok());
+  EXPECT_EQ(s.getCode(), CarveStream::kFilesChanged);
+}
+
+/// Send a request to a testing endpoint of the TLS server.
+Status callTestServer(const std::string& endpoint,
+                      const JSON& params,
+                      JSON& response) {
+  Request<TLSTransport, JSONSerializer> request(
+      TLSRequestHelper::makeURI(endpoint));
+  auto s = request.call(params);
+  if (!s.ok()) {
+    return s;
+  }
+  return request.getResponse(response);
+}
+
+/// Drop carve blocks from an id onwards, or none if the id is negative.
+Status dropCarveBlocks(int from) {
+  JSON params;
+  if (from >= 0) {
+    params.add("from", from);
+  } else {
+    params.add("from", rapidjson::Value(rapidjson::kNullType));
+  }
+
+  JSON response;
+  return callTestServer("/carve_drop_blocks", params, response);
+}
+
+TEST_F(CarverTests, test_carve_upload_resume) {
+  {
+    // Reset the carves.
+    std::vector<std::string> carves;
+    scanDatabaseKeys(kCarves, carves, kCarverDBPrefix);
+    for (const auto& key : carves) {
+      deleteDatabaseValue(kCarves, key);
+    }
+  }
+
+  ASSERT_TRUE(TLSServerRunner::start());
+  TLSServerRunner::setClientConfig();
+
+  auto start_endpoint = Flag::getValue("carver_start_endpoint");
+  auto continue_endpoint = Flag::getValue("carver_continue_endpoint");
+  auto block_size = Flag::getValue("carver_block_size");
+  Flag::updateValue("carver_start_endpoint", "/carve_init");
+  Flag::updateValue("carver_continue_endpoint", "/carve_block");
+  Flag::updateValue("carver_block_size", "1024");
+
+  std::string guid;
+  auto s = osquery::carvePaths(getCarvePaths(), "request-id", guid);
+  ASSERT_TRUE(s.ok());
+
+  std::set<fs::path> paths;
+  for (const auto& path : getCarvePaths()) {
+    paths.insert(path);
+  }
+  CarveStream stream(paths, 1024, false);
+  ASSERT_TRUE(stream.measure().ok());
+  ASSERT_GT(stream.blocks(), 4U);
+
+  // Every block after the first 4 fails, the upload is interrupted.
+  ASSERT_TRUE(dropCarveBlocks(4).ok());
+  {
+    Carver carve(getCarvePaths(), guid, "request-id");
+    EXPECT_FALSE(carve.carve().ok());
+  }
+
+  CarveUpload upload;
+  ASSERT_TRUE(getCarveUpload(guid, upload).ok());
+  EXPECT_FALSE(upload.session_id.empty());
+  EXPECT_EQ(upload.size, stream.size());
+  EXPECT_EQ(upload.acknowledged, 4U);
+  EXPECT_TRUE(upload.acknowledged_after.empty());
+
+  // The next runner resumes the failed upload.
+  ASSERT_TRUE(dropCarveBlocks(-1).ok());
+  {
+    CarverRunner<Carver> runner;
+    runner.start();
+    EXPECT_EQ(runner.carves(), 1U);
+  }
+
+  CarveUpload completed;
+  EXPECT_FALSE(getCarveUpload(guid, completed).ok());
+
+  std::string carve;
+  ASSERT_TRUE(getDatabaseValue(kCarves, kCarverDBPrefix + guid, carve).ok());
+  JSON tree;
+  ASSERT_TRUE(tree.fromString(carve).ok());
+  EXPECT_EQ(std::string(tree.doc()["status"].GetString()),
+            kCarverStatusSuccess);
+
+  // A single session was started, and each block was received once.
+  JSON requests;
+  s = callTestServer("/test_read_requests", JSON(), requests);
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  ASSERT_TRUE(requests.doc().IsArray());
+
+  size_t sessions = 0;
+  std::map<size_t, size_t> received;
+  for (const auto& request : requests.doc().GetArray()) {
+    std::string command = request["command"].GetString();
+    if (command == "carve_init" && request["carve_id"].GetString() == guid) {
+      sessions++;
+    } else if (command == "carve_block" &&
+               request["session_id"].GetString() == upload.session_id) {
+      received[JSON::valueToSize(request["block_id"])]++;
+    }
+  }
+  EXPECT_EQ(sessions, 1U);
+  EXPECT_EQ(received.size(), stream.blocks());
+  for (const auto& block : received) {
+    EXPECT_EQ(block.second, 1U) << "Block " << block.first;
+  }
+
+  Flag::updateValue("carver_start_endpoint", start_endpoint);
+  Flag::updateValue("carver_continue_endpoint", continue_endpoint);
+  Flag::updateValue("carver_block_size", block_size);
+  TLSServerRunner::stop();
+  TLSServerRunner::unsetClientConfig();
+}
+
+TEST_F(CarverTests, test_carve_upload_restart) {
+  ASSERT_TRUE(TLSServerRunner::start());
+  TLSServerRunner::setClientConfig();
+
+  auto start_endpoint = Flag::getValue("carver_start_endpoint");
+  auto continue_endpoint = Flag::getValue("carver_continue_endpoint");
+  auto block_size = Flag::getValue("carver_block_size");
+  Flag::updateValue("carver_start_endpoint", "/carve_init");
+  Flag::updateValue("carver_continue_endpoint", "/carve_block");
+  Flag::updateValue("carver_block_size", "1024");
+
+  std::string guid;
+  auto s = osquery::carvePaths(getCarvePaths(), "request-id", guid);
+  ASSERT_TRUE(s.ok());
+
+  // The first attempt is interrupted after 4 blocks.
+  ASSERT_TRUE(dropCarveBlocks(4).ok());
+  {
+    Carver carve(getCarvePaths(), guid, "request-id");
+    EXPECT_FALSE(carve.carve().ok());
+  }
+
+  CarveUpload interrupted;
+  ASSERT_TRUE(getCarveUpload(guid, interrupted).ok());
+  EXPECT_EQ(interrupted.acknowledged, 4U);
+
+  // A file rewritten at the same size does not resume the upload.
+  writeTextFile(getFilesToCarveDir() / "secrets.txt",
+                "This is a message I'd rather no two saw.");
+  std::set<fs::path> paths;
+  for (const auto& path : getCarvePaths()) {
+    paths.insert(path);
+  }
+  CarveStream stream(paths, 1024, false);
+  ASSERT_TRUE(stream.measure().ok());
+  EXPECT_EQ(stream.size(), interrupted.size);
+  EXPECT_NE(stream.sha256(), interrupted.sha256);
+
+  JSON requests;
+  s = callTestServer("/test_read_requests", JSON(), requests);
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  ASSERT_TRUE(requests.doc().IsArray());
+  auto first_requests = requests.doc().GetArray().Size();
+
+  ASSERT_TRUE(dropCarveBlocks(-1).ok());
+  {
+    Carver carve(getCarvePaths(), guid, "request-id");
+    s = carve.carve();
+    EXPECT_TRUE(s.ok()) << s.getMessage();
+  }
+
+  std::string carve;
+  ASSERT_TRUE(getDatabaseValue(kCarves, kCarverDBPrefix + guid, carve).ok());
+  JSON tree;
+  ASSERT_TRUE(tree.fromString(carve).ok());
+  EXPECT_EQ(std::string(tree.doc()["sha256"].GetString()), stream.sha256());
+
+  // A new session was started and received every block of the new content.
+  s = callTestServer("/test_read_requests", JSON(), requests);
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  ASSERT_TRUE(requests.doc().IsArray());
+
+  size_t sessions = 0;
+  std::set<std::string> block_sessions;
+  std::map<size_t, size_t> received;
+  const auto& history = requests.doc().GetArray();
+  for (auto i = first_requests; i < history.Size(); i++) {
+    const auto& request = history[i];
+    std::string command = request["command"].GetString();
+    if (command == "carve_init" && request["carve_id"].GetString() == guid) {
+      sessions++;
+    } else if (command == "carve_block") {
+      block_sessions.insert(request["session_id"].GetString());
+      received[JSON::valueToSize(request["block_id"])]++;
+    }
+  }
+  EXPECT_EQ(sessions, 1U);
+  ASSERT_EQ(block_sessions.size(), 1U);
+  EXPECT_NE(*block_sessions.begin(), interrupted.session_id);
+  EXPECT_EQ(received.size(), stream.blocks());
+  for (const auto& block : received) {
+    EXPECT_EQ(block.second, 1U) << "Block " << block.first;
+  }
+
+  Flag::updateValue("carver_start_endpoint", start_endpoint);
+  Flag::updateValue("carver_continue_endpoint", continue_endpoint);
+  Flag::updateValue("carver_block_size", block_size);
+  TLSServerRunner::stop();
+  TLSServerRunner::unsetClientConfig();
+}
+
+TEST_F(CarverTests, test_carve_upload_acknowledge) {
+  CarveUpload upload;
+  upload.acknowledge(1);
+  upload.acknowledge(3);
+  EXPECT_EQ(upload.acknowledged, 0U);
+  EXPECT_TRUE(upload.isAcknowledged(3));
+  EXPECT_FALSE(upload.isAcknowledged(0));
+
+  upload.acknowledge(0);
+  EXPECT_EQ(upload.acknowledged, 2U);
+  EXPECT_EQ(upload.acknowledged_after, std::set<size_t>{3});
+
+  upload.acknowledge(2);
+  EXPECT_EQ(upload.acknowledged, 4U);
+  EXPECT_TRUE(upload.acknowledged_after.empty());
+
+  // The progress survives a restart.
+  upload.session_id = "session";
+  upload.acknowledge(6);
+  ASSERT_TRUE(setCarveUpload("guid", upload).ok());
+
+  CarveUpload persisted;
+  ASSERT_TRUE(getCarveUpload("guid", persisted).ok());
+  EXPECT_EQ(persisted.session_id, "session");
+  EXPECT_EQ(persisted.acknowledged, 4U);
+  EXPECT_EQ(persisted.acknowledged_after, std::set<size_t>{6});
+
+  deleteCarveUpload("guid");
+  EXPECT_FALSE(getCarveUpload("guid", persisted).ok());
 }
 
 TEST_F(CarverTests, test_schedule_carves) {
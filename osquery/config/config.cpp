@@ -13,6 +13,7 @@
 #include <map>
 #include <queue>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <boost/algorithm/string/replace.hpp>
@@ -52,6 +53,32 @@ const int kMaxConfigSize = 1024 * 1024;
 using ConfigMap = std::map<std::string, std::string>;
 
 std::atomic<bool> is_first_time_refresh(true);
+
+/// Hash the serialized content of a JSON value, to find changed content.
+std::string hashValue(const rapidjson::Value& value) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  value.Accept(writer);
+
+  Hash hash(HASH_TYPE_SHA1);
+  hash.update(buffer.GetString(), buffer.GetSize());
+  return hash.digest();
+}
+
+/// Hash the content of the top-level keys a config parser receives.
+std::string hashParserConfig(const ConfigParserPlugin& parser,
+                             const rapidjson::Value& obj) {
+  Hash hash(HASH_TYPE_SHA1);
+  for (const auto& key : parser.keys()) {
+    hash.update(key.c_str(), key.size() + 1);
+    auto it = obj.FindMember(key);
+    if (it != obj.MemberEnd()) {
+      auto value = hashValue(it->value);
+      hash.update(value.c_str(), value.size());
+    }
+  }
+  return hash.digest();
+}
 }; // namespace
 
 /**
@@ -173,6 +200,9 @@ class Schedule : private boost::noncopyable {
   /// Remove all packs by source.
   void removeAll(const std::string& source);
 
+  /// Check if a pack with a name and source exists.
+  bool contains(const std::string& pack, const std::string& source) const;
+
   /// Boost gives us a nice template for maintaining the state of the iterator
   using iterator = boost::filter_iterator<Step, container::iterator>;
 
@@ -194,6 +224,78 @@ class Schedule : private boost::noncopyable {
    */
   std::string failed_query_;
 
+  /**
+   * @brief Find the queries due at a step, using the queue of next steps.
+   *
+   * @param step the schedule step.
+   * @param due [output] indexes into queries_ of the due queries, in order.
+   * The indexes are valid while the generation is unchanged.
+   * @return the next step a query is due after this step, or 0.
+   */
+  uint64_t takeDue(uint64_t step, std::vector<size_t>& due);
+
+  /// Request the queue is rebuilt, for example after packs change.
+  void invalidate() {
+    generation_++;
+  }
+
+  /// Incremented whenever packs change, and queued queries may be removed.
+  uint64_t generation() const {
+    return generation_;
+  }
+
+ private:
+  /// Rebuild the queue with each query's first step at or after a step.
+  void buildQueue(uint64_t step);
+
+ private:
+  /**
+   * @brief A scheduled query in the queue of next steps.
+   *
+   * The pack and query are owned by packs_, and are only valid for the
+   * generation the queue was built for.
+   */
+  struct QueuedQuery {
+    /// The pack containing the query, packs may stop executing.
+    Pack* pack{nullptr};
+
+    /// The query name, synthetic for packs other than "main".
+    std::string name;
+
+    ScheduledQuery* query{nullptr};
+  };
+
+  /// The step a query is next due, ordered by step then index.
+  struct QueueStep {
+    uint64_t step{0};
+
+    /// The index into queries_.
+    size_t index{0};
+
+    /// The generation queries_ was built for, checked when popped.
+    uint64_t generation{0};
+
+    bool operator>(const QueueStep& other) const {
+      return std::tie(step, index) > std::tie(other.step, other.index);
+    }
+  };
+
+  /// Queries with a positive interval, in pack order.
+  std::vector<QueuedQuery> queries_;
+
+  /// A min-heap of the next step each query is due.
+  std::priority_queue<QueueStep, std::vector<QueueStep>, std::greater<>>
+      queue_;
+
+  /// The current generation of packs.
+  uint64_t generation_{1};
+
+  /// The generation of packs the queue was built for.
+  uint64_t queue_generation_{0};
+
+  /// The most recent step the queue was used for.
+  uint64_t last_step_{0};
+
   /**
    * @brief List of denylisted queries.
    *
@@ -214,6 +316,7 @@ bool Schedule::Step::operator()(const PackRef& pack) const {
 void Schedule::add(PackRef pack) {
   remove(pack->getName(), pack->getSource());
   packs_.push_back(std::move(pack));
+  invalidate();
 }
 
 void Schedule::remove(const std::string& pack) {
@@ -232,6 +335,7 @@ void Schedule::remove(const std::string& pack, const std::string& source) {
         return false;
       });
   packs_.erase(new_end, packs_.end());
+  invalidate();
 }
 
 void Schedule::removeAll(const std::string& source) {
@@ -245,6 +349,15 @@ void Schedule::removeAll(const std::string& source) {
         return false;
       });
   packs_.erase(new_end, packs_.end());
+  invalidate();
+}
+
+bool Schedule::contains(const std::string& pack,
+                        const std::string& source) const {
+  return std::any_of(
+      packs_.begin(), packs_.end(), [&pack, &source](const PackRef& p) {
+        return p->getName() == pack && p->getSource() == source;
+      });
 }
 
 Schedule::iterator Schedule::begin() {
@@ -259,6 +372,68 @@ PackRef& Schedule::last() {
   return packs_.back();
 }
 
+/// Queries due at most this many skipped steps ago run when packs change.
+const uint64_t kMaxSkippedSteps = 60;
+
+void Schedule::buildQueue(uint64_t step) {
+  queries_.clear();
+  queue_ = decltype(queue_)();
+  for (auto& pack : packs_) {
+    for (auto& it : pack->getSchedule()) {
+      auto interval = it.second.splayed_interval;
+      if (interval == 0) {
+        continue;
+      }
+
+      QueuedQuery queued;
+      queued.pack = pack.get();
+      queued.name = it.first;
+      // The query name may be synthetic.
+      if (pack->getName() != "main") {
+        queued.name = "pack" + FLAGS_pack_delimiter + pack->getName() +
+                      FLAGS_pack_delimiter + it.first;
+      }
+      queued.query = &it.second;
+
+      // The first step at or after the given step with the query's splay.
+      auto next = ((step + interval - 1) / interval) * interval;
+      queue_.push({next, queries_.size(), generation_});
+      queries_.push_back(std::move(queued));
+    }
+  }
+  queue_generation_ = generation_;
+}
+
+uint64_t Schedule::takeDue(uint64_t step, std::vector<size_t>& due) {
+  bool changed = (queue_generation_ != generation_);
+  if (changed || step < last_step_) {
+    // Queries due at steps skipped since the last use run at this step.
+    auto first = step;
+    if (changed && last_step_ < step &&
+        step - last_step_ <= kMaxSkippedSteps) {
+      first = last_step_ + 1;
+    }
+    buildQueue(first);
+  }
+  last_step_ = step;
+
+  while (!queue_.empty() && queue_.top().step <= step) {
+    auto entry = queue_.top();
+    queue_.pop();
+    if (entry.generation == generation_) {
+      due.push_back(entry.index);
+    }
+  }
+
+  // Each due query is next due at the next multiple of its interval.
+  for (auto index : due) {
+    auto interval = queries_[index].query->splayed_interval;
+    queue_.push({(step / interval + 1) * interval, index, generation_});
+  }
+
+  return queue_.empty() ? 0 : queue_.top().step;
+}
+
 /**
  * @brief A thread that periodically reloads configuration state.
  *
@@ -419,6 +594,35 @@ static inline bool denylistExpired(uint64_t blt, const ScheduledQuery& query) {
   return false;
 }
 
+/**
+ * @brief Check if a query is denylisted, removing an expired denylist entry.
+ *
+ * @param denylist The schedule's denylist.
+ * @param name The, possibly synthetic, query name.
+ * @param query The scheduled query, its denylisted state is updated.
+ */
+static bool checkDenylist(std::map<std::string, uint64_t>& denylist,
+                          const std::string& name,
+                          ScheduledQuery& query) {
+  // They query may have failed and been added to the schedule's denylist.
+  auto denylisted_query = denylist.find(name);
+  if (denylisted_query == denylist.end()) {
+    return false;
+  }
+
+  if (denylistExpired(denylisted_query->second, query)) {
+    // The denylisted query passed the expiration time (remove).
+    denylist.erase(denylisted_query);
+    saveScheduleDenylist(denylist);
+    query.denylisted = false;
+    return false;
+  }
+
+  // The query is still denylisted.
+  query.denylisted = true;
+  return true;
+}
+
 void Config::scheduledQueries(
     std::function<void(std::string name, const ScheduledQuery& query)>
         predicate,
@@ -433,22 +637,10 @@ void Config::scheduledQueries(
                FLAGS_pack_delimiter + it.first;
       }
 
-      // They query may have failed and been added to the schedule's denylist.
-      auto denylisted_query = schedule_->denylist_.find(name);
-      if (denylisted_query != schedule_->denylist_.end()) {
-        if (denylistExpired(denylisted_query->second, it.second)) {
-          // The denylisted query passed the expiration time (remove).
-          schedule_->denylist_.erase(denylisted_query);
-          saveScheduleDenylist(schedule_->denylist_);
-          it.second.denylisted = false;
-        } else {
-          // The query is still denylisted.
-          it.second.denylisted = true;
-          if (!denylisted) {
-            // The caller does not want denylisted queries.
-            continue;
-          }
-        }
+      if (checkDenylist(schedule_->denylist_, name, it.second) &&
+          !denylisted) {
+        // The caller does not want denylisted queries.
+        continue;
       }
 
       // Call the predicate.
@@ -457,6 +649,31 @@ void Config::scheduledQueries(
   }
 }
 
+uint64_t Config::dueQueries(
+    uint64_t step,
+    std::function<void(const std::string& name, const ScheduledQuery& query)>
+        predicate) const {
+  RecursiveLock lock(config_schedule_mutex_);
+  std::vector<size_t> due;
+  auto next = schedule_->takeDue(step, due);
+  auto generation = schedule_->generation();
+  for (auto index : due) {
+    if (schedule_->generation() != generation) {
+      // The predicate changed the packs, the queued queries may be removed.
+      return step + 1;
+    }
+
+    const auto& queued = schedule_->queries_[index];
+    if (!queued.pack->shouldPackExecute() ||
+        checkDenylist(schedule_->denylist_, queued.name, *queued.query)) {
+      continue;
+    }
+
+    predicate(queued.name, *queued.query);
+  }
+  return (schedule_->generation() != generation) ? step + 1 : next;
+}
+
 void Config::packs(std::function<void(const Pack& pack)> predicate) const {
   RecursiveLock lock(config_schedule_mutex_);
   for (PackRef& pack : schedule_->packs_) {
@@ -663,38 +880,37 @@ Status Config::updateSource(const std::string& source,
     return Status(2);
   }
 
-  {
+  // load the config (source.second) into a JSON object.
+  auto doc = JSON::newObject();
+  auto status = parseSource(json, doc);
+  if (!status.ok()) {
     RecursiveLock lock(config_schedule_mutex_);
     // Remove all packs from this source.
     schedule_->removeAll(source);
     // Remove all files from this source.
     removeFiles(source);
+    pack_hashes_.erase(source);
+    parser_hashes_.erase(source);
+    return status;
   }
 
-  // load the config (source.second) into a JSON object.
-  auto doc = JSON::newObject();
-  auto clone = json;
-  stripConfigComments(clone);
-
-  // Since we use iterative parsing, we limit the size of the JSON
-  // string to a sane value to avoid memory exhaustion.
-  if (clone.size() > kMaxConfigSize) {
-    return Status::failure(
-        "Error parsing the config JSON: the config size exceeds the limit "
-        "of " +
-        std::to_string(kMaxConfigSize) + " bytes");
-  }
-
-  if (!doc.fromString(clone, JSON::ParseMode::Iterative) ||
-      !doc.doc().IsObject()) {
-    return Status::failure("Error parsing the config JSON");
+  RecursiveLock lock(config_schedule_mutex_);
+  auto options = getParser("options");
+  if (options != nullptr) {
+    auto& parser_hashes = parser_hashes_[source];
+    auto it = parser_hashes.find("options");
+    if (it == parser_hashes.end() ||
+        it->second != hashParserConfig(*options, doc.doc())) {
+      // Options may change how any pack or parser applies, rebuild them all.
+      schedule_->removeAll(source);
+      pack_hashes_.erase(source);
+      parser_hashes.clear();
+    }
   }
 
-  auto status = validateConfig(doc);
-  if (!status.ok()) {
-    return Status::failure("Error validating the config JSON: " +
-                           status.getMessage());
-  }
+  // Packs are rebuilt only if their content changed.
+  auto previous = std::move(pack_hashes_[source]);
+  pack_hashes_[source].clear();
 
   // extract the "schedule" key and store it as the main pack
   auto& rf = RegistryFactory::get();
@@ -705,7 +921,7 @@ Status Config::updateSource(const std::string& source,
       auto queries_obj = main_doc.getObject();
       main_doc.copyFrom(schedule, queries_obj);
       main_doc.add("queries", queries_obj);
-      addPack("main", source, main_doc.doc());
+      applyPack("main", source, main_doc.doc(), previous);
     }
   }
 
@@ -717,21 +933,82 @@ Status Config::updateSource(const std::string& source,
         std::string pack_name = pack.name.GetString();
         if (pack.value.IsObject()) {
           // The pack is a JSON object, treat the content as pack data.
-          addPack(pack_name, source, pack.value);
+          applyPack(pack_name, source, pack.value, previous);
         } else if (pack.value.IsString()) {
-          genPack(pack_name, source, pack.value.GetString());
+          genPack(pack_name, source, pack.value.GetString(), previous);
         }
       }
     }
   }
 
+  // Remove the packs that are no longer part of the source.
+  const auto& current = pack_hashes_[source];
+  for (const auto& pack : previous) {
+    if (current.count(pack.first) == 0) {
+      schedule_->remove(pack.first, source);
+    }
+  }
+
   applyParsers(source, doc.doc(), false);
   return Status::success();
 }
 
+Status Config::parseSource(const std::string& json, JSON& doc) {
+  auto clone = json;
+  stripConfigComments(clone);
+
+  // Since we use iterative parsing, we limit the size of the JSON
+  // string to a sane value to avoid memory exhaustion.
+  if (clone.size() > kMaxConfigSize) {
+    return Status::failure(
+        "Error parsing the config JSON: the config size exceeds the limit "
+        "of " +
+        std::to_string(kMaxConfigSize) + " bytes");
+  }
+
+  if (!doc.fromString(clone, JSON::ParseMode::Iterative) ||
+      !doc.doc().IsObject()) {
+    return Status::failure("Error parsing the config JSON");
+  }
+
+  auto status = validateConfig(doc);
+  if (!status.ok()) {
+    return Status::failure("Error validating the config JSON: " +
+                           status.getMessage());
+  }
+  return Status::success();
+}
+
+void Config::applyPack(const std::string& name,
+                       const std::string& source,
+                       const rj::Value& obj,
+                       const std::map<std::string, std::string>& previous) {
+  if (name == "*") {
+    // A multi-pack generated by the config plugin, diff each of its packs.
+    for (const auto& pack : obj.GetObject()) {
+      if (!pack.value.IsObject()) {
+        LOG(WARNING) << "Error parsing pack: " << pack.name.GetString()
+                     << ": the value should be an object";
+        continue;
+      }
+      applyPack(pack.name.GetString(), source, pack.value, previous);
+    }
+    return;
+  }
+
+  auto hash = hashValue(obj);
+  auto it = previous.find(name);
+  if (it == previous.end() || it->second != hash ||
+      !schedule_->contains(name, source)) {
+    addPack(name, source, obj);
+  }
+  pack_hashes_[source][name] = std::move(hash);
+}
+
 Status Config::genPack(const std::string& name,
                        const std::string& source,
-                       const std::string& target) {
+                       const std::string& target,
+                       const std::map<std::string, std::string>& previous) {
   // If the pack value is a string (and not a JSON object) then it is a
   // resource to be handled by the config plugin.
   PluginResponse response;
@@ -754,7 +1031,7 @@ Status Config::genPack(const std::string& name,
   if (!doc.fromString(clone) || !doc.doc().IsObject()) {
     LOG(WARNING) << "Error parsing the \"" << name << "\" pack JSON";
   } else {
-    addPack(name, source, doc.doc());
+    applyPack(name, source, doc.doc(), previous);
   }
 
   return Status::success();
@@ -765,9 +1042,21 @@ void Config::applyParsers(const std::string& source,
                           bool pack) {
   assert(obj.IsObject());
 
-  auto applyParser = [=](const std::shared_ptr<ConfigParserPlugin>& parser,
+  auto applyParser = [=](const std::string& name,
+                         const std::shared_ptr<ConfigParserPlugin>& parser,
                          const std::string& source,
                          const rj::Value& obj) {
+    if (!pack) {
+      // Skip parsers whose keys did not change since they were applied.
+      auto hash = hashParserConfig(*parser, obj);
+      auto& hashes = parser_hashes_[source];
+      auto it = hashes.find(name);
+      if (it != hashes.end() && it->second == hash) {
+        return;
+      }
+      hashes[name] = std::move(hash);
+    }
+
     // For each key requested by the parser, add a property tree reference.
     std::map<std::string, JSON> parser_config;
     for (const auto& key : parser->keys()) {
@@ -806,7 +1095,7 @@ void Config::applyParsers(const std::string& source,
   if (options_plugin != plugins.end()) {
     auto parser = getParser(options_plugin->second, options_plugin->first);
     if (parser != nullptr && parser.get() != nullptr) {
-      applyParser(parser, source, obj);
+      applyParser(options_plugin->first, parser, source, obj);
     }
   }
 
@@ -817,7 +1106,7 @@ void Config::applyParsers(const std::string& source,
     }
     auto parser = getParser(plugin.second, plugin.first);
     if (parser != nullptr && parser.get() != nullptr) {
-      applyParser(parser, source, obj);
+      applyParser(plugin.first, parser, source, obj);
     }
   }
 }
@@ -964,8 +1253,11 @@ void Config::reset() {
 
   schedule_ = std::make_unique<Schedule>();
   std::map<std::string, QueryPerformance>().swap(performance_);
+  std::map<std::string, uint64_t>().swap(saved_timestamps_);
   std::map<std::string, FileCategories>().swap(files_);
   std::map<std::string, std::string>().swap(hash_);
+  pack_hashes_.clear();
+  parser_hashes_.clear();
   valid_ = false;
   loaded_ = false;
   is_first_time_refresh = true;
@@ -998,46 +1290,22 @@ void ConfigParserPlugin::reset() {
 }
 
 void Config::recordQueryPerformance(const std::string& name,
-                                    uint64_t delay,
-                                    const Row& r0,
-                                    const Row& r1) {
+                                    const QueryResourceUsage& usage) {
   RecursiveLock lock(config_performance_mutex_);
-  if (performance_.count(name) == 0) {
-    performance_[name] = QueryPerformance();
-  }
-
-  // Grab access to the non-const schedule item.
-  auto& query = performance_.at(name);
-  if (!r1.at("user_time").empty() && !r0.at("user_time").empty()) {
-    auto ut1 = tryTo<long long>(r1.at("user_time"));
-    auto ut0 = tryTo<long long>(r0.at("user_time"));
-    auto diff = (ut1 && ut0) ? ut1.take() - ut0.take() : 0;
-    if (diff > 0) {
-      query.user_time += diff;
-    }
+  auto& query = performance_[name];
+  query.user_time += usage.user_time;
+  query.system_time += usage.system_time;
+
+  if (usage.memory > 0) {
+    // Memory is stored as an average of heap changes between query executions.
+    query.average_memory = (query.average_memory * query.executions) +
+                           static_cast<uint64_t>(usage.memory);
+    query.average_memory = (query.average_memory / (query.executions + 1));
   }
 
-  if (!r1.at("system_time").empty() && !r0.at("system_time").empty()) {
-    auto st1 = tryTo<long long>(r1.at("system_time"));
-    auto st0 = tryTo<long long>(r0.at("system_time"));
-    auto diff = (st1 && st0) ? st1.take() - st0.take() : 0;
-    if (diff > 0) {
-      query.system_time += diff;
-    }
-  }
-
-  if (!r1.at("resident_size").empty() && !r0.at("resident_size").empty()) {
-    auto rs1 = tryTo<long long>(r1.at("resident_size"));
-    auto rs0 = tryTo<long long>(r0.at("resident_size"));
-    auto diff = (rs1 && rs0) ? rs1.take() - rs0.take() : 0;
-    if (diff > 0) {
-      // Memory is stored as an average of RSS changes between query executions.
-      query.average_memory = (query.average_memory * query.executions) + diff;
-      query.average_memory = (query.average_memory / (query.executions + 1));
-    }
-  }
-
-  query.wall_time += delay;
+  query.wall_time_ms += usage.wall_time_ms;
+  query.wall_time = query.wall_time_ms / 1000;
+  query.output_rows += usage.rows;
   query.executions += 1;
   query.last_executed = getUnixTime();
 
@@ -1052,8 +1320,18 @@ void Config::recordQueryStart(const std::string& name) {
   // When configuration updates occur the previous schedule is searched for
   // 'stale' query names, aka those that have week-old or longer last execute
   // timestamps. Offending queries have their database results purged.
+  // An hour of precision is plenty, so most executions skip this write.
+  auto now = getUnixTime();
+  {
+    RecursiveLock lock(config_performance_mutex_);
+    auto& saved = saved_timestamps_[name];
+    if (saved != 0 && now < saved + 3600) {
+      return;
+    }
+    saved = now;
+  }
   setDatabaseValue(
-      kPersistentSettings, "timestamp." + name, std::to_string(getUnixTime()));
+      kPersistentSettings, "timestamp." + name, std::to_string(now));
 }
 
 void Config::getPerformanceStats(
@@ -74,9 +74,9 @@ class Config : private boost::noncopyable {
   /**
    * @brief Record performance (monitoring) information about a scheduled query.
    *
-   * The daemon and query scheduler will optionally record process metadata
-   * before and after executing each query. This can be compared and reported
-   * on an interval or within the osquery_schedule table.
+   * The daemon and query scheduler will optionally record the resources used
+   * by the executing thread before and after each query. The differences are
+   * reported within the osquery_schedule table.
    *
    * The config consumes and calculates the optional performance differentials.
    * It would also be possible to store this in the RocksDB backing store or
@@ -85,15 +85,10 @@ class Config : private boost::noncopyable {
    * to the updates/changes reflected in the schedule, from the config.
    *
    * @param name The unique name of the scheduled item
-   * @param delay Number of seconds (wall time) taken by the query
-   * @param size Number of characters generated by query
-   * @param r0 the process row before the query
-   * @param r1 the process row after the query
+   * @param usage the resources used by one execution of the query
    */
   void recordQueryPerformance(const std::string& name,
-                              uint64_t delay,
-                              const Row& r0,
-                              const Row& r1);
+                              const QueryResourceUsage& usage);
 
   /**
    * @brief Record a query 'initialization', meaning the query will run.
@@ -104,6 +99,9 @@ class Config : private boost::noncopyable {
    * store. On process start, or worker state, if any dirty bit is set then
    * it is assumed that the current start is a result of a previous abort.
    *
+   * The time of the execution is also saved, for the results eviction in
+   * Config::purge. It is only rewritten when the saved time is an hour old.
+   *
    * @param name THe unique name of the scheduled item
    */
   void recordQueryStart(const std::string& name);
@@ -185,6 +183,26 @@ class Config : private boost::noncopyable {
           predicate,
       bool denylisted = false) const;
 
+  /**
+   * @brief Call a function for each scheduled query due at a schedule step.
+   *
+   * A query is due when the step is a multiple of its splayed interval. Due
+   * queries are found using a queue of each query's next step, rebuilt when
+   * packs change, so a step only visits the queries that are due. Queries
+   * due at steps skipped since the last call are due at this step.
+   * Denylisted queries and queries of packs that should not execute are not
+   * called.
+   *
+   * @param step the schedule step, in seconds.
+   * @param predicate is a function which accepts the name of the query and
+   * the ScheduledQuery struct of the queries data.
+   * @return the next step a query is due, or 0 if no queries are scheduled.
+   */
+  uint64_t dueQueries(
+      uint64_t step,
+      std::function<void(const std::string& name,
+                         const ScheduledQuery& query)> predicate) const;
+
   /**
    * @brief Map a function across the set of configured files
    *
@@ -269,9 +287,33 @@ class Config : private boost::noncopyable {
    */
   Status load();
 
-  /// A step method for Config::update.
+  /**
+   * @brief A step method for Config::update, apply the content of a source.
+   *
+   * The content is compared with the content last applied from the source.
+   * Only packs that were added, removed or changed are rebuilt, unchanged
+   * packs keep their queries and state. Config parsers are only updated if
+   * the content of their keys changed. A change to the options rebuilds every
+   * pack and parser of the source.
+   */
   Status updateSource(const std::string& source, const std::string& json);
 
+  /// Strip comments, parse and validate the content of a source.
+  Status parseSource(const std::string& json, JSON& doc);
+
+  /**
+   * @brief Add or replace a pack of a source if its content changed.
+   *
+   * @param name The pack name, or "*" for a multi-pack.
+   * @param source The config content source identifier.
+   * @param obj The pack content.
+   * @param previous The hashes of the packs of the source before the update.
+   */
+  void applyPack(const std::string& name,
+                 const std::string& source,
+                 const rapidjson::Value& obj,
+                 const std::map<std::string, std::string>& previous);
+
   /**
    * @brief Generate pack content from a resource handled by the Plugin.
    *
@@ -285,11 +327,13 @@ class Config : private boost::noncopyable {
    * @param name A pack name provided and handled by the ConfigPlugin.
    * @param source The config content source identifier.
    * @param target A resource (path, URL, etc) handled by the ConfigPlugin.
+   * @param previous The hashes of the packs of the source before the update.
    * @return status On success the response will be JSON parsed.
    */
   Status genPack(const std::string& name,
                  const std::string& source,
-                 const std::string& target);
+                 const std::string& target,
+                 const std::map<std::string, std::string>& previous);
 
   /**
    * @brief Apply each ConfigParser to an input JSON document.
@@ -333,6 +377,9 @@ class Config : private boost::noncopyable {
   /// A set of performance stats for each query in the schedule.
   std::map<std::string, QueryPerformance> performance_;
 
+  /// The last execution times saved to the database, for each query.
+  std::map<std::string, uint64_t> saved_timestamps_;
+
   /// A set of named categories filled with filesystem globbing paths.
   using FileCategories = std::map<std::string, std::vector<std::string>>;
   std::map<std::string, FileCategories> files_;
@@ -340,6 +387,12 @@ class Config : private boost::noncopyable {
   /// A set of hashes for each source of the config.
   std::map<std::string, std::string> hash_;
 
+  /// The hashes of the applied content of each pack, by source and pack.
+  std::map<std::string, std::map<std::string, std::string>> pack_hashes_;
+
+  /// The hashes of the keys applied by each config parser, by source.
+  std::map<std::string, std::map<std::string, std::string>> parser_hashes_;
+
   /// Check if the config received valid/parsable content from a config plugin.
   bool valid_{false};
 
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -525,6 +526,64 @@ TEST_F(ConfigTests, test_nondenylist_query) {
   EXPECT_FALSE(query->second);
 }
 
+TEST_F(ConfigTests, test_due_queries) {
+  // Intervals this small are not changed by the splay.
+  auto pack = JSON::newObject();
+  pack.fromString(R"json({
+    "queries": {
+      "two": {"query": "select 2", "interval": 2},
+      "three": {"query": "select 3", "interval": 3},
+      "five": {"query": "select 5", "interval": 5}
+    }
+  })json");
+  get().addPack("due_pack", "", pack.doc());
+
+  std::map<std::string, uint64_t> intervals;
+  get().scheduledQueries(
+      ([&intervals](std::string name, const ScheduledQuery& query) {
+        intervals[name] = query.splayed_interval;
+      }));
+  ASSERT_EQ(intervals.size(), 3U);
+
+  // Each step visits exactly the queries whose interval divides the step.
+  for (uint64_t step = 3000; step < 3031; step++) {
+    std::set<std::string> due;
+    auto next = get().dueQueries(
+        step, ([&due](const std::string& name, const ScheduledQuery&) {
+          due.insert(name);
+        }));
+
+    std::set<std::string> expected;
+    uint64_t expected_next = 0;
+    for (const auto& query : intervals) {
+      if (step % query.second == 0) {
+        expected.insert(query.first);
+      }
+      auto query_next = (step / query.second + 1) * query.second;
+      if (expected_next == 0 || query_next < expected_next) {
+        expected_next = query_next;
+      }
+    }
+    EXPECT_EQ(due, expected) << "at step " << step;
+    EXPECT_EQ(next, expected_next) << "at step " << step;
+  }
+
+  // After a pack change, queries due at skipped steps run at the next step.
+  // The "two" and "three" queries were due at steps 3032 and 3033.
+  get().addPack("due_pack", "", pack.doc());
+  std::set<std::string> due;
+  get().dueQueries(3034,
+                   ([&due](const std::string& name, const ScheduledQuery&) {
+                     due.insert(name);
+                   }));
+  EXPECT_EQ(due.size(), 2U);
+
+  get().removePack("due_pack");
+  auto next = get().dueQueries(
+      3035, ([](const std::string& name, const ScheduledQuery&) {}));
+  EXPECT_EQ(next, 0U);
+}
+
 class TestConfigParserPlugin : public ConfigParserPlugin {
  public:
   std::vector<std::string> keys() const override {
@@ -669,6 +728,71 @@ TEST_F(ConfigTests, test_pack_file_paths) {
   EXPECT_EQ(count, 0U);
 }
 
+TEST_F(ConfigTests, test_incremental_update) {
+  auto& rf = RegistryFactory::get();
+  rf.registry("config_parser")
+      ->add("test", std::make_shared<TestConfigParserPlugin>());
+
+  auto packs = [this]() {
+    std::map<std::string, const Pack*> packs;
+    get().packs([&packs](const Pack& pack) { packs[pack.getName()] = &pack; });
+    return packs;
+  };
+
+  auto query = [](const Pack* pack) {
+    return pack->getSchedule().at("q").query;
+  };
+
+  TestConfigParserPlugin::update_called = false;
+  get().update({{"data", R"json({
+    "list": ["a"],
+    "packs": {
+      "kept": {"queries": {"q": {"query": "select 1", "interval": 60}}},
+      "changed": {"queries": {"q": {"query": "select 2", "interval": 60}}},
+      "removed": {"queries": {"q": {"query": "select 3", "interval": 60}}}
+    }
+  })json"}});
+  EXPECT_TRUE(TestConfigParserPlugin::update_called);
+
+  auto first = packs();
+  ASSERT_EQ(first.size(), 3U);
+
+  // Only the changed packs are rebuilt, and the parser keys did not change.
+  TestConfigParserPlugin::update_called = false;
+  get().update({{"data", R"json({
+    "list": ["a"],
+    "packs": {
+      "kept": {"queries": {"q": {"query": "select 1", "interval": 60}}},
+      "changed": {"queries": {"q": {"query": "select 4", "interval": 60}}},
+      "added": {"queries": {"q": {"query": "select 5", "interval": 60}}}
+    }
+  })json"}});
+  EXPECT_FALSE(TestConfigParserPlugin::update_called);
+
+  auto second = packs();
+  ASSERT_EQ(second.size(), 3U);
+  EXPECT_EQ(second["kept"], first["kept"]);
+  EXPECT_EQ(query(second["changed"]), "select 4");
+  EXPECT_EQ(query(second["added"]), "select 5");
+  EXPECT_EQ(second.count("removed"), 0U);
+
+  // A changed parser key only updates the parsers, the packs are kept.
+  get().update({{"data", R"json({
+    "list": ["b"],
+    "packs": {
+      "kept": {"queries": {"q": {"query": "select 1", "interval": 60}}},
+      "changed": {"queries": {"q": {"query": "select 4", "interval": 60}}},
+      "added": {"queries": {"q": {"query": "select 5", "interval": 60}}}
+    }
+  })json"}});
+  EXPECT_TRUE(TestConfigParserPlugin::update_called);
+
+  auto third = packs();
+  EXPECT_EQ(third, second);
+
+  rf.registry("config_parser")->remove("test");
+}
+
 void waitForConfig(std::shared_ptr<TestConfigPlugin>& plugin, size_t count) {
   // Max wait of 3 seconds.
   auto delay = std::chrono::milliseconds{3000};
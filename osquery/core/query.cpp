@@ -117,7 +117,7 @@ Status Query::incrementCounter(bool reset, uint64_t& counter) const {
   return setDatabaseValue(kQueries, name_ + "counter", std::to_string(counter));
 }
 
-Status Query::addNewEvents(QueryDataTyped current_qd,
+Status Query::addNewEvents(QueryResults current_qd,
                            const uint64_t current_epoch,
                            uint64_t& counter,
                            DiffResults& dr) const {
@@ -140,14 +140,14 @@ Status Query::addNewEvents(QueryDataTyped current_qd,
   return Status::success();
 }
 
-Status Query::addNewResults(QueryDataTyped qd,
+Status Query::addNewResults(QueryResults qd,
                             const uint64_t epoch,
                             uint64_t& counter) const {
   DiffResults dr;
   return addNewResults(std::move(qd), epoch, counter, dr, false);
 }
 
-Status Query::addNewResults(QueryDataTyped current_qd,
+Status Query::addNewResults(QueryResults current_qd,
                             const uint64_t current_epoch,
                             uint64_t& counter,
                             DiffResults& dr,
@@ -171,7 +171,10 @@ Status Query::addNewResults(QueryDataTyped current_qd,
     }
 
     // Calculate the differential between previous and current query results.
-    dr = diff(previous_qd, current_qd);
+    status = diff(previous_qd, current_qd, dr);
+    if (!status.ok()) {
+      return status;
+    }
 
     update_db = (!dr.added.empty() || !dr.removed.empty());
   } else {
@@ -182,7 +185,7 @@ Status Query::addNewResults(QueryDataTyped current_qd,
   if (update_db) {
     // Replace the "previous" query data with the current.
     std::string json;
-    auto status = serializeQueryDataJSON(*target_gd, json, true);
+    auto status = serializeQueryResultsJSON(*target_gd, json, true);
     if (!status.ok()) {
       return status;
     }
@@ -208,20 +211,38 @@ Status Query::addNewResults(QueryDataTyped current_qd,
   return Status::success();
 }
 
+/// Convert the rows of a JSON array to QueryResults.
+static Status deserializeQueryResults(const rj::Value& arr,
+                                      QueryResults& results) {
+  QueryDataTyped rows;
+  auto status = deserializeQueryData(arr, rows);
+  if (!status.ok()) {
+    return status;
+  }
+
+  for (const auto& row : rows) {
+    status = results.addRow(row);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return Status::success();
+}
+
 Status deserializeDiffResults(const rj::Value& doc, DiffResults& dr) {
   if (!doc.IsObject()) {
     return Status(1);
   }
 
   if (doc.HasMember("removed")) {
-    auto status = deserializeQueryData(doc["removed"], dr.removed);
+    auto status = deserializeQueryResults(doc["removed"], dr.removed);
     if (!status.ok()) {
       return status;
     }
   }
 
   if (doc.HasMember("added")) {
-    auto status = deserializeQueryData(doc["added"], dr.added);
+    auto status = deserializeQueryResults(doc["added"], dr.added);
     if (!status.ok()) {
       return status;
     }
@@ -275,7 +296,7 @@ inline void getLegacyFieldsAndDecorations(const JSON& doc, QueryLogItem& item) {
 }
 
 Status serializeQueryLogItem(const QueryLogItem& item, JSON& doc) {
-  if (item.results.added.size() > 0 || item.results.removed.size() > 0) {
+  if (!item.results.added.empty() || !item.results.removed.empty()) {
     auto obj = doc.getObject();
     auto status =
         serializeDiffResults(item.results, doc, obj, FLAGS_logger_numerics);
@@ -286,7 +307,7 @@ Status serializeQueryLogItem(const QueryLogItem& item, JSON& doc) {
     doc.add("diffResults", obj);
   } else {
     auto arr = doc.getArray();
-    auto status = serializeQueryData(
+    auto status = serializeQueryResults(
         item.snapshot_results, doc, arr, FLAGS_logger_numerics);
     if (!status.ok()) {
       return status;
@@ -324,7 +345,7 @@ Status serializeQueryLogItemAsEvents(const QueryLogItem& item, JSON& doc) {
     }
   } else if (!item.snapshot_results.empty()) {
     auto arr = doc.getArray();
-    auto status = serializeQueryData(
+    auto status = serializeQueryResults(
         item.snapshot_results, temp_doc, arr, FLAGS_logger_numerics);
     if (!status.ok()) {
       return status;
@@ -39,7 +39,7 @@ struct QueryLogItem {
   DiffResults results;
 
   /// Optional snapshot results, no differential applied.
-  QueryDataTyped snapshot_results;
+  QueryResults snapshot_results;
 
   /// The name of the scheduled query.
   std::string name;
@@ -196,13 +196,13 @@ class Query {
    * Given the results of the execution of a scheduled query, add the results
    * to the database using addNewResults.
    *
-   * @param qd the QueryDataTyped object, which has the results of the query.
+   * @param qd the QueryResults object, which has the results of the query.
    * @param epoch the epoch associated with QueryData
    * @param counter [output] the output that holds the query execution counter.
    *
    * @return the success or failure of the operation.
    */
-  Status addNewResults(QueryDataTyped qd,
+  Status addNewResults(QueryResults qd,
                        uint64_t epoch,
                        uint64_t& counter) const;
 
@@ -214,7 +214,7 @@ class Query {
    * to the database using addNewResults and get back a data structure
    * indicating what rows in the query's results have changed.
    *
-   * @param qd the QueryDataTyped object containing query results to store.
+   * @param qd the QueryResults object containing query results to store.
    * @param epoch the epoch associated with QueryData
    * @param counter the output that holds the query execution counter.
    * @param dr an output to a DiffResults object populated based on last run.
@@ -222,14 +222,14 @@ class Query {
    *
    * @return the success or failure of the operation.
    */
-  Status addNewResults(QueryDataTyped qd,
+  Status addNewResults(QueryResults qd,
                        uint64_t epoch,
                        uint64_t& counter,
                        DiffResults& dr,
                        bool calculate_diff = true) const;
 
   /// A version of adding new results for events-based queries.
-  Status addNewEvents(QueryDataTyped current_qd,
+  Status addNewEvents(QueryResults current_qd,
                       const uint64_t current_epoch,
                       uint64_t& counter,
                       DiffResults& dr) const;
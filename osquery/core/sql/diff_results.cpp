@@ -9,10 +9,101 @@
 
 #include "diff_results.h"
 
+#include <map>
+#include <string_view>
+#include <vector>
+
 namespace rj = rapidjson;
 
 namespace osquery {
 
+namespace {
+
+/// A row of QueryResults, compared with a RowTyped as a RowTyped would be.
+struct ResultsRowKey {
+  const QueryResults& results;
+
+  size_t row;
+
+  /// The columns in the sorted order of RowTyped keys, without repeats.
+  const std::vector<size_t>& order;
+};
+
+/// The index of the RowDataTyped alternative of a cell type.
+int cellWhich(QueryResults::CellType type) {
+  switch (type) {
+  case QueryResults::CellType::Integer:
+    return 0;
+  case QueryResults::CellType::Real:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+/// Whether a RowTyped value is less than a cell, or greater when reversed.
+bool valueLess(const RowDataTyped& value,
+               const ResultsRowKey& key,
+               size_t column,
+               bool reversed) {
+  auto which = value.which();
+  auto cell_which = cellWhich(key.results.type(key.row, column));
+  if (which != cell_which) {
+    return reversed ? cell_which < which : which < cell_which;
+  }
+
+  switch (which) {
+  case 0: {
+    auto a = boost::get<long long>(value);
+    auto b = key.results.integer(key.row, column);
+    return reversed ? b < a : a < b;
+  }
+  case 1: {
+    auto a = boost::get<double>(value);
+    auto b = key.results.real(key.row, column);
+    return reversed ? b < a : a < b;
+  }
+  default: {
+    std::string_view a = boost::get<std::string>(value);
+    auto b = key.results.text(key.row, column);
+    return reversed ? b < a : a < b;
+  }
+  }
+}
+
+/// Compare the (name, value) pairs as std::map does, reversed for key < row.
+bool rowLess(const RowTyped& row, const ResultsRowKey& key, bool reversed) {
+  auto it = row.begin();
+  for (auto column : key.order) {
+    if (it == row.end()) {
+      return !reversed;
+    }
+
+    const auto& name = key.results.columnNames()[column];
+    if (it->first != name) {
+      return reversed ? name < it->first : it->first < name;
+    }
+    if (valueLess(it->second, key, column, reversed)) {
+      return true;
+    }
+    if (valueLess(it->second, key, column, !reversed)) {
+      return false;
+    }
+    ++it;
+  }
+  return reversed && it != row.end();
+}
+
+bool operator<(const RowTyped& row, const ResultsRowKey& key) {
+  return rowLess(row, key, false);
+}
+
+bool operator<(const ResultsRowKey& key, const RowTyped& row) {
+  return rowLess(row, key, true);
+}
+
+} // namespace
+
 Status serializeDiffResults(const DiffResults& d,
                             JSON& doc,
                             rj::Document& obj,
@@ -22,14 +113,14 @@ Status serializeDiffResults(const DiffResults& d,
   // the logger plugins and their aggregations, allowing them to parse chunked
   // lines. Note that the chunking is opaque to the database functions.
   auto removed_arr = doc.getArray();
-  auto status = serializeQueryData(d.removed, doc, removed_arr, asNumeric);
+  auto status = serializeQueryResults(d.removed, doc, removed_arr, asNumeric);
   if (!status.ok()) {
     return status;
   }
   doc.add("removed", removed_arr, obj);
 
   auto added_arr = doc.getArray();
-  status = serializeQueryData(d.added, doc, added_arr, asNumeric);
+  status = serializeQueryResults(d.added, doc, added_arr, asNumeric);
   if (!status.ok()) {
     return status;
   }
@@ -50,23 +141,37 @@ Status serializeDiffResultsJSON(const DiffResults& d,
   return doc.toString(json);
 }
 
-DiffResults diff(QueryDataSet& old, QueryDataTyped& current) {
-  DiffResults r;
+Status diff(QueryDataSet& old, const QueryResults& current, DiffResults& dr) {
+  dr.added = QueryResults(current.columnNames());
+  dr.removed.clear();
+
+  // A repeated column name keeps the last value, as in a RowTyped.
+  std::map<std::string, size_t> names;
+  for (size_t column = 0; column < current.columns(); column++) {
+    names[current.columnNames()[column]] = column;
+  }
+  std::vector<size_t> order;
+  order.reserve(names.size());
+  for (const auto& name : names) {
+    order.push_back(name.second);
+  }
 
-  for (auto& i : current) {
-    auto item = old.find(i);
+  for (size_t row = 0; row < current.rows(); row++) {
+    auto item = old.find(ResultsRowKey{current, row, order});
     if (item != old.end()) {
       old.erase(item);
     } else {
-      r.added.push_back(i);
+      dr.added.addRow(current, row);
     }
   }
 
-  for (auto& i : old) {
-    r.removed.push_back(std::move(i));
+  for (const auto& row : old) {
+    auto status = dr.removed.addRow(row);
+    if (!status.ok()) {
+      return status;
+    }
   }
-
-  return r;
+  return Status::success();
 }
 
 } // namespace osquery
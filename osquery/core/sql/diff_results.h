@@ -10,6 +10,7 @@
 #pragma once
 
 #include <osquery/core/sql/query_data.h>
+#include <osquery/core/sql/query_results.h>
 
 namespace osquery {
 
@@ -23,11 +24,11 @@ namespace osquery {
  */
 struct DiffResults : private only_movable {
  public:
-  /// vector of added rows
-  QueryDataTyped added;
+  /// added rows, with the columns of the new results
+  QueryResults added;
 
-  /// vector of removed rows
-  QueryDataTyped removed;
+  /// removed rows, with the sorted columns of the old results
+  QueryResults removed;
 
   DiffResults() {}
   DiffResults(DiffResults&&) = default;
@@ -84,16 +85,20 @@ Status serializeDiffResultsJSON(const DiffResults& d,
                                 bool asNumeric);
 
 /**
- * @brief Diff QueryDataSet object and QueryData object
+ * @brief Diff QueryDataSet object and QueryResults object
  *        and create a DiffResults object
  *
- * @param old_ the "old" set of results.
+ * Rows of the new results are compared with the old set without converting
+ * them to RowTyped.
+ *
+ * @param old_ the "old" set of results, the rows left are the removed rows.
  * @param new_ the "new" set of results.
+ * @param dr [output] the change from old_ to new_.
  *
- * @return a DiffResults object which indicates the change from old_ to new_
+ * @return failure if the old rows do not have the same columns.
  *
  * @see DiffResults
  */
-DiffResults diff(QueryDataSet& old_, QueryDataTyped& new_);
+Status diff(QueryDataSet& old_, const QueryResults& new_, DiffResults& dr);
 
 } // namespace osquery
@@ -36,8 +36,9 @@ using QueryDataTyped = std::vector<RowTyped>;
  * @brief Set representation result returned from a osquery SQL query
  *
  * QueryDataSet -  It's set of Rows for fast search of a specific row.
+ * The transparent comparison allows searching for rows of other containers.
  */
-using QueryDataSet = std::multiset<RowTyped>;
+using QueryDataSet = std::multiset<RowTyped, std::less<>>;
 
 /**
  * @brief Serialize a QueryData object into a JSON array.
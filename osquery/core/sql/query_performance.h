@@ -10,6 +10,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace osquery {
 
@@ -23,9 +24,12 @@ struct QueryPerformance {
   /// Last UNIX time in seconds the query was executed successfully.
   unsigned long long int last_executed{0};
 
-  /// Total wall time taken
+  /// Total wall time taken in seconds
   unsigned long long int wall_time{0};
 
+  /// Total wall time taken in milliseconds
+  unsigned long long int wall_time_ms{0};
+
   /// Total user time (cycles)
   unsigned long long int user_time{0};
 
@@ -34,6 +38,29 @@ struct QueryPerformance {
 
   /// Average memory differentials. This should be near 0.
   unsigned long long int average_memory{0};
+
+  /// Total number of rows generated
+  unsigned long long int output_rows{0};
+};
+
+/**
+ * @brief The resources used by a single execution of a query.
+ */
+struct QueryResourceUsage {
+  /// Wall time in milliseconds.
+  uint64_t wall_time_ms{0};
+
+  /// User time in milliseconds.
+  uint64_t user_time{0};
+
+  /// System time in milliseconds.
+  uint64_t system_time{0};
+
+  /// Change of the allocated heap bytes, negative if memory was released.
+  int64_t memory{0};
+
+  /// Number of rows generated.
+  uint64_t rows{0};
 };
 
 } // namespace osquery
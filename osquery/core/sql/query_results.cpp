@@ -0,0 +1,360 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include "query_results.h"
+
+#include <algorithm>
+#include <map>
+
+#include <osquery/utils/conversions/castvariant.h>
+
+namespace rj = rapidjson;
+
+namespace osquery {
+
+QueryResults::QueryResults(ColumnNames columns)
+    : column_names_(std::move(columns)), columns_(column_names_.size()) {}
+
+void QueryResults::reserve(size_t rows) {
+  for (auto& column : columns_) {
+    column.cells.reserve(rows);
+  }
+}
+
+void QueryResults::clear() {
+  column_names_.clear();
+  columns_.clear();
+  rows_ = 0;
+  next_column_ = 0;
+}
+
+void QueryResults::addCell(const Cell& cell) {
+  columns_[next_column_].cells.push_back(cell);
+  if (++next_column_ == columns_.size()) {
+    next_column_ = 0;
+    rows_++;
+  }
+}
+
+void QueryResults::addInteger(long long value) {
+  Cell cell;
+  cell.integer = value;
+  cell.type = CellType::Integer;
+  addCell(cell);
+}
+
+void QueryResults::addReal(double value) {
+  Cell cell;
+  cell.real = value;
+  cell.type = CellType::Real;
+  addCell(cell);
+}
+
+Status QueryResults::addText(std::string_view value) {
+  if (value.size() > kMaxTextSize) {
+    return Status::failure("Text of " + std::to_string(value.size()) +
+                           " bytes is too large for a result cell");
+  }
+
+  auto& text = columns_[next_column_].text;
+
+  Cell cell;
+  cell.offset = text.size();
+  cell.size = static_cast<uint32_t>(value.size());
+  cell.type = CellType::Text;
+  text.append(value.data(), cell.size);
+  addCell(cell);
+  return Status::success();
+}
+
+Status QueryResults::addRow(const RowTyped& row) {
+  if (columns_.empty() && rows_ == 0) {
+    ColumnNames names;
+    names.reserve(row.size());
+    for (const auto& column : row) {
+      names.push_back(column.first);
+    }
+    *this = QueryResults(std::move(names));
+  }
+
+  if (row.size() != columns_.size() || next_column_ != 0) {
+    return Status::failure("Row does not have the result columns");
+  }
+
+  size_t column = 0;
+  for (const auto& value : row) {
+    if (value.first != column_names_[column++]) {
+      return Status::failure("Row does not have the result columns");
+    }
+  }
+
+  for (const auto& value : row) {
+    switch (value.second.which()) {
+    case 0:
+      addInteger(boost::get<long long>(value.second));
+      break;
+    case 1:
+      addReal(boost::get<double>(value.second));
+      break;
+    default: {
+      auto status = addText(boost::get<std::string>(value.second));
+      if (!status.ok()) {
+        // Drop the incomplete row.
+        for (size_t i = 0; i < next_column_; i++) {
+          columns_[i].cells.pop_back();
+        }
+        next_column_ = 0;
+        return status;
+      }
+    }
+    }
+  }
+  return Status::success();
+}
+
+void QueryResults::addRow(const QueryResults& other, size_t row) {
+  for (size_t column = 0; column < columns(); column++) {
+    const auto& c = other.cell(row, column);
+    if (c.type == CellType::Text) {
+      // The text already fits in a cell.
+      addText(other.text(row, column));
+    } else {
+      addCell(c);
+    }
+  }
+}
+
+Status QueryResults::transformText(
+    const std::function<void(std::string&)>& transform) {
+  for (auto& column : columns_) {
+    std::string text;
+    text.reserve(column.text.size());
+    for (auto& cell : column.cells) {
+      if (cell.type != CellType::Text) {
+        continue;
+      }
+
+      std::string value(column.text, cell.offset, cell.size);
+      transform(value);
+      if (value.size() > kMaxTextSize) {
+        return Status::failure("Text of " + std::to_string(value.size()) +
+                               " bytes is too large for a result cell");
+      }
+      cell.offset = text.size();
+      cell.size = static_cast<uint32_t>(value.size());
+      text.append(value);
+    }
+    column.text = std::move(text);
+  }
+  return Status::success();
+}
+
+Status QueryResults::append(QueryResults&& other) {
+  if (other.empty()) {
+    return Status::success();
+  }
+
+  if (empty() && next_column_ == 0) {
+    *this = std::move(other);
+    return Status::success();
+  }
+
+  if (column_names_ != other.column_names_) {
+    return Status::failure("Results have different columns");
+  }
+
+  for (size_t i = 0; i < columns_.size(); i++) {
+    auto& column = columns_[i];
+    auto& other_column = other.columns_[i];
+    auto offset = column.text.size();
+    column.text.append(other_column.text);
+
+    column.cells.reserve(rows_ + other.rows_);
+    for (size_t row = 0; row < other.rows_; row++) {
+      auto cell = other_column.cells[row];
+      if (cell.type == CellType::Text) {
+        cell.offset += offset;
+      }
+      column.cells.push_back(cell);
+    }
+  }
+
+  rows_ += other.rows_;
+  other.clear();
+  return Status::success();
+}
+
+std::string_view QueryResults::text(size_t row, size_t column) const {
+  const auto& c = cell(row, column);
+  return std::string_view(columns_[column].text.data() + c.offset, c.size);
+}
+
+RowDataTyped QueryResults::value(size_t row, size_t column) const {
+  switch (type(row, column)) {
+  case CellType::Integer:
+    return integer(row, column);
+  case CellType::Real:
+    return real(row, column);
+  default:
+    return std::string(text(row, column));
+  }
+}
+
+std::string QueryResults::string(size_t row, size_t column) const {
+  static const CastVisitor visitor;
+  switch (type(row, column)) {
+  case CellType::Integer:
+    return visitor(integer(row, column));
+  case CellType::Real:
+    return visitor(real(row, column));
+  default:
+    return std::string(text(row, column));
+  }
+}
+
+RowTyped QueryResults::toRowTyped(size_t row) const {
+  RowTyped r;
+  for (size_t column = 0; column < columns(); column++) {
+    r[column_names_[column]] = value(row, column);
+  }
+  return r;
+}
+
+Row QueryResults::toRow(size_t row) const {
+  Row r;
+  for (size_t column = 0; column < columns(); column++) {
+    r[column_names_[column]] = string(row, column);
+  }
+  return r;
+}
+
+void QueryResults::appendTo(QueryDataTyped& results) const {
+  results.reserve(results.size() + rows_);
+  for (size_t row = 0; row < rows_; row++) {
+    results.push_back(toRowTyped(row));
+  }
+}
+
+void QueryResults::appendTo(QueryData& results) const {
+  results.reserve(results.size() + rows_);
+  for (size_t row = 0; row < rows_; row++) {
+    results.push_back(toRow(row));
+  }
+}
+
+size_t QueryResults::memoryUsed() const {
+  size_t bytes = sizeof(QueryResults);
+  for (const auto& name : column_names_) {
+    bytes += sizeof(name) + name.capacity();
+  }
+  for (const auto& column : columns_) {
+    bytes += sizeof(column) + column.cells.capacity() * sizeof(Cell) +
+             column.text.capacity();
+  }
+  return bytes;
+}
+
+bool QueryResults::operator==(const QueryResults& other) const {
+  if (column_names_ != other.column_names_ || rows_ != other.rows_) {
+    return false;
+  }
+
+  for (size_t row = 0; row < rows_; row++) {
+    for (size_t column = 0; column < columns(); column++) {
+      auto t = type(row, column);
+      if (t != other.type(row, column)) {
+        return false;
+      }
+
+      bool equal = false;
+      switch (t) {
+      case CellType::Integer:
+        equal = integer(row, column) == other.integer(row, column);
+        break;
+      case CellType::Real:
+        equal = real(row, column) == other.real(row, column);
+        break;
+      default:
+        equal = text(row, column) == other.text(row, column);
+      }
+      if (!equal) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Status serializeQueryResults(const QueryResults& results,
+                             JSON& doc,
+                             rj::Document& arr,
+                             bool asNumeric) {
+  // Serialized objects have the sorted keys of a RowTyped. A repeated column
+  // name keeps the last value, as in a RowTyped.
+  std::map<std::string, size_t> order;
+  for (size_t column = 0; column < results.columns(); column++) {
+    order[results.columnNames()[column]] = column;
+  }
+
+  auto& allocator = doc.doc().GetAllocator();
+  for (size_t row = 0; row < results.rows(); row++) {
+    auto row_obj = doc.getObject();
+    for (const auto& column : order) {
+      rj::Value key(rj::StringRef(column.first), allocator);
+      auto type = results.type(row, column.second);
+      if (asNumeric && type == QueryResults::CellType::Integer) {
+        row_obj.AddMember(
+            key.Move(),
+            rj::Value(static_cast<int64_t>(
+                          results.integer(row, column.second)))
+                .Move(),
+            allocator);
+      } else if (asNumeric && type == QueryResults::CellType::Real) {
+        row_obj.AddMember(
+            key.Move(),
+            rj::Value(results.real(row, column.second)).Move(),
+            allocator);
+      } else if (type == QueryResults::CellType::Text) {
+        auto text = results.text(row, column.second);
+        row_obj.AddMember(
+            key.Move(),
+            rj::Value(text.data(),
+                      static_cast<rj::SizeType>(text.size()),
+                      allocator)
+                .Move(),
+            allocator);
+      } else {
+        auto value = results.string(row, column.second);
+        row_obj.AddMember(
+            key.Move(),
+            rj::Value(value.c_str(),
+                      static_cast<rj::SizeType>(value.size()),
+                      allocator)
+                .Move(),
+            allocator);
+      }
+    }
+    doc.push(row_obj, arr);
+  }
+  return Status::success();
+}
+
+Status serializeQueryResultsJSON(const QueryResults& results,
+                                 std::string& json,
+                                 bool asNumeric) {
+  auto doc = JSON::newArray();
+
+  auto status = serializeQueryResults(results, doc, doc.doc(), asNumeric);
+  if (!status.ok()) {
+    return status;
+  }
+  return doc.toString(json);
+}
+
+} // namespace osquery
@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <osquery/core/sql/query_data.h>
+#include <osquery/core/sql/row.h>
+#include <osquery/utils/json/json.h>
+#include <osquery/utils/status/status.h>
+
+namespace osquery {
+
+/**
+ * @brief The typed, column-major results of an osquery SQL query.
+ *
+ * QueryDataTyped stores a map per row, with a copy of every column name for
+ * every cell. QueryResults stores the column names once, and the cells of
+ * each column in a flat buffer of fixed-size values. Text values are kept in
+ * one arena per column.
+ *
+ * Results are filled a row at a time, by adding one cell for each column in
+ * order. Use the conversion helpers to produce QueryData or QueryDataTyped
+ * where APIs still require them. A text cell holds less than 4 GiB.
+ */
+class QueryResults {
+ public:
+  /// The SQLite type affinities of result cells, matching RowDataTyped.
+  enum class CellType : uint8_t {
+    Integer,
+    Real,
+    Text,
+  };
+
+  /// A read-only view of a single row.
+  class RowView {
+   public:
+    RowView(const QueryResults& results, size_t row)
+        : results_(results), row_(row) {}
+
+    /// Number of cells, the same as the number of columns.
+    size_t size() const {
+      return results_.columns();
+    }
+
+    /// The name of a column.
+    const std::string& name(size_t column) const {
+      return results_.columnNames()[column];
+    }
+
+    CellType type(size_t column) const {
+      return results_.type(row_, column);
+    }
+
+    long long integer(size_t column) const {
+      return results_.integer(row_, column);
+    }
+
+    double real(size_t column) const {
+      return results_.real(row_, column);
+    }
+
+    std::string_view text(size_t column) const {
+      return results_.text(row_, column);
+    }
+
+    /// Copy a cell into a RowTyped variant.
+    RowDataTyped value(size_t column) const {
+      return results_.value(row_, column);
+    }
+
+   private:
+    const QueryResults& results_;
+    size_t row_;
+  };
+
+ public:
+  QueryResults() = default;
+
+  /// Create empty results for a set of columns.
+  explicit QueryResults(ColumnNames columns);
+
+  QueryResults(QueryResults&&) = default;
+  QueryResults& operator=(QueryResults&&) = default;
+
+  /// The column names, in the order they were selected.
+  const ColumnNames& columnNames() const {
+    return column_names_;
+  }
+
+  size_t columns() const {
+    return column_names_.size();
+  }
+
+  /// Number of complete rows.
+  size_t rows() const {
+    return rows_;
+  }
+
+  bool empty() const {
+    return rows_ == 0;
+  }
+
+  /// Reserve space for a number of rows.
+  void reserve(size_t rows);
+
+  /// Remove all rows and columns.
+  void clear();
+
+  /// Add an integer as the next cell of the current row.
+  void addInteger(long long value);
+
+  /// Add a double as the next cell of the current row.
+  void addReal(double value);
+
+  /**
+   * @brief Add a copy of text as the next cell of the current row.
+   *
+   * @return failure, without adding a cell, if the text is 4 GiB or larger.
+   */
+  Status addText(std::string_view value);
+
+  /**
+   * @brief Add a typed row, converted from a legacy API.
+   *
+   * Empty results take the row's (sorted) keys as their columns.
+   *
+   * @return failure if the row's keys are not the column names.
+   */
+  Status addRow(const RowTyped& row);
+
+  /// Copy a row of other results with the same columns.
+  void addRow(const QueryResults& other, size_t row);
+
+  /**
+   * @brief Replace the content of every text cell.
+   *
+   * @return failure if a replaced text is too large for a cell.
+   */
+  Status transformText(const std::function<void(std::string&)>& transform);
+
+  /**
+   * @brief Move the rows of other results with the same columns to the end.
+   *
+   * @return failure if the column names differ.
+   */
+  Status append(QueryResults&& other);
+
+  CellType type(size_t row, size_t column) const {
+    return cell(row, column).type;
+  }
+
+  /// The value of an Integer cell.
+  long long integer(size_t row, size_t column) const {
+    return cell(row, column).integer;
+  }
+
+  /// The value of a Real cell.
+  double real(size_t row, size_t column) const {
+    return cell(row, column).real;
+  }
+
+  /// The value of a Text cell, valid until more text is added to the column.
+  std::string_view text(size_t row, size_t column) const;
+
+  /// Copy a cell into a RowTyped variant.
+  RowDataTyped value(size_t row, size_t column) const;
+
+  /// Convert a cell to a string, the same as castVariant.
+  std::string string(size_t row, size_t column) const;
+
+  RowView row(size_t row) const {
+    return RowView(*this, row);
+  }
+
+  /// Convert a row into a RowTyped map.
+  RowTyped toRowTyped(size_t row) const;
+
+  /// Convert a row into a Row map of strings.
+  Row toRow(size_t row) const;
+
+  /// Convert and add every row to typed results.
+  void appendTo(QueryDataTyped& results) const;
+
+  /// Convert and add every row to string results.
+  void appendTo(QueryData& results) const;
+
+  /// The approximate number of bytes allocated for the results.
+  size_t memoryUsed() const;
+
+  /// Results are equal with the same columns, and rows of equal cells.
+  bool operator==(const QueryResults& other) const;
+
+  bool operator!=(const QueryResults& other) const {
+    return !(*this == other);
+  }
+
+ public:
+  /// The size of the largest text cell.
+  static constexpr size_t kMaxTextSize = UINT32_MAX;
+
+ private:
+  struct Cell {
+    union {
+      long long integer;
+      double real;
+      size_t offset;
+    };
+
+    /// The length of a Text cell.
+    uint32_t size{0};
+
+    CellType type{CellType::Integer};
+  };
+
+  struct Column {
+    /// Cells of the column, one per row.
+    std::vector<Cell> cells;
+
+    /// The contents of all text cells of the column.
+    std::string text;
+  };
+
+  const Cell& cell(size_t row, size_t column) const {
+    return columns_[column].cells[row];
+  }
+
+  /// Add a cell to the next column, completing the row at the last one.
+  void addCell(const Cell& cell);
+
+ private:
+  ColumnNames column_names_;
+
+  std::vector<Column> columns_;
+
+  /// Number of complete rows.
+  size_t rows_{0};
+
+  /// The column of the next cell added.
+  size_t next_column_{0};
+};
+
+/**
+ * @brief Serialize QueryResults into a JSON array.
+ *
+ * Rows are serialized the same as serializeQueryData for QueryDataTyped.
+ *
+ * @param results the QueryResults to serialize.
+ * @param doc the managed JSON document.
+ * @param arr [output] the output JSON array.
+ * @param asNumeric true iff numeric values are serialized as such.
+ *
+ * @return Status indicating the success or failure of the operation.
+ */
+Status serializeQueryResults(const QueryResults& results,
+                             JSON& doc,
+                             rapidjson::Document& arr,
+                             bool asNumeric);
+
+/**
+ * @brief Serialize QueryResults into a JSON string.
+ *
+ * @param results the QueryResults to serialize.
+ * @param json [output] the output JSON string.
+ * @param asNumeric true iff numeric values are serialized as such.
+ *
+ * @return Status indicating the success or failure of the operation.
+ */
+Status serializeQueryResultsJSON(const QueryResults& results,
+                                 std::string& json,
+                                 bool asNumeric);
+
+} // namespace osquery
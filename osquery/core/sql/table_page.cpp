@@ -0,0 +1,266 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <osquery/core/sql/table_page.h>
+#include <osquery/utils/conversions/castvariant.h>
+
+namespace osquery {
+
+namespace {
+
+template <typename T>
+void appendValue(std::string& buffer, T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// Reads the values appended to a buffer, failing past its end.
+class BufferReader {
+ public:
+  explicit BufferReader(const std::string& buffer) : buffer_(buffer) {}
+
+  size_t remaining() const {
+    return buffer_.size() - pos_;
+  }
+
+  template <typename T>
+  bool read(T& value) {
+    if (remaining() < sizeof(value)) {
+      return false;
+    }
+    memcpy(&value, buffer_.data() + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return true;
+  }
+
+  bool read(size_t size, std::string& value) {
+    if (remaining() < size) {
+      return false;
+    }
+    value.assign(buffer_.data() + pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+ private:
+  const std::string& buffer_;
+  size_t pos_{0};
+};
+
+} // namespace
+
+TablePage::Column& TablePage::addColumn(const std::string& name,
+                                        Storage storage) {
+  // A duplicate keeps the first index, and fails validation.
+  index_.emplace(name, columns_.size());
+  columns_.emplace_back();
+  auto& column = columns_.back();
+  column.name = name;
+  column.storage = storage;
+  return column;
+}
+
+const TablePage::Column* TablePage::column(const std::string& name) const {
+  auto it = index_.find(name);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  return &columns_[it->second];
+}
+
+Status TablePage::validate() const {
+  if (index_.size() != columns_.size()) {
+    return Status::failure("Table page contains duplicate columns");
+  }
+
+  for (const auto& column : columns_) {
+    size_t values = 0;
+    switch (column.storage) {
+    case Storage::Text:
+      values = column.text.size();
+      break;
+    case Storage::Integer:
+      values = column.integers.size();
+      break;
+    case Storage::Double:
+      values = column.doubles.size();
+      break;
+    }
+
+    if (values != rows_ ||
+        (!column.nulls.empty() && column.nulls.size() != rows_)) {
+      return Status::failure("Table page column " + column.name +
+                             " does not contain " + std::to_string(rows_) +
+                             " rows");
+    }
+  }
+  return Status::success();
+}
+
+void TablePage::clear() {
+  columns_.clear();
+  index_.clear();
+  rows_ = 0;
+}
+
+std::string TablePage::string(const Column& column, size_t row) {
+  switch (column.storage) {
+  case Storage::Integer:
+    return castVariant(static_cast<long long>(column.integers[row]));
+  case Storage::Double:
+    return castVariant(column.doubles[row]);
+  case Storage::Text:
+  default:
+    return column.text[row];
+  }
+}
+
+Row TablePage::toRow(size_t row) const {
+  Row r;
+  for (const auto& column : columns_) {
+    if (!isNull(column, row)) {
+      r[column.name] = string(column, row);
+    }
+  }
+  return r;
+}
+
+void TablePage::encode(size_t begin,
+                       size_t end,
+                       std::string& buffer) const {
+  end = std::min(end, rows_);
+  begin = std::min(begin, end);
+
+  appendValue<uint64_t>(buffer, end - begin);
+  appendValue<uint32_t>(buffer, static_cast<uint32_t>(columns_.size()));
+  for (const auto& column : columns_) {
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(column.name.size()));
+    buffer.append(column.name);
+    appendValue<uint8_t>(buffer, static_cast<uint8_t>(column.storage));
+    appendValue<uint8_t>(buffer, column.nulls.empty() ? 0 : 1);
+    if (!column.nulls.empty()) {
+      for (size_t row = begin; row < end; ++row) {
+        appendValue<uint8_t>(buffer, column.nulls[row] ? 1 : 0);
+      }
+    }
+
+    switch (column.storage) {
+    case Storage::Text:
+      for (size_t row = begin; row < end; ++row) {
+        const auto& value = column.text[row];
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+      }
+      break;
+    case Storage::Integer:
+      buffer.append(
+          reinterpret_cast<const char*>(column.integers.data() + begin),
+          (end - begin) * sizeof(int64_t));
+      break;
+    case Storage::Double:
+      buffer.append(
+          reinterpret_cast<const char*>(column.doubles.data() + begin),
+          (end - begin) * sizeof(double));
+      break;
+    }
+  }
+}
+
+Status TablePage::decode(const std::string& buffer) {
+  BufferReader reader(buffer);
+  uint64_t rows = 0;
+  uint32_t count = 0;
+  if (!reader.read(rows) || !reader.read(count)) {
+    return Status::failure("Truncated table page");
+  }
+
+  // The first rows name the columns, later rows must use the same columns.
+  bool add_columns = columns_.empty();
+  if (add_columns && rows_ > 0) {
+    return Status::failure("Table page rows have no columns");
+  }
+  if (!add_columns && count != columns_.size()) {
+    return Status::failure("Table page rows have different columns");
+  }
+
+  const auto base = rows_;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t name_size = 0;
+    std::string name;
+    uint8_t storage = 0;
+    uint8_t has_nulls = 0;
+    if (!reader.read(name_size) || !reader.read(name_size, name) ||
+        !reader.read(storage) || !reader.read(has_nulls) ||
+        storage > static_cast<uint8_t>(Storage::Double)) {
+      return Status::failure("Invalid table page column");
+    }
+
+    Column* column = nullptr;
+    if (add_columns) {
+      column = &addColumn(name, static_cast<Storage>(storage));
+    } else {
+      column = &columns_[i];
+      if (column->name != name ||
+          column->storage != static_cast<Storage>(storage)) {
+        return Status::failure("Table page rows have different columns");
+      }
+    }
+
+    if (has_nulls != 0) {
+      if (reader.remaining() < rows) {
+        return Status::failure("Truncated table page column " + name);
+      }
+      column->nulls.resize(base, false);
+      for (uint64_t row = 0; row < rows; ++row) {
+        uint8_t null = 0;
+        reader.read(null);
+        column->nulls.push_back(null != 0);
+      }
+    } else if (!column->nulls.empty()) {
+      column->nulls.resize(base + rows, false);
+    }
+
+    if (column->storage == Storage::Text) {
+      for (uint64_t row = 0; row < rows; ++row) {
+        uint32_t size = 0;
+        std::string value;
+        if (!reader.read(size) || !reader.read(size, value)) {
+          return Status::failure("Truncated table page column " + name);
+        }
+        column->text.push_back(std::move(value));
+      }
+      continue;
+    }
+
+    if (reader.remaining() / sizeof(int64_t) < rows) {
+      return Status::failure("Truncated table page column " + name);
+    }
+    for (uint64_t row = 0; row < rows; ++row) {
+      if (column->storage == Storage::Integer) {
+        int64_t value = 0;
+        reader.read(value);
+        column->integers.push_back(value);
+      } else {
+        double value = 0;
+        reader.read(value);
+        column->doubles.push_back(value);
+      }
+    }
+  }
+
+  if (reader.remaining() != 0) {
+    return Status::failure("Table page has trailing bytes");
+  }
+  rows_ = base + static_cast<size_t>(rows);
+  return Status::success();
+}
+
+} // namespace osquery
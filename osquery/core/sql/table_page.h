@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osquery/core/sql/row.h>
+#include <osquery/utils/status/status.h>
+
+namespace osquery {
+
+/**
+ * @brief The rows of a table stored as typed columns.
+ *
+ * Extension tables return a string map per row, which repeats every column
+ * name for every row and prints every number as text. A TablePage names each
+ * column once and keeps the values of a column together, already cast to the
+ * column's storage type.
+ *
+ * Every column holds one value per row. Rows without a value are marked in
+ * the column's nulls and hold a default value.
+ */
+class TablePage {
+ public:
+  /// How the values of a column are stored.
+  enum class Storage : uint8_t {
+    Text,
+    Integer,
+    Double,
+  };
+
+  struct Column {
+    std::string name;
+
+    Storage storage{Storage::Text};
+
+    /// True for rows without a value, empty if every row has a value.
+    std::vector<bool> nulls;
+
+    /// Values of a Text column.
+    std::vector<std::string> text;
+
+    /// Values of an Integer column.
+    std::vector<int64_t> integers;
+
+    /// Values of a Double column.
+    std::vector<double> doubles;
+  };
+
+ public:
+  /// Number of rows.
+  size_t rows() const {
+    return rows_;
+  }
+
+  void setRows(size_t rows) {
+    rows_ = rows;
+  }
+
+  /// Add an empty column, the name must be unique within the page.
+  Column& addColumn(const std::string& name, Storage storage);
+
+  /// The columns, in the order they were added.
+  const std::vector<Column>& columns() const {
+    return columns_;
+  }
+
+  /**
+   * @brief Access the columns to fill or move their values.
+   *
+   * Column names must not be changed, they are indexed by addColumn.
+   */
+  std::vector<Column>& columns() {
+    return columns_;
+  }
+
+  /// Find a column by name, nullptr if the page does not include it.
+  const Column* column(const std::string& name) const;
+
+  /// Check that every column holds a value for every row.
+  Status validate() const;
+
+  /// Remove all rows and columns.
+  void clear();
+
+  /// True if the column has no value for a row.
+  static bool isNull(const Column& column, size_t row) {
+    return !column.nulls.empty() && column.nulls[row];
+  }
+
+  /// Convert a value to a string, the same as castVariant.
+  static std::string string(const Column& column, size_t row);
+
+  /// Convert a row into a Row map of strings, without the null values.
+  Row toRow(size_t row) const;
+
+  /**
+   * @brief Append rows [begin, end) to a buffer, in the host's byte order.
+   *
+   * This lets a page be sent in pieces between processes on the same host.
+   */
+  void encode(size_t begin, size_t end, std::string& buffer) const;
+
+  /// Append rows written by encode, the columns must match previous rows.
+  Status decode(const std::string& buffer);
+
+ private:
+  std::vector<Column> columns_;
+
+  /// Index of each column name within columns_.
+  std::map<std::string, size_t> index_;
+
+  size_t rows_{0};
+};
+
+} // namespace osquery
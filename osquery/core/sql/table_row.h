@@ -56,6 +56,17 @@ class TableRow {
    */
   virtual operator Row() const = 0;
 
+  /**
+   * Estimate the bytes of memory used by this row's column names and values.
+   */
+  virtual size_t memoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& column : static_cast<Row>(*this)) {
+      bytes += column.first.size() + column.second.size();
+    }
+    return bytes;
+  }
+
  protected:
   TableRow(const TableRow&) = default;
   TableRow& operator=(const TableRow&) = default;
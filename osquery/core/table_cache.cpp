@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <unordered_set>
+
+#include <osquery/core/flags.h>
+#include <osquery/core/table_cache.h>
+#include <osquery/logger/logger.h>
+#include <osquery/utils/conversions/tokenizer.h>
+
+namespace osquery {
+
+FLAG(uint64,
+     table_cache_max_bytes,
+     64 * 1024 * 1024,
+     "Memory budget in bytes for cached table results (default 64MB)");
+
+FLAG(string,
+     table_cache_ttl,
+     "",
+     "Comma-separated table=seconds freshness overrides for cached results");
+
+namespace {
+
+/// Get the TTL override for a table, or 0 to use the query interval.
+uint64_t getTableTTL(const std::string& table) {
+  static Mutex mutex;
+  static std::string parsed;
+  static std::unordered_map<std::string, uint64_t> ttls;
+
+  WriteLock lock(mutex);
+  if (parsed != FLAGS_table_cache_ttl) {
+    parsed = FLAGS_table_cache_ttl;
+    ttls.clear();
+
+    Tokenizer overrides(parsed, ",");
+    std::string_view item, name, seconds;
+    uint64_t ttl = 0;
+    while (overrides.next(item)) {
+      if (!splitKeyValue(item, '=', name, seconds) ||
+          !parseInteger(seconds, ttl)) {
+        LOG(WARNING) << "Invalid table_cache_ttl entry: " << item;
+        continue;
+      }
+      ttls[std::string(name)] = ttl;
+    }
+  }
+
+  auto it = ttls.find(table);
+  return (it == ttls.end()) ? 0 : it->second;
+}
+
+/// Append a field prefixed by its length, so no separator can collide.
+void appendKeyField(std::string& key, const std::string& field) {
+  key += std::to_string(field.size());
+  key += ':';
+  key += field;
+}
+
+} // namespace
+
+TableResultCache& TableResultCache::get() {
+  static TableResultCache cache;
+  return cache;
+}
+
+std::string TableResultCache::key(const std::string& table,
+                                  const QueryContext& ctx) {
+  std::string key;
+  appendKeyField(key, table);
+
+  // Columns that are not used may be left empty by the table.
+  key += (ctx.colsUsedBitset) ? ctx.colsUsedBitset->to_string() : "*";
+
+  // The constraint map is ordered by column, the constraints are sorted so
+  // equivalent predicates written in another order share an entry.
+  std::vector<std::pair<unsigned char, std::string>> constraints;
+  for (const auto& column : ctx.constraints) {
+    const auto& all = column.second.getAll();
+    if (all.empty()) {
+      continue;
+    }
+
+    constraints.clear();
+    for (const auto& constraint : all) {
+      constraints.emplace_back(constraint.op, constraint.expr);
+    }
+    std::sort(constraints.begin(), constraints.end());
+    constraints.erase(std::unique(constraints.begin(), constraints.end()),
+                      constraints.end());
+
+    appendKeyField(key, column.first);
+    for (const auto& constraint : constraints) {
+      key += std::to_string(constraint.first);
+      appendKeyField(key, constraint.second);
+    }
+    key += ';';
+  }
+  return key;
+}
+
+std::list<TableResultCache::Entry>::iterator TableResultCache::find(
+    const std::string& table, const std::string& key, uint64_t step) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return entries_.end();
+  }
+
+  auto entry = it->second;
+  auto ttl = getTableTTL(table);
+  if (step >= entry->step + ((ttl > 0) ? ttl : entry->interval)) {
+    erase(entry);
+    return entries_.end();
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  return entry;
+}
+
+void TableResultCache::erase(std::list<Entry>::iterator entry) {
+  auto& stats = stats_[entry->table];
+  stats.entries--;
+  stats.rows -= entry->rows->size();
+  stats.memory_used -= entry->bytes;
+  memory_used_ -= entry->bytes;
+
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+bool TableResultCache::exists(const std::string& table,
+                              const std::string& key,
+                              uint64_t step) {
+  WriteLock lock(mutex_);
+  return find(table, key, step) != entries_.end();
+}
+
+bool TableResultCache::take(const std::string& table,
+                            const std::string& key,
+                            uint64_t step,
+                            TableRows& results) {
+  std::shared_ptr<const TableRows> rows;
+  {
+    WriteLock lock(mutex_);
+    auto entry = find(table, key, step);
+    if (entry == entries_.end()) {
+      stats_[table].misses++;
+      return false;
+    }
+    stats_[table].hits++;
+    rows = entry->rows;
+  }
+
+  results.clear();
+  results.reserve(rows->size());
+  for (const auto& row : *rows) {
+    results.push_back(row->clone());
+  }
+  return true;
+}
+
+void TableResultCache::put(const std::string& table,
+                           const std::string& key,
+                           uint64_t step,
+                           uint64_t interval,
+                           const TableRows& results) {
+  Entry entry;
+  entry.table = table;
+  entry.key = key;
+  entry.step = step;
+  entry.interval = interval;
+
+  auto rows = std::make_shared<TableRows>();
+  rows->reserve(results.size());
+  for (const auto& row : results) {
+    entry.bytes += row->memoryUsage();
+    rows->push_back(row->clone());
+  }
+  entry.rows = std::move(rows);
+
+  WriteLock lock(mutex_);
+  auto existing = index_.find(key);
+  if (existing != index_.end()) {
+    erase(existing->second);
+  }
+
+  size_t budget = FLAGS_table_cache_max_bytes;
+  if (entry.bytes > budget) {
+    // The results would evict every other entry and still not fit.
+    return;
+  }
+
+  auto& stats = stats_[table];
+  stats.entries++;
+  stats.rows += entry.rows->size();
+  stats.memory_used += entry.bytes;
+  memory_used_ += entry.bytes;
+
+  entries_.push_front(std::move(entry));
+  index_[key] = entries_.begin();
+
+  while (memory_used_ > budget) {
+    auto last = std::prev(entries_.end());
+    stats_[last->table].evictions++;
+    erase(last);
+  }
+}
+
+void TableResultCache::clear() {
+  WriteLock lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  stats_.clear();
+  memory_used_ = 0;
+}
+
+std::vector<TableCacheStats> TableResultCache::stats() const {
+  ReadLock lock(mutex_);
+  std::vector<TableCacheStats> stats;
+  stats.reserve(stats_.size());
+  for (const auto& table : stats_) {
+    stats.push_back(table.second);
+    stats.back().table = table.first;
+  }
+  return stats;
+}
+
+struct TableSingleFlight::Flight {
+  /// Requests waiting for the results, final once the flight is removed.
+  size_t followers{0};
+
+  std::promise<void> done;
+  std::shared_future<void> ready{done.get_future().share()};
+
+  Status status;
+
+  /// A copy of the results, only made if there are followers.
+  std::shared_ptr<const TableRows> rows;
+};
+
+TableSingleFlight& TableSingleFlight::get() {
+  static TableSingleFlight single_flight;
+  return single_flight;
+}
+
+Status TableSingleFlight::run(const std::string& key,
+                              const Generator& generate,
+                              TableRows& results,
+                              bool& coalesced) {
+  // Keys of the generations this thread is performing.
+  thread_local std::unordered_set<std::string> leading;
+
+  coalesced = false;
+  if (leading.count(key) > 0) {
+    return generate(results);
+  }
+
+  std::shared_ptr<Flight> flight;
+  bool leader = false;
+  {
+    WriteLock lock(mutex_);
+    auto& existing = flights_[key];
+    if (existing == nullptr) {
+      existing = std::make_shared<Flight>();
+      leader = true;
+    } else {
+      existing->followers++;
+    }
+    flight = existing;
+  }
+
+  if (!leader) {
+    coalesced_++;
+    coalesced = true;
+
+    // Rethrows an exception from the generator.
+    flight->ready.get();
+    if (flight->status.ok()) {
+      results.clear();
+      results.reserve(flight->rows->size());
+      for (const auto& row : *flight->rows) {
+        results.push_back(row->clone());
+      }
+    }
+    return flight->status;
+  }
+
+  generations_++;
+  leading.insert(key);
+  std::exception_ptr error;
+  try {
+    flight->status = generate(results);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  leading.erase(key);
+
+  // No request can join the flight once it is removed.
+  {
+    WriteLock lock(mutex_);
+    flights_.erase(key);
+  }
+
+  if (error != nullptr) {
+    flight->done.set_exception(error);
+    std::rethrow_exception(error);
+  }
+
+  if (flight->followers > 0 && flight->status.ok()) {
+    auto rows = std::make_shared<TableRows>();
+    rows->reserve(results.size());
+    for (const auto& row : results) {
+      rows->push_back(row->clone());
+    }
+    flight->rows = std::move(rows);
+  }
+  flight->done.set_value();
+  return flight->status;
+}
+
+TableSingleFlightStats TableSingleFlight::stats() const {
+  TableSingleFlightStats stats;
+  stats.generations = generations_;
+  stats.coalesced = coalesced_;
+  return stats;
+}
+
+} // namespace osquery
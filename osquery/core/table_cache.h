@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <osquery/core/tables.h>
+#include <osquery/utils/mutex.h>
+
+namespace osquery {
+
+/// Counters describing the cached results of a single table.
+struct TableCacheStats {
+  std::string table;
+
+  /// Number of cached constraint and column combinations.
+  size_t entries{0};
+
+  size_t rows{0};
+  uint64_t hits{0};
+  uint64_t misses{0};
+
+  /// Entries removed to keep the cache within its memory budget.
+  uint64_t evictions{0};
+
+  /// Estimated bytes of memory used by the cached rows.
+  uint64_t memory_used{0};
+};
+
+/**
+ * @brief An in-memory LRU cache of typed table results.
+ *
+ * Results are keyed by the table name, the normalized constraints, and the
+ * columns used by the query, because tables may generate different rows for
+ * each. Scheduled queries sharing a table within an interval reuse the rows
+ * without generating, serializing, or parsing them again.
+ *
+ * An entry is fresh for the interval of the query that cached it, unless the
+ * table has a TTL set with --table_cache_ttl. The estimated memory used by
+ * all entries is kept within --table_cache_max_bytes by evicting the least
+ * recently used entries.
+ */
+class TableResultCache : private boost::noncopyable {
+ public:
+  static TableResultCache& get();
+
+  /// Build the cache key for a table's query context.
+  static std::string key(const std::string& table, const QueryContext& ctx);
+
+  /// Check if a fresh entry exists at the schedule step, without counting.
+  bool exists(const std::string& table, const std::string& key, uint64_t step);
+
+  /**
+   * @brief Copy fresh cached rows into results.
+   *
+   * A stale entry is removed.
+   *
+   * @return false on a cache miss.
+   */
+  bool take(const std::string& table,
+            const std::string& key,
+            uint64_t step,
+            TableRows& results);
+
+  /// Cache a copy of the results generated at a step for an interval.
+  void put(const std::string& table,
+           const std::string& key,
+           uint64_t step,
+           uint64_t interval,
+           const TableRows& results);
+
+  /// Remove all entries and counters.
+  void clear();
+
+  /// The counters for each table that used the cache.
+  std::vector<TableCacheStats> stats() const;
+
+ private:
+  TableResultCache() = default;
+
+  struct Entry {
+    std::string table;
+    std::string key;
+
+    /// The schedule step and interval when the rows were generated.
+    uint64_t step{0};
+    uint64_t interval{0};
+
+    size_t bytes{0};
+
+    /// Shared so the rows are copied without holding the lock.
+    std::shared_ptr<const TableRows> rows;
+  };
+
+  /// Find a fresh entry and mark it as recently used, or remove it if stale.
+  std::list<Entry>::iterator find(const std::string& table,
+                                  const std::string& key,
+                                  uint64_t step);
+
+  /// Remove an entry and account for its rows.
+  void erase(std::list<Entry>::iterator entry);
+
+ private:
+  /// Cached results, the most recently used first.
+  std::list<Entry> entries_;
+
+  /// Cache key to the cached results.
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  /// Counters for each table.
+  std::map<std::string, TableCacheStats> stats_;
+
+  size_t memory_used_{0};
+
+  mutable Mutex mutex_;
+};
+
+/// Counters describing generations shared by identical table requests.
+struct TableSingleFlightStats {
+  /// Generations performed on behalf of one or more requests.
+  uint64_t generations{0};
+
+  /// Requests that waited for an identical generation instead of generating.
+  uint64_t coalesced{0};
+};
+
+/**
+ * @brief Share one in-progress table generation between identical requests.
+ *
+ * Distributed queries, the schedule, and extensions may scan the same
+ * expensive table at the same time. A request with the same TableResultCache
+ * key as a generation in progress waits for it and receives a copy of its
+ * results instead of generating the table again.
+ *
+ * A thread that requests its own in-progress generation, for example a table
+ * that queries itself, generates again instead of waiting forever.
+ */
+class TableSingleFlight : private boost::noncopyable {
+ public:
+  using Generator = std::function<Status(TableRows& results)>;
+
+  static TableSingleFlight& get();
+
+  /**
+   * @brief Generate results, or wait for the identical generation in progress.
+   *
+   * Exceptions thrown by the generator are rethrown to every waiting request.
+   *
+   * @param key The TableResultCache key of the request.
+   * @param generate Called if no identical generation is in progress.
+   * @param results The output rows.
+   * @param coalesced Set to true if another request's generation was used.
+   * @return The status of the generation.
+   */
+  Status run(const std::string& key,
+             const Generator& generate,
+             TableRows& results,
+             bool& coalesced);
+
+  TableSingleFlightStats stats() const;
+
+ private:
+  TableSingleFlight() = default;
+
+  struct Flight;
+
+  /// Cache key to the generation in progress.
+  std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+
+  std::atomic<uint64_t> generations_{0};
+  std::atomic<uint64_t> coalesced_{0};
+
+  Mutex mutex_;
+};
+
+} // namespace osquery
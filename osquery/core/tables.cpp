@@ -10,12 +10,13 @@
 #include <osquery/utils/json/json.h>
 
 #include <osquery/core/flags.h>
+#include <osquery/core/table_cache.h>
 #include <osquery/core/tables.h>
-#include <osquery/database/database.h>
 #include <osquery/logger/logger.h>
 #include <osquery/registry/registry_factory.h>
 #include <osquery/utils/conversions/tryto.h>
 
+#include <algorithm>
 #include <climits>
 
 namespace osquery {
@@ -160,6 +161,128 @@ Status TablePlugin::call(const PluginRequest& request,
   return Status::success();
 }
 
+/// The page storage of a column type.
+static TablePage::Storage pageStorage(ColumnType type) {
+  switch (type) {
+  case INTEGER_TYPE:
+  case BIGINT_TYPE:
+  case UNSIGNED_BIGINT_TYPE:
+    return TablePage::Storage::Integer;
+  case DOUBLE_TYPE:
+    return TablePage::Storage::Double;
+  default:
+    return TablePage::Storage::Text;
+  }
+}
+
+/// Add a value cast to the column type, false if it does not fit.
+static bool addPageValue(ColumnType type,
+                         std::string& value,
+                         TablePage::Column& column) {
+  switch (column.storage) {
+  case TablePage::Storage::Text:
+    column.text.push_back(std::move(value));
+    return true;
+  case TablePage::Storage::Integer:
+    if (type == INTEGER_TYPE) {
+      auto integer = tryTo<long>(value, 0);
+      if (integer.isError()) {
+        return false;
+      }
+      column.integers.push_back(integer.take());
+    } else {
+      auto integer = tryTo<long long>(value, 0);
+      if (integer.isError()) {
+        return false;
+      }
+      column.integers.push_back(integer.take());
+    }
+    return true;
+  case TablePage::Storage::Double: {
+    char* end = nullptr;
+    double real = strtod(value.c_str(), &end);
+    if (end == nullptr || end == value.c_str() || *end != '\0') {
+      return false;
+    }
+    column.doubles.push_back(real);
+    return true;
+  }
+  }
+  return false;
+}
+
+/// Add a null value, marking the row within the column's nulls.
+static void addPageNull(TablePage::Column& column, size_t row, size_t rows) {
+  switch (column.storage) {
+  case TablePage::Storage::Text:
+    column.text.emplace_back();
+    break;
+  case TablePage::Storage::Integer:
+    column.integers.push_back(0);
+    break;
+  case TablePage::Storage::Double:
+    column.doubles.push_back(0);
+    break;
+  }
+
+  if (column.nulls.empty()) {
+    column.nulls.resize(rows, false);
+  }
+  column.nulls[row] = true;
+}
+
+Status TablePlugin::generatePage(const PluginRequest& request,
+                                 TablePage& page) {
+  page.clear();
+
+  auto context = getContextFromRequest(request);
+  auto rows = generate(context);
+
+  std::vector<ColumnType> types;
+  for (const auto& column : columns()) {
+    if (page.column(std::get<0>(column)) == nullptr) {
+      page.addColumn(std::get<0>(column), pageStorage(std::get<1>(column)));
+      types.push_back(std::get<1>(column));
+    }
+  }
+
+  for (auto& column : page.columns()) {
+    if (column.storage == TablePage::Storage::Text) {
+      column.text.reserve(rows.size());
+    } else if (column.storage == TablePage::Storage::Integer) {
+      column.integers.reserve(rows.size());
+    } else {
+      column.doubles.reserve(rows.size());
+    }
+  }
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    auto row = static_cast<Row>(*rows[i]);
+    rows[i].reset();
+
+    // Rows may set their own rowid without declaring the column.
+    if (row.count("rowid") > 0 && page.column("rowid") == nullptr) {
+      auto& rowid = page.addColumn("rowid", TablePage::Storage::Text);
+      rowid.text.resize(i);
+      rowid.nulls.resize(rows.size(), false);
+      std::fill(rowid.nulls.begin(), rowid.nulls.begin() + i, true);
+      types.push_back(TEXT_TYPE);
+    }
+
+    for (size_t j = 0; j < types.size(); j++) {
+      auto& column = page.columns()[j];
+      auto value = row.find(column.name);
+      if (value == row.end() ||
+          !addPageValue(types[j], value->second, column)) {
+        addPageNull(column, i, rows.size());
+      }
+    }
+  }
+
+  page.setRows(rows.size());
+  return Status::success();
+}
+
 std::string TablePlugin::columnDefinition(bool is_extension) const {
   return osquery::columnDefinition(columns(), is_extension);
 }
@@ -195,57 +318,46 @@ PluginResponse TablePlugin::routeInfo() const {
   return response;
 }
 
-static bool cacheAllowed(const TableColumns& cols, const QueryContext& ctx) {
-  if (!ctx.useCache() || !ctx.defaultColumnsUsed()) {
-    // The query execution did not request use of the warm cache.
+static bool cacheAllowed(const QueryContext& ctx) {
+  // Only scheduled query executions request use of the warm cache.
+  return !FLAGS_disable_caching && ctx.useCache();
+}
+
+bool TablePlugin::isCached(uint64_t step, const QueryContext& ctx) const {
+  if (!cacheAllowed(ctx)) {
     return false;
   }
 
-  auto uncachable = ColumnOptions::INDEX | ColumnOptions::REQUIRED |
-                    ColumnOptions::ADDITIONAL | ColumnOptions::OPTIMIZED;
-  for (const auto& column : cols) {
-    auto opts = std::get<2>(column) & uncachable;
-    if (opts && ctx.constraints.at(std::get<0>(column)).exists()) {
-      return false;
-    }
-  }
-  return true;
+  auto key = TableResultCache::key(getName(), ctx);
+  return TableResultCache::get().exists(getName(), key, step);
 }
 
-bool TablePlugin::isCached(uint64_t step, const QueryContext& ctx) const {
-  if (FLAGS_disable_caching) {
+bool TablePlugin::getCache(uint64_t step,
+                           const QueryContext& ctx,
+                           TableRows& results) const {
+  if (!cacheAllowed(ctx)) {
     return false;
   }
 
-  // Perform the step comparison first, because it's easy.
-  return (step < last_cached_ + last_interval_ && cacheAllowed(columns(), ctx));
-}
+  auto key = TableResultCache::key(getName(), ctx);
+  if (!TableResultCache::get().take(getName(), key, step, results)) {
+    return false;
+  }
 
-TableRows TablePlugin::getCache() const {
-  VLOG(1) << "Retrieving results from cache for table: " << getName();
-  // Lookup results from database and deserialize.
-  std::string content;
-  getDatabaseValue(kQueries, "cache." + getName(), content);
-  TableRows results;
-  deserializeTableRowsJSON(content, results);
-  return results;
+  VLOG(1) << "Retrieved results from cache for table: " << getName();
+  return true;
 }
 
 void TablePlugin::setCache(uint64_t step,
                            uint64_t interval,
                            const QueryContext& ctx,
                            const TableRows& results) {
-  if (FLAGS_disable_caching || !cacheAllowed(columns(), ctx)) {
+  if (!cacheAllowed(ctx)) {
     return;
   }
 
-  // Serialize QueryData and save to database.
-  std::string content;
-  if (serializeTableRowsJSON(results, content)) {
-    last_cached_ = step;
-    last_interval_ = interval;
-    setDatabaseValue(kQueries, "cache." + getName(), content);
-  }
+  auto key = TableResultCache::key(getName(), ctx);
+  TableResultCache::get().put(getName(), key, step, interval, results);
 }
 
 std::string columnDefinition(const TableColumns& columns, bool is_extension) {
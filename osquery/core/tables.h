@@ -26,6 +26,7 @@
 #include <osquery/core/plugins/plugin.h>
 #include <osquery/core/query.h>
 #include <osquery/core/sql/column.h>
+#include <osquery/core/sql/table_page.h>
 
 #include <gtest/gtest_prod.h>
 
@@ -803,51 +804,46 @@ class TablePlugin : public Plugin {
    * table "processes" at the interval 60. The first executed will cache results
    * and the second will use the cached results.
    *
-   * Table results are not cached if a QueryContext contains constraints or
-   * provides HOB (hand-off blocks) to additional tables within a query.
+   * Results are cached in memory by the TableResultCache for each combination
+   * of constraints and used columns, so queries with the same predicates share
+   * results. A table may override the interval with --table_cache_ttl.
    * Currently, the query scheduler cannot communicate to table implementations.
    * An interval is set globally by the scheduler and passed to the table
    * implementation as a future-proof API. There is no "shortcut" for caching
-   * when used in external tables. A cache lookup within an extension means
-   * a database call API and re-serialization to the virtual table APIs. In
-   * practice this does not perform well and is explicitly disabled.
+   * when used in external tables.
    *
-   * @param interval The interval this query expects the tables results.
+   * @param step The current schedule step.
    * @param ctx The query context.
    * @return True if the cache contains fresh results, otherwise false.
    */
-  bool isCached(uint64_t interval, const QueryContext& ctx) const;
+  bool isCached(uint64_t step, const QueryContext& ctx) const;
 
   /**
-   * @brief Perform a database lookup of cached results and deserialize.
+   * @brief Copy fresh cached results for the query context.
    *
-   * If a query determined the table's cached results are fresh, it may ask the
-   * table to retrieve results from the database and deserialized them into
-   * table row data.
+   * If the cache contains fresh results for the query's constraints and used
+   * columns they are cloned into results.
    *
-   * @return The deserialized row data of cached results.
+   * @param step The current schedule step.
+   * @param ctx The query context.
+   * @param results The output cached row data.
+   * @return True on a cache hit, otherwise false.
    */
-  TableRows getCache() const;
+  bool getCache(uint64_t step,
+                const QueryContext& ctx,
+                TableRows& results) const;
 
   /**
    * @brief Similar to getCache, stores the results from generate.
    *
-   * Set will serialize and save the results as JSON to be retrieved later.
-   * It will inspect the query context, if any required/indexed/optimized or
-   * additional columns are used then the cache will not be saved.
+   * Set will keep a copy of the results in memory to be retrieved later by
+   * queries with the same constraints and used columns.
    */
   void setCache(uint64_t step,
                 uint64_t interval,
                 const QueryContext& ctx,
                 const TableRows& results);
 
- private:
-  /// The last time in seconds the table data results were saved to cache.
-  uint64_t last_cached_{0};
-
-  /// The last interval in seconds when the table data was cached.
-  uint64_t last_interval_{0};
-
  public:
   /**
    * @brief The scheduled interval for the executing query.
@@ -877,6 +873,19 @@ class TablePlugin : public Plugin {
    */
   Status call(const PluginRequest& request, PluginResponse& response) override;
 
+  /**
+   * @brief Generate the table's rows as typed columns.
+   *
+   * Extensions answer generateTable requests from the core with a TablePage
+   * rather than a string map per row. Each value is cast to its column type
+   * the same way the SQL virtual table casts it, and a value that does not
+   * fit its type is null.
+   *
+   * @param request The plugin request, including the query context.
+   * @param page [output] The generated rows.
+   */
+  Status generatePage(const PluginRequest& request, TablePage& page);
+
  public:
   /// Helper data structure transformation methods.
   static void setRequestFromContext(const QueryContext& context,
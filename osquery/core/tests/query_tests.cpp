@@ -68,7 +68,8 @@ TEST_F(QueryTests, test_get_query_status) {
 
   // Add results for this query (this action is not under test).
   uint64_t counter = 0;
-  auto status = cf.addNewResults(getTestDBExpectedResults(), 100, counter);
+  auto status = cf.addNewResults(
+      getQueryResults(getTestDBExpectedResults()), 100, counter);
   ASSERT_TRUE(status.ok());
 
   // The query has results and the query text has not changed.
@@ -86,7 +87,8 @@ TEST_F(QueryTests, test_get_query_status) {
   EXPECT_FALSE(new_query);
 
   // Add results for the new epoch (this action is not under test).
-  status = cf.addNewResults(getTestDBExpectedResults(), 101, counter);
+  status = cf.addNewResults(
+      getQueryResults(getTestDBExpectedResults()), 101, counter);
   ASSERT_TRUE(status.ok());
 
   // The epoch is the same but the query text has changed.
@@ -105,7 +107,8 @@ TEST_F(QueryTests, test_add_and_get_current_results) {
   auto query = getOsqueryScheduledQuery();
   auto cf = Query("foobar", query);
   uint64_t counter = 128;
-  auto status = cf.addNewResults(getTestDBExpectedResults(), 0, counter);
+  auto status = cf.addNewResults(
+      getQueryResults(getTestDBExpectedResults()), 0, counter);
   EXPECT_TRUE(status.ok());
   EXPECT_EQ(status.toString(), "OK");
   EXPECT_EQ(counter, 0UL);
@@ -122,12 +125,15 @@ TEST_F(QueryTests, test_add_and_get_current_results) {
     // Add the "current" results and output the differentials.
     DiffResults dr;
     counter = 128;
-    auto s = cf.addNewResults(result.second, 0, counter, dr, true);
+    auto s = cf.addNewResults(
+        getQueryResults(result.second), 0, counter, dr, true);
     EXPECT_TRUE(s.ok());
     EXPECT_EQ(counter, expected_counter++);
 
     // Call the diffing utility directly.
-    DiffResults expected = diff(previous_qd, result.second);
+    DiffResults expected;
+    ASSERT_TRUE(
+        diff(previous_qd, getQueryResults(result.second), expected).ok());
     EXPECT_EQ(dr, expected);
 
     // After Query::addNewResults the previous results are now current.
@@ -188,7 +194,7 @@ TEST_F(QueryTests, test_query_name_updated) {
   DiffResults dr;
   uint64_t counter = 128;
   auto results = getTestDBExpectedResults();
-  cf.addNewResults(results, 0, counter, dr);
+  cf.addNewResults(getQueryResults(results), 0, counter, dr);
   EXPECT_FALSE(cf.isNewQuery());
   EXPECT_EQ(counter, 0UL);
 
@@ -197,7 +203,7 @@ TEST_F(QueryTests, test_query_name_updated) {
   auto cf2 = Query("will_update_query", query);
   EXPECT_TRUE(cf2.isQueryNameInDatabase());
   EXPECT_TRUE(cf2.isNewQuery());
-  cf2.addNewResults(results, 0, counter, dr);
+  cf2.addNewResults(getQueryResults(results), 0, counter, dr);
   EXPECT_FALSE(cf2.isNewQuery());
   EXPECT_EQ(counter, 0UL);
 }
@@ -35,7 +35,7 @@ QueryData getExampleQueryData(size_t x, size_t y) {
 
 QueryDataSet getExampleQueryDataSet(size_t x, size_t y) {
   QueryDataSet qds;
-  Row r;
+  RowTyped r;
 
   // Fill in a row with x;
   for (size_t i = 0; i < x; i++) {
@@ -56,6 +56,16 @@ ColumnNames getExampleColumnNames(size_t x) {
   return cn;
 }
 
+QueryResults getExampleQueryResults(size_t x, size_t y) {
+  QueryResults results(getExampleColumnNames(x));
+  for (size_t i = 0; i < y; i++) {
+    for (size_t j = 0; j < x; j++) {
+      results.addText(std::to_string(j) + "content");
+    }
+  }
+  return results;
+}
+
 static void DATABASE_serialize(benchmark::State& state) {
   auto qd = getExampleQueryData(state.range(0), state.range(1));
   while (state.KeepRunning()) {
@@ -95,23 +105,26 @@ BENCHMARK(DATABASE_serialize_json)
     ->ArgPair(10, 100);
 
 static void DATABASE_diff(benchmark::State& state) {
-  QueryData qd = getExampleQueryData(state.range(0), state.range(1));
+  auto results = getExampleQueryResults(state.range(0), state.range(1));
   QueryDataSet qds = getExampleQueryDataSet(state.range(0), state.range(1));
   while (state.KeepRunning()) {
-    auto d = diff(qds, qd);
+    DiffResults d;
+    diff(qds, results, d);
   }
 }
 
 BENCHMARK(DATABASE_diff)->ArgPair(1, 1)->ArgPair(10, 10)->ArgPair(10, 100);
 
 static void DATABASE_query_results(benchmark::State& state) {
-  auto qd = getExampleQueryData(state.range(0), state.range(1));
   auto query = getOsqueryScheduledQuery();
   while (state.KeepRunning()) {
     DiffResults diff_results;
     uint64_t counter;
     auto dbq = Query("default", query);
-    dbq.addNewResults(std::move(qd), 0, counter, diff_results);
+    dbq.addNewResults(getExampleQueryResults(state.range(0), state.range(1)),
+                      0,
+                      counter,
+                      diff_results);
   }
 }
 
@@ -12,6 +12,7 @@
 #include <osquery/core/query.h>
 #include <osquery/core/sql/diff_results.h>
 #include <osquery/core/sql/query_data.h>
+#include <osquery/core/sql/query_results.h>
 #include <osquery/sql/tests/sql_test_utils.h>
 
 #include <gtest/gtest.h>
@@ -24,16 +25,53 @@ class ResultsTests : public testing::Test {};
 
 TEST_F(ResultsTests, test_simple_diff) {
   QueryDataSet os;
-  QueryDataTyped o;
-  QueryDataTyped n;
+  QueryResults n({"foo"});
+  n.addText("bar");
 
-  RowTyped r1;
-  r1["foo"] = "bar";
-  n.push_back(r1);
-
-  auto results = diff(os, n);
+  DiffResults results;
+  ASSERT_TRUE(diff(os, n, results).ok());
   EXPECT_EQ(results.added, n);
-  EXPECT_EQ(results.removed, o);
+  EXPECT_TRUE(results.removed.empty());
+}
+
+TEST_F(ResultsTests, test_diff_query_results) {
+  // Rows are found in the previous set as the equal RowTyped would be.
+  QueryDataSet os = {
+      {{"age", 23LL}, {"name", "mike"}, {"score", 1.0}},
+      {{"age", 24LL}, {"name", "matt"}, {"score", 0.5}},
+      {{"age", 25LL}, {"name", "nick"}, {"score", 0.0}},
+  };
+
+  // The columns are not sorted, the last of a repeated column is used.
+  QueryResults n({"name", "score", "age", "name"});
+  n.addText("ignored");
+  n.addReal(1.0);
+  n.addInteger(23);
+  n.addText("mike");
+  // A cell of another type is a different value.
+  n.addText("ignored");
+  n.addText("0.5");
+  n.addInteger(24);
+  n.addText("matt");
+  n.addText("ignored");
+  n.addReal(0.0);
+  n.addInteger(25);
+  n.addText("nick");
+
+  DiffResults results;
+  ASSERT_TRUE(diff(os, n, results).ok());
+  ASSERT_EQ(results.added.rows(), 1U);
+  EXPECT_EQ(results.added.columnNames(), n.columnNames());
+  EXPECT_EQ(results.added.text(0, 1), "0.5");
+
+  QueryResults removed;
+  ASSERT_TRUE(
+      removed.addRow({{"age", 24LL}, {"name", "matt"}, {"score", 0.5}}).ok());
+  EXPECT_EQ(results.removed, removed);
+
+  // Removed rows must have the same columns.
+  os = {{{"name", "mike"}}, {{"age", 23LL}}};
+  EXPECT_FALSE(diff(os, n, results).ok());
 }
 
 TEST_F(ResultsTests, test_serialize_row) {
@@ -90,6 +128,86 @@ TEST_F(ResultsTests, test_deserialize_query_data_json) {
   EXPECT_EQ(output, resultSet);
 }
 
+TEST_F(ResultsTests, test_query_results) {
+  QueryResults results({"name", "age", "score"});
+  results.addText("mike");
+  results.addInteger(23);
+  results.addReal(1.0);
+  results.addText("matt");
+  results.addInteger(24);
+  results.addReal(0.5);
+  ASSERT_EQ(results.rows(), 2U);
+  EXPECT_EQ(results.row(1).text(0), "matt");
+  EXPECT_EQ(results.row(1).integer(1), 24);
+
+  QueryDataTyped typed;
+  results.appendTo(typed);
+  QueryDataTyped expected_typed = {
+      {{"name", "mike"}, {"age", 23LL}, {"score", 1.0}},
+      {{"name", "matt"}, {"age", 24LL}, {"score", 0.5}},
+  };
+  EXPECT_EQ(typed, expected_typed);
+
+  QueryData rows;
+  results.appendTo(rows);
+  EXPECT_EQ(rows[0], Row({{"name", "mike"}, {"age", "23"}, {"score", "1.0"}}));
+
+  // Serialization matches the typed rows.
+  for (bool numeric : {true, false}) {
+    auto expected = JSON::newArray();
+    serializeQueryData(typed, expected, expected.doc(), numeric);
+    auto doc = JSON::newArray();
+    EXPECT_TRUE(serializeQueryResults(results, doc, doc.doc(), numeric).ok());
+    EXPECT_EQ(expected.doc(), doc.doc());
+  }
+
+  // Rows of other results are appended if the columns match.
+  QueryResults more({"name", "age", "score"});
+  more.addText("nick");
+  more.addInteger(25);
+  more.addReal(0.0);
+  EXPECT_TRUE(results.append(std::move(more)).ok());
+  ASSERT_EQ(results.rows(), 3U);
+  EXPECT_EQ(results.text(2, 0), "nick");
+  EXPECT_EQ(results.string(2, 2), "0.0");
+
+  QueryResults other({"name"});
+  other.addText("other");
+  EXPECT_FALSE(results.append(std::move(other)).ok());
+}
+
+TEST_F(ResultsTests, test_query_results_rows) {
+  QueryResults results;
+  ASSERT_TRUE(results.addRow({{"name", "mike"}, {"age", 23LL}}).ok());
+  EXPECT_EQ(results.columnNames(), ColumnNames({"age", "name"}));
+  EXPECT_FALSE(results.addRow({{"name", "matt"}}).ok());
+  EXPECT_FALSE(results.addRow({{"name", "matt"}, {"score", 1.0}}).ok());
+  ASSERT_EQ(results.rows(), 1U);
+
+  QueryResults copy(results.columnNames());
+  copy.addRow(results, 0);
+  EXPECT_EQ(copy, results);
+  copy.addInteger(24);
+  EXPECT_TRUE(copy.addText("matt").ok());
+  EXPECT_NE(copy, results);
+
+  // Text is replaced in every text cell.
+  EXPECT_TRUE(copy
+                  .transformText([](std::string& value) {
+                    value = "<" + value + ">";
+                  })
+                  .ok());
+  EXPECT_EQ(copy.text(0, 1), "<mike>");
+  EXPECT_EQ(copy.text(1, 1), "<matt>");
+  EXPECT_EQ(copy.integer(1, 0), 24);
+
+  // A text cell is smaller than 4 GiB, the size is checked before reading.
+  std::string text("x");
+  std::string_view large(text.data(), QueryResults::kMaxTextSize + 1);
+  EXPECT_FALSE(copy.addText(large).ok());
+  EXPECT_EQ(copy.rows(), 2U);
+}
+
 TEST_F(ResultsTests, test_serialize_diff_results) {
   auto results = getSerializedDiffResults();
   auto doc = JSON::newObject();
@@ -8,6 +8,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <ctime>
 
 #include <boost/format.hpp>
@@ -24,6 +25,7 @@
 #include <osquery/numeric_monitoring/numeric_monitoring.h>
 #include <osquery/process/process.h>
 #include <osquery/profiler/code_profiler.h>
+#include <osquery/profiler/resource_usage.h>
 
 #include <osquery/utils/system/time.h>
 
@@ -79,27 +81,27 @@ SQLInternal monitor(const std::string& name, const ScheduledQuery& query) {
              .str()});
     return SQLInternal(query.query, true);
   } else {
-    // Snapshot the performance and times for the worker before running.
-    auto pid = std::to_string(PlatformProcess::getCurrentPid());
-    auto r0 = SQL::selectFrom({"resident_size", "user_time", "system_time"},
-                              "processes",
-                              "pid",
-                              EQUALS,
-                              pid);
-    auto t0 = getUnixTime();
+    // Snapshot the resources used by this thread before running.
+    auto u0 = getResourceUsage();
     Config::get().recordQueryStart(name);
     SQLInternal sql(query.query, true);
-    // Snapshot the performance after, and compare.
-    auto t1 = getUnixTime();
-    auto r1 = SQL::selectFrom({"resident_size", "user_time", "system_time"},
-                              "processes",
-                              "pid",
-                              EQUALS,
-                              pid);
-    if (r0.size() > 0 && r1.size() > 0) {
-      // Always called while processes table is working.
-      Config::get().recordQueryPerformance(name, t1 - t0, r0[0], r1[0]);
-    }
+    // Snapshot the resources after, and compare.
+    auto u1 = getResourceUsage();
+
+    QueryResourceUsage usage;
+    usage.wall_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             u1.wall_time - u0.wall_time)
+                             .count();
+    usage.user_time = (u1.user_time > u0.user_time)
+                          ? u1.user_time - u0.user_time
+                          : 0;
+    usage.system_time = (u1.system_time > u0.system_time)
+                            ? u1.system_time - u0.system_time
+                            : 0;
+    usage.memory = static_cast<int64_t>(u1.allocated_bytes) -
+                   static_cast<int64_t>(u0.allocated_bytes);
+    usage.rows = sql.results().rows();
+    Config::get().recordQueryPerformance(name, usage);
     return sql;
   }
 }
@@ -135,7 +137,7 @@ Status launchQuery(const std::string& name, const ScheduledQuery& query) {
 
   if (query.isSnapshotQuery()) {
     // This is a snapshot query, emit results with a differential or state.
-    item.snapshot_results = std::move(sql.rowsTyped());
+    item.snapshot_results = std::move(sql.results());
     logSnapshotQuery(item);
     return Status::success();
   }
@@ -143,18 +145,22 @@ Status launchQuery(const std::string& name, const ScheduledQuery& query) {
   // Create a database-backed set of query results.
   auto dbQuery = Query(name, query);
   // Comparisons and stores must include escaped data.
-  sql.escapeResults();
-  Status status;
+  auto status = sql.escapeResults();
+  if (!status.ok()) {
+    LOG(ERROR) << "Error escaping the results of scheduled query " << name
+               << ": " << status.toString();
+    return Status::failure("Error executing scheduled query");
+  }
   DiffResults& diff_results = item.results;
   // Add this execution's set of results to the database-tracked named query.
   // We can then ask for a differential from the last time this named query
   // was executed by exact matching each row.
   if (!FLAGS_events_optimize || !sql.eventBased()) {
     status = dbQuery.addNewResults(
-        std::move(sql.rowsTyped()), item.epoch, item.counter, diff_results);
+        std::move(sql.results()), item.epoch, item.counter, diff_results);
   } else {
     status = dbQuery.addNewEvents(
-        std::move(sql.rowsTyped()), item.epoch, item.counter, diff_results);
+        std::move(sql.results()), item.epoch, item.counter, diff_results);
   }
 
   if (!status.ok()) {
@@ -186,12 +192,13 @@ Status launchQuery(const std::string& name, const ScheduledQuery& query) {
 }
 
 void SchedulerRunner::calculateTimeDriftAndMaybePause(
-    std::chrono::milliseconds loop_step_duration) {
-  if (loop_step_duration + time_drift_ < interval_) {
-    pause(interval_ - loop_step_duration - time_drift_);
+    std::chrono::milliseconds loop_step_duration, uint64_t steps) {
+  auto interval = interval_ * steps;
+  if (loop_step_duration + time_drift_ < interval) {
+    pause(interval - loop_step_duration - time_drift_);
     time_drift_ = std::chrono::milliseconds::zero();
   } else {
-    time_drift_ += loop_step_duration - interval_;
+    time_drift_ += loop_step_duration - interval;
     if (time_drift_ > max_time_drift_) {
       // giving up
       time_drift_ = std::chrono::milliseconds::zero();
@@ -199,33 +206,92 @@ void SchedulerRunner::calculateTimeDriftAndMaybePause(
   }
 }
 
-void SchedulerRunner::maybeRunDecorators(uint64_t time_step) {
-  // Configuration decorators run on 60 second intervals only.
-  if ((time_step % 60) == 0) {
-    runDecorators(DECORATE_INTERVAL, time_step);
-  }
+/// The first multiple of an interval after a step.
+static inline uint64_t nextMultiple(uint64_t time_step, uint64_t interval) {
+  return (time_step / interval + 1) * interval;
 }
 
-void SchedulerRunner::maybeScheduleCarves(uint64_t time_step) {
-  if ((time_step % 60) == 0) {
-    scheduleCarves();
+uint64_t SchedulerRunner::taskInterval(Task task) {
+  switch (task) {
+  case Task::Decorators:
+  case Task::Carves:
+    return 60;
+  case Task::Reload:
+    return FLAGS_schedule_reload;
+  case Task::FlushLogs:
+    return 3;
   }
+  return 0;
 }
 
-void SchedulerRunner::maybeReloadSchedule(uint64_t time_step) {
-  if (FLAGS_schedule_reload > 0 && (time_step % FLAGS_schedule_reload) == 0) {
+void SchedulerRunner::runTask(Task task, uint64_t time_step) {
+  switch (task) {
+  case Task::Decorators:
+    // Configuration decorators run on 60 second intervals only.
+    runDecorators(DECORATE_INTERVAL, time_step);
+    break;
+  case Task::Reload:
     if (FLAGS_schedule_reload_sql) {
       SQLiteDBManager::resetPrimary();
     }
     resetDatabase();
+    break;
+  case Task::FlushLogs:
+    // GLog is not re-entrant, so logs must be flushed in a dedicated thread.
+    relayStatusLogs(LoggerRelayMode::Async);
+    break;
+  case Task::Carves:
+    scheduleCarves();
+    break;
   }
 }
 
-void SchedulerRunner::maybeFlushLogs(uint64_t time_step) {
-  // GLog is not re-entrant, so logs must be flushed in a dedicated thread.
-  if ((time_step % 3) == 0) {
-    relayStatusLogs(LoggerRelayMode::Async);
+void SchedulerRunner::queueTasks(uint64_t time_step) {
+  tasks_ = decltype(tasks_)();
+  for (auto task : {Task::Decorators, Task::Reload, Task::Carves}) {
+    auto interval = taskInterval(task);
+    if (interval > 0) {
+      // The first multiple at or after the step.
+      tasks_.push({nextMultiple(time_step - 1, interval), task});
+    }
   }
+  flush_queued_ = false;
+}
+
+void SchedulerRunner::runDueTasks(uint64_t time_step) {
+  bool flushed = false;
+  while (!tasks_.empty() && tasks_.top().first <= time_step) {
+    auto task = tasks_.top().second;
+    tasks_.pop();
+    runTask(task, time_step);
+
+    if (task == Task::FlushLogs) {
+      flush_queued_ = false;
+      flushed = true;
+      continue;
+    }
+    auto interval = taskInterval(task);
+    if (interval > 0) {
+      tasks_.push({nextMultiple(time_step, interval), task});
+    }
+  }
+
+  // The relay is asynchronous, logs remain buffered after a flush.
+  if (!flushed && !flush_queued_ && queuedStatuses() > 0) {
+    tasks_.push({nextMultiple(time_step, taskInterval(Task::FlushLogs)),
+                 Task::FlushLogs});
+    flush_queued_ = true;
+  }
+}
+
+uint64_t SchedulerRunner::nextStep(uint64_t time_step,
+                                   uint64_t next_query) const {
+  // Steps between scheduled queries still run decorators, carves, etc.
+  auto next = tasks_.empty() ? time_step + 1 : tasks_.top().first;
+  if (next_query > time_step) {
+    next = std::min(next, next_query);
+  }
+  return next;
 }
 
 void SchedulerRunner::start() {
@@ -233,37 +299,41 @@ void SchedulerRunner::start() {
   auto i = osquery::getUnixTime();
   // Timeout is the number of seconds from starting.
   auto end = (timeout_ == 0) ? 0 : timeout_ + i;
+  queueTasks(i);
 
-  for (; (end == 0) || (i <= end); ++i) {
+  while ((end == 0) || (i <= end)) {
     auto start_time_point = std::chrono::steady_clock::now();
-    Config::get().scheduledQueries(([&i](const std::string& name,
-                                         const ScheduledQuery& query) {
-      if (query.splayed_interval > 0 && i % query.splayed_interval == 0) {
-        TablePlugin::kCacheInterval = query.splayed_interval;
-        TablePlugin::kCacheStep = i;
-        const auto status = launchQuery(name, query);
-        monitoring::record((boost::format("scheduler.query.%s.%s.status.%s") %
-                            query.pack_name % query.name %
-                            (status.ok() ? "success" : "failure"))
-                               .str(),
-                           1,
-                           monitoring::PreAggregationType::Sum,
-                           true);
-      }
-    }));
-
-    maybeRunDecorators(i);
-    maybeReloadSchedule(i);
-    maybeFlushLogs(i);
-    maybeScheduleCarves(i);
+    auto next_query = Config::get().dueQueries(
+        i, ([&i](const std::string& name, const ScheduledQuery& query) {
+          TablePlugin::kCacheInterval = query.splayed_interval;
+          TablePlugin::kCacheStep = i;
+          const auto status = launchQuery(name, query);
+          monitoring::record(
+              (boost::format("scheduler.query.%s.%s.status.%s") %
+               query.pack_name % query.name %
+               (status.ok() ? "success" : "failure"))
+                  .str(),
+              1,
+              monitoring::PreAggregationType::Sum,
+              true);
+        }));
+
+    runDueTasks(i);
+
+    // Sleep through the steps where nothing is due.
+    auto next = nextStep(i, next_query);
+    if (end != 0) {
+      next = std::min(next, end + 1);
+    }
 
     auto loop_step_duration =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::steady_clock::now() - start_time_point);
-    calculateTimeDriftAndMaybePause(loop_step_duration);
+    calculateTimeDriftAndMaybePause(loop_step_duration, next - i);
     if (interrupted()) {
       break;
     }
+    i = next;
   }
 
   // Scheduler ended.
@@ -11,6 +11,9 @@
 
 #include <chrono>
 #include <map>
+#include <queue>
+#include <utility>
+#include <vector>
 
 #include <osquery/dispatcher/dispatcher.h>
 
@@ -42,20 +45,45 @@ class SchedulerRunner : public InternalRunnable {
   std::chrono::milliseconds getCurrentTimeDrift() const noexcept;
 
  private:
+  /// Pause for a number of schedule steps, less any accumulated drift.
   void calculateTimeDriftAndMaybePause(
-      std::chrono::milliseconds loop_step_duration);
-
-  /// Check interval-based decorators.
-  void maybeRunDecorators(uint64_t time_step);
-
-  /// Check relative configuration flags.
-  void maybeReloadSchedule(uint64_t time_step);
-
-  /// Check if buffered status logs should be flushed.
-  void maybeFlushLogs(uint64_t time_step);
-
-  /// Check if carve requests should be scheduled.
-  void maybeScheduleCarves(uint64_t time_step);
+      std::chrono::milliseconds loop_step_duration, uint64_t steps);
+
+  /// Periodic work between scheduled queries, in the order it runs.
+  enum class Task {
+    Decorators,
+    Reload,
+    FlushLogs,
+    Carves,
+  };
+
+  /// The step a task is next due.
+  using TaskStep = std::pair<uint64_t, Task>;
+
+  /**
+   * @brief Compute the next step with work to do.
+   *
+   * @param time_step the current step.
+   * @param next_query the next step a scheduled query is due, or 0.
+   */
+  uint64_t nextStep(uint64_t time_step, uint64_t next_query) const;
+
+  /// Queue the periodic tasks at their first step at or after a step.
+  void queueTasks(uint64_t time_step);
+
+  /**
+   * @brief Run the tasks due at a step, and queue each at its next step.
+   *
+   * Status logs are only flushed while they are buffered. Logs buffered
+   * while the scheduler sleeps are flushed at the next step with work.
+   */
+  void runDueTasks(uint64_t time_step);
+
+  /// Run a periodic task.
+  void runTask(Task task, uint64_t time_step);
+
+  /// The interval in steps of a periodic task, 0 if it is disabled.
+  static uint64_t taskInterval(Task task);
 
  private:
   /// Interval in seconds between schedule steps.
@@ -71,6 +99,12 @@ class SchedulerRunner : public InternalRunnable {
 
   const std::chrono::milliseconds max_time_drift_;
 
+  /// A min-heap of the next step each periodic task is due.
+  std::priority_queue<TaskStep, std::vector<TaskStep>, std::greater<>> tasks_;
+
+  /// True if a status log flush is queued.
+  bool flush_queued_{false};
+
   /// Tests should not always trigger a shutdown when the scheduler expires,
   /// so let tests decide when this should happen.
   FRIEND_TEST(TLSConfigTests, test_runner_and_scheduler);
@@ -58,7 +58,7 @@ TEST_F(SchedulerTests, test_monitor) {
   query.splayed_interval = 11;
 
   auto results = monitor(name, query);
-  EXPECT_EQ(results.rowsTyped().size(), 1U);
+  EXPECT_EQ(results.results().rows(), 1U);
 
   // Ask the config instance for the monitored performance.
   QueryPerformance perf;
@@ -68,6 +68,7 @@ TEST_F(SchedulerTests, test_monitor) {
   // There is no pack for this query within the config, that is fine as these
   // performance stats are tracked independently.
   EXPECT_EQ(perf.executions, 1U);
+  EXPECT_EQ(perf.output_rows, 1U);
 
   // A bit more testing, potentially redundant, check the database results.
   // Since we are only monitoring, no 'actual' results are stored.
@@ -79,6 +80,17 @@ TEST_F(SchedulerTests, test_monitor) {
   // We are not concerned with the APPROX value, only that it was recorded.
   getDatabaseValue(kPersistentSettings, "timestamp." + name, timestamp);
   EXPECT_FALSE(timestamp.empty());
+
+  // Executions within the hour do not rewrite the timestamp.
+  setDatabaseValue(kPersistentSettings, "timestamp." + name, "1");
+  monitor(name, query);
+  getDatabaseValue(kPersistentSettings, "timestamp." + name, timestamp);
+  EXPECT_EQ(timestamp, "1");
+
+  Config::get().getPerformanceStats(
+      name, ([&perf](const QueryPerformance& r) { perf = r; }));
+  EXPECT_EQ(perf.executions, 2U);
+  EXPECT_EQ(perf.output_rows, 2U);
 }
 
 TEST_F(SchedulerTests, test_config_results_purge) {
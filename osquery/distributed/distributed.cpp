@@ -7,7 +7,11 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include <osquery/core/plugins/logger.h>
@@ -33,9 +37,63 @@ FLAG(bool,
      true,
      "Disable distributed queries (default true)");
 
+FLAG(uint64,
+     distributed_concurrency,
+     4,
+     "Maximum number of distributed queries executed at once (default 4)");
+
+FLAG(uint64,
+     distributed_query_timeout,
+     0,
+     "Seconds a distributed query may run before it is interrupted, 0 for no "
+     "limit (default 0)");
+
+FLAG(uint64,
+     distributed_flush_rows,
+     10000,
+     "Rows of completed distributed results to write at once (default 10000)");
+
 const std::string kDistributedQueryPrefix{"distributed."};
 
-std::string Distributed::currentRequestId_{""};
+/// Completed results are written once they have waited this long.
+const std::chrono::seconds kDistributedFlushInterval{5};
+
+thread_local std::string Distributed::currentRequestId_{""};
+
+namespace {
+
+Status serializeCompleted(const std::vector<DistributedQueryResult>& results,
+                          std::string& json) {
+  auto doc = JSON::newObject();
+  auto queries_obj = doc.getObject();
+  auto statuses_obj = doc.getObject();
+  auto messages_obj = doc.getObject();
+  for (const auto& result : results) {
+    auto arr = doc.getArray();
+    auto s = serializeQueryData(result.results, result.columns, doc, arr);
+    if (!s.ok()) {
+      return s;
+    }
+    doc.add(result.request.id, arr, queries_obj);
+    doc.add(result.request.id, result.status.getCode(), statuses_obj);
+    doc.add(result.request.id, result.message, messages_obj);
+  }
+
+  doc.add("queries", queries_obj);
+  doc.add("statuses", statuses_obj);
+  doc.add("messages", messages_obj);
+  return doc.toString(json);
+}
+
+size_t countRows(const std::vector<DistributedQueryResult>& results) {
+  size_t rows = 0;
+  for (const auto& result : results) {
+    rows += result.results.size();
+  }
+  return rows;
+}
+
+} // namespace
 
 Status DistributedPlugin::call(const PluginRequest& request,
                                PluginResponse& response) {
@@ -86,54 +144,135 @@ size_t Distributed::getPendingQueryCount() {
 }
 
 size_t Distributed::getCompletedCount() {
+  std::lock_guard<std::mutex> lock(results_mutex_);
   return results_.size();
 }
 
 Status Distributed::serializeResults(std::string& json) {
-  auto doc = JSON::newObject();
-  auto queries_obj = doc.getObject();
-  auto statuses_obj = doc.getObject();
-  auto messages_obj = doc.getObject();
-  for (const auto& result : results_) {
-    auto arr = doc.getArray();
-    auto s = serializeQueryData(result.results, result.columns, doc, arr);
-    if (!s.ok()) {
-      return s;
-    }
-    doc.add(result.request.id, arr, queries_obj);
-    doc.add(result.request.id, result.status.getCode(), statuses_obj);
-    doc.add(result.request.id, result.message, messages_obj);
+  std::lock_guard<std::mutex> lock(results_mutex_);
+  return serializeCompleted(results_, json);
+}
+
+void Distributed::addResult(const DistributedQueryResult& result) {
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    results_.push_back(result);
   }
+  results_cv_.notify_all();
+}
 
-  doc.add("queries", queries_obj);
-  doc.add("statuses", statuses_obj);
-  doc.add("messages", messages_obj);
-  return doc.toString(json);
+bool Distributed::takeRequest(DistributedQueryRequest& request) {
+  std::lock_guard<std::mutex> lock(requests_mutex_);
+  if (getPendingQueryCount() == 0) {
+    return false;
+  }
+
+  request = popRequest();
+  return true;
 }
 
-void Distributed::addResult(const DistributedQueryResult& result) {
-  results_.push_back(result);
+DistributedQueryResult Distributed::runQuery(
+    const DistributedQueryRequest& request) {
+  LOG(INFO) << "Executing distributed query: " << request.id << ": "
+            << request.query;
+
+  // Keep track of the currently executing request
+  Distributed::setCurrentRequestId(request.id);
+
+  SQLDeadline deadline(std::chrono::seconds(FLAGS_distributed_query_timeout));
+  SQL sql(request.query);
+  const auto ok = sql.getStatus().ok();
+  auto msg = ok ? "" : sql.getMessageString();
+  if (!ok && SQLDeadline::expired()) {
+    msg = "Query did not complete within " +
+          std::to_string(FLAGS_distributed_query_timeout) + " seconds";
+  }
+  if (!ok) {
+    LOG(ERROR) << "Error executing distributed query: " << request.id << ": "
+               << msg;
+  }
+
+  Distributed::setCurrentRequestId("");
+  return DistributedQueryResult(
+      request, sql.rows(), sql.columns(), sql.getStatus(), msg);
+}
+
+void Distributed::runPendingQueries() {
+  DistributedQueryRequest request;
+  while (takeRequest(request)) {
+    // An exception must not escape the worker thread.
+    std::string error;
+    try {
+      addResult(runQuery(request));
+      continue;
+    } catch (const std::exception& e) {
+      error = e.what();
+    } catch (...) {
+      error = "Unknown exception";
+    }
+
+    LOG(ERROR) << "Error executing distributed query: " << request.id << ": "
+               << error;
+    Distributed::setCurrentRequestId("");
+    addResult(DistributedQueryResult(
+        request, {}, {}, Status::failure(error), error));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    running_--;
+  }
+  results_cv_.notify_all();
 }
 
 Status Distributed::runQueries() {
-  while (getPendingQueryCount() > 0) {
-    auto request = popRequest();
-    LOG(INFO) << "Executing distributed query: " << request.id << ": "
-              << request.query;
-
-    // Keep track of the currently executing request
-    Distributed::setCurrentRequestId(request.id);
-
-    SQL sql(request.query);
-    const auto ok = sql.getStatus().ok();
-    const auto& msg = ok ? "" : sql.getMessageString();
-    if (!ok) {
-      LOG(ERROR) << "Error executing distributed query: " << request.id << ": "
-                 << msg;
+  auto workers = std::min<size_t>(
+      std::max<size_t>(FLAGS_distributed_concurrency, 1),
+      getPendingQueryCount());
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    running_ = workers;
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < workers; i++) {
+    threads.emplace_back(&Distributed::runPendingQueries, this);
+  }
+
+  // Write the completed results while the remaining queries execute.
+  auto last_flush = std::chrono::steady_clock::now();
+  bool flush_failed = false;
+  while (true) {
+    bool flush = false;
+    {
+      // After a failed write only the interval triggers the next attempt,
+      // the results kept for it would otherwise trigger it immediately.
+      std::unique_lock<std::mutex> lock(results_mutex_);
+      results_cv_.wait_for(lock, std::chrono::seconds(1), [&] {
+        return running_ == 0 ||
+               (!flush_failed &&
+                countRows(results_) >= FLAGS_distributed_flush_rows);
+      });
+      if (running_ == 0) {
+        break;
+      }
+
+      flush = !results_.empty() &&
+              ((!flush_failed &&
+                countRows(results_) >= FLAGS_distributed_flush_rows) ||
+               std::chrono::steady_clock::now() - last_flush >=
+                   kDistributedFlushInterval);
+    }
+
+    if (flush) {
+      // Failed writes keep their results, for the next attempt.
+      flush_failed = !flushCompleted().ok();
+      last_flush = std::chrono::steady_clock::now();
     }
-    DistributedQueryResult result(
-        request, sql.rows(), sql.columns(), sql.getStatus(), msg);
-    addResult(result);
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
   }
   return flushCompleted();
 }
@@ -148,18 +287,27 @@ Status Distributed::flushCompleted() {
     return Status(1, "Missing distributed plugin " + distributed_plugin);
   }
 
-  std::string results;
-  auto s = serializeResults(results);
-  if (!s.ok()) {
-    return s;
+  std::vector<DistributedQueryResult> completed;
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    completed.swap(results_);
   }
 
-  PluginResponse response;
-  s = Registry::call("distributed",
-                     {{"action", "writeResults"}, {"results", results}},
-                     response);
+  std::string results;
+  auto s = serializeCompleted(completed, results);
   if (s.ok()) {
-    results_.clear();
+    PluginResponse response;
+    s = Registry::call("distributed",
+                       {{"action", "writeResults"}, {"results", results}},
+                       response);
+  }
+
+  if (!s.ok()) {
+    // Keep the results, ahead of any completed while writing.
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    results_.insert(results_.begin(),
+                    std::make_move_iterator(completed.begin()),
+                    std::make_move_iterator(completed.end()));
   }
   return s;
 }
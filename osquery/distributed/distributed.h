@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -231,10 +233,17 @@ class Distributed {
   /// Serialize result data into a JSON string and clear the results
   Status serializeResults(std::string& json);
 
-  /// Process and execute queued queries
+  /**
+   * @brief Process and execute queued queries
+   *
+   * Up to distributed_concurrency queries run at once, each limited to
+   * distributed_query_timeout seconds. Results are written as queries
+   * complete, in chunks of at least distributed_flush_rows rows, or after
+   * they have waited a few seconds.
+   */
   Status runQueries();
 
-  // Getter for ID of currently executing request
+  // Getter for ID of the request executing on the calling thread
   static std::string getCurrentRequestId();
 
  protected:
@@ -256,6 +265,19 @@ class Distributed {
    */
   DistributedQueryRequest popRequest();
 
+  /**
+   * @brief Pop the next request while other threads may also be popping
+   *
+   * @return false if there are no pending requests
+   */
+  bool takeRequest(DistributedQueryRequest& request);
+
+  /// Execute a request, within the configured deadline
+  DistributedQueryResult runQuery(const DistributedQueryRequest& request);
+
+  /// Run queries until there are none pending, from a worker thread
+  void runPendingQueries();
+
   /**
    * @brief Queue a result to be batch sent to the server
    *
@@ -268,16 +290,29 @@ class Distributed {
    */
   Status flushCompleted();
 
-  // Setter for ID of currently executing request
+  // Setter for ID of the request executing on the calling thread
   static void setCurrentRequestId(const std::string& cReqId);
 
   std::vector<DistributedQueryResult> results_;
 
-  // ID of the currently executing query
-  static std::string currentRequestId_;
+  // ID of the query executing on each thread
+  static thread_local std::string currentRequestId_;
+
+ private:
+  /// Protects results_, and notifies about completed queries.
+  std::mutex results_mutex_;
+  std::condition_variable results_cv_;
+
+  /// Number of worker threads executing queries.
+  size_t running_{0};
+
+  /// Serializes popping requests from the database.
+  std::mutex requests_mutex_;
 
  private:
   friend class DistributedTests;
   FRIEND_TEST(DistributedTests, test_workflow);
+  FRIEND_TEST(DistributedTests, test_concurrent_workflow);
+  FRIEND_TEST(DistributedTests, test_query_timeout);
 };
 } // namespace osquery
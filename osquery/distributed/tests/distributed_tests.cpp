@@ -27,6 +27,9 @@ namespace osquery {
 
 DECLARE_string(distributed_tls_read_endpoint);
 DECLARE_string(distributed_tls_write_endpoint);
+DECLARE_uint64(distributed_concurrency);
+DECLARE_uint64(distributed_flush_rows);
+DECLARE_uint64(distributed_query_timeout);
 
 class DistributedTests : public testing::Test {
  protected:
@@ -206,4 +209,46 @@ TEST_F(DistributedTests, test_workflow) {
   EXPECT_EQ(dist.getPendingQueryCount(), 0U);
   EXPECT_EQ(dist.results_.size(), 0U);
 }
+
+TEST_F(DistributedTests, test_concurrent_workflow) {
+  ASSERT_TRUE(startServer());
+
+  auto concurrency = FLAGS_distributed_concurrency;
+  auto flush_rows = FLAGS_distributed_flush_rows;
+  // Run both queries at once, and write each result as it completes.
+  FLAGS_distributed_concurrency = 2;
+  FLAGS_distributed_flush_rows = 1;
+
+  auto dist = Distributed();
+  auto s = dist.pullUpdates();
+  ASSERT_TRUE(s.ok()) << s.getMessage();
+  EXPECT_EQ(dist.getPendingQueryCount(), 2U);
+
+  s = dist.runQueries();
+  EXPECT_TRUE(s.ok()) << s.getMessage();
+  EXPECT_EQ(dist.getPendingQueryCount(), 0U);
+  EXPECT_EQ(dist.results_.size(), 0U);
+
+  FLAGS_distributed_concurrency = concurrency;
+  FLAGS_distributed_flush_rows = flush_rows;
+}
+
+TEST_F(DistributedTests, test_query_timeout) {
+  auto timeout = FLAGS_distributed_query_timeout;
+  FLAGS_distributed_query_timeout = 1;
+
+  DistributedQueryRequest request;
+  request.id = "endless";
+  request.query =
+      "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c) "
+      "SELECT count(*) FROM c";
+
+  auto dist = Distributed();
+  auto result = dist.runQuery(request);
+  EXPECT_FALSE(result.status.ok());
+  EXPECT_EQ(result.message, "Query did not complete within 1 seconds");
+  EXPECT_EQ(result.request.id, "endless");
+
+  FLAGS_distributed_query_timeout = timeout;
+}
 } // namespace osquery
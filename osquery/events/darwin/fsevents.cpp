@@ -197,25 +197,8 @@ std::set<std::string> FSEventsEventPublisher::transformSubscription(
 }
 
 void FSEventsEventPublisher::buildExcludePathsSet() {
-  auto parser = Config::getParser("file_paths");
-
-  WriteLock lock(subscription_lock_);
   exclude_paths_.clear();
-
-  const auto& doc = parser->getData();
-  if (!doc.doc().HasMember("exclude_paths")) {
-    return;
-  }
-
-  for (const auto& category : doc.doc()["exclude_paths"].GetObject()) {
-    for (const auto& excl_path : category.value.GetArray()) {
-      std::string pattern = excl_path.GetString();
-      if (pattern.empty()) {
-        continue;
-      }
-      exclude_paths_.insert(pattern);
-    }
-  }
+  exclude_paths_.addConfigExcludePaths();
 }
 
 void FSEventsEventPublisher::configure() {
@@ -346,11 +329,7 @@ bool FSEventsEventPublisher::shouldFire(
     return false;
   }
 
-  auto path = ec->path.substr(0, ec->path.rfind('/'));
-  // Need to have two finds,
-  // what if somebody excluded an individual file inside a directory
-  if (!exclude_paths_.empty() &&
-      (exclude_paths_.find(path) || exclude_paths_.find(ec->path))) {
+  if (exclude_paths_.isExcluded(ec->path)) {
     return false;
   }
 
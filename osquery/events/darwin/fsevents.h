@@ -20,7 +20,7 @@
 #include <osquery/events/eventpublisher.h>
 #include <osquery/utils/status/status.h>
 
-#include "osquery/events/pathset.h"
+#include "osquery/events/pathmatcher.h"
 
 namespace osquery {
 
@@ -78,8 +78,6 @@ using FSEventsEventContextRef = std::shared_ptr<FSEventsEventContext>;
 using FSEventsSubscriptionContextRef =
     std::shared_ptr<FSEventsSubscriptionContext>;
 
-using ExcludePathSet = PathSet<patternedPath>;
-
 /**
  * @brief An osquery EventPublisher for the Apple FSEvents notification API.
  *
@@ -164,7 +162,7 @@ class FSEventsEventPublisher
   std::set<std::string> paths_;
 
   /// Events pertaining to these paths not to be propagated.
-  ExcludePathSet exclude_paths_;
+  FilePathMatcher exclude_paths_;
 
   /// Reference to the run loop for this thread.
   CFRunLoopRef run_loop_{nullptr};
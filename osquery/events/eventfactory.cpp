@@ -86,6 +86,7 @@ Status EventFactory::registerEventSubscriber(const PluginRef& sub) {
   }
 
   if (base_sub->state() != EventState::EVENT_NONE) {
+    base_sub->flushCoalescedRows();
     base_sub->tearDown();
   }
 
@@ -176,6 +177,8 @@ Status EventFactory::deregisterEventSubscriber(const std::string& sub) {
   auto subscriber = subscriber_it->second;
   ef.event_subs_.erase(subscriber_it);
 
+  // Store the rows held back by the coalescing window before stopping.
+  subscriber->flushCoalescedRows();
   subscriber->tearDown();
   subscriber->state(EventState::EVENT_NONE);
 
@@ -465,6 +468,9 @@ void EventFactory::end(bool join) {
 
     // Threads may still be executing, when they finish, release publishers.
     ef.event_pubs_.clear();
+    for (const auto& subscriber : ef.event_subs_) {
+      subscriber.second->flushCoalescedRows();
+    }
     ef.event_subs_.clear();
   }
 }
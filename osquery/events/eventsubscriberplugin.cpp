@@ -7,6 +7,8 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <chrono>
+
 #include <osquery/config/config.h>
 #include <osquery/core/flags.h>
 #include <osquery/database/database.h>
@@ -26,6 +28,20 @@ namespace {
 /// Checkpoint interval to inspect max event buffering.
 const EventContextID kEventsCheckpoint{256U};
 
+/// Maximum number of distinct rows held back by a coalescing window.
+const std::size_t kMaxCoalescedRows{4096U};
+
+/// The columns identifying duplicate events, 'path' or 'target_path' required.
+const std::vector<std::string> kCoalesceColumns = {
+    "path", "target_path", "action", "pid"};
+
+std::uint64_t getMonotonicTimeMs() {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
 void removeDeprecatedEventKeysOnceHelper() {
   std::vector<std::string> key_list;
   auto status = scanDatabaseKeys(kEvents, key_list);
@@ -110,6 +126,58 @@ Status EventSubscriberPlugin::addBatch(std::vector<Row>& row_list) {
 
 Status EventSubscriberPlugin::addBatch(std::vector<Row>& row_list,
                                        EventTime custom_event_time) {
+  auto event_time = custom_event_time != 0 ? custom_event_time : getTime();
+
+  auto window = getCoalesceWindow();
+  if (window == 0) {
+    // The window may have been disabled while rows were held back.
+    flushCoalescedRows();
+    return storeBatch(row_list, event_time);
+  }
+
+  // Hold back bursts of identical events, only store the merged rows.
+  std::vector<EventTime> time_list;
+  coalesceRows(
+      context, row_list, time_list, event_time, window, getMonotonicTimeMs());
+  if (row_list.empty()) {
+    return Status::success();
+  }
+  return storeBatch(row_list, time_list);
+}
+
+void EventSubscriberPlugin::flushCoalescedRows() {
+  std::vector<Row> row_list;
+  std::vector<EventTime> time_list;
+  flushCoalescedRows(context, row_list, time_list);
+  if (!row_list.empty()) {
+    storeBatch(row_list, time_list);
+  }
+}
+
+Status EventSubscriberPlugin::storeBatch(
+    std::vector<Row>& row_list, const std::vector<EventTime>& time_list) {
+  // Rows are indexed by event time, store each run of equal times together.
+  Status status;
+  std::vector<Row> batch;
+  for (size_t begin = 0; begin < row_list.size();) {
+    auto end = begin + 1;
+    while (end < row_list.size() && time_list[end] == time_list[begin]) {
+      end++;
+    }
+
+    batch.assign(std::make_move_iterator(row_list.begin() + begin),
+                 std::make_move_iterator(row_list.begin() + end));
+    auto s = storeBatch(batch, time_list[begin]);
+    if (!s.ok()) {
+      status = s;
+    }
+    begin = end;
+  }
+  return status;
+}
+
+Status EventSubscriberPlugin::storeBatch(std::vector<Row>& row_list,
+                                         EventTime event_time) {
   removeDeprecatedEventKeysOnce();
 
   DatabaseStringValueList database_data;
@@ -118,7 +186,6 @@ Status EventSubscriberPlugin::addBatch(std::vector<Row>& row_list,
   EventIDList event_id_list;
   event_id_list.reserve(row_list.size());
 
-  auto event_time = custom_event_time != 0 ? custom_event_time : getTime();
   auto string_event_time = std::to_string(event_time);
 
   for (auto& row : row_list) {
@@ -210,6 +277,10 @@ size_t EventSubscriberPlugin::getEventBatchesMax() {
   return FLAGS_events_max;
 }
 
+size_t EventSubscriberPlugin::getCoalesceWindow() {
+  return 0;
+}
+
 bool EventSubscriberPlugin::shouldOptimize() const {
   return isDaemon() && FLAGS_events_optimize;
 }
@@ -314,6 +385,9 @@ void EventSubscriberPlugin::genTable(RowYield& yield, QueryContext& context) {
     }
   }
 
+  // Rows within a coalescing window are stored so the query includes them.
+  flushCoalescedRows();
+
   auto generateRowsCallback = [&yield](Row row) {
     yield(TableRowHolder(new DynamicTableRow(std::move(row))));
   };
@@ -582,6 +656,94 @@ void EventSubscriberPlugin::removeOverflowingEventBatches(
   LOG(WARNING) << message.str();
 }
 
+std::string EventSubscriberPlugin::coalesceKey(const Row& row) {
+  if (row.count("path") == 0 && row.count("target_path") == 0) {
+    return std::string();
+  }
+
+  std::string key;
+  for (const auto& column : kCoalesceColumns) {
+    auto it = row.find(column);
+    if (it != row.end()) {
+      key += it->second;
+    }
+    key.push_back('\0');
+  }
+  return key;
+}
+
+void EventSubscriberPlugin::coalesceRows(Context& context,
+                                         std::vector<Row>& row_list,
+                                         std::vector<EventTime>& time_list,
+                                         EventTime event_time,
+                                         std::uint64_t window,
+                                         std::uint64_t current_time) {
+  std::vector<Row> ready_list;
+  time_list.clear();
+
+  WriteLock lock(context.coalesce_mutex);
+  auto release_oldest = [&context, &ready_list, &time_list]() {
+    const auto& key = context.coalesced_order.front().second;
+    auto it = context.coalesced_rows.find(key);
+    it->second.row["count"] = std::to_string(it->second.count);
+    ready_list.push_back(std::move(it->second.row));
+    time_list.push_back(it->second.time);
+
+    context.coalesced_rows.erase(it);
+    context.coalesced_order.pop_front();
+  };
+
+  // Release the rows whose coalescing window has elapsed.
+  while (!context.coalesced_order.empty() &&
+         context.coalesced_order.front().first + window <= current_time) {
+    release_oldest();
+  }
+
+  for (auto& row : row_list) {
+    auto key = coalesceKey(row);
+    if (key.empty()) {
+      row["count"] = "1";
+      ready_list.push_back(std::move(row));
+      time_list.push_back(event_time);
+      continue;
+    }
+
+    auto it = context.coalesced_rows.find(key);
+    if (it != context.coalesced_rows.end()) {
+      // Keep the most recent values, for example the hash after the burst.
+      it->second.row = std::move(row);
+      it->second.count++;
+      continue;
+    }
+
+    if (context.coalesced_rows.size() >= kMaxCoalescedRows) {
+      release_oldest();
+    }
+
+    context.coalesced_order.emplace_back(current_time, key);
+    context.coalesced_rows.emplace(
+        std::move(key), CoalescedRow{std::move(row), 1U, event_time});
+  }
+
+  row_list = std::move(ready_list);
+}
+
+void EventSubscriberPlugin::flushCoalescedRows(
+    Context& context,
+    std::vector<Row>& row_list,
+    std::vector<EventTime>& time_list) {
+  WriteLock lock(context.coalesce_mutex);
+  for (const auto& entry : context.coalesced_order) {
+    auto& coalesced_row = context.coalesced_rows.at(entry.second);
+    coalesced_row.row["count"] = std::to_string(coalesced_row.count);
+    row_list.push_back(std::move(coalesced_row.row));
+    time_list.push_back(coalesced_row.time);
+  }
+
+  context.coalesced_rows.clear();
+  context.coalesced_order.clear();
+}
+
 void EventSubscriberPlugin::expireEventBatches(Context& context,
                                                IDatabaseInterface& db_interface,
                                                std::size_t events_expiry,
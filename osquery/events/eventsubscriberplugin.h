@@ -9,6 +9,9 @@
 
 #pragma once
 
+#include <deque>
+#include <unordered_map>
+
 #include <gtest/gtest_prod.h>
 
 #include <osquery/core/plugins/plugin.h>
@@ -71,6 +74,16 @@ class EventSubscriberPlugin : public Plugin, public Eventer {
   virtual Status addBatch(std::vector<Row>& row_list,
                           EventTime custom_event_time) final;
 
+  /// Serialize, index, and store rows that passed the coalescing stage.
+  Status storeBatch(std::vector<Row>& row_list, EventTime event_time);
+
+  /// Store rows that each have their own event time, see coalesceRows.
+  Status storeBatch(std::vector<Row>& row_list,
+                    const std::vector<EventTime>& time_list);
+
+  /// Store every row held back by the coalescing window.
+  void flushCoalescedRows();
+
   /// Scans the database to enumerate all the data keys and build a new index
   Status generateEventDataIndex();
 
@@ -111,6 +124,17 @@ class EventSubscriberPlugin : public Plugin, public Eventer {
    */
   virtual size_t getEventBatchesMax();
 
+  /**
+   * @brief Get the coalescing window, in milliseconds, for this event type
+   *
+   * Identical (path, action, pid) events added within the window are merged
+   * into a single row with a 'count' column before they are stored. The
+   * default implementation returns 0, which disables coalescing.
+   *
+   * @return The coalescing window in milliseconds
+   */
+  virtual size_t getCoalesceWindow();
+
   /// Determine if the subscriber should attempt optmization.
   virtual bool shouldOptimize() const;
 
@@ -181,6 +205,15 @@ class EventSubscriberPlugin : public Plugin, public Eventer {
   /// Compare the number of queries run against the queries configured.
   virtual bool executedAllQueries() const;
 
+  /// A row held back by the coalescing window and its number of duplicates.
+  struct CoalescedRow final {
+    Row row;
+    std::size_t count{0U};
+
+    /// The event time of the first duplicate, the row is stored with it.
+    EventTime time{0U};
+  };
+
   struct Context final {
     std::string database_namespace;
     EventIndex event_index;
@@ -188,6 +221,13 @@ class EventSubscriberPlugin : public Plugin, public Eventer {
 
     std::size_t last_query_time{0U};
     std::atomic<EventID> last_event_id{0U};
+
+    /// Rows within their coalescing window, keyed by coalesceKey.
+    std::unordered_map<std::string, CoalescedRow> coalesced_rows;
+
+    /// The coalesced row keys and the time they were first seen, oldest first.
+    std::deque<std::pair<std::uint64_t, std::string>> coalesced_order;
+    Mutex coalesce_mutex;
   };
 
   static std::string toIndex(std::uint64_t i);
@@ -218,6 +258,40 @@ class EventSubscriberPlugin : public Plugin, public Eventer {
                                             IDatabaseInterface& db_interface,
                                             std::size_t max_event_batches);
 
+  /**
+   * @brief Build the (path, action, pid) identity of an event row.
+   *
+   * @return An empty string if the row does not describe a path.
+   */
+  static std::string coalesceKey(const Row& row);
+
+  /**
+   * @brief Merge identical rows that are added within a coalescing window.
+   *
+   * New rows are held in the context until their window elapses, duplicates
+   * increment the held row's count and replace its values with the most
+   * recent ones. On return row_list contains the rows ready to be stored,
+   * each with a 'count' column, and time_list the event time of each.
+   *
+   * @param context The subscriber context.
+   * @param row_list The added rows, replaced by the rows to store.
+   * @param time_list The event time of each row to store.
+   * @param event_time The event time of the added rows.
+   * @param window The coalescing window in milliseconds.
+   * @param current_time A monotonic time in milliseconds.
+   */
+  static void coalesceRows(Context& context,
+                           std::vector<Row>& row_list,
+                           std::vector<EventTime>& time_list,
+                           EventTime event_time,
+                           std::uint64_t window,
+                           std::uint64_t current_time);
+
+  /// Release every held row, regardless of its window, into row_list.
+  static void flushCoalescedRows(Context& context,
+                                 std::vector<Row>& row_list,
+                                 std::vector<EventTime>& time_list);
+
   static void expireEventBatches(Context& context,
                                  IDatabaseInterface& db_interface,
                                  std::size_t events_expiry,
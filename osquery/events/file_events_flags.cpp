@@ -13,4 +13,16 @@ namespace osquery {
 
 FLAG(bool, enable_file_events, false, "Enables the file_events publisher");
 
+/// On Linux, use filesystem-wide fanotify marks instead of inotify watches.
+FLAG(bool,
+     enable_file_events_fanotify,
+     false,
+     "Use the fanotify publisher for file_events (Linux 5.9+)");
+
+/// Merge bursts of identical file_events rows before they are stored.
+FLAG(uint64,
+     file_events_coalesce_window,
+     0,
+     "Merge identical file_events within this many milliseconds (0 disables)");
+
 } // namespace osquery
@@ -0,0 +1,619 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/limits.h>
+#include <poll.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <osquery/config/config.h>
+#include <osquery/core/flags.h>
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/logger/logger.h>
+#include <osquery/registry/registry_factory.h>
+#include <osquery/utils/system/time.h>
+
+#include "osquery/events/linux/fanotify.h"
+
+namespace fs = boost::filesystem;
+
+// Older kernel headers do not define the file handle reporting API.
+#ifndef FAN_REPORT_DIR_FID
+#define FAN_REPORT_DIR_FID 0x00000400
+#endif
+
+#ifndef FAN_REPORT_NAME
+#define FAN_REPORT_NAME 0x00000800
+#endif
+
+#ifndef FAN_MARK_FILESYSTEM
+#define FAN_MARK_FILESYSTEM 0x00000100
+#endif
+
+#ifndef FAN_ATTRIB
+#define FAN_ATTRIB 0x00000004
+#endif
+
+#ifndef FAN_MOVED_FROM
+#define FAN_MOVED_FROM 0x00000040
+#define FAN_MOVED_TO 0x00000080
+#define FAN_CREATE 0x00000100
+#define FAN_DELETE 0x00000200
+#define FAN_DELETE_SELF 0x00000400
+#define FAN_MOVE_SELF 0x00000800
+#endif
+
+#ifndef FAN_EVENT_INFO_TYPE_FID
+#define FAN_EVENT_INFO_TYPE_FID 1
+#define FAN_EVENT_INFO_TYPE_DFID_NAME 2
+#define FAN_EVENT_INFO_TYPE_DFID 3
+#endif
+
+namespace osquery {
+
+DECLARE_bool(enable_file_events);
+DECLARE_bool(enable_file_events_fanotify);
+
+namespace {
+
+/// Mirrors struct fanotify_event_info_header.
+struct FanotifyInfoHeader {
+  uint8_t info_type;
+  uint8_t pad;
+  uint16_t len;
+};
+
+/// Mirrors struct fanotify_event_info_fid, followed by a struct file_handle.
+struct FanotifyInfoFid {
+  FanotifyInfoHeader hdr;
+  int32_t fsid[2];
+};
+
+const size_t kFanotifyBufferSize = 64 * 1024;
+
+/// Stop caching directory handles past this many entries.
+const size_t kFanotifyMaxCachedDirectories = 4096;
+
+/// Set while a publisher holds an initialized fanotify group.
+std::atomic<bool> kFanotifyInitialized{false};
+
+/// Mount marks cannot report directory entry or attribute events.
+const uint64_t kFanotifyMountMasks =
+    FAN_ACCESS | FAN_MODIFY | FAN_CLOSE_WRITE | FAN_OPEN;
+
+/// Directory events that invalidate cached directory paths.
+const uint64_t kFanotifyDirectoryChangeMasks = FAN_MOVED_FROM | FAN_MOVED_TO |
+                                               FAN_DELETE | FAN_DELETE_SELF |
+                                               FAN_MOVE_SELF;
+
+/// Resolve the literal leading directories of a pattern through symlinks.
+std::string canonicalPattern(const std::string& pattern) {
+  auto glob = pattern.find_first_of("*?");
+  auto split = (glob == std::string::npos) ? pattern.size()
+                                           : pattern.rfind('/', glob) + 1;
+  auto prefix = pattern.substr(0, split);
+  auto remainder = pattern.substr(split);
+
+  boost::system::error_code ec;
+  auto canonical = fs::weakly_canonical(prefix, ec).string();
+  if (ec || canonical.empty()) {
+    return pattern;
+  }
+
+  if (prefix.back() == '/' && canonical.back() != '/') {
+    canonical += '/';
+  }
+  return canonical + remainder;
+}
+
+/// Find the nearest existing directory for a pattern's literal prefix.
+bool existingRoot(const std::string& pattern, std::string& root, dev_t& dev) {
+  fs::path path(PathTrie<INotifySubscriptionContextRef>::literalPrefix(pattern));
+  while (!path.empty()) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+      root = path.string();
+      dev = st.st_dev;
+      return true;
+    }
+    if (path == path.root_path()) {
+      break;
+    }
+    path = path.parent_path();
+  }
+  return false;
+}
+
+} // namespace
+
+REGISTER(FanotifyEventPublisher, "event_publisher", "fanotify");
+
+Status FanotifyEventPublisher::setUp() {
+  if (!FLAGS_enable_file_events || !FLAGS_enable_file_events_fanotify) {
+    return Status(1, "Publisher disabled via configuration");
+  }
+
+  fanotify_handle_ = ::fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC |
+                                         FAN_NONBLOCK | FAN_REPORT_DIR_FID |
+                                         FAN_REPORT_NAME,
+                                     O_RDONLY | O_LARGEFILE);
+  if (fanotify_handle_ == -1) {
+    return Status(1,
+                  "Could not start fanotify: fanotify_init failed: " +
+                      std::string(std::strerror(errno)));
+  }
+
+  WriteLock lock(scratch_mutex_);
+  scratch_ = (char*)malloc(kFanotifyBufferSize);
+  if (scratch_ == nullptr) {
+    return Status(1, "Could not allocate scratch space");
+  }
+
+  kFanotifyInitialized = true;
+  return Status::success();
+}
+
+bool FanotifyEventPublisher::initialized() {
+  return kFanotifyInitialized;
+}
+
+void FanotifyEventPublisher::buildExcludePathsSet() {
+  exclude_paths_.clear();
+  exclude_paths_.addConfigExcludePaths();
+}
+
+void FanotifyEventPublisher::configure() {
+  if (!FLAGS_enable_file_events || !FLAGS_enable_file_events_fanotify) {
+    return;
+  }
+
+  if (fanotify_handle_ == -1) {
+    // This publisher has not been setup correctly.
+    return;
+  }
+
+  {
+    WriteLock lock(subscription_lock_);
+    auto end = std::remove_if(
+        subscriptions_.begin(),
+        subscriptions_.end(),
+        [](const SubscriptionRef& subscription) {
+          return getSubscriptionContext(subscription->context)
+              ->mark_for_deletion;
+        });
+    subscriptions_.erase(end, subscriptions_.end());
+  }
+
+  buildExcludePathsSet();
+
+  WriteLock lock(path_mutex_);
+  paths_.clear();
+  directory_cache_.clear();
+
+  std::map<dev_t, std::string> roots;
+  uint64_t mask = 0;
+  {
+    ReadLock subscription_lock(subscription_lock_);
+    for (const auto& sub : subscriptions_) {
+      auto sc = getSubscriptionContext(sub->context);
+
+      auto pattern = canonicalPattern(sc->path);
+      if (pattern.find('*') == std::string::npos && pattern.back() != '/' &&
+          isDirectory(pattern).ok()) {
+        // A directory is watched along with its direct children.
+        pattern += '/';
+      }
+      paths_.insert(pattern, sc);
+      mask |= (sc->mask == 0) ? kFileDefaultMasks : sc->mask;
+
+      std::string root;
+      dev_t dev;
+      if (existingRoot(pattern, root, dev)) {
+        roots.emplace(dev, root);
+      } else {
+        LOG(WARNING) << "Could not find a filesystem to mark for: "
+                     << sc->path;
+      }
+    }
+  }
+
+  updateMarks(roots, mask);
+}
+
+void FanotifyEventPublisher::updateMarks(
+    const std::map<dev_t, std::string>& roots, uint64_t mask) {
+  for (auto it = marks_.begin(); it != marks_.end();) {
+    if (roots.count(it->first) == 0) {
+      removeMark(it->second);
+      it = marks_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (const auto& root : roots) {
+    auto& mark = marks_[root.first];
+    if (mark.mount_fd != -1 && mark.mask == mask) {
+      continue;
+    }
+
+    if (!addMark(root.second, mask, mark)) {
+      marks_.erase(root.first);
+    }
+  }
+}
+
+bool FanotifyEventPublisher::addMark(const std::string& path,
+                                     uint64_t mask,
+                                     FanotifyMark& mark) {
+  if (mark.mount_fd == -1) {
+    mark.mount_fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mark.mount_fd == -1) {
+      LOG(WARNING) << "Could not open fanotify mark path: " << path;
+      return false;
+    }
+    mark.path = path;
+
+    struct statfs st;
+    if (::fstatfs(mark.mount_fd, &st) == 0) {
+      FanotifyFsid fsid{st.f_fsid.__val[0], st.f_fsid.__val[1]};
+      fsid_mounts_[fsid] = mark.mount_fd;
+    }
+  } else if ((mark.mask & ~mask) != 0) {
+    // Drop event types that are no longer requested by any subscription.
+    auto applied = (mark.type == FAN_MARK_MOUNT) ? kFanotifyMountMasks : ~0ULL;
+    ::fanotify_mark(fanotify_handle_,
+                    FAN_MARK_REMOVE | mark.type,
+                    (mark.mask & ~mask) & applied,
+                    mark.mount_fd,
+                    nullptr);
+  }
+
+  if (mark.type != FAN_MARK_MOUNT) {
+    if (::fanotify_mark(fanotify_handle_,
+                        FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                        mask | FAN_ONDIR,
+                        mark.mount_fd,
+                        nullptr) == 0) {
+      mark.type = FAN_MARK_FILESYSTEM;
+      mark.mask = mask;
+      return true;
+    }
+    VLOG(1) << "Could not add a fanotify filesystem mark on " << path << " ("
+            << std::strerror(errno) << "), falling back to a mount mark";
+  }
+
+  if (::fanotify_mark(fanotify_handle_,
+                      FAN_MARK_ADD | FAN_MARK_MOUNT,
+                      mask & kFanotifyMountMasks,
+                      mark.mount_fd,
+                      nullptr) == 0) {
+    mark.type = FAN_MARK_MOUNT;
+    mark.mask = mask;
+    if (!mount_mark_reported_) {
+      LOG(WARNING) << "fanotify uses a mount mark on " << path
+                   << ": file creations, deletions, moves and attribute "
+                      "changes are not reported for its filesystem";
+      mount_mark_reported_ = true;
+    }
+    return true;
+  }
+
+  LOG(WARNING) << "Could not add fanotify mark on: " << path;
+  removeMark(mark);
+  return false;
+}
+
+void FanotifyEventPublisher::removeMark(FanotifyMark& mark) {
+  if (mark.mount_fd == -1) {
+    return;
+  }
+
+  if (mark.type != 0) {
+    ::fanotify_mark(fanotify_handle_,
+                    FAN_MARK_REMOVE | mark.type,
+                    (mark.type == FAN_MARK_MOUNT)
+                        ? (mark.mask & kFanotifyMountMasks)
+                        : (mark.mask | FAN_ONDIR),
+                    mark.mount_fd,
+                    nullptr);
+  }
+
+  for (auto it = fsid_mounts_.begin(); it != fsid_mounts_.end();) {
+    if (it->second == mark.mount_fd) {
+      it = fsid_mounts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  ::close(mark.mount_fd);
+  mark.mount_fd = -1;
+  mark.type = 0;
+  mark.mask = 0;
+}
+
+void FanotifyEventPublisher::tearDown() {
+  if (!FLAGS_enable_file_events || !FLAGS_enable_file_events_fanotify) {
+    return;
+  }
+
+  {
+    WriteLock lock(path_mutex_);
+    for (auto& mark : marks_) {
+      removeMark(mark.second);
+    }
+    marks_.clear();
+    fsid_mounts_.clear();
+    directory_cache_.clear();
+  }
+
+  if (fanotify_handle_ > -1) {
+    ::close(fanotify_handle_);
+    kFanotifyInitialized = false;
+  }
+  fanotify_handle_ = -1;
+
+  WriteLock lock(scratch_mutex_);
+  if (scratch_ != nullptr) {
+    free(scratch_);
+    scratch_ = nullptr;
+  }
+}
+
+void FanotifyEventPublisher::handleOverflow() {
+  if (last_overflow_ != -1 && getUnixTime() - last_overflow_ < 60) {
+    return;
+  }
+  VLOG(1) << "fanotify was overflown";
+  last_overflow_ = getUnixTime();
+}
+
+Status FanotifyEventPublisher::run() {
+  if (!FLAGS_enable_file_events || !FLAGS_enable_file_events_fanotify) {
+    return Status(1, "Publisher disabled via configuration");
+  }
+
+  struct pollfd fds[1];
+  fds[0].fd = fanotify_handle_;
+  fds[0].events = POLLIN;
+  int selector = ::poll(fds, 1, 1000);
+  if (selector == -1) {
+    if (errno == EINTR) {
+      return Status::success();
+    }
+    LOG(WARNING) << "Could not read fanotify handle";
+    return Status(1, "fanotify poll failed");
+  }
+
+  if (selector == 0 || !(fds[0].revents & POLLIN)) {
+    return Status::success();
+  }
+
+  WriteLock lock(scratch_mutex_);
+  ssize_t length = ::read(fanotify_handle_, scratch_, kFanotifyBufferSize);
+  if (length == -1 && (errno == EAGAIN || errno == EINTR)) {
+    return Status::success();
+  }
+
+  if (length <= 0) {
+    return Status(1, "fanotify read failed");
+  }
+
+  auto metadata = reinterpret_cast<struct fanotify_event_metadata*>(scratch_);
+  for (; FAN_EVENT_OK(metadata, length);
+       metadata = FAN_EVENT_NEXT(metadata, length)) {
+    if (metadata->vers != FANOTIFY_METADATA_VERSION) {
+      return Status(1, "Unsupported fanotify metadata version");
+    }
+
+    if (metadata->fd >= 0) {
+      // File handle reporting should never open descriptors.
+      ::close(metadata->fd);
+    }
+
+    if (metadata->mask & FAN_Q_OVERFLOW) {
+      handleOverflow();
+      continue;
+    }
+
+    handleEvent(reinterpret_cast<const char*>(metadata), metadata->event_len);
+  }
+
+  return Status::success();
+}
+
+bool FanotifyEventPublisher::resolvePath(const char* info, std::string& path) {
+  auto fid = reinterpret_cast<const FanotifyInfoFid*>(info);
+  auto handle =
+      reinterpret_cast<const struct file_handle*>(info + sizeof(*fid));
+
+  // The fsid and opaque handle identify the directory.
+  std::string key(reinterpret_cast<const char*>(fid->fsid),
+                  sizeof(fid->fsid));
+  key.append(reinterpret_cast<const char*>(handle),
+             sizeof(*handle) + handle->handle_bytes);
+
+  auto cached = directory_cache_.find(key);
+  if (cached != directory_cache_.end()) {
+    path = cached->second;
+  } else {
+    auto mount = fsid_mounts_.find({fid->fsid[0], fid->fsid[1]});
+    if (mount == fsid_mounts_.end()) {
+      return false;
+    }
+
+    // Opening by handle requires CAP_DAC_READ_SEARCH.
+    int fd = ::open_by_handle_at(mount->second,
+                                 const_cast<struct file_handle*>(handle),
+                                 O_PATH | O_CLOEXEC);
+    if (fd == -1) {
+      // The directory was removed before the event was read.
+      return false;
+    }
+
+    char buffer[PATH_MAX];
+    auto proc_fd = "/proc/self/fd/" + std::to_string(fd);
+    auto size = ::readlink(proc_fd.c_str(), buffer, sizeof(buffer) - 1);
+    ::close(fd);
+    if (size <= 0) {
+      return false;
+    }
+    path.assign(buffer, size);
+
+    if (directory_cache_.size() >= kFanotifyMaxCachedDirectories) {
+      directory_cache_.clear();
+    }
+    directory_cache_[key] = path;
+  }
+
+  if (fid->hdr.info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) {
+    const char* name =
+        reinterpret_cast<const char*>(handle->f_handle) + handle->handle_bytes;
+    if (std::strcmp(name, ".") != 0) {
+      if (path.back() != '/') {
+        path += '/';
+      }
+      path += name;
+    }
+  }
+  return true;
+}
+
+void FanotifyEventPublisher::handleEvent(const char* event, size_t length) {
+  auto metadata = reinterpret_cast<const struct fanotify_event_metadata*>(event);
+
+  // Prefer the directory handle with an entry name, it names the target.
+  const char* info = nullptr;
+  for (size_t offset = metadata->metadata_len;
+       offset + sizeof(FanotifyInfoHeader) <= length;) {
+    auto header = reinterpret_cast<const FanotifyInfoHeader*>(event + offset);
+    if (header->len == 0) {
+      break;
+    }
+
+    if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) {
+      info = event + offset;
+      break;
+    } else if (header->info_type == FAN_EVENT_INFO_TYPE_DFID ||
+               header->info_type == FAN_EVENT_INFO_TYPE_FID) {
+      info = event + offset;
+    }
+    offset += header->len;
+  }
+
+  if (info == nullptr) {
+    return;
+  }
+
+  std::string path;
+  std::vector<INotifySubscriptionContextRef> matches;
+  {
+    WriteLock lock(path_mutex_);
+    if (!resolvePath(info, path)) {
+      return;
+    }
+
+    if ((metadata->mask & FAN_ONDIR) &&
+        (metadata->mask & kFanotifyDirectoryChangeMasks)) {
+      // A directory was renamed or removed, cached paths may be stale.
+      directory_cache_.clear();
+    }
+
+    matches = paths_.match(path);
+  }
+
+  if (matches.empty() || exclude_paths_.isExcluded(path)) {
+    return;
+  }
+
+  // The fanotify event bits match their inotify counterparts, including
+  // FAN_ONDIR and IN_ISDIR, so subscribers can treat both publishers alike.
+  std::string action;
+  for (const auto& bit : kMaskActions) {
+    if (metadata->mask & bit.first) {
+      action = bit.second;
+      break;
+    }
+  }
+
+  if (action.empty()) {
+    return;
+  }
+
+  for (const auto& sc : matches) {
+    auto ec = createEventContext();
+    ec->event = std::make_unique<struct inotify_event>();
+    ec->event->wd = -1;
+    ec->event->mask = static_cast<uint32_t>(metadata->mask);
+    ec->event->cookie = 0;
+    ec->event->len = 0;
+    ec->path = path;
+    ec->action = action;
+    ec->isub_ctx = sc;
+    fire(ec);
+  }
+}
+
+bool FanotifyEventPublisher::shouldFire(
+    const INotifySubscriptionContextRef& sc,
+    const INotifyEventContextRef& ec) const {
+  if (sc.get() != ec->isub_ctx.get()) {
+    /// Not my event.
+    return false;
+  }
+
+  // The subscription may supply a required event mask.
+  if (sc->mask != 0 && !(ec->event->mask & sc->mask)) {
+    return false;
+  }
+
+  return true;
+}
+
+void FanotifyEventPublisher::removeSubscriptions(
+    const std::string& subscriber) {
+  WriteLock lock(subscription_lock_);
+  std::for_each(subscriptions_.begin(),
+                subscriptions_.end(),
+                [&subscriber](const SubscriptionRef& sub) {
+                  if (sub->subscriber_name == subscriber) {
+                    getSubscriptionContext(sub->context)->mark_for_deletion =
+                        true;
+                  }
+                });
+}
+
+Status FanotifyEventPublisher::addSubscription(
+    const SubscriptionRef& subscription) {
+  WriteLock lock(subscription_lock_);
+  auto received_sc = getSubscriptionContext(subscription->context);
+  for (auto& sub : subscriptions_) {
+    auto sc = getSubscriptionContext(sub->context);
+    if (*received_sc == *sc) {
+      if (sc->mark_for_deletion) {
+        sc->mark_for_deletion = false;
+        return Status(0);
+      }
+      // Returning non zero signals EventSubscriber::subscribe
+      // do not bump up subscription_count_.
+      return Status(1);
+    }
+  }
+
+  subscriptions_.push_back(subscription);
+  return Status(0);
+}
+} // namespace osquery
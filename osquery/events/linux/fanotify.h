@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include <sys/stat.h>
+
+#include <osquery/events/eventpublisher.h>
+#include <osquery/events/linux/inotify.h>
+#include <osquery/events/pathmatcher.h>
+#include <osquery/events/pathtrie.h>
+#include <osquery/utils/mutex.h>
+
+namespace osquery {
+
+/// The statfs f_fsid of a marked filesystem, reported with every event.
+using FanotifyFsid = std::pair<int, int>;
+
+/// A filesystem-wide (or mount-wide) fanotify mark.
+struct FanotifyMark {
+  /// Directory descriptor on the marked filesystem, used to open handles.
+  int mount_fd{-1};
+
+  /// The path the mark was placed through.
+  std::string path;
+
+  /// Either FAN_MARK_FILESYSTEM or FAN_MARK_MOUNT.
+  unsigned int type{0};
+
+  /// The event mask requested by subscriptions.
+  uint64_t mask{0};
+};
+
+/**
+ * @brief A Linux `fanotify` EventPublisher for file_events.
+ *
+ * Instead of one inotify watch per directory this publisher places a single
+ * FAN_MARK_FILESYSTEM mark (or FAN_MARK_MOUNT, when the filesystem does not
+ * support filesystem marks) for each filesystem containing a configured path.
+ * Events are reported with directory file handles and entry names
+ * (FAN_REPORT_DFID_NAME), resolved to paths, and filtered in userspace by a
+ * PathTrie compiled from the subscriptions.
+ *
+ * This shares INotifySubscriptionContext and INotifyEventContext with the
+ * inotify publisher so the file_events subscriber can use either one.
+ * Requires CAP_SYS_ADMIN and Linux 5.9 or newer.
+ */
+class FanotifyEventPublisher
+    : public EventPublisher<INotifySubscriptionContext, INotifyEventContext> {
+  DECLARE_PUBLISHER("fanotify");
+
+ public:
+  virtual ~FanotifyEventPublisher() {
+    tearDown();
+  }
+
+  /// Create the `fanotify` group descriptor.
+  Status setUp() override;
+
+  /// Rebuild the path trie and update filesystem marks.
+  void configure() override;
+
+  /// Remove all marks and release the `fanotify` descriptor.
+  void tearDown() override;
+
+  /// The calling for beginning the thread's run loop.
+  Status run() override;
+
+  /// Mark for delete, subscriptions.
+  void removeSubscriptions(const std::string& subscriber) override;
+
+  /// Only add the subscription, if it not already part of subscription list.
+  Status addSubscription(const SubscriptionRef& subscription) override;
+
+  /**
+   * @brief Check if a fanotify publisher was set up and replaces inotify.
+   *
+   * fanotify_init fails on older kernels and without CAP_SYS_ADMIN, then
+   * file_events keeps using the inotify publisher.
+   */
+  static bool initialized();
+
+ private:
+
+  /// Build the set of excluded paths for which events are not to be propagated.
+  void buildExcludePathsSet();
+
+  /**
+   * @brief Place, update, or remove marks so each root's filesystem is marked.
+   *
+   * @param roots one existing directory per filesystem device.
+   * @param mask the union of all subscription masks.
+   */
+  void updateMarks(const std::map<dev_t, std::string>& roots, uint64_t mask);
+
+  /// Add or update a mark, falling back from a filesystem to a mount mark.
+  bool addMark(const std::string& path, uint64_t mask, FanotifyMark& mark);
+
+  /// Remove a mark and close its mount descriptor.
+  void removeMark(FanotifyMark& mark);
+
+  /// Resolve the path for a file handle info record.
+  bool resolvePath(const char* info, std::string& path);
+
+  /// Fire the event for every subscription whose pattern matches.
+  void handleEvent(const char* event, size_t length);
+
+  /// Given a SubscriptionContext and INotifyEventContext match path and action.
+  bool shouldFire(const INotifySubscriptionContextRef& sc,
+                  const INotifyEventContextRef& ec) const override;
+
+  /// The kernel dropped events because the queue was full.
+  void handleOverflow();
+
+ private:
+  /// Compiled subscription patterns.
+  PathTrie<INotifySubscriptionContextRef> paths_;
+
+  /// Events pertaining to these paths not to be propagated.
+  FilePathMatcher exclude_paths_;
+
+  /// Marks keyed by the device of the filesystem they observe.
+  std::map<dev_t, FanotifyMark> marks_;
+
+  /// Filesystem ids to the mount descriptor used by open_by_handle_at.
+  std::map<FanotifyFsid, int> fsid_mounts_;
+
+  /// Recently resolved directory handles to their paths.
+  std::map<std::string, std::string> directory_cache_;
+
+  /// The fanotify group descriptor.
+  std::atomic<int> fanotify_handle_{-1};
+
+  /// Time in seconds of the last fanotify overflow.
+  std::atomic<int> last_overflow_{-1};
+
+  /// A fallback to a mount mark was reported, it is only logged once.
+  bool mount_mark_reported_{false};
+
+  /// Scratch space for reading events, allocated in setUp.
+  char* scratch_{nullptr};
+
+  /// Access to the trie, marks, and the directory cache.
+  mutable Mutex path_mutex_;
+
+  /// Access the fanotify response scratch space.
+  mutable Mutex scratch_mutex_;
+
+ public:
+  friend class FanotifyTests;
+  FRIEND_TEST(FanotifyTests, test_fanotify_configure);
+  FRIEND_TEST(FanotifyTests, test_fanotify_fire_event);
+};
+} // namespace osquery
@@ -22,6 +22,7 @@
 #include <osquery/registry/registry_factory.h>
 #include <osquery/utils/system/time.h>
 
+#include "osquery/events/linux/fanotify.h"
 #include "osquery/events/linux/inotify.h"
 
 namespace fs = boost::filesystem;
@@ -29,6 +30,7 @@ namespace fs = boost::filesystem;
 namespace osquery {
 
 DECLARE_bool(enable_file_events);
+DECLARE_bool(enable_file_events_fanotify);
 
 static const size_t kINotifyMaxEvents = 512;
 static const size_t kINotifyEventSize =
@@ -60,6 +62,14 @@ Status INotifyEventPublisher::setUp() {
     return Status(1, "Publisher disabled via configuration");
   }
 
+  // Publishers are set up in the order of their names, fanotify first.
+  if (FLAGS_enable_file_events_fanotify) {
+    if (FanotifyEventPublisher::initialized()) {
+      return Status(1, "Publisher replaced by fanotify");
+    }
+    LOG(WARNING) << "fanotify is not available, file_events uses inotify";
+  }
+
   inotify_handle_ = ::inotify_init();
   // If this does not work throw an exception.
   if (inotify_handle_ == -1) {
@@ -135,25 +145,8 @@ bool INotifyEventPublisher::monitorSubscription(
 }
 
 void INotifyEventPublisher::buildExcludePathsSet() {
-  auto parser = Config::getParser("file_paths");
-
-  WriteLock lock(subscription_lock_);
   exclude_paths_.clear();
-
-  const auto& doc = parser->getData();
-  if (!doc.doc().HasMember("exclude_paths")) {
-    return;
-  }
-
-  for (const auto& category : doc.doc()["exclude_paths"].GetObject()) {
-    for (const auto& excl_path : category.value.GetArray()) {
-      std::string pattern = excl_path.GetString();
-      if (pattern.empty()) {
-        continue;
-      }
-      exclude_paths_.insert(pattern);
-    }
-  }
+  exclude_paths_.addConfigExcludePaths();
 }
 
 void INotifyEventPublisher::configure() {
@@ -347,11 +340,7 @@ bool INotifyEventPublisher::shouldFire(const INotifySubscriptionContextRef& sc,
   }
 
   // exclude paths should be applied at last
-  auto path = ec->path.substr(0, ec->path.rfind('/'));
-  // Need to have two finds,
-  // what if somebody excluded an individual file inside a directory
-  if (!exclude_paths_.empty() &&
-      (exclude_paths_.find(path) || exclude_paths_.find(ec->path))) {
+  if (exclude_paths_.isExcluded(ec->path)) {
     return false;
   }
 
@@ -16,7 +16,7 @@
 #include <sys/stat.h>
 
 #include <osquery/events/eventpublisher.h>
-#include <osquery/events/pathset.h>
+#include <osquery/events/pathmatcher.h>
 #include <osquery/events/subscription.h>
 
 namespace osquery {
@@ -124,8 +124,6 @@ using INotifyEventContextRef = std::shared_ptr<INotifyEventContext>;
 // Publisher container
 using DescriptorINotifySubCtxMap = std::map<int, INotifySubscriptionContextRef>;
 
-using ExcludePathSet = PathSet<patternedPath>;
-
 /**
  * @brief A Linux `inotify` EventPublisher.
  *
@@ -253,7 +251,7 @@ class INotifyEventPublisher
   DescriptorINotifySubCtxMap descriptor_inosubctx_;
 
   /// Events pertaining to these paths not to be propagated.
-  ExcludePathSet exclude_paths_;
+  FilePathMatcher exclude_paths_;
 
   /// The inotify file descriptor handle.
   std::atomic<int> inotify_handle_{-1};
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <osquery/config/config.h>
+#include <osquery/events/pathmatcher.h>
+#include <osquery/filesystem/filesystem.h>
+
+namespace osquery {
+
+void FilePathMatcher::addPath(const std::string& category,
+                              const std::string& pattern) {
+  if (pattern.empty()) {
+    return;
+  }
+
+  auto glob = pattern;
+  replaceGlobWildcards(glob);
+
+  WriteLock lock(mutex_);
+  paths_.insert(glob, category);
+}
+
+void FilePathMatcher::addExcludePath(const std::string& category,
+                                     const std::string& pattern) {
+  if (pattern.empty()) {
+    return;
+  }
+
+  auto glob = pattern;
+  replaceGlobWildcards(glob);
+
+  // A directory is matched exactly, the parent check covers its files.
+  while (glob.size() > 1 && glob.back() == '/') {
+    glob.pop_back();
+  }
+
+  WriteLock lock(mutex_);
+  excludes_.insert(glob, category);
+}
+
+void FilePathMatcher::addConfigPaths() {
+  Config::get().files([this](const std::string& category,
+                             const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+      addPath(category, file);
+    }
+  });
+}
+
+void FilePathMatcher::addConfigExcludePaths() {
+  auto parser = Config::getParser("file_paths");
+  if (parser == nullptr) {
+    return;
+  }
+
+  const auto& doc = parser->getData().doc();
+  if (!doc.HasMember("exclude_paths") || !doc["exclude_paths"].IsObject()) {
+    return;
+  }
+
+  for (const auto& category : doc["exclude_paths"].GetObject()) {
+    if (!category.value.IsArray()) {
+      continue;
+    }
+
+    for (const auto& excl_path : category.value.GetArray()) {
+      if (excl_path.IsString()) {
+        addExcludePath(category.name.GetString(), excl_path.GetString());
+      }
+    }
+  }
+}
+
+std::vector<std::string> FilePathMatcher::categories(
+    const std::string& path) const {
+  ReadLock lock(mutex_);
+  return paths_.match(path);
+}
+
+bool FilePathMatcher::matches(const std::string& path) const {
+  {
+    ReadLock lock(mutex_);
+    if (!paths_.matches(path)) {
+      return false;
+    }
+  }
+
+  return !isExcluded(path);
+}
+
+bool FilePathMatcher::isExcluded(const std::string& path) const {
+  ReadLock lock(mutex_);
+  if (excludes_.empty()) {
+    return false;
+  }
+
+  if (excludes_.matches(path)) {
+    return true;
+  }
+
+  // Check the parent too, an excluded directory excludes the files within.
+  auto parent = path.substr(0, path.rfind('/'));
+  return !parent.empty() && excludes_.matches(parent);
+}
+
+void FilePathMatcher::clear() {
+  WriteLock lock(mutex_);
+  paths_.clear();
+  excludes_.clear();
+}
+
+bool FilePathMatcher::empty() const {
+  ReadLock lock(mutex_);
+  return paths_.empty() && excludes_.empty();
+}
+
+} // namespace osquery
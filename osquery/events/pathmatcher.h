@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <osquery/events/pathtrie.h>
+#include <osquery/utils/mutex.h>
+
+namespace osquery {
+
+/**
+ * @brief Compiled file_paths and exclude_paths patterns.
+ *
+ * File event publishers and subscribers compile the configured patterns once
+ * during configure and then match every event path against the PathTrie%s,
+ * instead of comparing each event against each configured path.
+ *
+ * Exclusions keep the semantics of the earlier multiset implementation: an
+ * event is excluded when either its path or its parent directory matches.
+ * For example '/etc/' excludes every file directly within /etc and '/etc/%%'
+ * excludes everything below it.
+ *
+ * The matcher is threadsafe.
+ */
+class FilePathMatcher : private boost::noncopyable {
+ public:
+  /// Add a file_paths pattern, '%' wildcards are translated to globs.
+  void addPath(const std::string& category, const std::string& pattern);
+
+  /// Add an exclude_paths pattern, '%' wildcards are translated to globs.
+  void addExcludePath(const std::string& category, const std::string& pattern);
+
+  /// Compile all file_paths categories from the config.
+  void addConfigPaths();
+
+  /// Compile all exclude_paths categories from the file_paths config parser.
+  void addConfigExcludePaths();
+
+  /// The sorted categories whose file_paths patterns match a path.
+  std::vector<std::string> categories(const std::string& path) const;
+
+  /// Check if a path matches any file_paths pattern and is not excluded.
+  bool matches(const std::string& path) const;
+
+  /// Check if a path, or its parent directory, matches an exclude_paths entry.
+  bool isExcluded(const std::string& path) const;
+
+  void clear();
+
+  bool empty() const;
+
+ private:
+  /// file_paths patterns to their category.
+  PathTrie<std::string> paths_;
+
+  /// exclude_paths patterns to their category.
+  PathTrie<std::string> excludes_;
+
+  mutable Mutex mutex_;
+};
+
+} // namespace osquery
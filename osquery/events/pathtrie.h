@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace osquery {
+
+/**
+ * @brief A prefix trie of path components for matching event paths.
+ *
+ * Patterns use the globbing syntax produced by replaceGlobWildcards. Each
+ * '/'-separated component becomes an edge: a lone '*' matches any single
+ * component, components containing '*' or '?' are matched as globs, and a
+ * '**' component matches the node and everything below it. A pattern with a
+ * trailing '/' matches the directory and its direct children, the same scope
+ * as an inotify watch on that directory.
+ *
+ * Matching visits one node per path component (plus any glob branches), so
+ * its cost is proportional to the path length and not to the number of
+ * inserted patterns.
+ *
+ * The trie is not synchronized, owners rebuild it in configure and guard it
+ * with their own lock.
+ */
+template <typename T>
+class PathTrie : private boost::noncopyable {
+ public:
+  /// Add a pattern, values are returned by match for every matching path.
+  void insert(const std::string& pattern, const T& value) {
+    auto components = split(pattern);
+    auto* node = &root_;
+    for (const auto& component : components) {
+      if (component == "**") {
+        node->recursive.push_back(value);
+        patterns_++;
+        return;
+      }
+      node = node->child(component);
+    }
+
+    node->exact.push_back(value);
+    if (!pattern.empty() && pattern.back() == '/') {
+      node->child("*")->exact.push_back(value);
+    }
+    patterns_++;
+  }
+
+  /// Return the sorted, unique set of values whose patterns match a path.
+  std::vector<T> match(const std::string& path) const {
+    std::vector<T> results;
+    std::vector<const Node*> frontier = {&root_};
+    std::vector<const Node*> next;
+
+    auto components = split(path);
+    for (const auto& component : components) {
+      next.clear();
+      for (const auto* node : frontier) {
+        append(results, node->recursive);
+        node->step(component, next);
+      }
+
+      frontier.swap(next);
+      if (frontier.empty()) {
+        break;
+      }
+    }
+
+    for (const auto* node : frontier) {
+      append(results, node->recursive);
+      append(results, node->exact);
+    }
+
+    std::sort(results.begin(), results.end());
+    results.erase(std::unique(results.begin(), results.end()), results.end());
+    return results;
+  }
+
+  /// Check if any pattern matches a path.
+  bool matches(const std::string& path) const {
+    return !match(path).empty();
+  }
+
+  void clear() {
+    root_ = Node();
+    patterns_ = 0;
+  }
+
+  bool empty() const {
+    return patterns_ == 0;
+  }
+
+  /// The number of inserted patterns.
+  size_t size() const {
+    return patterns_;
+  }
+
+  /**
+   * @brief The leading components of a pattern that contain no globs.
+   *
+   * Publishers use this to find the directory (and filesystem) that must be
+   * observed for a pattern. The result always ends with a '/'.
+   */
+  static std::string literalPrefix(const std::string& pattern) {
+    std::string prefix = "/";
+    for (const auto& component : split(pattern)) {
+      if (isGlob(component) || component == "**") {
+        break;
+      }
+      prefix += component + '/';
+    }
+    return prefix;
+  }
+
+  /// Match a single path component against a glob supporting '*' and '?'.
+  static bool globMatch(const std::string& glob, const std::string& str) {
+    size_t g = 0;
+    size_t s = 0;
+    size_t star = std::string::npos;
+    size_t mark = 0;
+    while (s < str.size()) {
+      if (g < glob.size() && (glob[g] == '?' || glob[g] == str[s])) {
+        g++;
+        s++;
+      } else if (g < glob.size() && glob[g] == '*') {
+        star = g++;
+        mark = s;
+      } else if (star != std::string::npos) {
+        g = star + 1;
+        s = ++mark;
+      } else {
+        return false;
+      }
+    }
+
+    while (g < glob.size() && glob[g] == '*') {
+      g++;
+    }
+    return g == glob.size();
+  }
+
+ private:
+  struct Node {
+    /// Edges for literal components.
+    std::map<std::string, std::unique_ptr<Node>> literals;
+
+    /// Edges for components containing globs, matched in insertion order.
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> globs;
+
+    /// The edge for a lone '*' component, which matches without comparing.
+    std::unique_ptr<Node> any;
+
+    /// Values whose pattern ends at this node.
+    std::vector<T> exact;
+
+    /// Values matching this node and all of its descendants.
+    std::vector<T> recursive;
+
+    Node* child(const std::string& component) {
+      if (component == "*") {
+        if (any == nullptr) {
+          any = std::make_unique<Node>();
+        }
+        return any.get();
+      }
+
+      if (isGlob(component)) {
+        for (auto& glob : globs) {
+          if (glob.first == component) {
+            return glob.second.get();
+          }
+        }
+        globs.emplace_back(component, std::make_unique<Node>());
+        return globs.back().second.get();
+      }
+
+      auto& literal = literals[component];
+      if (literal == nullptr) {
+        literal = std::make_unique<Node>();
+      }
+      return literal.get();
+    }
+
+    void step(const std::string& component,
+              std::vector<const Node*>& next) const {
+      auto literal = literals.find(component);
+      if (literal != literals.end()) {
+        next.push_back(literal->second.get());
+      }
+
+      if (any != nullptr) {
+        next.push_back(any.get());
+      }
+
+      for (const auto& glob : globs) {
+        if (globMatch(glob.first, component)) {
+          next.push_back(glob.second.get());
+        }
+      }
+    }
+  };
+
+  static bool isGlob(const std::string& component) {
+    return component.find_first_of("*?") != std::string::npos;
+  }
+
+  static std::vector<std::string> split(const std::string& path) {
+    std::vector<std::string> components;
+    size_t start = 0;
+    while (start < path.size()) {
+      auto end = path.find('/', start);
+      if (end == std::string::npos) {
+        end = path.size();
+      }
+      if (end > start) {
+        components.push_back(path.substr(start, end - start));
+      }
+      start = end + 1;
+    }
+    return components;
+  }
+
+  static void append(std::vector<T>& results, const std::vector<T>& values) {
+    results.insert(results.end(), values.begin(), values.end());
+  }
+
+ private:
+  Node root_;
+
+  size_t patterns_{0};
+};
+
+} // namespace osquery
@@ -217,7 +217,7 @@ TEST_F(FSEventsTests, test_fsevents_match_subscription) {
   std::vector<std::string> exclude_paths = {
       "/etc/ssh/%%", "/etc/", "/etc/ssl/openssl.cnf", "/"};
   for (const auto& path : exclude_paths) {
-    event_pub->exclude_paths_.insert(path);
+    event_pub->exclude_paths_.addExcludePath("test", path);
   }
 
   {
@@ -193,6 +193,74 @@ TEST_F(EventSubscriberPluginTests, expireEventBatches) {
   EXPECT_EQ(context.event_index.size(), 5U);
 }
 
+TEST_F(EventSubscriberPluginTests, coalesceKey) {
+  Row row = {{"path", "/etc/passwd"}, {"action", "UPDATED"}, {"pid", "1"}};
+  auto key = EventSubscriberPlugin::coalesceKey(row);
+  EXPECT_FALSE(key.empty());
+
+  // Columns outside of the identity do not change the key.
+  row["sha256"] = "abc";
+  EXPECT_EQ(key, EventSubscriberPlugin::coalesceKey(row));
+
+  row["pid"] = "2";
+  EXPECT_NE(key, EventSubscriberPlugin::coalesceKey(row));
+
+  // Events without a path are never coalesced.
+  EXPECT_TRUE(EventSubscriberPlugin::coalesceKey({{"pid", "1"}}).empty());
+}
+
+TEST_F(EventSubscriberPluginTests, coalesceRows) {
+  EventSubscriberPlugin::Context context;
+  const std::uint64_t kWindow{100U};
+
+  Row modified = {{"target_path", "/tmp/a"}, {"action", "UPDATED"}};
+  Row attributes = {{"target_path", "/tmp/a"},
+                    {"action", "ATTRIBUTES_MODIFIED"}};
+  Row process = {{"pid", "1"}, {"cmdline", "make"}};
+
+  // A burst is held back, only rows without a path pass through.
+  std::vector<Row> row_list = {modified, modified, attributes, process};
+  std::vector<EventTime> time_list;
+  EventSubscriberPlugin::coalesceRows(
+      context, row_list, time_list, 10U, kWindow, 1000U);
+  ASSERT_EQ(row_list.size(), 1U);
+  EXPECT_EQ(row_list[0]["cmdline"], "make");
+  EXPECT_EQ(row_list[0]["count"], "1");
+  EXPECT_EQ(time_list, std::vector<EventTime>({10U}));
+  EXPECT_EQ(context.coalesced_rows.size(), 2U);
+
+  // Within the window duplicates keep merging.
+  modified["sha256"] = "abc";
+  row_list = {modified};
+  EventSubscriberPlugin::coalesceRows(
+      context, row_list, time_list, 11U, kWindow, 1050U);
+  EXPECT_TRUE(row_list.empty());
+  EXPECT_TRUE(time_list.empty());
+
+  // The window elapsed, the merged rows are released with their counts and
+  // the time they were first seen.
+  row_list = {modified};
+  EventSubscriberPlugin::coalesceRows(
+      context, row_list, time_list, 12U, kWindow, 1100U);
+  ASSERT_EQ(row_list.size(), 2U);
+  EXPECT_EQ(row_list[0]["action"], "UPDATED");
+  EXPECT_EQ(row_list[0]["count"], "3");
+  EXPECT_EQ(row_list[0]["sha256"], "abc");
+  EXPECT_EQ(row_list[1]["action"], "ATTRIBUTES_MODIFIED");
+  EXPECT_EQ(row_list[1]["count"], "1");
+  EXPECT_EQ(time_list, std::vector<EventTime>({10U, 10U}));
+
+  // The newest event started a new window and is flushed on demand.
+  row_list.clear();
+  time_list.clear();
+  EventSubscriberPlugin::flushCoalescedRows(context, row_list, time_list);
+  ASSERT_EQ(row_list.size(), 1U);
+  EXPECT_EQ(row_list[0]["count"], "1");
+  EXPECT_EQ(time_list, std::vector<EventTime>({12U}));
+  EXPECT_TRUE(context.coalesced_rows.empty());
+  EXPECT_TRUE(context.coalesced_order.empty());
+}
+
 TEST_F(EventSubscriberPluginTests, generateRows) {
   MockedOsqueryDatabase mocked_database;
   mocked_database.generateEvents("type", "name");
@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <stdio.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <osquery/core/flags.h>
+#include <osquery/database/database.h>
+#include <osquery/events/eventsubscriber.h>
+#include <osquery/events/linux/fanotify.h>
+#include <osquery/events/linux/inotify.h>
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/registry/registry_factory.h>
+#include <osquery/utils/info/tool_type.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+DECLARE_bool(enable_file_events);
+DECLARE_bool(enable_file_events_fanotify);
+
+const int kMaxEventLatency = 3000;
+
+class FanotifyTests : public testing::Test {
+  bool enable_file_events_backup{false};
+  bool enable_file_events_fanotify_backup{false};
+
+ protected:
+  void SetUp() override {
+    enable_file_events_backup = FLAGS_enable_file_events;
+    enable_file_events_fanotify_backup = FLAGS_enable_file_events_fanotify;
+    FLAGS_enable_file_events = true;
+    FLAGS_enable_file_events_fanotify = true;
+
+    setToolType(ToolType::TEST);
+    registryAndPluginInit();
+    initDatabasePluginForTesting();
+
+    // fanotify will use exclude_paths from the config parsers.
+    Registry::get().registry("config_parser")->setUp();
+
+    real_test_dir =
+        fs::weakly_canonical(fs::temp_directory_path() /
+                             fs::unique_path("fanotify-trigger.%%%%.%%%%"))
+            .string();
+    fs::create_directories(real_test_dir);
+    real_test_path = real_test_dir + "/1";
+  }
+
+  void TearDown() override {
+    FLAGS_enable_file_events = enable_file_events_backup;
+    FLAGS_enable_file_events_fanotify = enable_file_events_fanotify_backup;
+    removePath(real_test_dir);
+  }
+
+  void TriggerEvent(const std::string& path) {
+    FILE* fd = fopen(path.c_str(), "w");
+    fputs("fanotify", fd);
+    fclose(fd);
+  }
+
+ protected:
+  /// Transient paths ./fanotify-trigger/.
+  std::string real_test_dir;
+
+  /// Transient paths ./fanotify-trigger/1.
+  std::string real_test_path;
+};
+
+TEST_F(FanotifyTests, test_fanotify_inotify_fallback) {
+  // Without an initialized fanotify publisher, inotify is not replaced.
+  ASSERT_FALSE(FanotifyEventPublisher::initialized());
+  auto inotify = std::make_shared<INotifyEventPublisher>();
+  EXPECT_TRUE(inotify->setUp().ok());
+  inotify->tearDown();
+
+  auto pub = std::make_shared<FanotifyEventPublisher>();
+  if (!pub->setUp().ok()) {
+    GTEST_SKIP() << "fanotify requires CAP_SYS_ADMIN and a recent kernel";
+  }
+  EXPECT_TRUE(FanotifyEventPublisher::initialized());
+  EXPECT_FALSE(inotify->setUp().ok());
+
+  pub->tearDown();
+  EXPECT_FALSE(FanotifyEventPublisher::initialized());
+}
+
+TEST_F(FanotifyTests, test_fanotify_configure) {
+  auto pub = std::make_shared<FanotifyEventPublisher>();
+  if (!pub->setUp().ok()) {
+    GTEST_SKIP() << "fanotify requires CAP_SYS_ADMIN and a recent kernel";
+  }
+
+  auto sc = pub->createSubscriptionContext();
+  sc->path = real_test_dir;
+  sc->category = "test";
+  pub->addSubscription(Subscription::create("TestSubscriber", sc));
+  pub->configure();
+
+  // The directory is matched with its direct children.
+  EXPECT_EQ(pub->paths_.size(), 1U);
+  EXPECT_TRUE(pub->paths_.matches(real_test_path));
+  EXPECT_FALSE(pub->paths_.matches(real_test_dir + "/1/2"));
+
+  // A single mark covers the temporary directory's filesystem.
+  EXPECT_EQ(pub->marks_.size(), 1U);
+
+  // Removing the subscription releases the mark.
+  pub->removeSubscriptions("TestSubscriber");
+  pub->configure();
+  EXPECT_TRUE(pub->paths_.empty());
+  EXPECT_TRUE(pub->marks_.empty());
+  pub->tearDown();
+}
+
+class TestFanotifyEventSubscriber
+    : public EventSubscriber<FanotifyEventPublisher> {
+ public:
+  TestFanotifyEventSubscriber() {
+    setName("TestFanotifyEventSubscriber");
+  }
+
+  Status init() override {
+    callback_count_ = 0;
+    return Status::success();
+  }
+
+  Status Callback(const ECRef& ec, const SCRef& sc) {
+    WriteLock lock(paths_lock_);
+    paths_.push_back(ec->path);
+    callback_count_++;
+    return Status::success();
+  }
+
+  void WaitForEvents(int max, int num_events = 1) {
+    int delay = 0;
+    while (delay < max * 1000) {
+      if (callback_count_ >= num_events) {
+        return;
+      }
+      ::usleep(50);
+      delay += 50;
+    }
+  }
+
+  std::vector<std::string> paths() {
+    WriteLock lock(paths_lock_);
+    return paths_;
+  }
+
+ public:
+  std::atomic<int> callback_count_{0};
+
+ private:
+  std::vector<std::string> paths_;
+
+  Mutex paths_lock_;
+
+ private:
+  FRIEND_TEST(FanotifyTests, test_fanotify_fire_event);
+};
+
+TEST_F(FanotifyTests, test_fanotify_fire_event) {
+  auto pub = std::make_shared<FanotifyEventPublisher>();
+  auto status = EventFactory::registerEventPublisher(pub);
+  if (!status.ok()) {
+    GTEST_SKIP() << "fanotify requires CAP_SYS_ADMIN and a recent kernel";
+  }
+
+  auto sub = std::make_shared<TestFanotifyEventSubscriber>();
+  EventFactory::registerEventSubscriber(sub);
+
+  auto sc = sub->createSubscriptionContext();
+  sc->path = real_test_dir + "/*";
+  sub->subscribe(&TestFanotifyEventSubscriber::Callback, sc);
+  pub->configure();
+
+  std::thread temp_thread(EventFactory::run, "fanotify");
+  TriggerEvent(real_test_path);
+  sub->WaitForEvents(kMaxEventLatency);
+
+  EXPECT_GT(sub->callback_count_, 0);
+  for (const auto& path : sub->paths()) {
+    EXPECT_EQ(path, real_test_path);
+  }
+
+  EventFactory::end(true);
+  temp_thread.join();
+}
+} // namespace osquery
@@ -259,7 +259,7 @@ TEST_F(INotifyTests, test_inotify_match_subscription) {
   std::vector<std::string> exclude_paths = {
       "/etc/ssh/%%", "/etc/", "/etc/ssl/openssl.cnf", "/"};
   for (const auto& path : exclude_paths) {
-    event_pub_->exclude_paths_.insert(path);
+    event_pub_->exclude_paths_.addExcludePath("test", path);
   }
 
   {
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <gtest/gtest.h>
+
+#include <osquery/events/pathmatcher.h>
+#include <osquery/events/pathtrie.h>
+
+namespace osquery {
+
+class PathMatcherTests : public testing::Test {};
+
+TEST_F(PathMatcherTests, test_path_trie_match) {
+  PathTrie<std::string> trie;
+  trie.insert("/etc/passwd", "file");
+  trie.insert("/etc/ssh/", "directory");
+  trie.insert("/home/*/.ssh/**", "recursive");
+  trie.insert("/var/log/*.log", "glob");
+  EXPECT_EQ(trie.size(), 4U);
+
+  EXPECT_EQ(trie.match("/etc/passwd"), std::vector<std::string>{"file"});
+  EXPECT_TRUE(trie.match("/etc/shadow").empty());
+
+  // A directory pattern matches the directory and its direct children.
+  EXPECT_EQ(trie.match("/etc/ssh"), std::vector<std::string>{"directory"});
+  EXPECT_EQ(trie.match("/etc/ssh/sshd_config"),
+            std::vector<std::string>{"directory"});
+  EXPECT_TRUE(trie.match("/etc/ssh/keys/host_key").empty());
+
+  EXPECT_EQ(trie.match("/home/user/.ssh/keys/id_rsa"),
+            std::vector<std::string>{"recursive"});
+  EXPECT_TRUE(trie.match("/home/user/.bashrc").empty());
+
+  EXPECT_EQ(trie.match("/var/log/syslog.log"),
+            std::vector<std::string>{"glob"});
+  EXPECT_TRUE(trie.match("/var/log/syslog").empty());
+
+  // Overlapping patterns report each value once.
+  trie.insert("/etc/**", "etc");
+  trie.insert("/etc/**", "etc");
+  EXPECT_EQ(trie.match("/etc/passwd"),
+            (std::vector<std::string>{"etc", "file"}));
+
+  EXPECT_EQ(PathTrie<std::string>::literalPrefix("/home/*/.ssh/**"),
+            "/home/");
+  EXPECT_EQ(PathTrie<std::string>::literalPrefix("/etc/passwd"),
+            "/etc/passwd/");
+
+  trie.clear();
+  EXPECT_TRUE(trie.empty());
+  EXPECT_TRUE(trie.match("/etc/passwd").empty());
+}
+
+TEST_F(PathMatcherTests, test_path_trie_glob) {
+  EXPECT_TRUE(PathTrie<int>::globMatch("*", ""));
+  EXPECT_TRUE(PathTrie<int>::globMatch("*sh", "bash"));
+  EXPECT_TRUE(PathTrie<int>::globMatch("lib*.so.?", "libc.so.6"));
+  EXPECT_TRUE(PathTrie<int>::globMatch("a*b*c", "aXbYbZc"));
+  EXPECT_FALSE(PathTrie<int>::globMatch("a*b*c", "aXbYbZ"));
+  EXPECT_FALSE(PathTrie<int>::globMatch("?", ""));
+}
+
+TEST_F(PathMatcherTests, test_file_path_matcher_categories) {
+  FilePathMatcher matcher;
+  EXPECT_TRUE(matcher.empty());
+
+  matcher.addPath("etc", "/etc/%%");
+  matcher.addPath("bin", "/bin/%sh");
+  matcher.addPath("homes", "/home/%/.ssh/");
+
+  EXPECT_EQ(matcher.categories("/etc/hosts"), std::vector<std::string>{"etc"});
+  EXPECT_EQ(matcher.categories("/bin/bash"), std::vector<std::string>{"bin"});
+  EXPECT_TRUE(matcher.categories("/bin/ls").empty());
+  EXPECT_EQ(matcher.categories("/home/user/.ssh/authorized_keys"),
+            std::vector<std::string>{"homes"});
+  EXPECT_TRUE(matcher.matches("/home/user/.ssh/authorized_keys"));
+  EXPECT_FALSE(matcher.matches("/home/user/.profile"));
+}
+
+TEST_F(PathMatcherTests, test_file_path_matcher_excludes) {
+  FilePathMatcher matcher;
+  matcher.addPath("etc", "/etc/%%");
+
+  std::vector<std::string> exclude_paths = {
+      "/etc/ssh/%%", "/etc/", "/etc/ssl/openssl.cnf", "/"};
+  for (const auto& path : exclude_paths) {
+    matcher.addExcludePath("etc", path);
+  }
+
+  EXPECT_TRUE(matcher.isExcluded("/etc/ssh/ssh_config"));
+  EXPECT_TRUE(matcher.isExcluded("/etc/ssh/keys/host_key"));
+  EXPECT_TRUE(matcher.isExcluded("/etc/passwd"));
+  EXPECT_TRUE(matcher.isExcluded("/etc/ssl/openssl.cnf"));
+  EXPECT_FALSE(matcher.isExcluded("/etc/ssl/certs/"));
+  EXPECT_FALSE(matcher.isExcluded("/var/log"));
+
+  EXPECT_FALSE(matcher.matches("/etc/passwd"));
+  EXPECT_TRUE(matcher.matches("/etc/ssl/certs/ca.pem"));
+
+  matcher.clear();
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_FALSE(matcher.isExcluded("/etc/passwd"));
+}
+} // namespace osquery
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <boost/filesystem.hpp>
+
+#include <osquery/core/tables.h>
+#include <osquery/extensions/extensions.h>
+#include <osquery/extensions/interface.h>
+#include <osquery/registry/registry_factory.h>
+#include <osquery/sql/columnar_table_row.h>
+#include <osquery/sql/dynamic_table_row.h>
+#include <osquery/utils/json/json.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+
+DECLARE_bool(extensions_shared_memory);
+
+const size_t kBenchmarkExtensionRows{100000};
+
+class BenchmarkExtensionPagePlugin : public TablePlugin {
+ protected:
+  TableColumns columns() const override {
+    return {
+        std::make_tuple("pid", INTEGER_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("name", TEXT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("size", BIGINT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("score", DOUBLE_TYPE, ColumnOptions::DEFAULT),
+    };
+  }
+
+  TableRows generate(QueryContext& ctx) override {
+    TableRows results;
+    results.reserve(kBenchmarkExtensionRows);
+    for (size_t i = 0; i < kBenchmarkExtensionRows; i++) {
+      auto r = make_table_row();
+      r["pid"] = std::to_string(i);
+      r["name"] = "process_" + std::to_string(i);
+      r["size"] = std::to_string(i * 4096);
+      r["score"] = "0.5";
+      results.push_back(std::move(r));
+    }
+    return results;
+  }
+};
+
+/// Start a manager and an extension in this process, return its socket.
+static std::string startBenchmarkExtension() {
+  auto manager_path =
+      (fs::temp_directory_path() /
+       fs::unique_path("osquery.extensions_benchmark.%%%%.%%%%"))
+          .string();
+  auto status = startExtensionManager(manager_path);
+  if (!status.ok()) {
+    return "";
+  }
+
+  auto& rf = RegistryFactory::get();
+  rf.registry("table")->add("benchmark_extension",
+                            std::make_shared<BenchmarkExtensionPagePlugin>());
+  rf.allowDuplicates(true);
+
+  status = startExtension(manager_path, "benchmark", "0.1", "0.0.0", "0.0.0");
+  if (!status.ok()) {
+    return "";
+  }
+  return manager_path + "." + status.getMessage();
+}
+
+static void EXT_table_transport(benchmark::State& state) {
+  // Profile reading a 100k row extension table through the extension socket.
+  // An argument of 0 receives the page through Thrift, 1 through shared
+  // memory that Thrift only names.
+  static const auto extension_path = startBenchmarkExtension();
+  if (extension_path.empty()) {
+    state.SkipWithError("Cannot start the benchmark extension");
+    return;
+  }
+
+  auto shared_memory = FLAGS_extensions_shared_memory;
+  FLAGS_extensions_shared_memory = (state.range(0) == 1);
+  while (state.KeepRunning()) {
+    TablePage page;
+    auto status = generateExtensionTable(
+        extension_path, "benchmark_extension", {{"action", "generate"}}, page);
+    if (!status.ok()) {
+      state.SkipWithError(status.getMessage().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(page);
+  }
+  FLAGS_extensions_shared_memory = shared_memory;
+  state.SetItemsProcessed(state.iterations() * kBenchmarkExtensionRows);
+}
+
+BENCHMARK(EXT_table_transport)->Arg(0)->Arg(1);
+
+static void EXT_table_response(benchmark::State& state) {
+  // Profile a 100k row extension table round trip over the extension socket,
+  // until the rows are read back as results are logged.
+  // An argument of 0 calls the table for row maps of strings, 1 generates
+  // typed table pages.
+  static const auto extension_path = startBenchmarkExtension();
+  if (extension_path.empty()) {
+    state.SkipWithError("Cannot start the benchmark extension");
+    return;
+  }
+
+  auto shared_memory = FLAGS_extensions_shared_memory;
+  FLAGS_extensions_shared_memory = false;
+  while (state.KeepRunning()) {
+    TableRows rows;
+    Status status;
+    if (state.range(0) == 0) {
+      PluginResponse response;
+      status = callExtension(extension_path,
+                             "table",
+                             "benchmark_extension",
+                             {{"action", "generate"}},
+                             response);
+      rows = tableRowsFromQueryData(std::move(response));
+    } else {
+      TablePage page;
+      status = generateExtensionTable(extension_path,
+                                      "benchmark_extension",
+                                      {{"action", "generate"}},
+                                      page);
+      rows = tableRowsFromPage(std::move(page));
+    }
+    if (!status.ok()) {
+      state.SkipWithError(status.getMessage().c_str());
+      break;
+    }
+
+    auto doc = JSON::newArray();
+    for (const auto& row : rows) {
+      auto obj = doc.getObject();
+      row->serialize(doc, obj);
+    }
+    benchmark::DoNotOptimize(doc);
+  }
+  FLAGS_extensions_shared_memory = shared_memory;
+  state.SetItemsProcessed(state.iterations() * kBenchmarkExtensionRows);
+}
+
+BENCHMARK(EXT_table_response)->Arg(0)->Arg(1);
+} // namespace osquery
@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <future>
 #include <map>
 #include <set>
 #include <string>
@@ -34,6 +35,12 @@
 #include <osquery/utils/info/platform_type.h>
 #include <osquery/utils/info/version.h>
 
+#ifdef __linux__
+#include <unistd.h>
+
+#include <osquery/worker/ipc/linux/shared_ring_channel.h>
+#endif
+
 namespace fs = boost::filesystem;
 
 namespace osquery {
@@ -57,6 +64,10 @@ const std::map<PlatformType, ExtendableTypeSet> kFileExtensions{
 /// Millisecond latency between initializing manager pings.
 const size_t kExtensionInitializeLatency{20};
 
+/// Extensions that do not implement generateTable.
+std::set<RouteUUID> kUnsupportedTableExtensions;
+Mutex kUnsupportedTableExtensionsMutex;
+
 } // namespace
 
 CLI_FLAG(bool, disable_extensions, false, "Disable extension API");
@@ -83,6 +94,18 @@ CLI_FLAG(string,
 
 SHELL_FLAG(string, extension, "", "Path to a single extension to autoload");
 
+FLAG(bool,
+     extensions_shared_memory,
+     false,
+     "Read extension table rows through shared memory (Linux only)");
+
+FLAG(uint64,
+     extensions_shared_memory_size,
+     4,
+     "Size in MiB of the shared memory used for each extension table");
+
+DECLARE_uint32(thrift_timeout);
+
 CLI_FLAG(string,
          extensions_require,
          "",
@@ -222,6 +245,7 @@ void ExtensionWatcher::start() {
   // service is added and started.
   while (!interrupted()) {
     watch();
+    ExtensionClientCore::expireConnections();
     pause(std::chrono::milliseconds(interval_));
   }
 }
@@ -230,6 +254,7 @@ void ExtensionManagerWatcher::start() {
   // Watch each extension.
   while (!interrupted()) {
     watch();
+    ExtensionClientCore::expireConnections();
     pause(std::chrono::milliseconds(interval_));
   }
 
@@ -347,6 +372,8 @@ void ExtensionManagerWatcher::watch() {
     if (uuid.second > 1) {
       LOG(INFO) << "Extension UUID " << uuid.first << " has gone away";
       RegistryFactory::get().removeBroadcast(uuid.first);
+      ExtensionClientCore::closeConnections(getExtensionSocket(uuid.first));
+      setExtensionTableSupport(uuid.first, true);
       failures_[uuid.first] = 1;
     }
   }
@@ -703,6 +730,154 @@ Status callExtension(const std::string& extension_path,
   return status;
 }
 
+Status generateExtensionTable(const RouteUUID uuid,
+                              const std::string& item,
+                              const PluginRequest& request,
+                              TablePage& page) {
+  if (FLAGS_disable_extensions) {
+    return Status(1, "Extensions disabled");
+  }
+
+  {
+    ReadLock lock(kUnsupportedTableExtensionsMutex);
+    if (kUnsupportedTableExtensions.count(uuid) > 0) {
+      return Status(kExtensionUnsupportedCode,
+                    "Extension does not implement generateTable");
+    }
+  }
+
+  auto status =
+      generateExtensionTable(getExtensionSocket(uuid), item, request, page);
+  if (status.getCode() == kExtensionUnsupportedCode) {
+    setExtensionTableSupport(uuid, false);
+  }
+  return status;
+}
+
+void setExtensionTableSupport(RouteUUID uuid, bool supported) {
+  WriteLock lock(kUnsupportedTableExtensionsMutex);
+  if (supported) {
+    kUnsupportedTableExtensions.erase(uuid);
+  } else {
+    kUnsupportedTableExtensions.insert(uuid);
+  }
+}
+
+#ifdef __linux__
+/**
+ * @brief Read an extension's table page from a shared memory ring.
+ *
+ * The extension writes the rows to the ring while generateTable is pending,
+ * and answers with the page itself if it cannot open the ring.
+ */
+static Status generateSharedRingTable(const std::string& extension_path,
+                                      const std::string& item,
+                                      const PluginRequest& request,
+                                      SharedRingChannel& ring,
+                                      TablePage& page) {
+  auto ring_request = request;
+  ring_request[kSharedRingPidKey] = std::to_string(getpid());
+  ring_request[kSharedRingFdKey] = std::to_string(ring.fd());
+
+  TablePage response;
+  auto call = std::async(std::launch::async, [&]() {
+    Status status;
+    try {
+      ExtensionClient client(extension_path);
+      status = client.generateTable(item, ring_request, response);
+    } catch (const std::exception& e) {
+      status = Status(1, "Extension call failed: " + std::string(e.what()));
+    }
+
+    // Once the extension answered nothing more is written to the ring.
+    ring.closeWriter();
+    return status;
+  });
+
+  TablePage received;
+  bool ended = false;
+  Status read_status;
+  std::string message;
+  while (!ended) {
+    read_status = ring.recvStringMessage(message);
+    if (!read_status.ok()) {
+      break;
+    }
+    if (message == kSharedRingEndMessage) {
+      ended = true;
+    } else {
+      read_status = received.decode(message);
+      if (!read_status.ok()) {
+        break;
+      }
+    }
+  }
+
+  if (!ended) {
+    // Fail the extension's pending writes rather than wait for them.
+    ring.closeReader();
+  }
+
+  auto status = call.get();
+  if (!status.ok()) {
+    return status;
+  }
+
+  if (ended) {
+    if (received.rows() != response.rows()) {
+      return Status::failure("Extension table " + item + " wrote " +
+                             std::to_string(received.rows()) + " of " +
+                             std::to_string(response.rows()) + " rows");
+    }
+    page = std::move(received);
+    return Status::success();
+  }
+
+  if (response.rows() == 0 || !response.columns().empty()) {
+    // The extension did not use the ring, the page came through Thrift.
+    page = std::move(response);
+    return Status::success();
+  }
+  return read_status;
+}
+#endif
+
+Status generateExtensionTable(const std::string& extension_path,
+                              const std::string& item,
+                              const PluginRequest& request,
+                              TablePage& page) {
+  auto status = extensionPathActive(extension_path);
+  if (!status.ok()) {
+    return status;
+  }
+
+#ifdef __linux__
+  if (FLAGS_extensions_shared_memory) {
+    std::unique_ptr<SharedRingChannel> ring;
+    status = SharedRingChannel::create(
+        item,
+        static_cast<size_t>(FLAGS_extensions_shared_memory_size) << 20,
+        std::chrono::seconds(FLAGS_thrift_timeout),
+        ring);
+    if (status.ok()) {
+      return generateSharedRingTable(
+          extension_path, item, request, *ring, page);
+    }
+    VLOG(1) << "Cannot create a shared ring for table " << item << ": "
+            << status.getMessage();
+  }
+#endif
+
+  try {
+    ExtensionClient client(extension_path);
+    status = client.generateTable(item, request, page);
+  } catch (const std::exception& e) {
+    return Status(1, "Extension call failed: " + std::string(e.what()));
+  }
+
+  return status;
+}
+
 Status startExtensionWatcher(const std::string& manager_path,
                              size_t interval,
                              bool fatal,
@@ -12,6 +12,7 @@
 #include <osquery/core/core.h>
 #include <osquery/core/flags.h>
 #include <osquery/core/plugins/sql.h>
+#include <osquery/core/sql/table_page.h>
 #include <osquery/registry/registry_interface.h>
 
 namespace osquery {
@@ -35,6 +36,9 @@ struct ExtensionInfo {
 
 typedef std::map<RouteUUID, ExtensionInfo> ExtensionList;
 
+/// The Status code of an extension call the extension does not implement.
+const int kExtensionUnsupportedCode = 3;
+
 inline std::string getExtensionSocket(
     RouteUUID uuid, const std::string& path = FLAGS_extensions_socket) {
   return (uuid == 0) ? path : path + "." + std::to_string(uuid);
@@ -138,6 +142,41 @@ Status callExtension(const std::string& extension_path,
                      const PluginRequest& request,
                      PluginResponse& response);
 
+/**
+ * @brief Generate the rows of an extension's table as typed columns.
+ *
+ * Extensions built with an older SDK do not implement generateTable, this
+ * returns kExtensionUnsupportedCode for them and the caller should fall back
+ * to callExtension. The result is remembered per extension UUID.
+ *
+ * @param uuid Route UUID of the matched Extension
+ * @param item The table name.
+ * @param request The plugin request input, as sent to callExtension.
+ * @param page The table page output.
+ * @return Success indicates Extension API call success and a valid page.
+ */
+Status generateExtensionTable(const RouteUUID uuid,
+                              const std::string& item,
+                              const PluginRequest& request,
+                              TablePage& page);
+
+/// Internal generateExtensionTable implementation using a socket path.
+Status generateExtensionTable(const std::string& extension_path,
+                              const std::string& item,
+                              const PluginRequest& request,
+                              TablePage& page);
+
+/**
+ * @brief Set whether generateExtensionTable is tried for an extension.
+ *
+ * An extension that does not implement generateTable is recorded as
+ * unsupported the first time. Deregistering an extension forgets it.
+ *
+ * @param uuid Route UUID of the Extension.
+ * @param supported false to use callExtension for its tables.
+ */
+void setExtensionTableSupport(RouteUUID uuid, bool supported);
+
 /// The main runloop entered by an Extension, start an ExtensionRunner thread.
 Status startExtension(const std::string& name, const std::string& version);
 
@@ -7,13 +7,20 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <map>
+
 #include <osquery/core/core.h>
 #include <osquery/core/system.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
 
+#include <thrift/concurrency/ThreadFactory.h>
 #include <thrift/concurrency/ThreadManager.h>
 #include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/server/TThreadPoolServer.h>
 #include <thrift/server/TThreadedServer.h>
 #include <thrift/transport/TBufferTransports.h>
 
@@ -23,6 +30,9 @@
 #include <thrift/transport/TPipe.h>
 #include <thrift/transport/TPipeServer.h>
 #else
+#include <fcntl.h>
+#include <poll.h>
+
 #include <thrift/transport/TServerSocket.h>
 #include <thrift/transport/TSocket.h>
 #endif
@@ -42,6 +52,23 @@ namespace osquery {
 FLAG(bool, thrift_verbose, false, "Enable the thrift log handler");
 FLAG(uint32, thrift_timeout, 300, "Timeout for thrift socket operations");
 
+FLAG(uint32,
+     thrift_server_threads,
+     0,
+     "Serve extension calls from a pool of this many threads (0 starts a "
+     "thread per connection)");
+
+FLAG(uint32,
+     thrift_client_pool_size,
+     4,
+     "Idle connections kept open to each extension socket (0 disables)");
+
+/// Seconds a pooled client connection may stay idle before it is closed.
+const std::chrono::seconds kClientIdleTimeout{5};
+
+/// Seconds a thread pool server waits for the next call on a connection.
+const size_t kServerIdleTimeout{10};
+
 using namespace apache::thrift;
 using namespace apache::thrift::protocol;
 using namespace apache::thrift::transport;
@@ -112,6 +139,12 @@ class ExtensionHandler : virtual public extensions::ExtensionIf,
             const std::string& item,
             const extensions::ExtensionPluginRequest& request) override;
 
+  using ExtensionInterface::generateTable;
+  void generateTable(
+      extensions::ExtensionTablePage& _return,
+      const std::string& item,
+      const extensions::ExtensionPluginRequest& request) override;
+
   using ExtensionInterface::shutdown;
   void shutdown() override;
 
@@ -158,6 +191,7 @@ class ExtensionManagerHandler : virtual public extensions::ExtensionManagerIf,
 
  public:
   using ExtensionHandler::call;
+  using ExtensionHandler::generateTable;
   using ExtensionHandler::ping;
   using ExtensionHandler::shutdown;
 };
@@ -168,7 +202,7 @@ class ExtensionManagerHandler : virtual public extensions::ExtensionManagerIf,
 
 struct ImplExtensionRunner {
   std::shared_ptr<TServerTransport> transport;
-  std::shared_ptr<TThreadedServer> server;
+  std::shared_ptr<TServerFramework> server;
   std::shared_ptr<TProcessor> processor;
   std::shared_ptr<ThriftServerEventHandler> server_event_handler;
 };
@@ -179,8 +213,153 @@ struct ImplExtensionClient {
 
   std::shared_ptr<TBufferedTransport> transport;
   std::shared_ptr<TPlatformSocket> socket;
+
+  /// Uncaught exceptions when the client was created, see ~ExtensionClientCore.
+  int exceptions{0};
+};
+
+/// An open connection to an extension socket that is not in use.
+struct IdleConnection {
+  std::shared_ptr<TPlatformSocket> socket;
+  std::shared_ptr<TBufferedTransport> transport;
+  std::chrono::steady_clock::time_point since;
+};
+
+/**
+ * @brief Connections kept open between calls, per socket path.
+ *
+ * Each call used to connect, and the server started a thread for each
+ * connection. A client now takes the most recently used idle connection to
+ * its path and returns it when destroyed.
+ */
+class ExtensionConnectionPool : private boost::noncopyable {
+ public:
+  static ExtensionConnectionPool& get() {
+    static ExtensionConnectionPool pool;
+    return pool;
+  }
+
+  /// Take a healthy idle connection to path, false if there is none.
+  bool acquire(const std::string& path, IdleConnection& connection);
+
+  /// Keep a connection for the next client, or close it if the pool is full.
+  void release(const std::string& path, IdleConnection&& connection);
+
+  /// Close every idle connection to path.
+  void close(const std::string& path);
+
+  /// Number of idle connections to path.
+  size_t size(const std::string& path);
+
+  /// Close the connections that were idle for too long, to every path.
+  void expire();
+
+ private:
+  /// Close the connections to each path that were idle for too long.
+  void expire(std::chrono::steady_clock::time_point now);
+
+ private:
+  Mutex mutex_;
+
+  /// Idle connections per path, the most recently used last.
+  std::map<std::string, std::deque<IdleConnection>> idle_;
 };
 
+static void closeConnection(IdleConnection& connection) {
+  try {
+    connection.transport->close();
+  } catch (const std::exception& /* e */) {
+    // The transport/socket may have exited.
+  }
+}
+
+/// An idle connection is usable if the server has not closed it.
+static bool connectionHealthy(IdleConnection& connection) {
+  if (!connection.transport->isOpen()) {
+    return false;
+  }
+
+#ifndef WIN32
+  // Nothing should be readable between calls, the server closing is.
+  pollfd fds{};
+  fds.fd = connection.socket->getSocketFD();
+  fds.events = POLLIN;
+  return ::poll(&fds, 1, 0) == 0;
+#else
+  return true;
+#endif
+}
+
+bool ExtensionConnectionPool::acquire(const std::string& path,
+                                      IdleConnection& connection) {
+  auto now = std::chrono::steady_clock::now();
+
+  WriteLock lock(mutex_);
+  expire(now);
+  auto it = idle_.find(path);
+  while (it != idle_.end() && !it->second.empty()) {
+    connection = std::move(it->second.back());
+    it->second.pop_back();
+    if (connectionHealthy(connection)) {
+      return true;
+    }
+    closeConnection(connection);
+  }
+  return false;
+}
+
+void ExtensionConnectionPool::release(const std::string& path,
+                                      IdleConnection&& connection) {
+  connection.since = std::chrono::steady_clock::now();
+
+  WriteLock lock(mutex_);
+  expire(connection.since);
+  auto& idle = idle_[path];
+  if (idle.size() >= FLAGS_thrift_client_pool_size) {
+    closeConnection(connection);
+    return;
+  }
+  idle.push_back(std::move(connection));
+}
+
+void ExtensionConnectionPool::close(const std::string& path) {
+  WriteLock lock(mutex_);
+  auto it = idle_.find(path);
+  if (it == idle_.end()) {
+    return;
+  }
+
+  for (auto& connection : it->second) {
+    closeConnection(connection);
+  }
+  idle_.erase(it);
+}
+
+size_t ExtensionConnectionPool::size(const std::string& path) {
+  WriteLock lock(mutex_);
+  auto it = idle_.find(path);
+  return (it == idle_.end()) ? 0 : it->second.size();
+}
+
+void ExtensionConnectionPool::expire() {
+  auto now = std::chrono::steady_clock::now();
+
+  WriteLock lock(mutex_);
+  expire(now);
+}
+
+void ExtensionConnectionPool::expire(
+    std::chrono::steady_clock::time_point now) {
+  for (auto it = idle_.begin(); it != idle_.end();) {
+    auto& idle = it->second;
+    while (!idle.empty() && now - idle.front().since >= kClientIdleTimeout) {
+      closeConnection(idle.front());
+      idle.pop_front();
+    }
+    it = idle.empty() ? idle_.erase(it) : std::next(it);
+  }
+}
+
 void ExtensionHandler::ping(extensions::ExtensionStatus& _return) {
   auto s = ExtensionInterface::ping();
   _return.code = (int)extensions::ExtensionCode::EXT_SUCCESS;
@@ -212,6 +391,49 @@ void ExtensionHandler::call(extensions::ExtensionResponse& _return,
   }
 }
 
+void ExtensionHandler::generateTable(
+    extensions::ExtensionTablePage& _return,
+    const std::string& item,
+    const extensions::ExtensionPluginRequest& request) {
+  PluginRequest plugin_request;
+  for (const auto& request_item : request) {
+    plugin_request[request_item.first] = request_item.second;
+  }
+
+  TablePage page;
+  auto s = ExtensionInterface::generateTable(item, plugin_request, page);
+  _return.status.code = s.getCode();
+  _return.status.message = s.getMessage();
+  _return.status.uuid = getUUID();
+  if (!s.ok()) {
+    return;
+  }
+
+  // Move each column's values into the response, the page is discarded.
+  _return.rows = static_cast<int64_t>(page.rows());
+  _return.columns.reserve(page.columns().size());
+  for (auto& column : page.columns()) {
+    _return.columns.emplace_back();
+    auto& ext_column = _return.columns.back();
+    ext_column.name = column.name;
+    ext_column.nulls = std::move(column.nulls);
+    switch (column.storage) {
+    case TablePage::Storage::Integer:
+      ext_column.type = extensions::ExtensionColumnType::EXT_COLUMN_INTEGER;
+      ext_column.integer_values = std::move(column.integers);
+      break;
+    case TablePage::Storage::Double:
+      ext_column.type = extensions::ExtensionColumnType::EXT_COLUMN_DOUBLE;
+      ext_column.double_values = std::move(column.doubles);
+      break;
+    case TablePage::Storage::Text:
+      ext_column.type = extensions::ExtensionColumnType::EXT_COLUMN_TEXT;
+      ext_column.text_values = std::move(column.text);
+      break;
+    }
+  }
+}
+
 void ExtensionHandler::shutdown() {}
 
 RouteUUID ExtensionHandler::getUUID() const {
@@ -342,15 +564,33 @@ void ExtensionRunnerInterface::connect() {
   server_->transport = std::make_shared<TPlatformServerSocket>(
       path_, bufsize, TPIPE_SERVER_MAX_CONNS_DEFAULT, securityDescriptor);
 #else
-  server_->transport = std::make_shared<TPlatformServerSocket>(path_);
+  auto server_socket = std::make_shared<TPlatformServerSocket>(path_);
+  if (FLAGS_thrift_server_threads > 0) {
+    // Pooled clients keep connections open, each one holds a worker thread.
+    // Close the idle connections so they cannot hold every worker.
+    server_socket->setRecvTimeout(static_cast<int>(kServerIdleTimeout * 1000));
+  }
+  server_->transport = server_socket;
 #endif
 
   // Construct the service's transport, protocol, thread pool.
   auto transport_fac = std::make_shared<TBufferedTransportFactory>();
   auto protocol_fac = std::make_shared<TBinaryProtocolFactory>();
 
-  server_->server = std::make_shared<TThreadedServer>(
-      server_->processor, server_->transport, transport_fac, protocol_fac);
+  if (FLAGS_thrift_server_threads == 0) {
+    server_->server = std::make_shared<TThreadedServer>(
+        server_->processor, server_->transport, transport_fac, protocol_fac);
+  } else {
+    auto thread_manager =
+        ThreadManager::newSimpleThreadManager(FLAGS_thrift_server_threads);
+    thread_manager->threadFactory(std::make_shared<ThreadFactory>());
+    thread_manager->start();
+    server_->server = std::make_shared<TThreadPoolServer>(server_->processor,
+                                                          server_->transport,
+                                                          transport_fac,
+                                                          protocol_fac,
+                                                          thread_manager);
+  }
 
   server_->server_event_handler = std::make_shared<ThriftServerEventHandler>();
   server_->server->setServerEventHandler(server_->server_event_handler);
@@ -398,8 +638,17 @@ void ExtensionClientCore::init(const std::string& path, bool manager) {
   manager_ = manager;
 
   client_ = std::make_unique<ImplExtensionClient>();
-  client_->socket = std::make_shared<TPlatformSocket>(path);
-  client_->transport = std::make_shared<TBufferedTransport>(client_->socket);
+  client_->exceptions = std::uncaught_exceptions();
+
+  IdleConnection connection;
+  bool pooled = ExtensionConnectionPool::get().acquire(path, connection);
+  if (pooled) {
+    client_->socket = std::move(connection.socket);
+    client_->transport = std::move(connection.transport);
+  } else {
+    client_->socket = std::make_shared<TPlatformSocket>(path);
+    client_->transport = std::make_shared<TBufferedTransport>(client_->socket);
+  }
   auto protocol = std::make_shared<TBinaryProtocol>(client_->transport);
 
   if (!manager_) {
@@ -409,15 +658,41 @@ void ExtensionClientCore::init(const std::string& path, bool manager) {
         std::make_shared<extensions::ExtensionManagerClient>(protocol);
   }
 
-  (void)client_->transport->open();
+  if (!pooled) {
+    (void)client_->transport->open();
+#ifndef WIN32
+    // Pooled connections outlive the call, do not leak them into children.
+    ::fcntl(client_->socket->getSocketFD(), F_SETFD, FD_CLOEXEC);
+#endif
+  }
 }
 
 ExtensionClientCore::~ExtensionClientCore() {
-  try {
-    client_->transport->close();
-  } catch (const std::exception& /* e */) {
-    // The transport/socket may have exited.
+  if (client_ == nullptr || client_->transport == nullptr) {
+    return;
   }
+
+  IdleConnection connection{client_->socket, client_->transport, {}};
+  // A call that threw may have left a partial message on the connection.
+  bool interrupted = std::uncaught_exceptions() > client_->exceptions;
+  if (interrupted || !client_->transport->isOpen() ||
+      FLAGS_thrift_client_pool_size == 0) {
+    closeConnection(connection);
+    return;
+  }
+  ExtensionConnectionPool::get().release(path_, std::move(connection));
+}
+
+void ExtensionClientCore::closeConnections(const std::string& path) {
+  ExtensionConnectionPool::get().close(path);
+}
+
+size_t ExtensionClientCore::idleConnections(const std::string& path) {
+  return ExtensionConnectionPool::get().size(path);
+}
+
+void ExtensionClientCore::expireConnections() {
+  ExtensionConnectionPool::get().expire();
 }
 
 void ExtensionClientCore::setTimeouts(size_t timeouts) {
@@ -467,6 +742,62 @@ Status ExtensionClient::call(const std::string& registry,
   return Status(er.status.code, er.status.message);
 }
 
+Status ExtensionClient::generateTable(const std::string& item,
+                                      const PluginRequest& request,
+                                      TablePage& page) {
+  extensions::ExtensionTablePage ep;
+  auto client = manager() ? client_->em : client_->e;
+  try {
+    client->generateTable(ep, item, request);
+  } catch (const TApplicationException& e) {
+    if (e.getType() == TApplicationException::UNKNOWN_METHOD) {
+      // The extension was built with an SDK that only implements call.
+      return Status(kExtensionUnsupportedCode, e.what());
+    }
+    throw;
+  }
+
+  if (ep.status.code != (int)extensions::ExtensionCode::EXT_SUCCESS) {
+    return Status(ep.status.code, ep.status.message);
+  }
+
+  if (ep.rows < 0) {
+    return Status::failure("Extension table page has a negative row count");
+  }
+
+  page.clear();
+  page.setRows(static_cast<size_t>(ep.rows));
+  for (auto& ext_column : ep.columns) {
+    switch (ext_column.type) {
+    case extensions::ExtensionColumnType::EXT_COLUMN_INTEGER: {
+      auto& column =
+          page.addColumn(ext_column.name, TablePage::Storage::Integer);
+      column.integers = std::move(ext_column.integer_values);
+      column.nulls = std::move(ext_column.nulls);
+      break;
+    }
+    case extensions::ExtensionColumnType::EXT_COLUMN_DOUBLE: {
+      auto& column =
+          page.addColumn(ext_column.name, TablePage::Storage::Double);
+      column.doubles = std::move(ext_column.double_values);
+      column.nulls = std::move(ext_column.nulls);
+      break;
+    }
+    case extensions::ExtensionColumnType::EXT_COLUMN_TEXT: {
+      auto& column = page.addColumn(ext_column.name, TablePage::Storage::Text);
+      column.text = std::move(ext_column.text_values);
+      column.nulls = std::move(ext_column.nulls);
+      break;
+    }
+    default:
+      return Status::failure("Extension table column " + ext_column.name +
+                             " has an unknown type");
+    }
+  }
+
+  return page.validate();
+}
+
 void ExtensionClient::shutdown() {
   auto client = manager() ? client_->em : client_->e;
   client->shutdown();
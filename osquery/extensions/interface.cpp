@@ -15,6 +15,7 @@
 #include <osquery/core/core.h>
 #include <osquery/core/shutdown.h>
 #include <osquery/core/system.h>
+#include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
 #include <osquery/registry/registry_factory.h>
@@ -23,9 +24,14 @@
 #include "osquery/extensions/interface.h"
 
 #include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tryto.h>
 #include <osquery/utils/info/platform_type.h>
 #include <osquery/utils/info/version.h>
 
+#ifdef __linux__
+#include <osquery/worker/ipc/linux/shared_ring_channel.h>
+#endif
+
 using chrono_clock = std::chrono::high_resolution_clock;
 
 namespace osquery {
@@ -34,6 +40,63 @@ const std::vector<std::string> kSDKVersionChanges = {
     {"1.7.7"},
 };
 
+const std::string kSharedRingPidKey{"shared_ring_pid"};
+const std::string kSharedRingFdKey{"shared_ring_fd"};
+const std::string kSharedRingEndMessage{"E"};
+
+namespace {
+
+#ifdef __linux__
+/// Rows of a page written to a shared ring in each message.
+const size_t kSharedRingMessageRows{4096};
+
+/**
+ * @brief Write a page's rows to the shared ring named by a request.
+ *
+ * On success the page keeps its row count and loses its columns, which were
+ * already read from the ring. If the ring cannot be opened the page is kept
+ * whole and answered through Thrift instead.
+ */
+Status writeSharedRing(const std::string& item,
+                       const std::string& pid,
+                       const std::string& fd,
+                       TablePage& page) {
+  auto ring_pid = tryTo<int>(pid, 10);
+  auto ring_fd = tryTo<int>(fd, 10);
+  if (ring_pid.isError() || ring_fd.isError()) {
+    return Status::failure("Invalid shared ring for table " + item);
+  }
+
+  std::unique_ptr<SharedRingChannel> ring;
+  auto status = SharedRingChannel::open(
+      item, ring_pid.get(), ring_fd.get(), ring);
+  if (!status.ok()) {
+    VLOG(1) << "Cannot open the shared ring of table " << item << ": "
+            << status.getMessage();
+    return Status::success();
+  }
+
+  std::string message;
+  for (size_t row = 0; row < page.rows(); row += kSharedRingMessageRows) {
+    message.clear();
+    page.encode(row, row + kSharedRingMessageRows, message);
+    status = ring->sendStringMessage(message);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  status = ring->sendStringMessage(kSharedRingEndMessage);
+  if (!status.ok()) {
+    return status;
+  }
+  page.columns().clear();
+  return Status::success();
+}
+#endif
+
+} // namespace
+
 class UuidGenerator {
  public:
   uint16_t getUuid() {
@@ -82,6 +145,42 @@ Status ExtensionInterface::call(const std::string& registry,
   return RegistryFactory::call(registry, local_item, request, response);
 }
 
+Status ExtensionInterface::generateTable(const std::string& item,
+                                         const PluginRequest& request,
+                                         TablePage& page) {
+  auto local_item = RegistryFactory::get().getAlias("table", item);
+  if (local_item.empty()) {
+    local_item = item;
+  }
+
+  auto plugin = RegistryFactory::get().plugin("table", local_item);
+  auto table = std::dynamic_pointer_cast<TablePlugin>(plugin);
+  if (table == nullptr) {
+    return Status::failure("Cannot generate table: " + item);
+  }
+
+  auto pid = request.find(kSharedRingPidKey);
+  auto fd = request.find(kSharedRingFdKey);
+  if (pid == request.end() || fd == request.end()) {
+    return table->generatePage(request, page);
+  }
+
+  // The table only sees its own request keys.
+  auto table_request = request;
+  table_request.erase(kSharedRingPidKey);
+  table_request.erase(kSharedRingFdKey);
+  auto status = table->generatePage(table_request, page);
+  if (!status.ok()) {
+    return status;
+  }
+
+#ifdef __linux__
+  return writeSharedRing(item, pid->second, fd->second, page);
+#else
+  return status;
+#endif
+}
+
 void ExtensionInterface::shutdown() {
   // Request a graceful shutdown of the Thrift listener.
   VLOG(1) << "Extension " << uuid_ << " requested shutdown";
@@ -166,6 +265,7 @@ Status ExtensionManagerInterface::deregisterExtension(RouteUUID uuid) {
 
   // On success return the uuid of the now de-registered extension.
   RegistryFactory::get().removeBroadcast(uuid);
+  setExtensionTableSupport(uuid, true);
 
   WriteLock lock(extensions_mutex_);
   extensions_.erase(uuid);
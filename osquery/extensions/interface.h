@@ -34,6 +34,19 @@ enum class ExtensionCode {
   EXT_FATAL = 2,
 };
 
+/**
+ * @brief Request keys naming a shared memory ring for generateTable.
+ *
+ * When a request includes both, the extension writes the page's rows to the
+ * ring followed by kSharedRingEndMessage, and answers generateTable with only
+ * the row count. An extension that cannot open the ring answers with the page.
+ */
+extern const std::string kSharedRingPidKey;
+extern const std::string kSharedRingFdKey;
+
+/// The message written to a shared ring after the last rows of a page.
+extern const std::string kSharedRingEndMessage;
+
 using OptionList = std::map<std::string, Option>;
 using ExtensionRouteTable = std::map<std::string, PluginResponse>;
 using ExtensionRegistry = std::map<std::string, ExtensionRouteTable>;
@@ -59,6 +72,9 @@ class ExtensionAPI {
                       const std::string& item,
                       const PluginRequest& request,
                       PluginResponse& response) = 0;
+  virtual Status generateTable(const std::string& item,
+                               const PluginRequest& request,
+                               TablePage& page) = 0;
   virtual void shutdown() = 0;
 };
 
@@ -96,6 +112,9 @@ class ExtensionInterface : public ExtensionAPI {
                       const std::string& item,
                       const PluginRequest& request,
                       PluginResponse& response) override;
+  virtual Status generateTable(const std::string& item,
+                               const PluginRequest& request,
+                               TablePage& page) override;
   virtual void shutdown() override;
 
  protected:
@@ -328,6 +347,27 @@ class ExtensionClientCore : private boost::noncopyable {
   /// Check if the client is an extension manager.
   bool manager();
 
+  /**
+   * @brief Close the idle connections kept open to a socket path.
+   *
+   * Clients return their connection to a pool when destroyed, such that the
+   * next client to the same path does not connect again. See the
+   * thrift_client_pool_size flag.
+   */
+  static void closeConnections(const std::string& path);
+
+  /// Number of idle connections kept open to a socket path.
+  static size_t idleConnections(const std::string& path);
+
+  /**
+   * @brief Close the pooled connections that were idle for too long.
+   *
+   * Clients expire connections when they take or return one. Without new
+   * calls an idle connection would stay open, and hold a worker of a thread
+   * pool server, so the extension watchers also expire them on an interval.
+   */
+  static void expireConnections();
+
  protected:
   /// Path to extension server socket.
   std::string path_;
@@ -366,6 +406,16 @@ class ExtensionClient : public ExtensionClientCore, public ExtensionAPI {
               const PluginRequest& request,
               PluginResponse& response) override;
 
+  /**
+   * @brief Generate an extension's table rows as typed columns.
+   *
+   * @return kExtensionUnsupportedCode if the extension was built with an SDK
+   * that does not implement generateTable.
+   */
+  Status generateTable(const std::string& item,
+                       const PluginRequest& request,
+                       TablePage& page) override;
+
   /// Request that the extension stop.
   void shutdown() override;
 };
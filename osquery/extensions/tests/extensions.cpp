@@ -16,9 +16,12 @@
 
 #include <gtest/gtest.h>
 
+#include <osquery/core/tables.h>
 #include <osquery/extensions/extensions.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/registry/registry_factory.h>
+#include <osquery/sql/dynamic_table_row.h>
+#include <osquery/sql/sql.h>
 
 #include <osquery/utils/info/platform_type.h>
 
@@ -34,6 +37,10 @@ namespace fs = boost::filesystem;
 namespace osquery {
 
 DECLARE_string(extensions_require);
+DECLARE_string(extensions_socket);
+DECLARE_uint32(thrift_server_threads);
+DECLARE_bool(extensions_shared_memory);
+DECLARE_uint64(extensions_shared_memory_size);
 
 const int kDelay = 20;
 const int kTimeout = 3000;
@@ -199,6 +206,65 @@ TEST_F(ExtensionsTest, test_extension_start) {
   rf.allowDuplicates(false);
 }
 
+TEST_F(ExtensionsTest, test_extension_client_pool) {
+  auto status = startExtensionManager(socket_path);
+  ASSERT_TRUE(status.ok());
+  EXPECT_TRUE(socketExistsLocal(socket_path));
+
+  // The connection used by a client is kept open for the next client.
+  EXPECT_TRUE(ping());
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 1U);
+  EXPECT_TRUE(ping());
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 1U);
+
+  {
+    // Clients in use at the same time each take a connection.
+    ExtensionManagerClient first(socket_path);
+    ExtensionManagerClient second(socket_path);
+    EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 0U);
+    EXPECT_TRUE(first.ping().ok());
+    EXPECT_TRUE(second.ping().ok());
+  }
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 2U);
+
+  // The watchers expire connections idle for longer than the timeout only.
+  ExtensionClientCore::expireConnections();
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 2U);
+
+  ExtensionClientCore::closeConnections(socket_path);
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 0U);
+
+  // A connection the server closed is not reused.
+  EXPECT_TRUE(ping());
+  resetDispatcher();
+  EXPECT_FALSE(ping(1));
+  EXPECT_EQ(ExtensionClientCore::idleConnections(socket_path), 0U);
+}
+
+TEST_F(ExtensionsTest, test_extension_thread_pool_server) {
+  auto server_threads = FLAGS_thrift_server_threads;
+  FLAGS_thrift_server_threads = 2;
+
+  auto status = startExtensionManager(socket_path);
+  ASSERT_TRUE(status.ok());
+  EXPECT_TRUE(socketExistsLocal(socket_path));
+
+  {
+    // Each open connection is served by one of the workers.
+    ExtensionManagerClient first(socket_path);
+    ExtensionManagerClient second(socket_path);
+    EXPECT_TRUE(first.ping().ok());
+    EXPECT_TRUE(second.ping().ok());
+  }
+
+  // Workers are reused by the pooled connections.
+  EXPECT_TRUE(ping());
+  EXPECT_TRUE(ping());
+
+  ExtensionClientCore::closeConnections(socket_path);
+  FLAGS_thrift_server_threads = server_threads;
+}
+
 class ExtensionPlugin : public Plugin {
  public:
   Status call(const PluginRequest& request, PluginResponse& response) {
@@ -287,4 +353,320 @@ TEST_F(ExtensionsTest, test_extension_broadcast) {
   rf.allowDuplicates(false);
 }
 
+class PageTablePlugin : public TablePlugin {
+ private:
+  TableColumns columns() const override {
+    return {
+        std::make_tuple("id", INTEGER_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("size", BIGINT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("ratio", DOUBLE_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("name", TEXT_TYPE, ColumnOptions::DEFAULT),
+    };
+  }
+
+  TableRows generate(QueryContext& context) override {
+    TableRows results;
+    results.push_back(make_table_row(
+        {{"id", "1"}, {"size", "0x10"}, {"ratio", "0.5"}, {"name", "one"}}));
+    results.push_back(make_table_row({{"id", "two"}, {"size", ""}}));
+    return results;
+  }
+};
+
+TEST_F(ExtensionsTest, test_extension_generate_table) {
+  auto status = startExtensionManager(socket_path);
+  EXPECT_TRUE(status.ok());
+
+  auto& rf = RegistryFactory::get();
+  rf.registry("table")->add("page_test", std::make_shared<PageTablePlugin>());
+  rf.allowDuplicates(true);
+
+  status = startExtension(socket_path, "test", "0.1", "0.0.0", "0.0.0");
+  ASSERT_TRUE(status.ok());
+
+  RouteUUID uuid;
+  try {
+    uuid = (RouteUUID)stoi(status.getMessage(), nullptr, 0);
+  } catch (const std::exception& /* e */) {
+    EXPECT_TRUE(false);
+    return;
+  }
+
+  auto ext_socket = socket_path + "." + std::to_string(uuid);
+  TablePage page;
+  status = generateExtensionTable(
+      ext_socket, "page_test", {{"action", "generate"}}, page);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  ASSERT_EQ(page.rows(), 2U);
+
+  // Each column name is sent once, and values keep their declared type.
+  const auto* id = page.column("id");
+  ASSERT_NE(id, nullptr);
+  EXPECT_EQ(id->storage, TablePage::Storage::Integer);
+  EXPECT_EQ(id->integers[0], 1);
+  EXPECT_FALSE(TablePage::isNull(*id, 0));
+  EXPECT_TRUE(TablePage::isNull(*id, 1));
+
+  const auto* size = page.column("size");
+  ASSERT_NE(size, nullptr);
+  EXPECT_EQ(size->storage, TablePage::Storage::Integer);
+  EXPECT_EQ(size->integers[0], 16);
+  EXPECT_TRUE(TablePage::isNull(*size, 1));
+
+  const auto* ratio = page.column("ratio");
+  ASSERT_NE(ratio, nullptr);
+  EXPECT_EQ(ratio->storage, TablePage::Storage::Double);
+  EXPECT_DOUBLE_EQ(ratio->doubles[0], 0.5);
+
+  const auto* name = page.column("name");
+  ASSERT_NE(name, nullptr);
+  EXPECT_EQ(name->storage, TablePage::Storage::Text);
+  EXPECT_EQ(name->text[0], "one");
+  EXPECT_TRUE(TablePage::isNull(*name, 1));
+
+  Row expected = {
+      {"id", "1"}, {"size", "16"}, {"ratio", "0.5"}, {"name", "one"}};
+  EXPECT_EQ(page.toRow(0), expected);
+
+  // Only tables can be generated as pages.
+  status = generateExtensionTable(
+      ext_socket, "not_a_table", {{"action", "generate"}}, page);
+  EXPECT_FALSE(status.ok());
+  EXPECT_NE(status.getCode(), kExtensionUnsupportedCode);
+
+  rf.removeBroadcast(uuid);
+  rf.registry("table")->remove("page_test");
+  rf.allowDuplicates(false);
+}
+
+class SQLPageTablePlugin : public TablePlugin {
+ public:
+  /// Generate values of other types than the ones attached to SQLite.
+  static bool change_types;
+
+  /// Rows from call are marked, rows from generateTable are not.
+  Status call(const PluginRequest& request, PluginResponse& response) override {
+    auto status = TablePlugin::call(request, response);
+    if (request.at("action") == "generate") {
+      for (auto& row : response) {
+        row["source"] = "call";
+      }
+    }
+    return status;
+  }
+
+ private:
+  TableColumns columns() const override {
+    return {
+        std::make_tuple("id", INTEGER_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("size", BIGINT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("ratio",
+                        change_types ? TEXT_TYPE : DOUBLE_TYPE,
+                        ColumnOptions::DEFAULT),
+        std::make_tuple("name", TEXT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("label",
+                        change_types ? BIGINT_TYPE : TEXT_TYPE,
+                        ColumnOptions::DEFAULT),
+        std::make_tuple("source", TEXT_TYPE, ColumnOptions::DEFAULT),
+    };
+  }
+
+  ColumnAliasSet columnAliases() const override {
+    return {{"name", {"title"}}};
+  }
+
+  TableRows generate(QueryContext& context) override {
+    TableRows results;
+    results.push_back(make_table_row({{"id", "1"},
+                                      {"size", "0x10"},
+                                      {"ratio", "0.5"},
+                                      {"name", "one"},
+                                      {"label", "7"},
+                                      {"source", "page"}}));
+    results.push_back(
+        make_table_row({{"id", "two"}, {"size", ""}, {"source", "page"}}));
+    return results;
+  }
+};
+
+bool SQLPageTablePlugin::change_types{false};
+
+TEST_F(ExtensionsTest, test_extension_table_sql) {
+  // Extension tables are called through the default socket path.
+  auto extensions_socket = FLAGS_extensions_socket;
+  FLAGS_extensions_socket = socket_path;
+
+  auto status = startExtensionManager(socket_path);
+  EXPECT_TRUE(status.ok());
+
+  // The local plugin is only reached through the extension by its alias.
+  auto& rf = RegistryFactory::get();
+  rf.registry("table")->add("sql_page_source",
+                            std::make_shared<SQLPageTablePlugin>());
+  rf.addAlias("table", "sql_page_source", "sql_page_test");
+  rf.allowDuplicates(true);
+
+  status = startExtension(socket_path, "test", "0.1", "0.0.0", "0.0.0");
+  ASSERT_TRUE(status.ok());
+
+  RouteUUID uuid;
+  try {
+    uuid = (RouteUUID)stoi(status.getMessage(), nullptr, 0);
+  } catch (const std::exception& /* e */) {
+    EXPECT_TRUE(false);
+    return;
+  }
+  ASSERT_FALSE(rf.exists("table", "sql_page_test", true));
+  ASSERT_TRUE(rf.exists("table", "sql_page_test"));
+
+  const std::string query =
+      "select id, typeof(id) as id_type, size, ratio, typeof(ratio) as "
+      "ratio_type, name, title, label, typeof(label) as label_type, source "
+      "from sql_page_test";
+  SQL results(query);
+  ASSERT_TRUE(results.ok()) << results.getMessageString();
+  ASSERT_EQ(results.rows().size(), 2U);
+
+  // Typed values are read from the page, aliases read their target column.
+  auto first = results.rows()[0];
+  EXPECT_EQ(first["id"], "1");
+  EXPECT_EQ(first["id_type"], "integer");
+  EXPECT_EQ(first["size"], "16");
+  EXPECT_EQ(first["ratio"], "0.5");
+  EXPECT_EQ(first["ratio_type"], "real");
+  EXPECT_EQ(first["name"], "one");
+  EXPECT_EQ(first["title"], "one");
+  EXPECT_EQ(first["label"], "7");
+  EXPECT_EQ(first["label_type"], "text");
+  EXPECT_EQ(first["source"], "page");
+
+  // Values that do not fit the column type and missing columns are null.
+  auto second = results.rows()[1];
+  EXPECT_EQ(second["id_type"], "null");
+  EXPECT_EQ(second["ratio_type"], "null");
+  EXPECT_EQ(second["title"], "");
+
+  // Page values of another type are cast to the attached column type.
+  SQLPageTablePlugin::change_types = true;
+  SQL changed(query);
+  ASSERT_TRUE(changed.ok()) << changed.getMessageString();
+  ASSERT_EQ(changed.rows().size(), 2U);
+  first = changed.rows()[0];
+  EXPECT_EQ(first["ratio"], "0.5");
+  EXPECT_EQ(first["ratio_type"], "real");
+  EXPECT_EQ(first["label"], "7");
+  EXPECT_EQ(first["label_type"], "text");
+  EXPECT_EQ(first["source"], "page");
+  SQLPageTablePlugin::change_types = false;
+
+  // Extensions without generateTable are called for rows instead.
+  setExtensionTableSupport(uuid, false);
+  SQL legacy(query);
+  ASSERT_TRUE(legacy.ok()) << legacy.getMessageString();
+  ASSERT_EQ(legacy.rows().size(), 2U);
+  first = legacy.rows()[0];
+  EXPECT_EQ(first["id_type"], "integer");
+  EXPECT_EQ(first["size"], "16");
+  EXPECT_EQ(first["title"], "one");
+  EXPECT_EQ(first["source"], "call");
+  EXPECT_EQ(legacy.rows()[1]["source"], "call");
+
+  rf.removeBroadcast(uuid);
+  setExtensionTableSupport(uuid, true);
+  rf.registry("table")->remove("sql_page_source");
+  rf.allowDuplicates(false);
+  FLAGS_extensions_socket = extensions_socket;
+}
+
+#ifdef OSQUERY_LINUX
+class LargePageTablePlugin : public TablePlugin {
+ public:
+  static constexpr size_t kRows{50000};
+
+ private:
+  TableColumns columns() const override {
+    return {
+        std::make_tuple("id", BIGINT_TYPE, ColumnOptions::DEFAULT),
+        std::make_tuple("path", TEXT_TYPE, ColumnOptions::DEFAULT),
+    };
+  }
+
+  TableRows generate(QueryContext& context) override {
+    TableRows results;
+    for (size_t i = 0; i < kRows; ++i) {
+      auto id = std::to_string(i);
+      results.push_back(make_table_row(
+          {{"id", id}, {"path", "/usr/lib/osquery/shared/" + id}}));
+    }
+    return results;
+  }
+};
+
+TEST_F(ExtensionsTest, test_extension_generate_table_shared_memory) {
+  auto shared_memory = FLAGS_extensions_shared_memory;
+  auto shared_memory_size = FLAGS_extensions_shared_memory_size;
+  FLAGS_extensions_shared_memory = true;
+  // The page is larger than the ring, the extension waits for it to drain.
+  FLAGS_extensions_shared_memory_size = 1;
+
+  auto status = startExtensionManager(socket_path);
+  EXPECT_TRUE(status.ok());
+
+  auto& rf = RegistryFactory::get();
+  rf.registry("table")->add("page_test", std::make_shared<PageTablePlugin>());
+  rf.registry("table")->add("large_page_test",
+                            std::make_shared<LargePageTablePlugin>());
+  rf.allowDuplicates(true);
+
+  status = startExtension(socket_path, "test", "0.1", "0.0.0", "0.0.0");
+  ASSERT_TRUE(status.ok());
+
+  RouteUUID uuid;
+  try {
+    uuid = (RouteUUID)stoi(status.getMessage(), nullptr, 0);
+  } catch (const std::exception& /* e */) {
+    EXPECT_TRUE(false);
+    return;
+  }
+
+  auto ext_socket = socket_path + "." + std::to_string(uuid);
+  TablePage page;
+  status = generateExtensionTable(
+      ext_socket, "page_test", {{"action", "generate"}}, page);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  ASSERT_EQ(page.rows(), 2U);
+  ASSERT_TRUE(page.validate().ok());
+
+  // Values and nulls are the same as through Thrift.
+  Row expected = {
+      {"id", "1"}, {"size", "16"}, {"ratio", "0.5"}, {"name", "one"}};
+  EXPECT_EQ(page.toRow(0), expected);
+  const auto* id = page.column("id");
+  ASSERT_NE(id, nullptr);
+  EXPECT_EQ(id->storage, TablePage::Storage::Integer);
+  EXPECT_TRUE(TablePage::isNull(*id, 1));
+
+  status = generateExtensionTable(
+      ext_socket, "large_page_test", {{"action", "generate"}}, page);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  ASSERT_EQ(page.rows(), LargePageTablePlugin::kRows);
+  ASSERT_TRUE(page.validate().ok());
+  Row last = {{"id", "49999"}, {"path", "/usr/lib/osquery/shared/49999"}};
+  EXPECT_EQ(page.toRow(LargePageTablePlugin::kRows - 1), last);
+
+  // Failures are returned the same as through Thrift.
+  status = generateExtensionTable(
+      ext_socket, "not_a_table", {{"action", "generate"}}, page);
+  EXPECT_FALSE(status.ok());
+
+  rf.removeBroadcast(uuid);
+  rf.registry("table")->remove("page_test");
+  rf.registry("table")->remove("large_page_test");
+  rf.allowDuplicates(false);
+
+  FLAGS_extensions_shared_memory = shared_memory;
+  FLAGS_extensions_shared_memory_size = shared_memory_size;
+}
+#endif
+
 } // namespace osquery
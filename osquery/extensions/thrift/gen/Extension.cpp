@@ -205,16 +205,16 @@ uint32_t Extension_call_args::read(::apache::thrift::protocol::TProtocol* iprot)
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             this->request.clear();
-            uint32_t _size34;
-            ::apache::thrift::protocol::TType _ktype35;
-            ::apache::thrift::protocol::TType _vtype36;
-            xfer += iprot->readMapBegin(_ktype35, _vtype36, _size34);
-            uint32_t _i38;
-            for (_i38 = 0; _i38 < _size34; ++_i38) {
-              std::string _key39;
-              xfer += iprot->readString(_key39);
-              std::string& _val40 = this->request[_key39];
-              xfer += iprot->readString(_val40);
+            uint32_t _size73;
+            ::apache::thrift::protocol::TType _ktype74;
+            ::apache::thrift::protocol::TType _vtype75;
+            xfer += iprot->readMapBegin(_ktype74, _vtype75, _size73);
+            uint32_t _i77;
+            for (_i77 = 0; _i77 < _size73; ++_i77) {
+              std::string _key78;
+              xfer += iprot->readString(_key78);
+              std::string& _val79 = this->request[_key78];
+              xfer += iprot->readString(_val79);
             }
             xfer += iprot->readMapEnd();
           }
@@ -251,11 +251,11 @@ uint32_t Extension_call_args::write(::apache::thrift::protocol::TProtocol* oprot
   xfer += oprot->writeFieldBegin("request", ::apache::thrift::protocol::T_MAP, 3);
   {
     xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_STRING, static_cast<uint32_t>(this->request.size()));
-    std::map<std::string, std::string>::const_iterator _iter41;
-    for (_iter41 = this->request.begin(); _iter41 != this->request.end();
-         ++_iter41) {
-      xfer += oprot->writeString(_iter41->first);
-      xfer += oprot->writeString(_iter41->second);
+    std::map<std::string, std::string>::const_iterator _iter80;
+    for (_iter80 = this->request.begin(); _iter80 != this->request.end();
+         ++_iter80) {
+      xfer += oprot->writeString(_iter80->first);
+      xfer += oprot->writeString(_iter80->second);
     }
     xfer += oprot->writeMapEnd();
   }
@@ -284,12 +284,12 @@ uint32_t Extension_call_pargs::write(::apache::thrift::protocol::TProtocol* opro
   xfer += oprot->writeFieldBegin("request", ::apache::thrift::protocol::T_MAP, 3);
   {
     xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_STRING, static_cast<uint32_t>((*(this->request)).size()));
-    std::map<std::string, std::string>::const_iterator _iter42;
-    for (_iter42 = (*(this->request)).begin();
-         _iter42 != (*(this->request)).end();
-         ++_iter42) {
-      xfer += oprot->writeString(_iter42->first);
-      xfer += oprot->writeString(_iter42->second);
+    std::map<std::string, std::string>::const_iterator _iter81;
+    for (_iter81 = (*(this->request)).begin();
+         _iter81 != (*(this->request)).end();
+         ++_iter81) {
+      xfer += oprot->writeString(_iter81->first);
+      xfer += oprot->writeString(_iter81->second);
     }
     xfer += oprot->writeMapEnd();
   }
@@ -402,6 +402,230 @@ uint32_t Extension_call_presult::read(::apache::thrift::protocol::TProtocol* ipr
   return xfer;
 }
 
+Extension_generateTable_args::~Extension_generateTable_args() noexcept {}
+
+uint32_t Extension_generateTable_args::read(::apache::thrift::protocol::TProtocol* iprot) {
+
+  ::apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+  uint32_t xfer = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using ::apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == ::apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == ::apache::thrift::protocol::T_STRING) {
+          xfer += iprot->readString(this->item);
+          this->__isset.item = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 2:
+        if (ftype == ::apache::thrift::protocol::T_MAP) {
+          {
+            this->request.clear();
+            uint32_t _size82;
+            ::apache::thrift::protocol::TType _ktype83;
+            ::apache::thrift::protocol::TType _vtype84;
+            xfer += iprot->readMapBegin(_ktype83, _vtype84, _size82);
+            uint32_t _i86;
+            for (_i86 = 0; _i86 < _size82; ++_i86) {
+              std::string _key87;
+              xfer += iprot->readString(_key87);
+              std::string& _val88 = this->request[_key87];
+              xfer += iprot->readString(_val88);
+            }
+            xfer += iprot->readMapEnd();
+          }
+          this->__isset.request = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t Extension_generateTable_args::write(::apache::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  ::apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+  xfer += oprot->writeStructBegin("Extension_generateTable_args");
+
+  xfer += oprot->writeFieldBegin("item", ::apache::thrift::protocol::T_STRING, 1);
+  xfer += oprot->writeString(this->item);
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("request", ::apache::thrift::protocol::T_MAP, 2);
+  {
+    xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_STRING, static_cast<uint32_t>(this->request.size()));
+    std::map<std::string, std::string>::const_iterator _iter89;
+    for (_iter89 = this->request.begin(); _iter89 != this->request.end();
+         ++_iter89) {
+      xfer += oprot->writeString(_iter89->first);
+      xfer += oprot->writeString(_iter89->second);
+    }
+    xfer += oprot->writeMapEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+Extension_generateTable_pargs::~Extension_generateTable_pargs() noexcept {}
+
+uint32_t Extension_generateTable_pargs::write(::apache::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  ::apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+  xfer += oprot->writeStructBegin("Extension_generateTable_pargs");
+
+  xfer += oprot->writeFieldBegin("item", ::apache::thrift::protocol::T_STRING, 1);
+  xfer += oprot->writeString((*(this->item)));
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("request", ::apache::thrift::protocol::T_MAP, 2);
+  {
+    xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_STRING, static_cast<uint32_t>((*(this->request)).size()));
+    std::map<std::string, std::string>::const_iterator _iter90;
+    for (_iter90 = (*(this->request)).begin();
+         _iter90 != (*(this->request)).end();
+         ++_iter90) {
+      xfer += oprot->writeString(_iter90->first);
+      xfer += oprot->writeString(_iter90->second);
+    }
+    xfer += oprot->writeMapEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+Extension_generateTable_result::~Extension_generateTable_result() noexcept {}
+
+uint32_t Extension_generateTable_result::read(::apache::thrift::protocol::TProtocol* iprot) {
+
+  ::apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+  uint32_t xfer = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using ::apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == ::apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+          xfer += this->success.read(iprot);
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t Extension_generateTable_result::write(::apache::thrift::protocol::TProtocol* oprot) const {
+
+  uint32_t xfer = 0;
+
+  xfer += oprot->writeStructBegin("Extension_generateTable_result");
+
+  if (this->__isset.success) {
+    xfer += oprot->writeFieldBegin("success", ::apache::thrift::protocol::T_STRUCT, 0);
+    xfer += this->success.write(oprot);
+    xfer += oprot->writeFieldEnd();
+  }
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+Extension_generateTable_presult::~Extension_generateTable_presult() noexcept {}
+
+uint32_t Extension_generateTable_presult::read(::apache::thrift::protocol::TProtocol* iprot) {
+
+  ::apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+  uint32_t xfer = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using ::apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == ::apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 0:
+        if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+          xfer += (*(this->success)).read(iprot);
+          this->__isset.success = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
 Extension_shutdown_args::~Extension_shutdown_args() noexcept {}
 
 uint32_t Extension_shutdown_args::read(::apache::thrift::protocol::TProtocol* iprot) {
@@ -642,6 +866,65 @@ void ExtensionClient::recv_call(ExtensionResponse& _return)
   throw ::apache::thrift::TApplicationException(::apache::thrift::TApplicationException::MISSING_RESULT, "call failed: unknown result");
 }
 
+void ExtensionClient::generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request)
+{
+  send_generateTable(item, request);
+  recv_generateTable(_return);
+}
+
+void ExtensionClient::send_generateTable(const std::string& item, const ExtensionPluginRequest& request)
+{
+  int32_t cseqid = 0;
+  oprot_->writeMessageBegin("generateTable", ::apache::thrift::protocol::T_CALL, cseqid);
+
+  Extension_generateTable_pargs args;
+  args.item = &item;
+  args.request = &request;
+  args.write(oprot_);
+
+  oprot_->writeMessageEnd();
+  oprot_->getTransport()->writeEnd();
+  oprot_->getTransport()->flush();
+}
+
+void ExtensionClient::recv_generateTable(ExtensionTablePage& _return)
+{
+
+  int32_t rseqid = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TMessageType mtype;
+
+  iprot_->readMessageBegin(fname, mtype, rseqid);
+  if (mtype == ::apache::thrift::protocol::T_EXCEPTION) {
+    ::apache::thrift::TApplicationException x;
+    x.read(iprot_);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+    throw x;
+  }
+  if (mtype != ::apache::thrift::protocol::T_REPLY) {
+    iprot_->skip(::apache::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+  }
+  if (fname.compare("generateTable") != 0) {
+    iprot_->skip(::apache::thrift::protocol::T_STRUCT);
+    iprot_->readMessageEnd();
+    iprot_->getTransport()->readEnd();
+  }
+  Extension_generateTable_presult result;
+  result.success = &_return;
+  result.read(iprot_);
+  iprot_->readMessageEnd();
+  iprot_->getTransport()->readEnd();
+
+  if (result.__isset.success) {
+    // _return pointer has now been filled
+    return;
+  }
+  throw ::apache::thrift::TApplicationException(::apache::thrift::TApplicationException::MISSING_RESULT, "generateTable failed: unknown result");
+}
+
 void ExtensionClient::shutdown()
 {
   send_shutdown();
@@ -821,6 +1104,60 @@ void ExtensionProcessor::process_call(int32_t seqid, ::apache::thrift::protocol:
   }
 }
 
+void ExtensionProcessor::process_generateTable(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext)
+{
+  void* ctx = NULL;
+  if (this->eventHandler_.get() != NULL) {
+    ctx = this->eventHandler_->getContext("Extension.generateTable", callContext);
+  }
+  ::apache::thrift::TProcessorContextFreer freer(this->eventHandler_.get(), ctx, "Extension.generateTable");
+
+  if (this->eventHandler_.get() != NULL) {
+    this->eventHandler_->preRead(ctx, "Extension.generateTable");
+  }
+
+  Extension_generateTable_args args;
+  args.read(iprot);
+  iprot->readMessageEnd();
+  uint32_t bytes = iprot->getTransport()->readEnd();
+
+  if (this->eventHandler_.get() != NULL) {
+    this->eventHandler_->postRead(ctx, "Extension.generateTable", bytes);
+  }
+
+  Extension_generateTable_result result;
+  try {
+    iface_->generateTable(result.success, args.item, args.request);
+    result.__isset.success = true;
+  } catch (const std::exception& e) {
+    if (this->eventHandler_.get() != NULL) {
+      this->eventHandler_->handlerError(ctx, "Extension.generateTable");
+    }
+
+    ::apache::thrift::TApplicationException x(e.what());
+    oprot->writeMessageBegin("generateTable", ::apache::thrift::protocol::T_EXCEPTION, seqid);
+    x.write(oprot);
+    oprot->writeMessageEnd();
+    oprot->getTransport()->writeEnd();
+    oprot->getTransport()->flush();
+    return;
+  }
+
+  if (this->eventHandler_.get() != NULL) {
+    this->eventHandler_->preWrite(ctx, "Extension.generateTable");
+  }
+
+  oprot->writeMessageBegin("generateTable", ::apache::thrift::protocol::T_REPLY, seqid);
+  result.write(oprot);
+  oprot->writeMessageEnd();
+  bytes = oprot->getTransport()->writeEnd();
+  oprot->getTransport()->flush();
+
+  if (this->eventHandler_.get() != NULL) {
+    this->eventHandler_->postWrite(ctx, "Extension.generateTable", bytes);
+  }
+}
+
 void ExtensionProcessor::process_shutdown(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext)
 {
   void* ctx = NULL;
@@ -1056,6 +1393,92 @@ void ExtensionConcurrentClient::recv_call(ExtensionResponse& _return, const int3
   } // end while(true)
 }
 
+void ExtensionConcurrentClient::generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request)
+{
+  int32_t seqid = send_generateTable(item, request);
+  recv_generateTable(_return, seqid);
+}
+
+int32_t ExtensionConcurrentClient::send_generateTable(const std::string& item, const ExtensionPluginRequest& request)
+{
+  int32_t cseqid = this->sync_->generateSeqId();
+  ::apache::thrift::async::TConcurrentSendSentry sentry(this->sync_.get());
+  oprot_->writeMessageBegin("generateTable", ::apache::thrift::protocol::T_CALL, cseqid);
+
+  Extension_generateTable_pargs args;
+  args.item = &item;
+  args.request = &request;
+  args.write(oprot_);
+
+  oprot_->writeMessageEnd();
+  oprot_->getTransport()->writeEnd();
+  oprot_->getTransport()->flush();
+
+  sentry.commit();
+  return cseqid;
+}
+
+void ExtensionConcurrentClient::recv_generateTable(ExtensionTablePage& _return, const int32_t seqid)
+{
+
+  int32_t rseqid = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TMessageType mtype;
+
+  // the read mutex gets dropped and reacquired as part of waitForWork()
+  // The destructor of this sentry wakes up other clients
+  ::apache::thrift::async::TConcurrentRecvSentry sentry(this->sync_.get(),
+                                                        seqid);
+
+  while(true) {
+    if (!this->sync_->getPending(fname, mtype, rseqid)) {
+      iprot_->readMessageBegin(fname, mtype, rseqid);
+    }
+    if(seqid == rseqid) {
+      if (mtype == ::apache::thrift::protocol::T_EXCEPTION) {
+        ::apache::thrift::TApplicationException x;
+        x.read(iprot_);
+        iprot_->readMessageEnd();
+        iprot_->getTransport()->readEnd();
+        sentry.commit();
+        throw x;
+      }
+      if (mtype != ::apache::thrift::protocol::T_REPLY) {
+        iprot_->skip(::apache::thrift::protocol::T_STRUCT);
+        iprot_->readMessageEnd();
+        iprot_->getTransport()->readEnd();
+      }
+      if (fname.compare("generateTable") != 0) {
+        iprot_->skip(::apache::thrift::protocol::T_STRUCT);
+        iprot_->readMessageEnd();
+        iprot_->getTransport()->readEnd();
+
+        // in a bad state, don't commit
+        using ::apache::thrift::protocol::TProtocolException;
+        throw TProtocolException(TProtocolException::INVALID_DATA);
+      }
+      Extension_generateTable_presult result;
+      result.success = &_return;
+      result.read(iprot_);
+      iprot_->readMessageEnd();
+      iprot_->getTransport()->readEnd();
+
+      if (result.__isset.success) {
+        // _return pointer has now been filled
+        sentry.commit();
+        return;
+      }
+      // in a bad state, don't commit
+      throw ::apache::thrift::TApplicationException(::apache::thrift::TApplicationException::MISSING_RESULT, "generateTable failed: unknown result");
+    }
+    // seqid != rseqid
+    this->sync_->updatePending(fname, mtype, rseqid);
+
+    // this will temporarily unlock the readMutex, and let other clients get work done
+    this->sync_->waitForWork(seqid);
+  } // end while(true)
+}
+
 void ExtensionConcurrentClient::shutdown()
 {
   int32_t seqid = send_shutdown();
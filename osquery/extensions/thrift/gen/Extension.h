@@ -24,6 +24,7 @@ class ExtensionIf {
   virtual ~ExtensionIf() {}
   virtual void ping(ExtensionStatus& _return) = 0;
   virtual void call(ExtensionResponse& _return, const std::string& registry, const std::string& item, const ExtensionPluginRequest& request) = 0;
+  virtual void generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request) = 0;
   virtual void shutdown() = 0;
 };
 
@@ -61,6 +62,9 @@ class ExtensionNull : virtual public ExtensionIf {
   void call(ExtensionResponse& /* _return */, const std::string& /* registry */, const std::string& /* item */, const ExtensionPluginRequest& /* request */) {
     return;
   }
+  void generateTable(ExtensionTablePage& /* _return */, const std::string& /* item */, const ExtensionPluginRequest& /* request */) {
+    return;
+  }
   void shutdown() {
     return;
   }
@@ -277,6 +281,118 @@ class Extension_call_presult {
 };
 
 
+typedef struct _Extension_generateTable_args__isset {
+  _Extension_generateTable_args__isset() : item(false), request(false) {}
+  bool item :1;
+  bool request :1;
+} _Extension_generateTable_args__isset;
+
+class Extension_generateTable_args {
+ public:
+
+  Extension_generateTable_args(const Extension_generateTable_args&);
+  Extension_generateTable_args(Extension_generateTable_args&&);
+  Extension_generateTable_args& operator=(const Extension_generateTable_args&);
+  Extension_generateTable_args& operator=(Extension_generateTable_args&&);
+  Extension_generateTable_args() : item() {
+  }
+
+  virtual ~Extension_generateTable_args() noexcept;
+  std::string item;
+  ExtensionPluginRequest request;
+
+  _Extension_generateTable_args__isset __isset;
+
+  void __set_item(const std::string& val);
+
+  void __set_request(const ExtensionPluginRequest& val);
+
+  bool operator == (const Extension_generateTable_args & rhs) const
+  {
+    if (!(item == rhs.item))
+      return false;
+    if (!(request == rhs.request))
+      return false;
+    return true;
+  }
+  bool operator != (const Extension_generateTable_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const Extension_generateTable_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+
+class Extension_generateTable_pargs {
+ public:
+  virtual ~Extension_generateTable_pargs() noexcept;
+  const std::string* item;
+  const ExtensionPluginRequest* request;
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _Extension_generateTable_result__isset {
+  _Extension_generateTable_result__isset() : success(false) {}
+  bool success :1;
+} _Extension_generateTable_result__isset;
+
+class Extension_generateTable_result {
+ public:
+
+  Extension_generateTable_result(const Extension_generateTable_result&);
+  Extension_generateTable_result(Extension_generateTable_result&&);
+  Extension_generateTable_result& operator=(const Extension_generateTable_result&);
+  Extension_generateTable_result& operator=(Extension_generateTable_result&&);
+  Extension_generateTable_result() {
+  }
+
+  virtual ~Extension_generateTable_result() noexcept;
+  ExtensionTablePage success;
+
+  _Extension_generateTable_result__isset __isset;
+
+  void __set_success(const ExtensionTablePage& val);
+
+  bool operator == (const Extension_generateTable_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    return true;
+  }
+  bool operator != (const Extension_generateTable_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const Extension_generateTable_result & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _Extension_generateTable_presult__isset {
+  _Extension_generateTable_presult__isset() : success(false) {}
+  bool success :1;
+} _Extension_generateTable_presult__isset;
+
+class Extension_generateTable_presult {
+ public:
+  virtual ~Extension_generateTable_presult() noexcept;
+  ExtensionTablePage* success;
+
+  _Extension_generateTable_presult__isset __isset;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+
+};
+
+
 class Extension_shutdown_args {
  public:
 
@@ -388,6 +504,9 @@ class ExtensionClient : virtual public ExtensionIf {
   void call(ExtensionResponse& _return, const std::string& registry, const std::string& item, const ExtensionPluginRequest& request);
   void send_call(const std::string& registry, const std::string& item, const ExtensionPluginRequest& request);
   void recv_call(ExtensionResponse& _return);
+  void generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request);
+  void send_generateTable(const std::string& item, const ExtensionPluginRequest& request);
+  void recv_generateTable(ExtensionTablePage& _return);
   void shutdown();
   void send_shutdown();
   void recv_shutdown();
@@ -408,11 +527,13 @@ class ExtensionProcessor : public ::apache::thrift::TDispatchProcessor {
   ProcessMap processMap_;
   void process_ping(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_call(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_generateTable(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_shutdown(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
  public:
   ExtensionProcessor(::std::shared_ptr<ExtensionIf> iface) : iface_(iface) {
     processMap_["ping"] = &ExtensionProcessor::process_ping;
     processMap_["call"] = &ExtensionProcessor::process_call;
+    processMap_["generateTable"] = &ExtensionProcessor::process_generateTable;
     processMap_["shutdown"] = &ExtensionProcessor::process_shutdown;
   }
 
@@ -465,6 +586,16 @@ class ExtensionMultiface : virtual public ExtensionIf {
     return;
   }
 
+  void generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->generateTable(_return, item, request);
+    }
+    ifaces_[i]->generateTable(_return, item, request);
+    return;
+  }
+
   void shutdown() {
     size_t sz = ifaces_.size();
     size_t i = 0;
@@ -522,6 +653,9 @@ class ExtensionConcurrentClient : virtual public ExtensionIf {
   void call(ExtensionResponse& _return, const std::string& registry, const std::string& item, const ExtensionPluginRequest& request);
   int32_t send_call(const std::string& registry, const std::string& item, const ExtensionPluginRequest& request);
   void recv_call(ExtensionResponse& _return, const int32_t seqid);
+  void generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request);
+  int32_t send_generateTable(const std::string& item, const ExtensionPluginRequest& request);
+  void recv_generateTable(ExtensionTablePage& _return, const int32_t seqid);
   void shutdown();
   int32_t send_shutdown();
   void recv_shutdown(const int32_t seqid);
@@ -90,16 +90,16 @@ uint32_t ExtensionManager_extensions_result::read(::apache::thrift::protocol::TP
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             this->success.clear();
-            uint32_t _size43;
-            ::apache::thrift::protocol::TType _ktype44;
-            ::apache::thrift::protocol::TType _vtype45;
-            xfer += iprot->readMapBegin(_ktype44, _vtype45, _size43);
-            uint32_t _i47;
-            for (_i47 = 0; _i47 < _size43; ++_i47) {
-              ExtensionRouteUUID _key48;
-              xfer += iprot->readI64(_key48);
-              InternalExtensionInfo& _val49 = this->success[_key48];
-              xfer += _val49.read(iprot);
+            uint32_t _size91;
+            ::apache::thrift::protocol::TType _ktype92;
+            ::apache::thrift::protocol::TType _vtype93;
+            xfer += iprot->readMapBegin(_ktype92, _vtype93, _size91);
+            uint32_t _i95;
+            for (_i95 = 0; _i95 < _size91; ++_i95) {
+              ExtensionRouteUUID _key96;
+              xfer += iprot->readI64(_key96);
+              InternalExtensionInfo& _val97 = this->success[_key96];
+              xfer += _val97.read(iprot);
             }
             xfer += iprot->readMapEnd();
           }
@@ -131,11 +131,11 @@ uint32_t ExtensionManager_extensions_result::write(::apache::thrift::protocol::T
     {
       xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_I64, ::apache::thrift::protocol::T_STRUCT, static_cast<uint32_t>(this->success.size()));
       std::map<ExtensionRouteUUID, InternalExtensionInfo>::const_iterator
-          _iter50;
-      for (_iter50 = this->success.begin(); _iter50 != this->success.end();
-           ++_iter50) {
-        xfer += oprot->writeI64(_iter50->first);
-        xfer += _iter50->second.write(oprot);
+          _iter98;
+      for (_iter98 = this->success.begin(); _iter98 != this->success.end();
+           ++_iter98) {
+        xfer += oprot->writeI64(_iter98->first);
+        xfer += _iter98->second.write(oprot);
       }
       xfer += oprot->writeMapEnd();
     }
@@ -174,16 +174,16 @@ uint32_t ExtensionManager_extensions_presult::read(::apache::thrift::protocol::T
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             (*(this->success)).clear();
-            uint32_t _size51;
-            ::apache::thrift::protocol::TType _ktype52;
-            ::apache::thrift::protocol::TType _vtype53;
-            xfer += iprot->readMapBegin(_ktype52, _vtype53, _size51);
-            uint32_t _i55;
-            for (_i55 = 0; _i55 < _size51; ++_i55) {
-              ExtensionRouteUUID _key56;
-              xfer += iprot->readI64(_key56);
-              InternalExtensionInfo& _val57 = (*(this->success))[_key56];
-              xfer += _val57.read(iprot);
+            uint32_t _size99;
+            ::apache::thrift::protocol::TType _ktype100;
+            ::apache::thrift::protocol::TType _vtype101;
+            xfer += iprot->readMapBegin(_ktype100, _vtype101, _size99);
+            uint32_t _i103;
+            for (_i103 = 0; _i103 < _size99; ++_i103) {
+              ExtensionRouteUUID _key104;
+              xfer += iprot->readI64(_key104);
+              InternalExtensionInfo& _val105 = (*(this->success))[_key104];
+              xfer += _val105.read(iprot);
             }
             xfer += iprot->readMapEnd();
           }
@@ -283,16 +283,16 @@ uint32_t ExtensionManager_options_result::read(::apache::thrift::protocol::TProt
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             this->success.clear();
-            uint32_t _size58;
-            ::apache::thrift::protocol::TType _ktype59;
-            ::apache::thrift::protocol::TType _vtype60;
-            xfer += iprot->readMapBegin(_ktype59, _vtype60, _size58);
-            uint32_t _i62;
-            for (_i62 = 0; _i62 < _size58; ++_i62) {
-              std::string _key63;
-              xfer += iprot->readString(_key63);
-              InternalOptionInfo& _val64 = this->success[_key63];
-              xfer += _val64.read(iprot);
+            uint32_t _size106;
+            ::apache::thrift::protocol::TType _ktype107;
+            ::apache::thrift::protocol::TType _vtype108;
+            xfer += iprot->readMapBegin(_ktype107, _vtype108, _size106);
+            uint32_t _i110;
+            for (_i110 = 0; _i110 < _size106; ++_i110) {
+              std::string _key111;
+              xfer += iprot->readString(_key111);
+              InternalOptionInfo& _val112 = this->success[_key111];
+              xfer += _val112.read(iprot);
             }
             xfer += iprot->readMapEnd();
           }
@@ -323,11 +323,11 @@ uint32_t ExtensionManager_options_result::write(::apache::thrift::protocol::TPro
     xfer += oprot->writeFieldBegin("success", ::apache::thrift::protocol::T_MAP, 0);
     {
       xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_STRUCT, static_cast<uint32_t>(this->success.size()));
-      std::map<std::string, InternalOptionInfo>::const_iterator _iter65;
-      for (_iter65 = this->success.begin(); _iter65 != this->success.end();
-           ++_iter65) {
-        xfer += oprot->writeString(_iter65->first);
-        xfer += _iter65->second.write(oprot);
+      std::map<std::string, InternalOptionInfo>::const_iterator _iter113;
+      for (_iter113 = this->success.begin(); _iter113 != this->success.end();
+           ++_iter113) {
+        xfer += oprot->writeString(_iter113->first);
+        xfer += _iter113->second.write(oprot);
       }
       xfer += oprot->writeMapEnd();
     }
@@ -366,16 +366,16 @@ uint32_t ExtensionManager_options_presult::read(::apache::thrift::protocol::TPro
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             (*(this->success)).clear();
-            uint32_t _size66;
-            ::apache::thrift::protocol::TType _ktype67;
-            ::apache::thrift::protocol::TType _vtype68;
-            xfer += iprot->readMapBegin(_ktype67, _vtype68, _size66);
-            uint32_t _i70;
-            for (_i70 = 0; _i70 < _size66; ++_i70) {
-              std::string _key71;
-              xfer += iprot->readString(_key71);
-              InternalOptionInfo& _val72 = (*(this->success))[_key71];
-              xfer += _val72.read(iprot);
+            uint32_t _size114;
+            ::apache::thrift::protocol::TType _ktype115;
+            ::apache::thrift::protocol::TType _vtype116;
+            xfer += iprot->readMapBegin(_ktype115, _vtype116, _size114);
+            uint32_t _i118;
+            for (_i118 = 0; _i118 < _size114; ++_i118) {
+              std::string _key119;
+              xfer += iprot->readString(_key119);
+              InternalOptionInfo& _val120 = (*(this->success))[_key119];
+              xfer += _val120.read(iprot);
             }
             xfer += iprot->readMapEnd();
           }
@@ -432,47 +432,47 @@ uint32_t ExtensionManager_registerExtension_args::read(::apache::thrift::protoco
         if (ftype == ::apache::thrift::protocol::T_MAP) {
           {
             this->registry.clear();
-            uint32_t _size73;
-            ::apache::thrift::protocol::TType _ktype74;
-            ::apache::thrift::protocol::TType _vtype75;
-            xfer += iprot->readMapBegin(_ktype74, _vtype75, _size73);
-            uint32_t _i77;
-            for (_i77 = 0; _i77 < _size73; ++_i77) {
-              std::string _key78;
-              xfer += iprot->readString(_key78);
-              ExtensionRouteTable& _val79 = this->registry[_key78];
+            uint32_t _size121;
+            ::apache::thrift::protocol::TType _ktype122;
+            ::apache::thrift::protocol::TType _vtype123;
+            xfer += iprot->readMapBegin(_ktype122, _vtype123, _size121);
+            uint32_t _i125;
+            for (_i125 = 0; _i125 < _size121; ++_i125) {
+              std::string _key126;
+              xfer += iprot->readString(_key126);
+              ExtensionRouteTable& _val127 = this->registry[_key126];
               {
-                _val79.clear();
-                uint32_t _size80;
-                ::apache::thrift::protocol::TType _ktype81;
-                ::apache::thrift::protocol::TType _vtype82;
-                xfer += iprot->readMapBegin(_ktype81, _vtype82, _size80);
-                uint32_t _i84;
-                for (_i84 = 0; _i84 < _size80; ++_i84) {
-                  std::string _key85;
-                  xfer += iprot->readString(_key85);
-                  ExtensionPluginResponse& _val86 = _val79[_key85];
+                _val127.clear();
+                uint32_t _size128;
+                ::apache::thrift::protocol::TType _ktype129;
+                ::apache::thrift::protocol::TType _vtype130;
+                xfer += iprot->readMapBegin(_ktype129, _vtype130, _size128);
+                uint32_t _i132;
+                for (_i132 = 0; _i132 < _size128; ++_i132) {
+                  std::string _key133;
+                  xfer += iprot->readString(_key133);
+                  ExtensionPluginResponse& _val134 = _val127[_key133];
                   {
-                    _val86.clear();
-                    uint32_t _size87;
-                    ::apache::thrift::protocol::TType _etype90;
-                    xfer += iprot->readListBegin(_etype90, _size87);
-                    _val86.resize(_size87);
-                    uint32_t _i91;
-                    for (_i91 = 0; _i91 < _size87; ++_i91) {
+                    _val134.clear();
+                    uint32_t _size135;
+                    ::apache::thrift::protocol::TType _etype138;
+                    xfer += iprot->readListBegin(_etype138, _size135);
+                    _val134.resize(_size135);
+                    uint32_t _i139;
+                    for (_i139 = 0; _i139 < _size135; ++_i139) {
                       {
-                        _val86[_i91].clear();
-                        uint32_t _size92;
-                        ::apache::thrift::protocol::TType _ktype93;
-                        ::apache::thrift::protocol::TType _vtype94;
+                        _val134[_i139].clear();
+                        uint32_t _size140;
+                        ::apache::thrift::protocol::TType _ktype141;
+                        ::apache::thrift::protocol::TType _vtype142;
                         xfer +=
-                            iprot->readMapBegin(_ktype93, _vtype94, _size92);
-                        uint32_t _i96;
-                        for (_i96 = 0; _i96 < _size92; ++_i96) {
-                          std::string _key97;
-                          xfer += iprot->readString(_key97);
-                          std::string& _val98 = _val86[_i91][_key97];
-                          xfer += iprot->readString(_val98);
+                            iprot->readMapBegin(_ktype141, _vtype142, _size140);
+                        uint32_t _i144;
+                        for (_i144 = 0; _i144 < _size140; ++_i144) {
+                          std::string _key145;
+                          xfer += iprot->readString(_key145);
+                          std::string& _val146 = _val134[_i139][_key145];
+                          xfer += iprot->readString(_val146);
                         }
                         xfer += iprot->readMapEnd();
                       }
@@ -514,40 +514,40 @@ uint32_t ExtensionManager_registerExtension_args::write(::apache::thrift::protoc
   xfer += oprot->writeFieldBegin("registry", ::apache::thrift::protocol::T_MAP, 2);
   {
     xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_MAP, static_cast<uint32_t>(this->registry.size()));
-    std::map<std::string, ExtensionRouteTable>::const_iterator _iter99;
-    for (_iter99 = this->registry.begin(); _iter99 != this->registry.end();
-         ++_iter99) {
-      xfer += oprot->writeString(_iter99->first);
+    std::map<std::string, ExtensionRouteTable>::const_iterator _iter147;
+    for (_iter147 = this->registry.begin(); _iter147 != this->registry.end();
+         ++_iter147) {
+      xfer += oprot->writeString(_iter147->first);
       {
         xfer +=
             oprot->writeMapBegin(::apache::thrift::protocol::T_STRING,
                                  ::apache::thrift::protocol::T_LIST,
-                                 static_cast<uint32_t>(_iter99->second.size()));
-        std::map<std::string, ExtensionPluginResponse>::const_iterator _iter100;
-        for (_iter100 = _iter99->second.begin();
-             _iter100 != _iter99->second.end();
-             ++_iter100) {
-          xfer += oprot->writeString(_iter100->first);
+                                 static_cast<uint32_t>(_iter147->second.size()));
+        std::map<std::string, ExtensionPluginResponse>::const_iterator _iter148;
+        for (_iter148 = _iter147->second.begin();
+             _iter148 != _iter147->second.end();
+             ++_iter148) {
+          xfer += oprot->writeString(_iter148->first);
           {
             xfer += oprot->writeListBegin(
                 ::apache::thrift::protocol::T_MAP,
-                static_cast<uint32_t>(_iter100->second.size()));
+                static_cast<uint32_t>(_iter148->second.size()));
             std::vector<std::map<std::string, std::string>>::const_iterator
-                _iter101;
-            for (_iter101 = _iter100->second.begin();
-                 _iter101 != _iter100->second.end();
-                 ++_iter101) {
+                _iter149;
+            for (_iter149 = _iter148->second.begin();
+                 _iter149 != _iter148->second.end();
+                 ++_iter149) {
               {
                 xfer += oprot->writeMapBegin(
                     ::apache::thrift::protocol::T_STRING,
                     ::apache::thrift::protocol::T_STRING,
-                    static_cast<uint32_t>((*_iter101).size()));
-                std::map<std::string, std::string>::const_iterator _iter102;
-                for (_iter102 = (*_iter101).begin();
-                     _iter102 != (*_iter101).end();
-                     ++_iter102) {
-                  xfer += oprot->writeString(_iter102->first);
-                  xfer += oprot->writeString(_iter102->second);
+                    static_cast<uint32_t>((*_iter149).size()));
+                std::map<std::string, std::string>::const_iterator _iter150;
+                for (_iter150 = (*_iter149).begin();
+                     _iter150 != (*_iter149).end();
+                     ++_iter150) {
+                  xfer += oprot->writeString(_iter150->first);
+                  xfer += oprot->writeString(_iter150->second);
                 }
                 xfer += oprot->writeMapEnd();
               }
@@ -582,41 +582,41 @@ uint32_t ExtensionManager_registerExtension_pargs::write(::apache::thrift::proto
   xfer += oprot->writeFieldBegin("registry", ::apache::thrift::protocol::T_MAP, 2);
   {
     xfer += oprot->writeMapBegin(::apache::thrift::protocol::T_STRING, ::apache::thrift::protocol::T_MAP, static_cast<uint32_t>((*(this->registry)).size()));
-    std::map<std::string, ExtensionRouteTable>::const_iterator _iter103;
-    for (_iter103 = (*(this->registry)).begin();
-         _iter103 != (*(this->registry)).end();
-         ++_iter103) {
-      xfer += oprot->writeString(_iter103->first);
+    std::map<std::string, ExtensionRouteTable>::const_iterator _iter151;
+    for (_iter151 = (*(this->registry)).begin();
+         _iter151 != (*(this->registry)).end();
+         ++_iter151) {
+      xfer += oprot->writeString(_iter151->first);
       {
         xfer += oprot->writeMapBegin(
             ::apache::thrift::protocol::T_STRING,
             ::apache::thrift::protocol::T_LIST,
-            static_cast<uint32_t>(_iter103->second.size()));
-        std::map<std::string, ExtensionPluginResponse>::const_iterator _iter104;
-        for (_iter104 = _iter103->second.begin();
-             _iter104 != _iter103->second.end();
-             ++_iter104) {
-          xfer += oprot->writeString(_iter104->first);
+            static_cast<uint32_t>(_iter151->second.size()));
+        std::map<std::string, ExtensionPluginResponse>::const_iterator _iter152;
+        for (_iter152 = _iter151->second.begin();
+             _iter152 != _iter151->second.end();
+             ++_iter152) {
+          xfer += oprot->writeString(_iter152->first);
           {
             xfer += oprot->writeListBegin(
                 ::apache::thrift::protocol::T_MAP,
-                static_cast<uint32_t>(_iter104->second.size()));
+                static_cast<uint32_t>(_iter152->second.size()));
             std::vector<std::map<std::string, std::string>>::const_iterator
-                _iter105;
-            for (_iter105 = _iter104->second.begin();
-                 _iter105 != _iter104->second.end();
-                 ++_iter105) {
+                _iter153;
+            for (_iter153 = _iter152->second.begin();
+                 _iter153 != _iter152->second.end();
+                 ++_iter153) {
               {
                 xfer += oprot->writeMapBegin(
                     ::apache::thrift::protocol::T_STRING,
                     ::apache::thrift::protocol::T_STRING,
-                    static_cast<uint32_t>((*_iter105).size()));
-                std::map<std::string, std::string>::const_iterator _iter106;
-                for (_iter106 = (*_iter105).begin();
-                     _iter106 != (*_iter105).end();
-                     ++_iter106) {
-                  xfer += oprot->writeString(_iter106->first);
-                  xfer += oprot->writeString(_iter106->second);
+                    static_cast<uint32_t>((*_iter153).size()));
+                std::map<std::string, std::string>::const_iterator _iter154;
+                for (_iter154 = (*_iter153).begin();
+                     _iter154 != (*_iter153).end();
+                     ++_iter154) {
+                  xfer += oprot->writeString(_iter154->first);
+                  xfer += oprot->writeString(_iter154->second);
                 }
                 xfer += oprot->writeMapEnd();
               }
@@ -30,6 +30,11 @@ class ExtensionHandler : virtual public ExtensionIf {
     printf("call\n");
   }
 
+  void generateTable(ExtensionTablePage& _return, const std::string& item, const ExtensionPluginRequest& request) {
+    // Your implementation goes here
+    printf("generateTable\n");
+  }
+
   void shutdown() {
     // Your implementation goes here
     printf("shutdown\n");
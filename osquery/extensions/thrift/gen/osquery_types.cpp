@@ -45,6 +45,38 @@ std::string to_string(const ExtensionCode::type& val) {
   }
 }
 
+int _kExtensionColumnTypeValues[] = {
+  ExtensionColumnType::EXT_COLUMN_TEXT,
+  ExtensionColumnType::EXT_COLUMN_INTEGER,
+  ExtensionColumnType::EXT_COLUMN_DOUBLE
+};
+const char* _kExtensionColumnTypeNames[] = {
+  "EXT_COLUMN_TEXT",
+  "EXT_COLUMN_INTEGER",
+  "EXT_COLUMN_DOUBLE"
+};
+const std::map<int, const char*> _ExtensionColumnType_VALUES_TO_NAMES(::apache::thrift::TEnumIterator(3, _kExtensionColumnTypeValues, _kExtensionColumnTypeNames), ::apache::thrift::TEnumIterator(-1, NULL, NULL));
+
+std::ostream& operator<<(std::ostream& out, const ExtensionColumnType::type& val) {
+  std::map<int, const char*>::const_iterator it = _ExtensionColumnType_VALUES_TO_NAMES.find(val);
+  if (it != _ExtensionColumnType_VALUES_TO_NAMES.end()) {
+    out << it->second;
+  } else {
+    out << static_cast<int>(val);
+  }
+  return out;
+}
+
+std::string to_string(const ExtensionColumnType::type& val) {
+  std::map<int, const char*>::const_iterator it =
+      _ExtensionColumnType_VALUES_TO_NAMES.find(val);
+  if (it != _ExtensionColumnType_VALUES_TO_NAMES.end()) {
+    return std::string(it->second);
+  } else {
+    return std::to_string(static_cast<int>(val));
+  }
+}
+
 InternalOptionInfo::~InternalOptionInfo() noexcept {}
 
 void InternalOptionInfo::__set_value(const std::string& val) {
@@ -662,6 +694,459 @@ void ExtensionResponse::printTo(std::ostream& out) const {
   out << ")";
 }
 
+ExtensionTableColumn::~ExtensionTableColumn() noexcept {}
+
+void ExtensionTableColumn::__set_name(const std::string& val) {
+  this->name = val;
+}
+
+void ExtensionTableColumn::__set_type(const ExtensionColumnType::type val) {
+  this->type = val;
+}
+
+void ExtensionTableColumn::__set_nulls(const std::vector<bool> & val) {
+  this->nulls = val;
+}
+
+void ExtensionTableColumn::__set_text_values(const std::vector<std::string> & val) {
+  this->text_values = val;
+}
+
+void ExtensionTableColumn::__set_integer_values(const std::vector<int64_t> & val) {
+  this->integer_values = val;
+}
+
+void ExtensionTableColumn::__set_double_values(const std::vector<double> & val) {
+  this->double_values = val;
+}
+std::ostream& operator<<(std::ostream& out, const ExtensionTableColumn& obj)
+{
+  obj.printTo(out);
+  return out;
+}
+
+
+uint32_t ExtensionTableColumn::read(::apache::thrift::protocol::TProtocol* iprot) {
+
+  ::apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+  uint32_t xfer = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using ::apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == ::apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == ::apache::thrift::protocol::T_STRING) {
+          xfer += iprot->readString(this->name);
+          this->__isset.name = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 2:
+        if (ftype == ::apache::thrift::protocol::T_I32) {
+          int32_t ecast30;
+          xfer += iprot->readI32(ecast30);
+          this->type = (ExtensionColumnType::type)ecast30;
+          this->__isset.type = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 3:
+        if (ftype == ::apache::thrift::protocol::T_LIST) {
+          {
+            this->nulls.clear();
+            uint32_t _size31;
+            ::apache::thrift::protocol::TType _etype34;
+            xfer += iprot->readListBegin(_etype34, _size31);
+            this->nulls.resize(_size31);
+            uint32_t _i35;
+            for (_i35 = 0; _i35 < _size31; ++_i35)
+            {
+              xfer += iprot->readBool(this->nulls[_i35]);
+            }
+            xfer += iprot->readListEnd();
+          }
+          this->__isset.nulls = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 4:
+        if (ftype == ::apache::thrift::protocol::T_LIST) {
+          {
+            this->text_values.clear();
+            uint32_t _size36;
+            ::apache::thrift::protocol::TType _etype39;
+            xfer += iprot->readListBegin(_etype39, _size36);
+            this->text_values.resize(_size36);
+            uint32_t _i40;
+            for (_i40 = 0; _i40 < _size36; ++_i40)
+            {
+              xfer += iprot->readString(this->text_values[_i40]);
+            }
+            xfer += iprot->readListEnd();
+          }
+          this->__isset.text_values = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 5:
+        if (ftype == ::apache::thrift::protocol::T_LIST) {
+          {
+            this->integer_values.clear();
+            uint32_t _size41;
+            ::apache::thrift::protocol::TType _etype44;
+            xfer += iprot->readListBegin(_etype44, _size41);
+            this->integer_values.resize(_size41);
+            uint32_t _i45;
+            for (_i45 = 0; _i45 < _size41; ++_i45)
+            {
+              xfer += iprot->readI64(this->integer_values[_i45]);
+            }
+            xfer += iprot->readListEnd();
+          }
+          this->__isset.integer_values = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 6:
+        if (ftype == ::apache::thrift::protocol::T_LIST) {
+          {
+            this->double_values.clear();
+            uint32_t _size46;
+            ::apache::thrift::protocol::TType _etype49;
+            xfer += iprot->readListBegin(_etype49, _size46);
+            this->double_values.resize(_size46);
+            uint32_t _i50;
+            for (_i50 = 0; _i50 < _size46; ++_i50)
+            {
+              xfer += iprot->readDouble(this->double_values[_i50]);
+            }
+            xfer += iprot->readListEnd();
+          }
+          this->__isset.double_values = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ExtensionTableColumn::write(::apache::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  ::apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+  xfer += oprot->writeStructBegin("ExtensionTableColumn");
+
+  xfer += oprot->writeFieldBegin("name", ::apache::thrift::protocol::T_STRING, 1);
+  xfer += oprot->writeString(this->name);
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("type", ::apache::thrift::protocol::T_I32, 2);
+  xfer += oprot->writeI32((int32_t)this->type);
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("nulls", ::apache::thrift::protocol::T_LIST, 3);
+  {
+    xfer += oprot->writeListBegin(::apache::thrift::protocol::T_BOOL, static_cast<uint32_t>(this->nulls.size()));
+    std::vector<bool> ::const_iterator _iter51;
+    for (_iter51 = this->nulls.begin(); _iter51 != this->nulls.end(); ++_iter51)
+    {
+      xfer += oprot->writeBool((*_iter51));
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("text_values", ::apache::thrift::protocol::T_LIST, 4);
+  {
+    xfer += oprot->writeListBegin(::apache::thrift::protocol::T_STRING, static_cast<uint32_t>(this->text_values.size()));
+    std::vector<std::string> ::const_iterator _iter52;
+    for (_iter52 = this->text_values.begin(); _iter52 != this->text_values.end(); ++_iter52)
+    {
+      xfer += oprot->writeString((*_iter52));
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("integer_values", ::apache::thrift::protocol::T_LIST, 5);
+  {
+    xfer += oprot->writeListBegin(::apache::thrift::protocol::T_I64, static_cast<uint32_t>(this->integer_values.size()));
+    std::vector<int64_t> ::const_iterator _iter53;
+    for (_iter53 = this->integer_values.begin(); _iter53 != this->integer_values.end(); ++_iter53)
+    {
+      xfer += oprot->writeI64((*_iter53));
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("double_values", ::apache::thrift::protocol::T_LIST, 6);
+  {
+    xfer += oprot->writeListBegin(::apache::thrift::protocol::T_DOUBLE, static_cast<uint32_t>(this->double_values.size()));
+    std::vector<double> ::const_iterator _iter54;
+    for (_iter54 = this->double_values.begin(); _iter54 != this->double_values.end(); ++_iter54)
+    {
+      xfer += oprot->writeDouble((*_iter54));
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+void swap(ExtensionTableColumn &a, ExtensionTableColumn &b) {
+  using ::std::swap;
+  swap(a.name, b.name);
+  swap(a.type, b.type);
+  swap(a.nulls, b.nulls);
+  swap(a.text_values, b.text_values);
+  swap(a.integer_values, b.integer_values);
+  swap(a.double_values, b.double_values);
+  swap(a.__isset, b.__isset);
+}
+
+ExtensionTableColumn::ExtensionTableColumn(const ExtensionTableColumn& other55) {
+  name = other55.name;
+  type = other55.type;
+  nulls = other55.nulls;
+  text_values = other55.text_values;
+  integer_values = other55.integer_values;
+  double_values = other55.double_values;
+  __isset = other55.__isset;
+}
+ExtensionTableColumn::ExtensionTableColumn( ExtensionTableColumn&& other56) {
+  name = std::move(other56.name);
+  type = std::move(other56.type);
+  nulls = std::move(other56.nulls);
+  text_values = std::move(other56.text_values);
+  integer_values = std::move(other56.integer_values);
+  double_values = std::move(other56.double_values);
+  __isset = std::move(other56.__isset);
+}
+ExtensionTableColumn& ExtensionTableColumn::operator=(const ExtensionTableColumn& other57) {
+  name = other57.name;
+  type = other57.type;
+  nulls = other57.nulls;
+  text_values = other57.text_values;
+  integer_values = other57.integer_values;
+  double_values = other57.double_values;
+  __isset = other57.__isset;
+  return *this;
+}
+ExtensionTableColumn& ExtensionTableColumn::operator=(ExtensionTableColumn&& other58) {
+  name = std::move(other58.name);
+  type = std::move(other58.type);
+  nulls = std::move(other58.nulls);
+  text_values = std::move(other58.text_values);
+  integer_values = std::move(other58.integer_values);
+  double_values = std::move(other58.double_values);
+  __isset = std::move(other58.__isset);
+  return *this;
+}
+void ExtensionTableColumn::printTo(std::ostream& out) const {
+  using ::apache::thrift::to_string;
+  out << "ExtensionTableColumn(";
+  out << "name=" << to_string(name);
+  out << ", " << "type=" << to_string(type);
+  out << ", " << "nulls=" << to_string(nulls);
+  out << ", " << "text_values=" << to_string(text_values);
+  out << ", " << "integer_values=" << to_string(integer_values);
+  out << ", " << "double_values=" << to_string(double_values);
+  out << ")";
+}
+
+
+ExtensionTablePage::~ExtensionTablePage() noexcept {}
+
+void ExtensionTablePage::__set_status(const ExtensionStatus& val) {
+  this->status = val;
+}
+
+void ExtensionTablePage::__set_rows(const int64_t val) {
+  this->rows = val;
+}
+
+void ExtensionTablePage::__set_columns(const std::vector<ExtensionTableColumn> & val) {
+  this->columns = val;
+}
+std::ostream& operator<<(std::ostream& out, const ExtensionTablePage& obj)
+{
+  obj.printTo(out);
+  return out;
+}
+
+
+uint32_t ExtensionTablePage::read(::apache::thrift::protocol::TProtocol* iprot) {
+
+  ::apache::thrift::protocol::TInputRecursionTracker tracker(*iprot);
+  uint32_t xfer = 0;
+  std::string fname;
+  ::apache::thrift::protocol::TType ftype;
+  int16_t fid;
+
+  xfer += iprot->readStructBegin(fname);
+
+  using ::apache::thrift::protocol::TProtocolException;
+
+
+  while (true)
+  {
+    xfer += iprot->readFieldBegin(fname, ftype, fid);
+    if (ftype == ::apache::thrift::protocol::T_STOP) {
+      break;
+    }
+    switch (fid)
+    {
+      case 1:
+        if (ftype == ::apache::thrift::protocol::T_STRUCT) {
+          xfer += this->status.read(iprot);
+          this->__isset.status = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 2:
+        if (ftype == ::apache::thrift::protocol::T_I64) {
+          xfer += iprot->readI64(this->rows);
+          this->__isset.rows = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      case 3:
+        if (ftype == ::apache::thrift::protocol::T_LIST) {
+          {
+            this->columns.clear();
+            uint32_t _size59;
+            ::apache::thrift::protocol::TType _etype62;
+            xfer += iprot->readListBegin(_etype62, _size59);
+            this->columns.resize(_size59);
+            uint32_t _i63;
+            for (_i63 = 0; _i63 < _size59; ++_i63)
+            {
+              xfer += this->columns[_i63].read(iprot);
+            }
+            xfer += iprot->readListEnd();
+          }
+          this->__isset.columns = true;
+        } else {
+          xfer += iprot->skip(ftype);
+        }
+        break;
+      default:
+        xfer += iprot->skip(ftype);
+        break;
+    }
+    xfer += iprot->readFieldEnd();
+  }
+
+  xfer += iprot->readStructEnd();
+
+  return xfer;
+}
+
+uint32_t ExtensionTablePage::write(::apache::thrift::protocol::TProtocol* oprot) const {
+  uint32_t xfer = 0;
+  ::apache::thrift::protocol::TOutputRecursionTracker tracker(*oprot);
+  xfer += oprot->writeStructBegin("ExtensionTablePage");
+
+  xfer += oprot->writeFieldBegin("status", ::apache::thrift::protocol::T_STRUCT, 1);
+  xfer += this->status.write(oprot);
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("rows", ::apache::thrift::protocol::T_I64, 2);
+  xfer += oprot->writeI64(this->rows);
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldBegin("columns", ::apache::thrift::protocol::T_LIST, 3);
+  {
+    xfer += oprot->writeListBegin(::apache::thrift::protocol::T_STRUCT, static_cast<uint32_t>(this->columns.size()));
+    std::vector<ExtensionTableColumn> ::const_iterator _iter64;
+    for (_iter64 = this->columns.begin(); _iter64 != this->columns.end(); ++_iter64)
+    {
+      xfer += (*_iter64).write(oprot);
+    }
+    xfer += oprot->writeListEnd();
+  }
+  xfer += oprot->writeFieldEnd();
+
+  xfer += oprot->writeFieldStop();
+  xfer += oprot->writeStructEnd();
+  return xfer;
+}
+
+void swap(ExtensionTablePage &a, ExtensionTablePage &b) {
+  using ::std::swap;
+  swap(a.status, b.status);
+  swap(a.rows, b.rows);
+  swap(a.columns, b.columns);
+  swap(a.__isset, b.__isset);
+}
+
+ExtensionTablePage::ExtensionTablePage(const ExtensionTablePage& other65) {
+  status = other65.status;
+  rows = other65.rows;
+  columns = other65.columns;
+  __isset = other65.__isset;
+}
+ExtensionTablePage::ExtensionTablePage( ExtensionTablePage&& other66) {
+  status = std::move(other66.status);
+  rows = std::move(other66.rows);
+  columns = std::move(other66.columns);
+  __isset = std::move(other66.__isset);
+}
+ExtensionTablePage& ExtensionTablePage::operator=(const ExtensionTablePage& other67) {
+  status = other67.status;
+  rows = other67.rows;
+  columns = other67.columns;
+  __isset = other67.__isset;
+  return *this;
+}
+ExtensionTablePage& ExtensionTablePage::operator=(ExtensionTablePage&& other68) {
+  status = std::move(other68.status);
+  rows = std::move(other68.rows);
+  columns = std::move(other68.columns);
+  __isset = std::move(other68.__isset);
+  return *this;
+}
+void ExtensionTablePage::printTo(std::ostream& out) const {
+  using ::apache::thrift::to_string;
+  out << "ExtensionTablePage(";
+  out << "status=" << to_string(status);
+  out << ", " << "rows=" << to_string(rows);
+  out << ", " << "columns=" << to_string(columns);
+  out << ")";
+}
+
 ExtensionException::~ExtensionException() noexcept {}
 
 void ExtensionException::__set_code(const int32_t val) {
@@ -769,34 +1254,34 @@ void swap(ExtensionException &a, ExtensionException &b) {
   swap(a.__isset, b.__isset);
 }
 
-ExtensionException::ExtensionException(const ExtensionException& other30)
+ExtensionException::ExtensionException(const ExtensionException& other69)
     : TException() {
-  code = other30.code;
-  message = other30.message;
-  uuid = other30.uuid;
-  __isset = other30.__isset;
+  code = other69.code;
+  message = other69.message;
+  uuid = other69.uuid;
+  __isset = other69.__isset;
 }
-ExtensionException::ExtensionException(ExtensionException&& other31)
+ExtensionException::ExtensionException(ExtensionException&& other70)
     : TException() {
-  code = std::move(other31.code);
-  message = std::move(other31.message);
-  uuid = std::move(other31.uuid);
-  __isset = std::move(other31.__isset);
+  code = std::move(other70.code);
+  message = std::move(other70.message);
+  uuid = std::move(other70.uuid);
+  __isset = std::move(other70.__isset);
 }
 ExtensionException& ExtensionException::operator=(
-    const ExtensionException& other32) {
-  code = other32.code;
-  message = other32.message;
-  uuid = other32.uuid;
-  __isset = other32.__isset;
+    const ExtensionException& other71) {
+  code = other71.code;
+  message = other71.message;
+  uuid = other71.uuid;
+  __isset = other71.__isset;
   return *this;
 }
 ExtensionException& ExtensionException::operator=(
-    ExtensionException&& other33) {
-  code = std::move(other33.code);
-  message = std::move(other33.message);
-  uuid = std::move(other33.uuid);
-  __isset = std::move(other33.__isset);
+    ExtensionException&& other72) {
+  code = std::move(other72.code);
+  message = std::move(other72.message);
+  uuid = std::move(other72.uuid);
+  __isset = std::move(other72.__isset);
   return *this;
 }
 void ExtensionException::printTo(std::ostream& out) const {
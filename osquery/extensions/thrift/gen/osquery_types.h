@@ -34,6 +34,20 @@ std::ostream& operator<<(std::ostream& out, const ExtensionCode::type& val);
 
 std::string to_string(const ExtensionCode::type& val);
 
+struct ExtensionColumnType {
+  enum type {
+    EXT_COLUMN_TEXT = 0,
+    EXT_COLUMN_INTEGER = 1,
+    EXT_COLUMN_DOUBLE = 2
+  };
+};
+
+extern const std::map<int, const char*> _ExtensionColumnType_VALUES_TO_NAMES;
+
+std::ostream& operator<<(std::ostream& out, const ExtensionColumnType::type& val);
+
+std::string to_string(const ExtensionColumnType::type& val);
+
 typedef std::map<std::string, std::string>  ExtensionPluginRequest;
 
 typedef std::vector<std::map<std::string, std::string> >  ExtensionPluginResponse;
@@ -56,6 +70,10 @@ class ExtensionStatus;
 
 class ExtensionResponse;
 
+class ExtensionTableColumn;
+
+class ExtensionTablePage;
+
 class ExtensionException;
 
 typedef struct _InternalOptionInfo__isset {
@@ -282,6 +300,136 @@ void swap(ExtensionResponse &a, ExtensionResponse &b);
 
 std::ostream& operator<<(std::ostream& out, const ExtensionResponse& obj);
 
+typedef struct _ExtensionTableColumn__isset {
+  _ExtensionTableColumn__isset() : name(false), type(false), nulls(false), text_values(false), integer_values(false), double_values(false) {}
+  bool name :1;
+  bool type :1;
+  bool nulls :1;
+  bool text_values :1;
+  bool integer_values :1;
+  bool double_values :1;
+} _ExtensionTableColumn__isset;
+
+class ExtensionTableColumn : public virtual ::apache::thrift::TBase {
+ public:
+
+  ExtensionTableColumn(const ExtensionTableColumn&);
+  ExtensionTableColumn(ExtensionTableColumn&&);
+  ExtensionTableColumn& operator=(const ExtensionTableColumn&);
+  ExtensionTableColumn& operator=(ExtensionTableColumn&&);
+  ExtensionTableColumn() : name(), type((ExtensionColumnType::type)0) {
+  }
+
+  virtual ~ExtensionTableColumn() noexcept;
+  std::string name;
+  ExtensionColumnType::type type;
+  std::vector<bool>  nulls;
+  std::vector<std::string>  text_values;
+  std::vector<int64_t>  integer_values;
+  std::vector<double>  double_values;
+
+  _ExtensionTableColumn__isset __isset;
+
+  void __set_name(const std::string& val);
+
+  void __set_type(const ExtensionColumnType::type val);
+
+  void __set_nulls(const std::vector<bool> & val);
+
+  void __set_text_values(const std::vector<std::string> & val);
+
+  void __set_integer_values(const std::vector<int64_t> & val);
+
+  void __set_double_values(const std::vector<double> & val);
+
+  bool operator == (const ExtensionTableColumn & rhs) const
+  {
+    if (!(name == rhs.name))
+      return false;
+    if (!(type == rhs.type))
+      return false;
+    if (!(nulls == rhs.nulls))
+      return false;
+    if (!(text_values == rhs.text_values))
+      return false;
+    if (!(integer_values == rhs.integer_values))
+      return false;
+    if (!(double_values == rhs.double_values))
+      return false;
+    return true;
+  }
+  bool operator != (const ExtensionTableColumn &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ExtensionTableColumn & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  virtual void printTo(std::ostream& out) const;
+};
+
+void swap(ExtensionTableColumn &a, ExtensionTableColumn &b);
+
+std::ostream& operator<<(std::ostream& out, const ExtensionTableColumn& obj);
+
+typedef struct _ExtensionTablePage__isset {
+  _ExtensionTablePage__isset() : status(false), rows(false), columns(false) {}
+  bool status :1;
+  bool rows :1;
+  bool columns :1;
+} _ExtensionTablePage__isset;
+
+class ExtensionTablePage : public virtual ::apache::thrift::TBase {
+ public:
+
+  ExtensionTablePage(const ExtensionTablePage&);
+  ExtensionTablePage(ExtensionTablePage&&);
+  ExtensionTablePage& operator=(const ExtensionTablePage&);
+  ExtensionTablePage& operator=(ExtensionTablePage&&);
+  ExtensionTablePage() : rows(0) {
+  }
+
+  virtual ~ExtensionTablePage() noexcept;
+  ExtensionStatus status;
+  int64_t rows;
+  std::vector<ExtensionTableColumn>  columns;
+
+  _ExtensionTablePage__isset __isset;
+
+  void __set_status(const ExtensionStatus& val);
+
+  void __set_rows(const int64_t val);
+
+  void __set_columns(const std::vector<ExtensionTableColumn> & val);
+
+  bool operator == (const ExtensionTablePage & rhs) const
+  {
+    if (!(status == rhs.status))
+      return false;
+    if (!(rows == rhs.rows))
+      return false;
+    if (!(columns == rhs.columns))
+      return false;
+    return true;
+  }
+  bool operator != (const ExtensionTablePage &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ExtensionTablePage & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  virtual void printTo(std::ostream& out) const;
+};
+
+void swap(ExtensionTablePage &a, ExtensionTablePage &b);
+
+std::ostream& operator<<(std::ostream& out, const ExtensionTablePage& obj);
+
 typedef struct _ExtensionException__isset {
   _ExtensionException__isset() : code(false), message(false), uuid(false) {}
   bool code :1;
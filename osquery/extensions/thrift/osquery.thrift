@@ -60,6 +60,31 @@ struct ExtensionResponse {
   2:ExtensionPluginResponse response,
 }
 
+/// The storage of a table column's values.
+enum ExtensionColumnType {
+  EXT_COLUMN_TEXT = 0,
+  EXT_COLUMN_INTEGER = 1,
+  EXT_COLUMN_DOUBLE = 2,
+}
+
+/// A table column is named once and holds one value for each row.
+struct ExtensionTableColumn {
+  1:string name,
+  2:ExtensionColumnType type,
+  /// True for rows without a value, empty if every row has a value.
+  3:list<bool> nulls,
+  4:list<string> text_values,
+  5:list<i64> integer_values,
+  6:list<double> double_values,
+}
+
+/// Table rows as typed columns, rather than a string map per row.
+struct ExtensionTablePage {
+  1:ExtensionStatus status,
+  2:i64 rows,
+  3:list<ExtensionTableColumn> columns,
+}
+
 exception ExtensionException {
   1:i32 code,
   2:string message,
@@ -77,6 +102,12 @@ service Extension {
     2:string item,
     /// The thrift-equivalent of an osquery::PluginRequest.
     3:ExtensionPluginRequest request),
+  /// Generate a table plugin's rows as typed columns.
+  ExtensionTablePage generateTable(
+    /// The table name (plugin name).
+    1:string item,
+    /// The thrift-equivalent of an osquery::PluginRequest.
+    2:ExtensionPluginRequest request),
   /// Request that an extension shutdown (does not apply to managers).
   void shutdown(),
 }
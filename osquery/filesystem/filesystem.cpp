@@ -26,6 +26,9 @@
 #include <osquery/core/flags.h>
 #include <osquery/core/system.h>
 #include <osquery/filesystem/filesystem.h>
+#ifdef __linux__
+#include <osquery/filesystem/linux/walk.h>
+#endif
 #include <osquery/logger/logger.h>
 #include <osquery/sql/sql.h>
 #if WIN32
@@ -49,6 +52,13 @@ HIDDEN_FLAG(bool, allow_unsafe, false, "Allow unsafe executable permissions");
 /// Disable forensics (atime/mtime preserving) file reads.
 HIDDEN_FLAG(bool, disable_forensic, true, "Disable atime/mtime preservation");
 
+#ifdef __linux__
+FLAG(uint32,
+     glob_walk_threads,
+     4,
+     "Maximum number of threads reading directories for a recursive glob");
+#endif
+
 static const size_t kMaxRecursiveGlobs = 64;
 
 Status writeTextFile(const fs::path& path,
@@ -316,11 +326,52 @@ static bool checkForLoops(std::set<int>& dsym_inos, std::string path) {
   return false;
 }
 
+static void pruneGlobs(std::vector<std::string>& results, GlobLimits limits) {
+  // Prune results based on settings/requested glob limitations.
+  auto end = std::remove_if(
+      results.begin(), results.end(), [limits](const std::string& found) {
+        return !(((found[found.length() - 1] == '/' ||
+                   found[found.length() - 1] == '\\') &&
+                  limits & GLOB_FOLDERS) ||
+                 ((found[found.length() - 1] != '/' &&
+                   found[found.length() - 1] != '\\') &&
+                  limits & GLOB_FILES));
+      });
+  results.erase(end, results.end());
+}
+
 static void genGlobs(std::string path,
                      std::vector<std::string>& results,
                      GlobLimits limits) {
   // Use our helped escape/replace for wildcards.
   replaceGlobWildcards(path, limits);
+
+#ifdef __linux__
+  // Expand a trailing double star by walking the matching directories,
+  // rather than globbing one more level at a time.
+  if (path.size() > 3 && path.compare(path.size() - 3, 3, "/**") == 0) {
+    auto base = path.substr(0, path.size() - 2);
+
+    std::vector<std::string> roots;
+    if (base.find_first_of("*?[{~") == std::string::npos) {
+      if (isDirectory(base).ok()) {
+        roots.push_back(base);
+      }
+    } else {
+      for (auto& root : platformGlob(base)) {
+        if (root.back() == '/') {
+          roots.push_back(std::move(root));
+        }
+      }
+    }
+
+    walkDirectories(
+        roots, kMaxRecursiveGlobs - 1, FLAGS_glob_walk_threads, results);
+    pruneGlobs(results, limits);
+    return;
+  }
+#endif
+
   // inodes of directory symlinks for loop detection
   std::set<int> dsym_inos;
 
@@ -347,17 +398,7 @@ static void genGlobs(std::string path,
     path += "/**";
   }
 
-  // Prune results based on settings/requested glob limitations.
-  auto end = std::remove_if(
-      results.begin(), results.end(), [limits](const std::string& found) {
-        return !(((found[found.length() - 1] == '/' ||
-                   found[found.length() - 1] == '\\') &&
-                  limits & GLOB_FOLDERS) ||
-                 ((found[found.length() - 1] != '/' &&
-                   found[found.length() - 1] != '\\') &&
-                  limits & GLOB_FILES));
-      });
-  results.erase(end, results.end());
+  pruneGlobs(results, limits);
 }
 
 Status resolveFilePattern(const fs::path& fs_path,
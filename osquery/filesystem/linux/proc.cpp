@@ -10,12 +10,14 @@
 #include <linux/limits.h>
 #include <unistd.h>
 
+#include <cstring>
+
 #include <boost/filesystem.hpp>
 
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/filesystem/linux/proc.h>
 #include <osquery/logger/logger.h>
-#include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tokenizer.h>
 
 namespace osquery {
 const std::vector<std::string> kUserNamespaceList = {
@@ -82,36 +84,41 @@ Status procGetProcessNamespaces(const std::string& process_id,
   return Status::success();
 }
 
-std::string procDecodeAddressFromHex(const std::string& encoded_address,
+std::string procDecodeAddressFromHex(std::string_view encoded_address,
                                      int family) {
   char addr_buffer[INET6_ADDRSTRLEN] = {0};
   if (family == AF_INET) {
     struct in_addr decoded;
-    if (encoded_address.length() == 8) {
-      sscanf(encoded_address.c_str(), "%X", &(decoded.s_addr));
+    if (encoded_address.length() == 8 &&
+        parseInteger(encoded_address, decoded.s_addr, 16)) {
       inet_ntop(AF_INET, &decoded, addr_buffer, INET_ADDRSTRLEN);
     }
 
   } else if (family == AF_INET6) {
     struct in6_addr decoded;
     if (encoded_address.length() == 32) {
-      sscanf(encoded_address.c_str(),
-             "%8x%8x%8x%8x",
-             (unsigned int*)&(decoded.s6_addr[0]),
-             (unsigned int*)&(decoded.s6_addr[4]),
-             (unsigned int*)&(decoded.s6_addr[8]),
-             (unsigned int*)&(decoded.s6_addr[12]));
-      inet_ntop(AF_INET6, &decoded, addr_buffer, INET6_ADDRSTRLEN);
+      // The address is printed as four 32-bit words in host order.
+      bool valid = true;
+      for (size_t i = 0; i < 4 && valid; i++) {
+        uint32_t word = 0;
+        valid = parseInteger(encoded_address.substr(i * 8, 8), word, 16);
+        std::memcpy(&decoded.s6_addr[i * 4], &word, sizeof(word));
+      }
+
+      if (valid) {
+        inet_ntop(AF_INET6, &decoded, addr_buffer, INET6_ADDRSTRLEN);
+      }
     }
   }
 
   return std::string(addr_buffer);
 }
 
-unsigned short procDecodePortFromHex(const std::string& encoded_port) {
+unsigned short procDecodePortFromHex(std::string_view encoded_port) {
   unsigned short decoded = 0;
-  if (encoded_port.length() == 4) {
-    sscanf(encoded_port.c_str(), "%hX", &decoded);
+  if (encoded_port.length() != 4 ||
+      !parseInteger(encoded_port, decoded, 16)) {
+    decoded = 0;
   }
   return decoded;
 }
@@ -124,7 +131,10 @@ static Status procGetSocketListInet(int family,
                                     SocketInfoList& result) {
   // The system's socket information is tokenized by line.
   bool header = true;
-  for (const auto& line : osquery::split(content, "\n")) {
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  std::vector<std::string_view> fields;
+  while (lines.next(line)) {
     if (header) {
       if (line.find("sl") != 0 && line.find("sk") != 0) {
         return Status(1, std::string("Invalid file header for ") + path);
@@ -134,40 +144,38 @@ static Status procGetSocketListInet(int family,
     }
 
     // The socket information is tokenized by spaces, each a field.
-    auto fields = osquery::split(line, " ");
-    if (fields.size() < 10) {
+    if (splitView(line, " ", fields) < 10) {
       VLOG(1) << "Invalid socket descriptor found: '" << line
               << "'. Skipping this entry";
       continue;
     }
 
     // Two of the fields are the local/remote address/port pairs.
-    auto locals = osquery::split(fields[1], ":");
-    auto remotes = osquery::split(fields[2], ":");
-
-    if (locals.size() != 2 || remotes.size() != 2) {
+    std::string_view local_address, local_port;
+    std::string_view remote_address, remote_port;
+    if (!splitKeyValue(fields[1], ':', local_address, local_port) ||
+        !splitKeyValue(fields[2], ':', remote_address, remote_port)) {
       VLOG(1) << "Invalid socket descriptor found: '" << line
               << "'. Skipping this entry";
       continue;
     }
 
     SocketInfo socket_info = {};
-    socket_info.socket = fields[9];
+    socket_info.socket = std::string(fields[9]);
     socket_info.net_ns = net_ns;
     socket_info.family = family;
     socket_info.protocol = protocol;
-    socket_info.local_address = procDecodeAddressFromHex(locals[0], family);
-    socket_info.local_port = procDecodePortFromHex(locals[1]);
-    socket_info.remote_address = procDecodeAddressFromHex(remotes[0], family);
-    socket_info.remote_port = procDecodePortFromHex(remotes[1]);
+    socket_info.local_address = procDecodeAddressFromHex(local_address, family);
+    socket_info.local_port = procDecodePortFromHex(local_port);
+    socket_info.remote_address =
+        procDecodeAddressFromHex(remote_address, family);
+    socket_info.remote_port = procDecodePortFromHex(remote_port);
 
     if (protocol == IPPROTO_TCP) {
-      char* null_terminator_ptr = nullptr;
-      auto integer_socket_state =
-          std::strtoull(fields[3].data(), &null_terminator_ptr, 16);
-      if (integer_socket_state == 0 ||
-          integer_socket_state >= tcp_states.size() ||
-          null_terminator_ptr == nullptr || *null_terminator_ptr != 0) {
+      size_t integer_socket_state = 0;
+      if (!parseInteger(fields[3], integer_socket_state, 16) ||
+          integer_socket_state == 0 ||
+          integer_socket_state >= tcp_states.size()) {
         socket_info.state = "UNKNOWN";
       } else {
         socket_info.state = tcp_states[integer_socket_state];
@@ -186,7 +194,10 @@ static Status procGetSocketListUnix(ino_t net_ns,
                                     SocketInfoList& result) {
   // The system's socket information is tokenized by line.
   bool header = true;
-  for (const auto& line : osquery::split(content, "\n")) {
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  std::vector<std::string_view> fields;
+  while (lines.next(line)) {
     if (header) {
       if (line.find("Num") != 0) {
         return Status(1, std::string("Invalid file header for ") + path);
@@ -196,19 +207,23 @@ static Status procGetSocketListUnix(ino_t net_ns,
     }
 
     // The socket information is tokenized by spaces, each a field.
-    auto fields = osquery::split(line, " ");
-    if (fields.size() < 7) {
+    if (splitView(line, " ", fields) < 7) {
       VLOG(1) << "Invalid UNIX socket descriptor found: '" << line
               << "'. Skipping this entry";
       continue;
     }
 
+    int protocol = 0;
+    parseInteger(fields[2], protocol);
+
     SocketInfo socket_info = {};
-    socket_info.socket = fields[6];
+    socket_info.socket = std::string(fields[6]);
     socket_info.net_ns = net_ns;
     socket_info.family = AF_UNIX;
-    socket_info.protocol = std::atoll(fields[2].data());
-    socket_info.unix_socket_path = (fields.size() >= 8) ? fields[7] : "";
+    socket_info.protocol = protocol;
+    if (fields.size() >= 8) {
+      socket_info.unix_socket_path = std::string(fields[7]);
+    }
 
     result.push_back(std::move(socket_info));
   }
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <string_view>
 #include <unordered_map>
 
 #include <arpa/inet.h>
@@ -88,10 +89,10 @@ Status procGetNamespaceInode(ino_t& inode,
                              const std::string& namespace_name,
                              const std::string& process_namespace_root);
 
-std::string procDecodeAddressFromHex(const std::string& encoded_address,
+std::string procDecodeAddressFromHex(std::string_view encoded_address,
                                      int family);
 
-unsigned short procDecodePortFromHex(const std::string& encoded_port);
+unsigned short procDecodePortFromHex(std::string_view encoded_port);
 
 /**
  * @brief Construct a map of socket inode number to socket information collected
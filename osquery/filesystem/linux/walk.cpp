@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <osquery/filesystem/linux/walk.h>
+
+namespace osquery {
+namespace {
+
+/// Queued directories per reading thread before another thread starts.
+const size_t kQueuedPerWalkThread{64U};
+
+/// Size of the getdents64 buffer used by each thread.
+const size_t kDirentBufferSize{32U * 1024U};
+
+/// The kernel's directory entry layout, glibc only wraps getdents64 in 2.30+.
+struct LinuxDirent64 final {
+  ino64_t d_ino;
+  off64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+/// A directory being walked, linked to its parent directory.
+struct WalkAncestor final {
+  dev_t device;
+  ino_t inode;
+  std::shared_ptr<const WalkAncestor> parent;
+};
+
+/// An open directory, closed once its queued children have opened.
+struct WalkDirectory final {
+  explicit WalkDirectory(int descriptor) : fd(descriptor) {}
+
+  ~WalkDirectory() {
+    ::close(fd);
+  }
+
+  const int fd;
+};
+
+/// A directory to read and the depth of its entries.
+struct WalkTask final {
+  std::string path;
+  size_t depth{0U};
+  std::shared_ptr<const WalkAncestor> parent;
+
+  /// The open parent directory and the name within it, unset for roots.
+  std::shared_ptr<const WalkDirectory> directory;
+  std::string name;
+};
+
+using WalkResults = std::vector<std::pair<size_t, std::string>>;
+
+class DirectoryWalker final {
+ public:
+  DirectoryWalker(size_t max_depth, size_t max_threads)
+      : max_depth_(max_depth), max_threads_(std::max<size_t>(max_threads, 1)) {}
+
+  void add(const std::string& path) {
+    WalkTask task;
+    task.path = path;
+    task.depth = 1U;
+    queue_.push_back(std::move(task));
+  }
+
+  /**
+   * @brief Read directories until every queued and discovered directory is
+   * done.
+   *
+   * The calling thread reads directories, more threads only start while the
+   * queue grows, so shallow walks remain serial.
+   */
+  void run(WalkResults& results) {
+    work();
+
+    // Threads are only started while there is work, they have all finished.
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+
+    results = std::move(results_);
+  }
+
+ private:
+  void work() {
+    WalkResults found;
+    std::vector<WalkTask> children;
+    std::vector<char> buffer(kDirentBufferSize);
+
+    while (true) {
+      WalkTask task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !queue_.empty() || active_ == 0; });
+        if (queue_.empty()) {
+          break;
+        }
+
+        // Newest first, this keeps the queue small on wide trees.
+        task = std::move(queue_.back());
+        queue_.pop_back();
+        active_++;
+      }
+
+      readDirectory(task, buffer, found, children);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& child : children) {
+          queue_.push_back(std::move(child));
+        }
+        active_--;
+
+        auto thread_count = threads_.size() + 1;
+        if (thread_count < max_threads_ &&
+            queue_.size() > thread_count * kQueuedPerWalkThread) {
+          threads_.emplace_back([this]() { work(); });
+        }
+      }
+      children.clear();
+      cv_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::move(found.begin(), found.end(), std::back_inserter(results_));
+  }
+
+  void readDirectory(WalkTask& task,
+                     std::vector<char>& buffer,
+                     WalkResults& found,
+                     std::vector<WalkTask>& children) {
+    // Children open relative to their parent, rather than resolving the path.
+    const int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+    auto fd = (task.directory == nullptr)
+                  ? ::open(task.path.c_str(), flags)
+                  : ::openat(task.directory->fd, task.name.c_str(), flags);
+    task.directory.reset();
+    if (fd < 0) {
+      return;
+    }
+
+    auto directory = std::make_shared<const WalkDirectory>(fd);
+    struct stat dir_stat;
+    if (::fstat(fd, &dir_stat) != 0) {
+      return;
+    }
+
+    // A symlink back to a directory being walked would loop.
+    for (auto ancestor = task.parent.get(); ancestor != nullptr;
+         ancestor = ancestor->parent.get()) {
+      if (ancestor->device == dir_stat.st_dev &&
+          ancestor->inode == dir_stat.st_ino) {
+        return;
+      }
+    }
+
+    std::shared_ptr<const WalkAncestor> self;
+
+    while (true) {
+      auto length = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+      if (length <= 0) {
+        break;
+      }
+
+      for (long offset = 0; offset < length;) {
+        auto entry = reinterpret_cast<const LinuxDirent64*>(&buffer[offset]);
+        offset += entry->d_reclen;
+
+        // A glob wildcard does not match hidden entries, nor '.' and '..'.
+        if (entry->d_name[0] == '.') {
+          continue;
+        }
+
+        bool is_directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+          // Follow symlinks, a link to a directory is walked as a directory.
+          struct stat entry_stat;
+          is_directory = ::fstatat(fd, entry->d_name, &entry_stat, 0) == 0 &&
+                         S_ISDIR(entry_stat.st_mode);
+        }
+
+        auto path = task.path + entry->d_name;
+        if (is_directory) {
+          path.push_back('/');
+          if (task.depth < max_depth_) {
+            if (self == nullptr) {
+              self = std::make_shared<const WalkAncestor>(WalkAncestor{
+                  dir_stat.st_dev, dir_stat.st_ino, task.parent});
+            }
+            WalkTask child;
+            child.path = path;
+            child.depth = task.depth + 1;
+            child.parent = self;
+            child.directory = directory;
+            child.name = entry->d_name;
+            children.push_back(std::move(child));
+          }
+        }
+        found.emplace_back(task.depth, std::move(path));
+      }
+    }
+  }
+
+ private:
+  const size_t max_depth_;
+
+  const size_t max_threads_;
+
+  /// Threads reading directories, besides the thread running the walk.
+  std::vector<std::thread> threads_;
+
+  /// Directories waiting for a thread.
+  std::deque<WalkTask> queue_;
+
+  /// Number of directories being read.
+  size_t active_{0U};
+
+  WalkResults results_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} // namespace
+
+void walkDirectories(const std::vector<std::string>& roots,
+                     size_t max_depth,
+                     size_t max_threads,
+                     std::vector<std::string>& results) {
+  if (roots.empty() || max_depth == 0) {
+    return;
+  }
+
+  DirectoryWalker walker(max_depth, max_threads);
+  for (const auto& root : roots) {
+    walker.add(root);
+  }
+
+  WalkResults found;
+  walker.run(found);
+
+  // Order the entries as the sequence of per-depth glob(3) calls would.
+  std::sort(found.begin(), found.end());
+  results.reserve(results.size() + found.size());
+  for (auto& entry : found) {
+    results.push_back(std::move(entry.second));
+  }
+}
+
+} // namespace osquery
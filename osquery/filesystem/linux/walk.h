@@ -0,0 +1,40 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace osquery {
+
+/**
+ * @brief List every entry below a set of directories using a pool of threads.
+ *
+ * This expands a trailing recursive ('%%') glob. Each directory is opened
+ * relative to its parent's descriptor and read with getdents64. Its entries
+ * are only stat'd, relative to the directory descriptor, when the entry type
+ * is a symlink or unknown. The calling thread reads directories, and more
+ * threads start, up to a maximum, only while many directories are queued.
+ *
+ * Like glob(3), hidden entries are skipped, symlinks to directories are
+ * followed, and directories are reported with a trailing '/'. A directory is
+ * not walked again below itself, which breaks symlink loops.
+ *
+ * @param roots The directories to walk, each with a trailing '/'.
+ * @param max_depth The maximum depth of a reported entry, 1 lists the roots.
+ * @param max_threads The maximum number of threads, 1 to walk serially.
+ * @param results Appended with the entries, ordered by depth then path.
+ */
+void walkDirectories(const std::vector<std::string>& roots,
+                     size_t max_depth,
+                     size_t max_threads,
+                     std::vector<std::string>& results);
+
+} // namespace osquery
@@ -37,6 +37,9 @@ namespace fs = boost::filesystem;
 namespace osquery {
 
 DECLARE_uint64(read_max);
+#ifdef __linux__
+DECLARE_uint32(glob_walk_threads);
+#endif
 
 class FilesystemTests : public testing::Test {
  protected:
@@ -386,6 +389,67 @@ TEST_F(FilesystemTests, test_wildcard_all_types) {
                    .string()));
 }
 
+TEST_F(FilesystemTests, test_wildcard_double_order) {
+  std::vector<std::string> results;
+  resolveFilePattern(fake_directory_ / "%%", results, GLOB_FOLDERS);
+
+  // Shallower results are listed first, as with one glob per depth.
+  auto top = std::find(
+      results.begin(),
+      results.end(),
+      fs::path(fake_directory_ / "deep11/").make_preferred().string());
+  auto deepest = std::find(results.begin(),
+                           results.end(),
+                           fs::path(fake_directory_ / "deep11/deep2/deep3/")
+                               .make_preferred()
+                               .string());
+  ASSERT_NE(top, results.end());
+  ASSERT_NE(deepest, results.end());
+  EXPECT_LT(top, deepest);
+}
+
+#ifndef WIN32
+TEST_F(FilesystemTests, test_wildcard_double_symlink_loop) {
+  boost::system::error_code ec;
+  fs::create_symlink(
+      fake_directory_ / "deep1", fake_directory_ / "deep1/deep2/up", ec);
+  ASSERT_FALSE(ec);
+
+  std::vector<std::string> results;
+  auto status = resolveFilePattern(fake_directory_ / "deep1/%%", results);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(contains(
+      results, fs::path(fake_directory_ / "deep1/deep2/level2.txt").string()));
+
+  // The loop is not followed indefinitely.
+  EXPECT_LT(results.size(), 10U);
+}
+#endif
+
+#ifdef __linux__
+TEST_F(FilesystemTests, test_wildcard_double_threads) {
+  // Enough directories that the walk starts more threads.
+  for (size_t i = 0; i < 200; i++) {
+    auto dir = fake_directory_ / "wide" / std::to_string(i) / "inner";
+    fs::create_directories(dir);
+    writeTextFile(dir / "file.txt", "");
+  }
+
+  auto threads = FLAGS_glob_walk_threads;
+  FLAGS_glob_walk_threads = 1;
+  std::vector<std::string> serial;
+  resolveFilePattern(fake_directory_ / "wide/%%", serial);
+
+  FLAGS_glob_walk_threads = 4;
+  std::vector<std::string> parallel;
+  resolveFilePattern(fake_directory_ / "wide/%%", parallel);
+  FLAGS_glob_walk_threads = threads;
+
+  EXPECT_EQ(serial.size(), 600U);
+  EXPECT_EQ(serial, parallel);
+}
+#endif
+
 TEST_F(FilesystemTests, test_wildcard_invalid_path) {
   std::vector<std::string> results;
   auto status = resolveFilePattern("/not_there_abcdefz/%%", results);
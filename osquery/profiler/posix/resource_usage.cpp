@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#ifdef __linux__
+// Needed for linux specific RUSAGE_THREAD, before including anything else
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+#include <osquery/profiler/resource_usage.h>
+
+namespace osquery {
+namespace {
+
+uint64_t toMilliseconds(const struct timeval& tv) {
+  return static_cast<uint64_t>(tv.tv_sec) * 1000 +
+         static_cast<uint64_t>(tv.tv_usec) / 1000;
+}
+
+uint64_t getAllocatedBytes() {
+#if defined(__linux__) && defined(__GLIBC__)
+  // Large allocations are mapped separately, and not part of uordblks.
+#if __GLIBC_PREREQ(2, 33)
+  auto info = mallinfo2();
+  return static_cast<uint64_t>(info.uordblks) + info.hblkhd;
+#else
+  // The counters of mallinfo are ints, and wrap above 4GB.
+  auto info = mallinfo();
+  return static_cast<uint64_t>(static_cast<unsigned int>(info.uordblks)) +
+         static_cast<unsigned int>(info.hblkhd);
+#endif
+#elif defined(__APPLE__)
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  return static_cast<uint64_t>(stats.size_in_use);
+#else
+  return 0;
+#endif
+}
+
+} // namespace
+
+ResourceUsage getResourceUsage() {
+  ResourceUsage usage;
+  usage.wall_time = std::chrono::steady_clock::now();
+
+  struct rusage stats;
+#ifdef __linux__
+  int who = RUSAGE_THREAD;
+#else
+  int who = RUSAGE_SELF;
+#endif
+  if (getrusage(who, &stats) == 0) {
+    usage.user_time = toMilliseconds(stats.ru_utime);
+    usage.system_time = toMilliseconds(stats.ru_stime);
+  }
+
+  usage.allocated_bytes = getAllocatedBytes();
+  return usage;
+}
+
+} // namespace osquery
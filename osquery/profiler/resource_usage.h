@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace osquery {
+
+/// A snapshot of the resources used by the calling thread.
+struct ResourceUsage {
+  /// Monotonic time the snapshot was taken.
+  std::chrono::steady_clock::time_point wall_time;
+
+  /// User CPU time of the thread in milliseconds.
+  uint64_t user_time{0};
+
+  /// System CPU time of the thread in milliseconds.
+  uint64_t system_time{0};
+
+  /// Bytes allocated from the process heap, 0 if not available.
+  uint64_t allocated_bytes{0};
+};
+
+/**
+ * @brief Take a snapshot of the resources used by the calling thread.
+ *
+ * This is cheap enough to call around every scheduled query: it does not
+ * read files or run queries. Where per-thread CPU times are not available
+ * the times of the whole process are used.
+ */
+ResourceUsage getResourceUsage();
+
+} // namespace osquery
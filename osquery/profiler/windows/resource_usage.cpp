@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <osquery/utils/system/system.h>
+
+#include <osquery/profiler/resource_usage.h>
+
+namespace osquery {
+namespace {
+
+uint64_t toMilliseconds(const FILETIME& ft) {
+  ULARGE_INTEGER value;
+  value.LowPart = ft.dwLowDateTime;
+  value.HighPart = ft.dwHighDateTime;
+  // FILETIME counts 100-nanosecond intervals.
+  return value.QuadPart / 10000;
+}
+
+} // namespace
+
+ResourceUsage getResourceUsage() {
+  ResourceUsage usage;
+  usage.wall_time = std::chrono::steady_clock::now();
+
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+  if (GetThreadTimes(GetCurrentThread(),
+                     &creation_time,
+                     &exit_time,
+                     &kernel_time,
+                     &user_time)) {
+    usage.user_time = toMilliseconds(user_time);
+    usage.system_time = toMilliseconds(kernel_time);
+  }
+
+  return usage;
+}
+
+} // namespace osquery
@@ -7,13 +7,17 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <regex>
+
 #include <benchmark/benchmark.h>
 
 #include <osquery/core/core.h>
+#include <osquery/core/sql/query_results.h>
 #include <osquery/core/tables.h>
 #include <osquery/registry/registry.h>
 #include <osquery/sql/sql.h>
 
+#include "osquery/sql/dynamic_table_row.h"
 #include "osquery/sql/virtual_table.h"
 
 namespace osquery {
@@ -195,6 +199,48 @@ static void SQL_virtual_table_internal_long(benchmark::State& state) {
 
 BENCHMARK(SQL_virtual_table_internal_long);
 
+static void SQL_regex_functions(benchmark::State& state) {
+  auto tables = RegistryFactory::get().registry("table");
+  tables->add("long_benchmark", std::make_shared<BenchmarkLongTablePlugin>());
+
+  PluginResponse res;
+  Registry::call("table", "long_benchmark", {{"action", "columns"}}, res);
+
+  auto dbc = SQLiteDBManager::getUnique();
+  attachTableInternal(
+      "long_benchmark", columnDefinition(res, false, false), dbc, false);
+
+  // Report rows per second, each pattern is compiled once per query.
+  auto query = (state.range(0) == 0)
+                   ? "select regex_match(test_text, '(h)(e)l+o$', 1) "
+                     "from long_benchmark"
+                   : "select regex_split(test_text, 'l+', 1) "
+                     "from long_benchmark";
+  while (state.KeepRunning()) {
+    QueryData results;
+    queryInternal(query, results, dbc);
+    dbc->clearAffectedTables();
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+BENCHMARK(SQL_regex_functions)->Arg(0)->Arg(1);
+
+static void SQL_regex_std_per_row(benchmark::State& state) {
+  // The previous regex_match implementation compiled the pattern per row.
+  std::vector<std::string> rows(1000, "hello");
+  while (state.KeepRunning()) {
+    for (const auto& row : rows) {
+      std::smatch results;
+      benchmark::DoNotOptimize(
+          std::regex_search(row, results, std::regex("(h)(e)l+o$")));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * rows.size());
+}
+
+BENCHMARK(SQL_regex_std_per_row);
+
 size_t kWideCount{0};
 
 class BenchmarkWideTablePlugin : public TablePlugin {
@@ -302,6 +348,72 @@ static void SQL_select_metadata(benchmark::State& state) {
 
 BENCHMARK(SQL_select_metadata);
 
+static void SQL_connection_setup(benchmark::State& state) {
+  auto tables = RegistryFactory::get().registry("table");
+  tables->add("benchmark", std::make_shared<BenchmarkTablePlugin>());
+
+  // Profile creating a transient connection and running a single query.
+  // An argument of 1 attaches every table first, as connections used to.
+  while (state.KeepRunning()) {
+    auto dbc = SQLiteDBManager::getUnique();
+    if (state.range(0) == 1) {
+      attachVirtualTables(dbc);
+    }
+
+    QueryData results;
+    queryInternal("select * from benchmark", results, dbc);
+  }
+}
+
+BENCHMARK(SQL_connection_setup)->Arg(0)->Arg(1);
+
+/// Approximate the bytes allocated for typed rows, for comparison.
+static size_t typedResultsBytes(const QueryDataTyped& results) {
+  // Each map node holds a key copy and a variant, plus the tree links.
+  const size_t node = sizeof(RowTyped::value_type) + 4 * sizeof(void*);
+  size_t bytes = results.capacity() * sizeof(RowTyped);
+  for (const auto& row : results) {
+    for (const auto& cell : row) {
+      bytes += node + cell.first.capacity() + 1;
+      if (const auto* text = boost::get<std::string>(&cell.second)) {
+        bytes += text->capacity() + 1;
+      }
+    }
+  }
+  return bytes;
+}
+
+static void SQL_result_materialization(benchmark::State& state) {
+  // Profile reading 100k rows as columnar, typed, and string results.
+  auto dbc = SQLiteDBManager::getUnique();
+  const std::string query =
+      "with recursive n(i) as (select 1 union all select i + 1 from n "
+      "where i < 100000) select i, 'process_' || i as name, i * 0.5 as score "
+      "from n";
+
+  size_t bytes = 0;
+  while (state.KeepRunning()) {
+    if (state.range(0) == 0) {
+      QueryResults results;
+      queryInternal(query, results, dbc);
+      bytes = results.memoryUsed();
+    } else if (state.range(0) == 1) {
+      QueryDataTyped results;
+      queryInternal(query, results, dbc);
+      bytes = typedResultsBytes(results);
+    } else {
+      QueryData results;
+      queryInternal(query, results, dbc);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 100000);
+  if (bytes > 0) {
+    state.counters["bytes"] = static_cast<double>(bytes);
+  }
+}
+
+BENCHMARK(SQL_result_materialization)->Arg(0)->Arg(1)->Arg(2);
+
 static void SQL_select_basic(benchmark::State& state) {
   // Profile executing a query against an internal, already attached table.
   while (state.KeepRunning()) {
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include "columnar_table_row.h"
+#include "dynamic_table_row.h"
+#include "virtual_table.h"
+
+#include <osquery/logger/logger.h>
+#include <osquery/utils/conversions/tryto.h>
+
+namespace rj = rapidjson;
+
+namespace osquery {
+
+TableRows tableRowsFromPage(TablePage&& page) {
+  auto shared = std::make_shared<const TablePage>(std::move(page));
+
+  TableRows result;
+  result.reserve(shared->rows());
+  for (size_t row = 0; row < shared->rows(); ++row) {
+    result.push_back(TableRowHolder(new ColumnarTableRow(shared, row)));
+  }
+  return result;
+}
+
+int ColumnarTableRow::get_rowid(sqlite_int64 default_value,
+                                sqlite_int64* pRowid) const {
+  const auto* column = page_->column("rowid");
+  if (column == nullptr || TablePage::isNull(*column, row_)) {
+    *pRowid = default_value;
+    return SQLITE_OK;
+  }
+
+  if (column->storage == TablePage::Storage::Integer) {
+    *pRowid = column->integers[row_];
+    return SQLITE_OK;
+  }
+
+  auto exp = tryTo<long long>(TablePage::string(*column, row_), 10);
+  if (exp.isError()) {
+    VLOG(1) << "Invalid rowid value returned " << exp.getError();
+    return SQLITE_ERROR;
+  }
+  *pRowid = exp.take();
+  return SQLITE_OK;
+}
+
+int ColumnarTableRow::get_column(sqlite3_context* ctx,
+                                 sqlite3_vtab* vtab,
+                                 int col) {
+  VirtualTable* pVtab = (VirtualTable*)vtab;
+  const auto& columns = pVtab->content->columns;
+  auto index = static_cast<size_t>(col);
+  auto alias = pVtab->content->aliases.find(std::get<0>(columns[index]));
+  if (alias != pVtab->content->aliases.end()) {
+    index = alias->second;
+  }
+  const auto& column_name = std::get<0>(columns[index]);
+  const auto& type = std::get<1>(columns[index]);
+
+  const auto* column = page_->column(column_name);
+  if (column == nullptr || TablePage::isNull(*column, row_)) {
+    sqlite3_result_null(ctx);
+    return SQLITE_OK;
+  }
+
+  // Values are already cast to the storage of their declared type.
+  if (column->storage == TablePage::Storage::Text &&
+      (type == TEXT_TYPE || type == BLOB_TYPE)) {
+    const auto& value = column->text[row_];
+    sqlite3_result_text(
+        ctx, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+  } else if (column->storage == TablePage::Storage::Integer &&
+             type == INTEGER_TYPE) {
+    sqlite3_result_int(ctx, static_cast<int>(column->integers[row_]));
+  } else if (column->storage == TablePage::Storage::Integer &&
+             (type == BIGINT_TYPE || type == UNSIGNED_BIGINT_TYPE)) {
+    sqlite3_result_int64(ctx, column->integers[row_]);
+  } else if (column->storage == TablePage::Storage::Double &&
+             type == DOUBLE_TYPE) {
+    sqlite3_result_double(ctx, column->doubles[row_]);
+  } else {
+    // The extension declared a different type, cast its value as text.
+    DynamicTableRow row({{column_name, TablePage::string(*column, row_)}});
+    return row.get_column(ctx, vtab, static_cast<int>(index));
+  }
+
+  return SQLITE_OK;
+}
+
+Status ColumnarTableRow::serialize(JSON& doc, rj::Value& obj) const {
+  for (const auto& column : page_->columns()) {
+    if (TablePage::isNull(column, row_)) {
+      continue;
+    }
+
+    if (column.storage == TablePage::Storage::Text) {
+      doc.addRef(column.name, column.text[row_], obj);
+    } else {
+      doc.addCopy(column.name, TablePage::string(column, row_), obj);
+    }
+  }
+
+  return Status::success();
+}
+
+TableRowHolder ColumnarTableRow::clone() const {
+  return TableRowHolder(new ColumnarTableRow(page_, row_));
+}
+
+size_t ColumnarTableRow::memoryUsage() const {
+  size_t bytes = 0;
+  for (const auto& column : page_->columns()) {
+    bytes += column.name.size();
+    if (column.storage == TablePage::Storage::Text) {
+      bytes += column.text[row_].size();
+    } else {
+      bytes += sizeof(int64_t);
+    }
+  }
+  return bytes;
+}
+
+} // namespace osquery
@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <osquery/core/sql/table_page.h>
+#include <osquery/core/sql/table_row.h>
+#include <osquery/core/sql/table_rows.h>
+#include <osquery/utils/json/json.h>
+
+namespace osquery {
+
+/** A TableRow backed by one row of a shared TablePage. */
+class ColumnarTableRow : public TableRow {
+ public:
+  ColumnarTableRow(std::shared_ptr<const TablePage> page, size_t row)
+      : page_(std::move(page)), row_(row) {}
+  ColumnarTableRow(const ColumnarTableRow&) = delete;
+  ColumnarTableRow& operator=(const ColumnarTableRow&) = delete;
+  explicit operator Row() const {
+    return page_->toRow(row_);
+  }
+  virtual int get_rowid(sqlite_int64 default_value, sqlite_int64* pRowid) const;
+  virtual int get_column(sqlite3_context* ctx, sqlite3_vtab* pVtab, int col);
+  virtual Status serialize(JSON& doc, rapidjson::Value& obj) const;
+  virtual TableRowHolder clone() const;
+  virtual size_t memoryUsage() const;
+
+ private:
+  std::shared_ptr<const TablePage> page_;
+  size_t row_;
+};
+
+/// Converts a TablePage to TableRows that share the page's columns.
+TableRows tableRowsFromPage(TablePage&& page);
+
+} // namespace osquery
@@ -162,4 +162,12 @@ TableRowHolder DynamicTableRow::clone() const {
   return TableRowHolder(new DynamicTableRow(std::move(new_row)));
 }
 
+size_t DynamicTableRow::memoryUsage() const {
+  size_t bytes = 0;
+  for (const auto& column : row) {
+    bytes += column.first.size() + column.second.size();
+  }
+  return bytes;
+}
+
 } // namespace osquery
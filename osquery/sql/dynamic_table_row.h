@@ -32,6 +32,7 @@ class DynamicTableRow : public TableRow {
   virtual int get_column(sqlite3_context* ctx, sqlite3_vtab* pVtab, int col);
   virtual Status serialize(JSON& doc, rapidjson::Value& obj) const;
   virtual TableRowHolder clone() const;
+  virtual size_t memoryUsage() const;
   inline std::string& operator[](const std::string& key) {
     return row[key];
   }
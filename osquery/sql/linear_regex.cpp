@@ -0,0 +1,919 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <cctype>
+#include <cstring>
+
+#include <osquery/sql/linear_regex.h>
+
+namespace osquery {
+
+namespace {
+
+/// Repetition counts above this are never within an instruction budget.
+const size_t kMaxRepeatCount = 100000;
+
+/// Limit the parser's recursion into nested groups.
+const size_t kMaxGroupDepth = 1000;
+
+const size_t kInfinite = static_cast<size_t>(-1);
+
+inline bool isWordByte(unsigned char c) {
+  return std::isalnum(c) || c == '_';
+}
+
+/// A parsed pattern, emitted as a program by the compiler.
+struct RegexNode {
+  enum class Kind {
+    Byte,
+    Any,
+    Class,
+    Concat,
+    Alternate,
+    Repeat,
+    Group,
+    Assert,
+  };
+
+  Kind kind{Kind::Concat};
+
+  /// The byte, class index, or capture group index.
+  size_t value{0};
+
+  /// The assertion operation.
+  LinearRegex::Op op{LinearRegex::Op::Match};
+
+  /// Repetition bounds.
+  size_t min{0};
+  size_t max{0};
+  bool greedy{true};
+
+  std::vector<size_t> children;
+};
+
+} // namespace
+
+/**
+ * @brief A recursive descent parser and code generator for LinearRegex.
+ *
+ * Errors are reported with the same failures std::regex would throw for, so
+ * callers may keep their existing error messages.
+ */
+class LinearRegexCompiler {
+ public:
+  LinearRegexCompiler(const std::string& pattern,
+                      size_t max_instructions,
+                      LinearRegex& regex)
+      : pattern_(pattern), max_instructions_(max_instructions), re_(regex) {}
+
+  Status compile() {
+    size_t root = 0;
+    auto s = parseAlternate(0, root);
+    if (!s.ok()) {
+      return s;
+    }
+    if (pos_ != pattern_.size()) {
+      // Only an unbalanced ')' stops the top-level alternation.
+      return Status::failure("Unbalanced parenthesis");
+    }
+
+    emit(LinearRegex::Op::Save, 0);
+    s = emitNode(root);
+    if (!s.ok()) {
+      return s;
+    }
+    emit(LinearRegex::Op::Save, 1);
+    emit(LinearRegex::Op::Match);
+    if (re_.program_.size() > max_instructions_) {
+      return tooComplex();
+    }
+    re_.groups_ = groups_;
+
+    // Every match starts with the byte following the first save.
+    if (re_.program_[1].op == LinearRegex::Op::Byte) {
+      re_.first_byte_ = static_cast<int>(re_.program_[1].x);
+    }
+    return Status::success();
+  }
+
+ private:
+  bool done() const {
+    return pos_ >= pattern_.size();
+  }
+
+  char peek() const {
+    return pattern_[pos_];
+  }
+
+  size_t addNode(RegexNode node) {
+    nodes_.push_back(std::move(node));
+    return nodes_.size() - 1;
+  }
+
+  static Status unsupported(const std::string& what) {
+    return Status(LinearRegex::kUnsupported, what + " are not supported");
+  }
+
+  static Status tooComplex() {
+    return Status(LinearRegex::kTooComplex, "Pattern is too complex");
+  }
+
+  Status parseAlternate(size_t depth, size_t& node) {
+    if (depth > kMaxGroupDepth) {
+      return tooComplex();
+    }
+
+    RegexNode alternate;
+    alternate.kind = RegexNode::Kind::Alternate;
+    while (true) {
+      size_t concat = 0;
+      auto s = parseConcat(depth, concat);
+      if (!s.ok()) {
+        return s;
+      }
+      alternate.children.push_back(concat);
+      if (done() || peek() != '|') {
+        break;
+      }
+      pos_++;
+    }
+
+    if (alternate.children.size() == 1) {
+      node = alternate.children[0];
+    } else {
+      node = addNode(std::move(alternate));
+    }
+    return Status::success();
+  }
+
+  Status parseConcat(size_t depth, size_t& node) {
+    RegexNode concat;
+    concat.kind = RegexNode::Kind::Concat;
+    while (!done() && peek() != '|' && peek() != ')') {
+      size_t atom = 0;
+      auto s = parseAtom(depth, atom);
+      if (!s.ok()) {
+        return s;
+      }
+      s = parseQuantifier(atom);
+      if (!s.ok()) {
+        return s;
+      }
+      concat.children.push_back(atom);
+    }
+    node = addNode(std::move(concat));
+    return Status::success();
+  }
+
+  /// Parse a decimal count within a brace quantifier.
+  bool parseCount(size_t& count) {
+    if (done() || !std::isdigit(static_cast<unsigned char>(peek()))) {
+      return false;
+    }
+    count = 0;
+    while (!done() && std::isdigit(static_cast<unsigned char>(peek()))) {
+      count = count * 10 + (peek() - '0');
+      if (count > kMaxRepeatCount) {
+        count = kMaxRepeatCount + 1;
+      }
+      pos_++;
+    }
+    return true;
+  }
+
+  Status parseQuantifier(size_t& atom) {
+    if (done()) {
+      return Status::success();
+    }
+
+    size_t min = 0;
+    size_t max = 0;
+    switch (peek()) {
+    case '*':
+      max = kInfinite;
+      break;
+    case '+':
+      min = 1;
+      max = kInfinite;
+      break;
+    case '?':
+      max = 1;
+      break;
+    case '{': {
+      pos_++;
+      if (!parseCount(min)) {
+        return Status::failure("Invalid brace quantifier");
+      }
+      max = min;
+      if (!done() && peek() == ',') {
+        pos_++;
+        max = kInfinite;
+        if (!done() && peek() != '}' && !parseCount(max)) {
+          return Status::failure("Invalid brace quantifier");
+        }
+      }
+      if (done() || peek() != '}' || max < min) {
+        return Status::failure("Invalid brace quantifier");
+      }
+      if (min > kMaxRepeatCount ||
+          (max != kInfinite && max > kMaxRepeatCount)) {
+        return tooComplex();
+      }
+      break;
+    }
+    default:
+      return Status::success();
+    }
+    pos_++;
+
+    if (nodes_[atom].kind == RegexNode::Kind::Assert) {
+      return Status::failure("Nothing to repeat");
+    }
+
+    RegexNode repeat;
+    repeat.kind = RegexNode::Kind::Repeat;
+    repeat.min = min;
+    repeat.max = max;
+    if (!done() && peek() == '?') {
+      repeat.greedy = false;
+      pos_++;
+    }
+    repeat.children.push_back(atom);
+    atom = addNode(std::move(repeat));
+
+    // Similar to std::regex, a repetition may be repeated again.
+    return parseQuantifier(atom);
+  }
+
+  Status parseAtom(size_t depth, size_t& node) {
+    RegexNode atom;
+    char c = peek();
+    pos_++;
+    switch (c) {
+    case '(': {
+      size_t group = 0;
+      if (!done() && peek() == '?') {
+        pos_++;
+        if (done()) {
+          return Status::failure("Invalid group");
+        }
+        if (peek() == '=' || peek() == '!') {
+          return unsupported("Lookahead assertions");
+        }
+        if (peek() != ':') {
+          return Status::failure("Invalid group");
+        }
+        pos_++;
+      } else {
+        group = groups_++;
+      }
+
+      size_t inner = 0;
+      auto s = parseAlternate(depth + 1, inner);
+      if (!s.ok()) {
+        return s;
+      }
+      if (done() || peek() != ')') {
+        return Status::failure("Unbalanced parenthesis");
+      }
+      pos_++;
+
+      if (group == 0) {
+        node = inner;
+        return Status::success();
+      }
+      atom.kind = RegexNode::Kind::Group;
+      atom.value = group;
+      atom.children.push_back(inner);
+      break;
+    }
+    case '[':
+      return parseClass(node);
+    case '.':
+      atom.kind = RegexNode::Kind::Any;
+      break;
+    case '^':
+      atom.kind = RegexNode::Kind::Assert;
+      atom.op = LinearRegex::Op::LineBegin;
+      break;
+    case '$':
+      atom.kind = RegexNode::Kind::Assert;
+      atom.op = LinearRegex::Op::LineEnd;
+      break;
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+      return Status::failure("Nothing to repeat");
+    case '\\':
+      return parseEscape(node);
+    default:
+      atom.kind = RegexNode::Kind::Byte;
+      atom.value = static_cast<unsigned char>(c);
+    }
+
+    node = addNode(std::move(atom));
+    return Status::success();
+  }
+
+  /// Parse a hexadecimal escape of a fixed number of digits.
+  bool parseHex(size_t digits, size_t& value) {
+    value = 0;
+    for (size_t i = 0; i < digits; i++) {
+      if (done() || !std::isxdigit(static_cast<unsigned char>(peek()))) {
+        return false;
+      }
+      auto c = static_cast<unsigned char>(std::tolower(peek()));
+      value = value * 16 + (std::isdigit(c) ? c - '0' : c - 'a' + 10);
+      pos_++;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Parse an escaped character or character class.
+   *
+   * @param in_class parsing within brackets, where '\b' is a backspace.
+   * @param set either the escaped class or the single escaped byte.
+   * @param is_class true if the escape is a class such as '\d'.
+   */
+  Status parseEscapeSet(bool in_class, std::bitset<256>& set, bool& is_class) {
+    if (done()) {
+      return Status::failure("Trailing escape");
+    }
+
+    is_class = false;
+    char c = peek();
+    pos_++;
+
+    auto byte = [&set](unsigned char b) { set.set(b); };
+    switch (c) {
+    case 'd':
+    case 'D':
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S': {
+      is_class = true;
+      auto lower = static_cast<char>(std::tolower(c));
+      for (size_t i = 0; i < 256; i++) {
+        auto b = static_cast<unsigned char>(i);
+        bool member = (lower == 'd')   ? std::isdigit(b) != 0
+                      : (lower == 'w') ? isWordByte(b)
+                                       : std::isspace(b) != 0;
+        if (member == (c == lower)) {
+          set.set(i);
+        }
+      }
+      return Status::success();
+    }
+    case 'n':
+      byte('\n');
+      break;
+    case 'r':
+      byte('\r');
+      break;
+    case 't':
+      byte('\t');
+      break;
+    case 'f':
+      byte('\f');
+      break;
+    case 'v':
+      byte('\v');
+      break;
+    case 'b':
+      // Only a backspace within brackets, otherwise a word boundary.
+      byte('\b');
+      break;
+    case '0':
+      byte('\0');
+      break;
+    case 'c':
+      if (done() || !std::isalpha(static_cast<unsigned char>(peek()))) {
+        return Status::failure("Invalid control escape");
+      }
+      byte(static_cast<unsigned char>(peek()) % 32);
+      pos_++;
+      break;
+    case 'x':
+    case 'u': {
+      size_t value = 0;
+      if (!parseHex((c == 'x') ? 2 : 4, value)) {
+        return Status::failure("Invalid hexadecimal escape");
+      }
+      if (value > 0xFF) {
+        return unsupported("Unicode escapes");
+      }
+      byte(static_cast<unsigned char>(value));
+      break;
+    }
+    default:
+      if (c >= '1' && c <= '9') {
+        return in_class ? Status::failure("Invalid escape")
+                        : unsupported("Backreferences");
+      }
+      byte(static_cast<unsigned char>(c));
+    }
+    return Status::success();
+  }
+
+  Status parseEscape(size_t& node) {
+    RegexNode atom;
+    if (!done() && (peek() == 'b' || peek() == 'B')) {
+      atom.kind = RegexNode::Kind::Assert;
+      atom.op = (peek() == 'b') ? LinearRegex::Op::WordBoundary
+                                : LinearRegex::Op::NotWordBoundary;
+      pos_++;
+      node = addNode(std::move(atom));
+      return Status::success();
+    }
+
+    std::bitset<256> set;
+    bool is_class = false;
+    auto s = parseEscapeSet(false, set, is_class);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (is_class) {
+      atom.kind = RegexNode::Kind::Class;
+      atom.value = re_.classes_.size();
+      re_.classes_.push_back(set);
+    } else {
+      atom.kind = RegexNode::Kind::Byte;
+      for (size_t i = 0; i < 256; i++) {
+        if (set[i]) {
+          atom.value = i;
+          break;
+        }
+      }
+    }
+    node = addNode(std::move(atom));
+    return Status::success();
+  }
+
+  /// Parse a '[:name:]' character class within brackets.
+  Status parseNamedClass(std::bitset<256>& set) {
+    auto end = pattern_.find(":]", pos_);
+    if (end == std::string::npos) {
+      return Status::failure("Invalid character class");
+    }
+    auto name = pattern_.substr(pos_, end - pos_);
+    pos_ = end + 2;
+
+    int (*test)(int) = nullptr;
+    if (name == "alnum") {
+      test = std::isalnum;
+    } else if (name == "alpha") {
+      test = std::isalpha;
+    } else if (name == "blank") {
+      test = std::isblank;
+    } else if (name == "cntrl") {
+      test = std::iscntrl;
+    } else if (name == "digit" || name == "d") {
+      test = std::isdigit;
+    } else if (name == "graph") {
+      test = std::isgraph;
+    } else if (name == "lower") {
+      test = std::islower;
+    } else if (name == "print") {
+      test = std::isprint;
+    } else if (name == "punct") {
+      test = std::ispunct;
+    } else if (name == "space" || name == "s") {
+      test = std::isspace;
+    } else if (name == "upper") {
+      test = std::isupper;
+    } else if (name == "xdigit") {
+      test = std::isxdigit;
+    } else if (name == "w") {
+      for (size_t i = 0; i < 256; i++) {
+        if (isWordByte(static_cast<unsigned char>(i))) {
+          set.set(i);
+        }
+      }
+      return Status::success();
+    } else {
+      return Status::failure("Invalid character class");
+    }
+
+    for (size_t i = 0; i < 256; i++) {
+      if (test(static_cast<int>(i)) != 0) {
+        set.set(i);
+      }
+    }
+    return Status::success();
+  }
+
+  /// Parse one bracket member, a byte for ranges or a set of bytes.
+  Status parseClassMember(std::bitset<256>& set, bool& is_byte, size_t& byte) {
+    is_byte = false;
+    std::bitset<256> member;
+    char c = peek();
+    pos_++;
+    if (c == '[' && !done() && peek() == ':') {
+      pos_++;
+      auto s = parseNamedClass(member);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (c == '[' && !done() && (peek() == '=' || peek() == '.')) {
+      return unsupported("Collating elements");
+    } else if (c == '\\') {
+      bool is_class = false;
+      auto s = parseEscapeSet(true, member, is_class);
+      if (!s.ok()) {
+        return s;
+      }
+      is_byte = !is_class;
+    } else {
+      member.set(static_cast<unsigned char>(c));
+      is_byte = true;
+    }
+
+    if (is_byte) {
+      for (byte = 0; byte < 256 && !member[byte]; byte++) {
+      }
+    }
+    set |= member;
+    return Status::success();
+  }
+
+  Status parseClass(size_t& node) {
+    bool negate = false;
+    if (!done() && peek() == '^') {
+      negate = true;
+      pos_++;
+    }
+
+    std::bitset<256> set;
+    while (true) {
+      if (done()) {
+        return Status::failure("Unbalanced bracket");
+      }
+      if (peek() == ']') {
+        pos_++;
+        break;
+      }
+
+      bool is_byte = false;
+      size_t first = 0;
+      auto s = parseClassMember(set, is_byte, first);
+      if (!s.ok()) {
+        return s;
+      }
+
+      // A '-' between two bytes is a range, otherwise it is a literal.
+      if (!is_byte || pos_ + 1 >= pattern_.size() || peek() != '-' ||
+          pattern_[pos_ + 1] == ']') {
+        continue;
+      }
+      pos_++;
+      bool last_is_byte = false;
+      size_t last = 0;
+      std::bitset<256> range;
+      s = parseClassMember(range, last_is_byte, last);
+      if (!s.ok()) {
+        return s;
+      }
+      if (!last_is_byte) {
+        set |= range;
+        set.set('-');
+        continue;
+      }
+      if (last < first) {
+        return Status::failure("Invalid range in bracket expression");
+      }
+      for (size_t i = first; i <= last; i++) {
+        set.set(i);
+      }
+    }
+
+    if (negate) {
+      set.flip();
+    }
+
+    RegexNode atom;
+    atom.kind = RegexNode::Kind::Class;
+    atom.value = re_.classes_.size();
+    re_.classes_.push_back(set);
+    node = addNode(std::move(atom));
+    return Status::success();
+  }
+
+  size_t emit(LinearRegex::Op op, size_t x = 0, size_t y = 0) {
+    LinearRegex::Instruction inst;
+    inst.op = op;
+    inst.x = x;
+    inst.y = y;
+    re_.program_.push_back(inst);
+    return re_.program_.size() - 1;
+  }
+
+  size_t next() const {
+    return re_.program_.size();
+  }
+
+  /// Emit a split, the greedy branch is preferred.
+  void setSplit(size_t split, size_t body, size_t exit, bool greedy) {
+    re_.program_[split].x = greedy ? body : exit;
+    re_.program_[split].y = greedy ? exit : body;
+  }
+
+  Status emitNode(size_t index) {
+    if (re_.program_.size() > max_instructions_) {
+      return tooComplex();
+    }
+
+    // Nodes are not added while emitting, the reference remains valid.
+    const auto& node = nodes_[index];
+    switch (node.kind) {
+    case RegexNode::Kind::Byte:
+      emit(LinearRegex::Op::Byte, node.value);
+      break;
+    case RegexNode::Kind::Any:
+      emit(LinearRegex::Op::Any);
+      break;
+    case RegexNode::Kind::Class:
+      emit(LinearRegex::Op::Class, node.value);
+      break;
+    case RegexNode::Kind::Assert:
+      emit(node.op);
+      break;
+    case RegexNode::Kind::Concat:
+      for (auto child : node.children) {
+        auto s = emitNode(child);
+        if (!s.ok()) {
+          return s;
+        }
+      }
+      break;
+    case RegexNode::Kind::Alternate: {
+      std::vector<size_t> jumps;
+      for (size_t i = 0; i < node.children.size(); i++) {
+        size_t split = 0;
+        bool last = (i + 1 == node.children.size());
+        if (!last) {
+          split = emit(LinearRegex::Op::Split);
+        }
+        auto s = emitNode(node.children[i]);
+        if (!s.ok()) {
+          return s;
+        }
+        if (!last) {
+          jumps.push_back(emit(LinearRegex::Op::Jump));
+          setSplit(split, split + 1, next(), true);
+        }
+      }
+      for (auto jump : jumps) {
+        re_.program_[jump].x = next();
+      }
+      break;
+    }
+    case RegexNode::Kind::Group: {
+      emit(LinearRegex::Op::Save, node.value * 2);
+      auto s = emitNode(node.children[0]);
+      if (!s.ok()) {
+        return s;
+      }
+      emit(LinearRegex::Op::Save, node.value * 2 + 1);
+      break;
+    }
+    case RegexNode::Kind::Repeat:
+      return emitRepeat(node);
+    }
+    return Status::success();
+  }
+
+  Status emitRepeat(const RegexNode& node) {
+    auto child = node.children[0];
+    for (size_t i = 0; i < node.min; i++) {
+      auto s = emitNode(child);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+
+    if (node.max == kInfinite) {
+      // L: split body, exit; body; loop L, exit; exit:
+      auto split = emit(LinearRegex::Op::Split);
+      auto s = emitNode(child);
+      if (!s.ok()) {
+        return s;
+      }
+      auto loop = emit(LinearRegex::Op::Loop, split);
+      re_.program_[loop].y = next();
+      setSplit(split, split + 1, next(), node.greedy);
+      return Status::success();
+    }
+
+    // Each optional repetition may exit to the end of the sequence.
+    std::vector<size_t> splits;
+    for (size_t i = node.min; i < node.max; i++) {
+      splits.push_back(emit(LinearRegex::Op::Split));
+      auto s = emitNode(child);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    for (auto split : splits) {
+      setSplit(split, split + 1, next(), node.greedy);
+    }
+    return Status::success();
+  }
+
+ private:
+  const std::string& pattern_;
+  size_t max_instructions_{0};
+  LinearRegex& re_;
+
+  size_t pos_{0};
+  size_t groups_{1};
+  std::vector<RegexNode> nodes_;
+};
+
+Status LinearRegex::compile(const std::string& pattern,
+                            size_t max_instructions,
+                            std::unique_ptr<LinearRegex>& regex) {
+  std::unique_ptr<LinearRegex> compiled(new LinearRegex());
+  LinearRegexCompiler compiler(pattern, max_instructions, *compiled);
+  auto s = compiler.compile();
+  if (!s.ok()) {
+    return s;
+  }
+
+  regex = std::move(compiled);
+  return Status::success();
+}
+
+bool LinearRegex::assertion(const Instruction& inst,
+                            const std::string& input,
+                            size_t pos) const {
+  switch (inst.op) {
+  case Op::LineBegin:
+    return pos == 0;
+  case Op::LineEnd:
+    return pos == input.size();
+  case Op::WordBoundary:
+  case Op::NotWordBoundary: {
+    bool before = pos > 0 && isWordByte(input[pos - 1]);
+    bool after = pos < input.size() && isWordByte(input[pos]);
+    return (before != after) == (inst.op == Op::WordBoundary);
+  }
+  default:
+    return false;
+  }
+}
+
+bool LinearRegex::search(const std::string& input,
+                         size_t start,
+                         bool continuous,
+                         bool not_null,
+                         Submatches& submatches) const {
+  const size_t slots = groups_ * 2;
+
+  // The threads of the current and next input position, in priority order.
+  struct ThreadList {
+    std::vector<size_t> pcs;
+    std::vector<std::ptrdiff_t> slots;
+
+    void clear() {
+      pcs.clear();
+      slots.clear();
+    }
+  };
+  ThreadList current;
+  ThreadList next;
+
+  // An instruction is added to a thread list at most once per position.
+  std::vector<size_t> marks(program_.size(), 0);
+  size_t generation = 1;
+
+  // Follow jumps, splits, saves, and assertions without consuming input.
+  struct Frame {
+    size_t pc;
+    std::ptrdiff_t slot;
+    std::ptrdiff_t value;
+  };
+  std::vector<Frame> stack;
+  std::vector<std::ptrdiff_t> work(slots, -1);
+  auto add = [&](ThreadList& list, size_t pc, size_t pos, size_t gen) {
+    stack.push_back({pc, -1, 0});
+    while (!stack.empty()) {
+      auto frame = stack.back();
+      stack.pop_back();
+      if (frame.slot >= 0) {
+        work[frame.slot] = frame.value;
+        continue;
+      }
+      if (marks[frame.pc] == gen) {
+        continue;
+      }
+      marks[frame.pc] = gen;
+
+      const auto& inst = program_[frame.pc];
+      switch (inst.op) {
+      case Op::Jump:
+        stack.push_back({inst.x, -1, 0});
+        break;
+      case Op::Loop:
+        // An iteration that matched nothing leaves the loop, like std::regex.
+        stack.push_back({(marks[inst.x] == gen) ? inst.y : inst.x, -1, 0});
+        break;
+      case Op::Split:
+        stack.push_back({inst.y, -1, 0});
+        stack.push_back({inst.x, -1, 0});
+        break;
+      case Op::Save:
+        if (inst.x < slots) {
+          auto slot = static_cast<std::ptrdiff_t>(inst.x);
+          stack.push_back({0, slot, work[inst.x]});
+          work[inst.x] = static_cast<std::ptrdiff_t>(pos);
+        }
+        stack.push_back({frame.pc + 1, -1, 0});
+        break;
+      case Op::LineBegin:
+      case Op::LineEnd:
+      case Op::WordBoundary:
+      case Op::NotWordBoundary:
+        if (assertion(inst, input, pos)) {
+          stack.push_back({frame.pc + 1, -1, 0});
+        }
+        break;
+      default:
+        list.pcs.push_back(frame.pc);
+        list.slots.insert(list.slots.end(), work.begin(), work.end());
+      }
+    }
+  };
+
+  bool matched = false;
+  for (size_t pos = start; pos <= input.size(); pos++) {
+    if (!matched && (!continuous || pos == start)) {
+      if (current.pcs.empty() && !continuous && first_byte_ >= 0) {
+        // Skip to the next possible start of a match.
+        auto found = std::memchr(input.data() + pos,
+                                 first_byte_,
+                                 input.size() - pos);
+        if (found == nullptr) {
+          break;
+        }
+        pos = static_cast<const char*>(found) - input.data();
+      }
+      std::fill(work.begin(), work.end(), -1);
+      add(current, 0, pos, generation);
+    }
+
+    if (current.pcs.empty()) {
+      if (matched || continuous) {
+        break;
+      }
+      generation++;
+      continue;
+    }
+
+    generation++;
+    for (size_t i = 0; i < current.pcs.size(); i++) {
+      const auto* thread = current.slots.data() + i * slots;
+      const auto& inst = program_[current.pcs[i]];
+      bool step = false;
+      if (inst.op == Op::Match) {
+        if (not_null && thread[0] == static_cast<std::ptrdiff_t>(pos)) {
+          continue;
+        }
+        submatches.assign(thread, thread + slots);
+        matched = true;
+        // Lower priority threads are cut.
+        break;
+      } else if (pos < input.size()) {
+        auto c = static_cast<unsigned char>(input[pos]);
+        if (inst.op == Op::Byte) {
+          step = (c == inst.x);
+        } else if (inst.op == Op::Any) {
+          step = (c != '\n' && c != '\r');
+        } else if (inst.op == Op::Class) {
+          step = classes_[inst.x][c];
+        }
+      }
+
+      if (step) {
+        work.assign(thread, thread + slots);
+        add(next, current.pcs[i] + 1, pos + 1, generation);
+      }
+    }
+
+    std::swap(current, next);
+    next.clear();
+  }
+
+  return matched;
+}
+
+} // namespace osquery
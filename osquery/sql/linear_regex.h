@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <osquery/utils/status/status.h>
+
+namespace osquery {
+
+/**
+ * @brief A regular expression matcher that runs in linear time.
+ *
+ * Patterns use the ECMAScript syntax of std::regex, without backreferences
+ * and lookahead assertions. They are compiled into a small program that is
+ * executed as a Pike VM, so matching visits each input byte once per program
+ * instruction and never backtracks. Submatches follow the same leftmost-first
+ * rules as std::regex, with one exception.
+ *
+ * A repetition whose body can match nothing, such as '(a*)*', '(.??)+' or
+ * '(|[^a]){2,}', stops at the first iteration that matches nothing, as the
+ * ECMAScript standard requires. std::regex in libstdc++ accepts up to two
+ * such iterations at the same offset, and backtracks into them. A search
+ * still finds a match at the same offset, but the end of the match and the
+ * groups may differ. For example '(a*)*' on "aab" ends with a group of "aa",
+ * not the empty group std::regex reports, and with not_null '(.??)+' on
+ * ".ba a" matches the whole input, not only ".".
+ *
+ * A compiled LinearRegex is immutable, and may be used from several threads.
+ */
+class LinearRegex : private boost::noncopyable {
+ public:
+  /// Compile failures for patterns that need a backtracking engine.
+  static constexpr int kUnsupported = 2;
+
+  /// Compile failures for patterns exceeding the instruction budget.
+  static constexpr int kTooComplex = 3;
+
+  /// Offsets of a match and its groups, -1 if a group did not participate.
+  using Submatches = std::vector<std::ptrdiff_t>;
+
+  /**
+   * @brief Compile a pattern.
+   *
+   * @param pattern an ECMAScript regular expression.
+   * @param max_instructions the program size budget, which bounds the memory
+   * needed to compile and to match.
+   * @param regex the output compiled regular expression.
+   * @return failure for invalid patterns, with the code kUnsupported or
+   * kTooComplex when the pattern is valid but cannot be compiled.
+   */
+  static Status compile(const std::string& pattern,
+                        size_t max_instructions,
+                        std::unique_ptr<LinearRegex>& regex);
+
+  /**
+   * @brief Search for the leftmost match at or after an offset.
+   *
+   * Assertions such as '^' and word boundaries see the whole input, similar
+   * to std::regex_constants::match_prev_avail.
+   *
+   * @param input the input string.
+   * @param start the offset to search from.
+   * @param continuous only match at the start offset.
+   * @param not_null do not accept an empty match.
+   * @param submatches set to the begin and end offsets of each group, group 0
+   * is the whole match.
+   * @return true if a match was found.
+   */
+  bool search(const std::string& input,
+              size_t start,
+              bool continuous,
+              bool not_null,
+              Submatches& submatches) const;
+
+  /// Number of groups, including the whole match.
+  size_t groups() const {
+    return groups_;
+  }
+
+ public:
+  enum class Op {
+    Byte,
+    Any,
+    Class,
+    Split,
+    Jump,
+    Loop,
+    Save,
+    LineBegin,
+    LineEnd,
+    WordBoundary,
+    NotWordBoundary,
+    Match,
+  };
+
+  struct Instruction {
+    Op op;
+
+    /// The byte, class index, save slot, first branch, or loop start.
+    size_t x{0};
+
+    /// The second, lower priority, branch of a split, or the loop exit.
+    size_t y{0};
+  };
+
+ private:
+  LinearRegex() = default;
+
+  bool assertion(const Instruction& inst,
+                 const std::string& input,
+                 size_t pos) const;
+
+ private:
+  std::vector<Instruction> program_;
+
+  std::vector<std::bitset<256>> classes_;
+
+  size_t groups_{1};
+
+  /// A byte every match starts with, or -1.
+  int first_byte_{-1};
+
+ private:
+  friend class LinearRegexCompiler;
+};
+
+} // namespace osquery
@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include <osquery/core/core.h>
@@ -25,6 +26,10 @@ namespace osquery {
 
 CREATE_LAZY_REGISTRY(SQLPlugin, "sql");
 
+/// The deadline of queries run by this thread, max() if there is none.
+static thread_local std::chrono::steady_clock::time_point kQueryDeadline{
+    std::chrono::steady_clock::time_point::max()};
+
 SQL::SQL(const std::string& query, bool use_cache) {
   TableColumns table_columns;
   status_ = getQueryColumns(query, table_columns);
@@ -36,6 +41,23 @@ SQL::SQL(const std::string& query, bool use_cache) {
   }
 }
 
+SQLDeadline::SQLDeadline(std::chrono::milliseconds timeout)
+    : previous_(kQueryDeadline) {
+  if (timeout.count() > 0) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    kQueryDeadline = std::min(kQueryDeadline, deadline);
+  }
+}
+
+SQLDeadline::~SQLDeadline() {
+  kQueryDeadline = previous_;
+}
+
+bool SQLDeadline::expired() {
+  return kQueryDeadline != std::chrono::steady_clock::time_point::max() &&
+         std::chrono::steady_clock::now() >= kQueryDeadline;
+}
+
 const QueryData& SQL::rows() const {
   return results_;
 }
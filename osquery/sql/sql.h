@@ -9,10 +9,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <string>
 #include <vector>
 
+#include <boost/noncopyable.hpp>
+
 #include <osquery/core/flags.h>
 #include <osquery/core/query.h>
 #include <osquery/core/tables.h>
@@ -156,6 +159,41 @@ class SQL : private only_movable {
   ColumnNames columns_;
 };
 
+/**
+ * @brief Interrupt the queries run by a thread after a deadline.
+ *
+ * While a SQLDeadline exists, queries run by the thread that created it fail
+ * once the deadline has passed. The deadline is checked between SQLite
+ * instructions, so a table that is generating rows completes them first.
+ *
+ * @code{.cpp}
+ *   SQLDeadline deadline(std::chrono::seconds(10));
+ *   SQL sql("SELECT * FROM file WHERE path LIKE '/%%'");
+ *   if (!sql.ok() && SQLDeadline::expired()) {
+ *     LOG(ERROR) << "Query did not complete within 10 seconds";
+ *   }
+ * @endcode
+ */
+class SQLDeadline : private boost::noncopyable {
+ public:
+  /**
+   * @brief Start a deadline for the calling thread.
+   *
+   * @param timeout the time queries may run for, 0 for no deadline.
+   */
+  explicit SQLDeadline(std::chrono::milliseconds timeout);
+
+  /// Restore the previous deadline of the thread.
+  ~SQLDeadline();
+
+  /// Check if the deadline of the calling thread has passed.
+  static bool expired();
+
+ private:
+  /// The deadline of the thread before this one.
+  std::chrono::steady_clock::time_point previous_;
+};
+
 /**
  * @brief Execute a query.
  *
@@ -16,12 +16,14 @@
 #endif
 
 #include <functional>
+#include <memory>
 #include <regex>
 #include <string>
 #include <vector>
 
 #include <osquery/core/flags.h>
 #include <osquery/logger/logger.h>
+#include <osquery/sql/linear_regex.h>
 #include <osquery/utils/conversions/split.h>
 
 #include <sqlite3.h>
@@ -35,9 +37,105 @@ HIDDEN_FLAG(
     "Defines the maximum size in bytes of a regex that can be used with the "
     "regex_match and regex_split functions");
 
+/// Instruction budget of a compiled regex_match or regex_split pattern.
+const size_t kRegexMaxInstructions = 16384;
+
 using SplitResult = std::vector<std::string>;
-using StringSplitFunction = std::function<SplitResult(
-    const std::string& input, const std::string& tokens)>;
+using StringSplitFunction =
+    std::function<SplitResult(sqlite3_context* context,
+                              const std::string& input,
+                              const std::string& tokens)>;
+
+/**
+ * @brief A pattern for the regex_match and regex_split functions.
+ *
+ * Patterns are matched in linear time with a LinearRegex. Only patterns that
+ * need backtracking, such as backreferences, fall back to std::regex.
+ */
+class SQLiteRegex {
+ public:
+  /// Compile a pattern, throws std::regex_error if it is invalid.
+  explicit SQLiteRegex(const std::string& pattern) {
+    auto status =
+        LinearRegex::compile(pattern, kRegexMaxInstructions, linear_);
+    if (status.getCode() == LinearRegex::kTooComplex) {
+      throw std::regex_error(std::regex_constants::error_complexity);
+    } else if (!status.ok()) {
+      // Report the same errors as std::regex for invalid patterns.
+      fallback_ = std::make_unique<std::regex>(pattern);
+    }
+  }
+
+  /// See LinearRegex::search.
+  bool search(const std::string& input,
+              size_t start,
+              bool continuous,
+              bool not_null,
+              LinearRegex::Submatches& submatches) const {
+    if (linear_ != nullptr) {
+      return linear_->search(input, start, continuous, not_null, submatches);
+    }
+
+    auto flags = std::regex_constants::match_default;
+    if (start > 0) {
+      flags |= std::regex_constants::match_prev_avail;
+    }
+    if (continuous) {
+      flags |= std::regex_constants::match_continuous;
+    }
+    if (not_null) {
+      flags |= std::regex_constants::match_not_null;
+    }
+
+    std::smatch results;
+    if (!std::regex_search(
+            input.begin() + start, input.end(), results, *fallback_, flags)) {
+      return false;
+    }
+
+    submatches.clear();
+    for (const auto& result : results) {
+      submatches.push_back(result.matched ? result.first - input.begin() : -1);
+      submatches.push_back(result.matched ? result.second - input.begin()
+                                          : -1);
+    }
+    return true;
+  }
+
+ private:
+  std::unique_ptr<LinearRegex> linear_;
+
+  std::unique_ptr<std::regex> fallback_;
+};
+
+/// Get the pattern compiled for the statement's current pattern argument.
+static const SQLiteRegex* getCachedRegex(sqlite3_context* context) {
+  return static_cast<const SQLiteRegex*>(sqlite3_get_auxdata(context, 1));
+}
+
+/**
+ * @brief Keep a compiled pattern for the remaining rows of the statement.
+ *
+ * SQLite discards the pattern when the argument changes, and may do so before
+ * this returns. The pattern must not be used afterward.
+ */
+static void setCachedRegex(sqlite3_context* context,
+                           std::unique_ptr<SQLiteRegex> regex) {
+  sqlite3_set_auxdata(context, 1, regex.release(), [](void* regex) {
+    delete static_cast<SQLiteRegex*>(regex);
+  });
+}
+
+/// Select the text of a submatch, or empty if the group did not participate.
+static std::string submatchText(const std::string& input,
+                                const LinearRegex::Submatches& submatches,
+                                size_t index) {
+  auto begin = submatches[index * 2];
+  if (begin < 0) {
+    return "";
+  }
+  return input.substr(begin, submatches[index * 2 + 1] - begin);
+}
 
 /**
  * @brief A simple SQLite column string split implementation.
@@ -54,7 +152,8 @@ using StringSplitFunction = std::function<SplitResult(
  *   3. SELECT SPLIT(ip_address, ".0", 0) from addresses;
  *      192
  */
-static SplitResult tokenSplit(const std::string& input,
+static SplitResult tokenSplit(sqlite3_context* context,
+                              const std::string& input,
                               const std::string& tokens) {
   return osquery::split(input, tokens);
 }
@@ -73,22 +172,57 @@ static SplitResult tokenSplit(const std::string& input,
  *   3. SELECT SPLIT(ip_address, "\.0", 0) from addresses;
  *      192.168
  */
-static SplitResult regexSplit(const std::string& input,
+static SplitResult regexSplit(sqlite3_context* context,
+                              const std::string& input,
                               const std::string& token) {
   // Split using the token as a regex to support multi-character tokens.
   // Exceptions are caught by the caller, as that's where the sql context is
-  std::vector<std::string> result;
-
-  if (token.size() > FLAGS_regex_max_size) {
-    throw std::regex_error(std::regex_constants::error_complexity);
+  std::unique_ptr<SQLiteRegex> compiled;
+  auto pattern = getCachedRegex(context);
+  if (pattern == nullptr) {
+    if (token.size() > FLAGS_regex_max_size) {
+      throw std::regex_error(std::regex_constants::error_complexity);
+    }
+    compiled = std::make_unique<SQLiteRegex>(token);
+    pattern = compiled.get();
   }
 
-  std::regex pattern = std::regex(token);
-  std::sregex_token_iterator iter_begin(
-      input.begin(), input.end(), pattern, -1);
-  std::sregex_token_iterator iter_end;
-  std::copy(iter_begin, iter_end, std::back_inserter(result));
+  // Collect the text between matches, the same as std::sregex_token_iterator
+  // selecting the -1 submatch.
+  SplitResult result;
+  LinearRegex::Submatches match;
+  if (!pattern->search(input, 0, false, false, match)) {
+    result.push_back(input);
+  } else {
+    size_t prefix = 0;
+    while (true) {
+      result.push_back(input.substr(prefix, match[0] - prefix));
+      prefix = match[1];
+
+      bool found = false;
+      if (match[0] == match[1]) {
+        // After an empty match try a non-empty match at the same offset.
+        if (prefix == input.size()) {
+          break;
+        }
+        found = pattern->search(input, prefix, true, true, match) ||
+                pattern->search(input, prefix + 1, false, false, match);
+      } else {
+        found = pattern->search(input, prefix, false, false, match);
+      }
+      if (!found) {
+        break;
+      }
+    }
+
+    if (prefix < input.size()) {
+      result.push_back(input.substr(prefix));
+    }
+  }
 
+  if (compiled != nullptr) {
+    setCachedRegex(context, std::move(compiled));
+  }
   return result;
 }
 
@@ -115,7 +249,7 @@ static void callStringSplitFunc(sqlite3_context* context,
     return;
   }
 
-  auto result = f(input, token);
+  auto result = f(context, input, token);
   if (index >= result.size()) {
     // Could emit a warning about a selected index that is out of bounds.
     sqlite3_result_null(context);
@@ -173,41 +307,46 @@ static void regexStringMatchFunc(sqlite3_context* context,
   // parse and verify input parameters
   const std::string input(
       reinterpret_cast<const char*>(sqlite3_value_text(argv[0])));
-  std::smatch results;
   auto index = static_cast<size_t>(sqlite3_value_int(argv[2]));
-  bool isMatchFound = false;
-
-  if (strnlen(regex, FLAGS_regex_max_size) == FLAGS_regex_max_size &&
-      regex[FLAGS_regex_max_size] != '\0') {
-    std::string error = "Invalid regex: too big, max size is " +
-                        std::to_string(FLAGS_regex_max_size) + " bytes";
-    LOG(INFO) << error;
-    sqlite3_result_error(context, error.c_str(), -1);
-    return;
-  }
 
-  try {
-    isMatchFound = std::regex_search(input, results, std::regex(regex));
-  } catch (const std::regex_error& e) {
-    LOG(INFO) << "Invalid regex: " << e.what();
-    sqlite3_result_error(context, "Invalid regex", -1);
-    return;
-  }
+  // The pattern is compiled once for each statement.
+  std::unique_ptr<SQLiteRegex> compiled;
+  auto pattern = getCachedRegex(context);
+  if (pattern == nullptr) {
+    if (strnlen(regex, FLAGS_regex_max_size) == FLAGS_regex_max_size &&
+        regex[FLAGS_regex_max_size] != '\0') {
+      std::string error = "Invalid regex: too big, max size is " +
+                          std::to_string(FLAGS_regex_max_size) + " bytes";
+      LOG(INFO) << error;
+      sqlite3_result_error(context, error.c_str(), -1);
+      return;
+    }
 
-  if (!isMatchFound) {
-    sqlite3_result_null(context);
-    return;
+    try {
+      compiled = std::make_unique<SQLiteRegex>(regex);
+    } catch (const std::regex_error& e) {
+      LOG(INFO) << "Invalid regex: " << e.what();
+      sqlite3_result_error(context, "Invalid regex", -1);
+      return;
+    }
+    pattern = compiled.get();
   }
 
-  if (index >= results.size()) {
+  LinearRegex::Submatches results;
+  if (!pattern->search(input, 0, false, false, results) ||
+      index * 2 >= results.size()) {
     sqlite3_result_null(context);
-    return;
+  } else {
+    auto match = submatchText(input, results, index);
+    sqlite3_result_text(context,
+                        match.c_str(),
+                        static_cast<int>(match.size()),
+                        SQLITE_TRANSIENT);
   }
 
-  sqlite3_result_text(context,
-                      results[index].str().c_str(),
-                      static_cast<int>(results[index].str().size()),
-                      SQLITE_TRANSIENT);
+  if (compiled != nullptr) {
+    setCachedRegex(context, std::move(compiled));
+  }
 }
 
 static void concatFunc(sqlite3_context* context,
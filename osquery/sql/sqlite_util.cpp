@@ -12,8 +12,6 @@
 
 #include <osquery/core/plugins/sql.h>
 
-#include <osquery/utils/conversions/castvariant.h>
-
 #include <osquery/core/core.h>
 #include <osquery/core/flags.h>
 #include <osquery/core/shutdown.h>
@@ -25,6 +23,12 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <set>
+
 namespace osquery {
 
 FLAG(string,
@@ -39,6 +43,11 @@ FLAG(string,
 
 FLAG(string, nullvalue, "", "Set string for NULL values, default ''");
 
+FLAG(uint32,
+     sql_statement_cache_size,
+     256,
+     "Prepared statements cached for repeated queries (0 disables)");
+
 using OpReg = QueryPlanner::Opcode::Register;
 
 using SQLiteDBInstanceRef = std::shared_ptr<SQLiteDBInstance>;
@@ -184,7 +193,7 @@ Status SQLiteSQLPlugin::getQueryTables(const std::string& query,
 SQLInternal::SQLInternal(const std::string& query, bool use_cache) {
   auto dbc = SQLiteDBManager::get();
   dbc->useCache(use_cache);
-  status_ = queryInternal(query, resultsTyped_, dbc);
+  status_ = queryInternal(query, results_, dbc);
 
   // One of the advantages of using SQLInternal (aside from the Registry-bypass)
   // is the ability to "deep-inspect" the table attributes and actions.
@@ -193,8 +202,8 @@ SQLInternal::SQLInternal(const std::string& query, bool use_cache) {
   dbc->clearAffectedTables();
 }
 
-QueryDataTyped& SQLInternal::rowsTyped() {
-  return resultsTyped_;
+QueryResults& SQLInternal::results() {
+  return results_;
 }
 
 const Status& SQLInternal::getStatus() const {
@@ -210,26 +219,8 @@ bool SQLInternal::eventBased() const {
 // make CRs smaller)
 extern void escapeNonPrintableBytesEx(std::string& str);
 
-class StringEscaperVisitor : public boost::static_visitor<> {
- public:
-  void operator()(long long& i) const { // NO-OP
-  }
-
-  void operator()(double& d) const { // NO-OP
-  }
-
-  void operator()(std::string& str) const {
-    escapeNonPrintableBytesEx(str);
-  }
-};
-
-void SQLInternal::escapeResults() {
-  StringEscaperVisitor visitor;
-  for (auto& rowTyped : resultsTyped_) {
-    for (auto& column : rowTyped) {
-      boost::apply_visitor(visitor, column.second);
-    }
-  }
+Status SQLInternal::escapeResults() {
+  return results_.transformText(escapeNonPrintableBytesEx);
 }
 
 Status SQLiteSQLPlugin::attach(const std::string& name) {
@@ -298,6 +289,12 @@ int sqliteAuthorizer(void* userData,
   return SQLITE_DENY;
 }
 
+// This function is called by SQLite between instructions of running
+// statements, a non-zero return interrupts the statement.
+static int sqliteProgress(void* userData) {
+  return SQLDeadline::expired() ? 1 : 0;
+}
+
 static inline void openOptimized(sqlite3*& db) {
   sqlite3_open(":memory:", &db);
 
@@ -324,6 +321,9 @@ static inline void openOptimized(sqlite3*& db) {
     LOG(ERROR) << "Failed to set sqlite authorizer: " << sqlite3_errmsg(db);
     requestShutdown(rc);
   }
+
+  // Check for query deadlines every few hundred instructions.
+  sqlite3_progress_handler(db, 500, &sqliteProgress, nullptr);
 }
 
 void SQLiteDBInstance::init() {
@@ -339,6 +339,14 @@ bool SQLiteDBInstance::useCache() const {
   return use_cache_;
 }
 
+void SQLiteDBInstance::lazyAttach(bool lazy_attach) {
+  lazy_attach_ = lazy_attach;
+}
+
+bool SQLiteDBInstance::lazyAttach() const {
+  return lazy_attach_;
+}
+
 RecursiveLock SQLiteDBInstance::attachLock() const {
   if (isPrimary()) {
     return RecursiveLock(kPrimaryAttachMutex);
@@ -370,6 +378,36 @@ TableAttributes SQLiteDBInstance::getAttributes() const {
   return attributes;
 }
 
+void SQLiteDBInstance::addPlannedIndex(
+    std::shared_ptr<VirtualTableContent> table, size_t index) {
+  // Only statements prepared on the primary database are cached.
+  if (isPrimary()) {
+    SQLitePlannedIndex plan;
+    plan.table = std::move(table);
+    plan.index = index;
+    planned_indexes_.push_back(std::move(plan));
+  }
+}
+
+std::vector<SQLitePlannedIndex> SQLiteDBInstance::takePlannedIndexes() {
+  if (isPrimary() && !managed_) {
+    // Similarly to clearAffectedTables, the connection is forwarded. This
+    // instance holds the primary lock so the connection cannot be reset.
+    return SQLiteDBManager::instance().connection_->takePlannedIndexes();
+  }
+
+  std::vector<SQLitePlannedIndex> planned;
+  planned.swap(planned_indexes_);
+  return planned;
+}
+
+SQLiteStatementCache* SQLiteDBInstance::statementCache() const {
+  if (!isPrimary()) {
+    return nullptr;
+  }
+  return &SQLiteDBManager::instance().statements_;
+}
+
 void SQLiteDBInstance::clearAffectedTables() {
   if (isPrimary() && !managed_) {
     // A primary instance must forward clear requests to the DB manager's
@@ -387,6 +425,7 @@ void SQLiteDBInstance::clearAffectedTables() {
   // Since the affected tables are cleared, there are no more affected tables.
   // There is no concept of compounding tables between queries.
   affected_tables_.clear();
+  planned_indexes_.clear();
   use_cache_ = false;
 }
 
@@ -448,6 +487,7 @@ void SQLiteDBManager::resetPrimary() {
 
   {
     WriteLock create_lock(self.create_mutex_);
+    self.statements_.clear();
     sqlite3_close(self.db_);
     self.db_ = nullptr;
   }
@@ -467,7 +507,7 @@ void SQLiteDBManager::setEnabledTables(const std::string& list) {
 
 SQLiteDBInstanceRef SQLiteDBManager::getUnique() {
   auto instance = std::make_shared<SQLiteDBInstance>();
-  attachVirtualTables(instance);
+  attachVirtualTablesLazily(instance);
   return instance;
 }
 
@@ -490,20 +530,105 @@ SQLiteDBInstanceRef SQLiteDBManager::getConnection(bool primary) {
   // Create a 'database connection' for the managed database instance.
   auto instance = std::make_shared<SQLiteDBInstance>(self.db_, self.mutex_);
   if (!instance->isPrimary()) {
-    attachVirtualTables(instance);
+    attachVirtualTablesLazily(instance);
   }
 
   return instance;
 }
 
+void SQLiteDBManager::clearStatementCache() {
+  instance().statements_.clear();
+}
+
+SQLiteStatementCacheStats SQLiteDBManager::getStatementCacheStats() {
+  return instance().statements_.stats();
+}
+
 SQLiteDBManager::~SQLiteDBManager() {
   connection_ = nullptr;
+  statements_.clear();
   if (db_ != nullptr) {
     sqlite3_close(db_);
     db_ = nullptr;
   }
 }
 
+SQLiteStatementCache::~SQLiteStatementCache() {
+  clear();
+}
+
+bool SQLiteStatementCache::take(const std::string& sql,
+                                SQLiteCachedStatement& statement) {
+  WriteLock lock(mutex_);
+  auto it = index_.find(sql);
+  if (it == index_.end()) {
+    misses_++;
+    return false;
+  }
+
+  statement = std::move(it->second->second);
+  statements_.erase(it->second);
+  index_.erase(it);
+
+  hits_++;
+  prepare_time_saved_ += statement.prepare_time;
+  return true;
+}
+
+void SQLiteStatementCache::put(const std::string& sql,
+                               SQLiteCachedStatement statement) {
+  WriteLock lock(mutex_);
+  size_t capacity = FLAGS_sql_statement_cache_size;
+  if (capacity == 0 || statement.generation != generation_ ||
+      index_.count(sql) > 0) {
+    // The cache was disabled or cleared while the statement was in use, or
+    // the same SQL was cached by a concurrent query.
+    sqlite3_finalize(statement.stmt);
+    return;
+  }
+
+  statements_.emplace_front(sql, std::move(statement));
+  index_[sql] = statements_.begin();
+
+  while (statements_.size() > capacity) {
+    auto& last = statements_.back();
+    sqlite3_finalize(last.second.stmt);
+    index_.erase(last.first);
+    statements_.pop_back();
+  }
+}
+
+void SQLiteStatementCache::clear() {
+  WriteLock lock(mutex_);
+  for (auto& statement : statements_) {
+    sqlite3_finalize(statement.second.stmt);
+  }
+  statements_.clear();
+  index_.clear();
+  generation_++;
+}
+
+size_t SQLiteStatementCache::generation() const {
+  ReadLock lock(mutex_);
+  return generation_;
+}
+
+SQLiteStatementCacheStats SQLiteStatementCache::stats() const {
+  SQLiteStatementCacheStats stats;
+  stats.capacity = FLAGS_sql_statement_cache_size;
+
+  ReadLock lock(mutex_);
+  stats.statements = statements_.size();
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.prepare_time_saved = prepare_time_saved_;
+  for (const auto& statement : statements_) {
+    stats.memory_used += sqlite3_stmt_status(
+        statement.second.stmt, SQLITE_STMTSTATUS_MEMUSED, 0);
+  }
+  return stats;
+}
+
 QueryPlanner::QueryPlanner(const std::string& query,
                            const SQLiteDBInstanceRef& instance) {
   QueryData plan;
@@ -579,76 +704,73 @@ Status QueryPlanner::applyTypes(TableColumns& columns) {
   return Status(0);
 }
 
-// Wrapper for legacy method until all uses can be replaced
-Status queryInternal(const std::string& query,
-                     QueryData& results,
-                     const SQLiteDBInstanceRef& instance) {
-  QueryDataTyped typedResults;
-  Status status = queryInternal(query, typedResults, instance);
-  if (status.ok()) {
-    results.reserve(typedResults.size());
-    for (const auto& row : typedResults) {
-      Row r;
-      for (const auto& col : row) {
-        r[col.first] = castVariant(col.second);
-      }
-      results.push_back(std::move(r));
-    }
-  }
-  return status;
-}
-
-Status readRows(sqlite3_stmt* prepared_statement,
-                QueryDataTyped& results,
-                const SQLiteDBInstanceRef& instance) {
-  // Do nothing with a null prepared_statement (eg, if the sql was just
-  // whitespace)
-  if (prepared_statement == nullptr) {
-    return Status::success();
-  }
+static Status stepRows(sqlite3_stmt* prepared_statement,
+                       QueryResults& results,
+                       const SQLiteDBInstanceRef& instance) {
   int rc = sqlite3_step(prepared_statement);
   /* if we have a result set row... */
   if (SQLITE_ROW == rc) {
-    // First collect the column names
+    // First collect the column names, they are stored once for all rows.
     int num_columns = sqlite3_column_count(prepared_statement);
-    std::vector<std::string> colNames;
+    ColumnNames colNames;
     colNames.reserve(num_columns);
     for (int i = 0; i < num_columns; i++) {
       colNames.push_back(sqlite3_column_name(prepared_statement, i));
     }
+    results = QueryResults(std::move(colNames));
 
     do {
-      RowTyped row;
-      for (int i = 0; i < num_columns; i++) {
+      Status status;
+      for (int i = 0; i < num_columns && status.ok(); i++) {
         switch (sqlite3_column_type(prepared_statement, i)) {
         case SQLITE_INTEGER:
-          row[colNames[i]] = static_cast<long long>(
-              sqlite3_column_int64(prepared_statement, i));
+          results.addInteger(static_cast<long long>(
+              sqlite3_column_int64(prepared_statement, i)));
           break;
         case SQLITE_FLOAT:
-          row[colNames[i]] = sqlite3_column_double(prepared_statement, i);
+          results.addReal(sqlite3_column_double(prepared_statement, i));
           break;
         case SQLITE_NULL:
-          row[colNames[i]] = FLAGS_nullvalue;
+          status = results.addText(FLAGS_nullvalue);
           break;
-        default:
+        default: {
           // Everything else (SQLITE_TEXT, SQLITE3_TEXT, SQLITE_BLOB) is
           // obtained/conveyed as text/string
-          row[colNames[i]] = std::string(reinterpret_cast<const char*>(
-              sqlite3_column_text(prepared_statement, i)));
+          auto text = reinterpret_cast<const char*>(
+              sqlite3_column_text(prepared_statement, i));
+          status = results.addText(text != nullptr ? text : "");
         }
+        }
+      }
+      if (!status.ok()) {
+        results.clear();
+        return status;
       }
-      results.push_back(std::move(row));
       rc = sqlite3_step(prepared_statement);
     } while (SQLITE_ROW == rc);
   }
   if (rc != SQLITE_DONE) {
-    auto s = Status::failure(sqlite3_errmsg(instance->db()));
+    return Status::failure(sqlite3_errmsg(instance->db()));
+  }
+  return Status::success();
+}
+
+static Status readRows(sqlite3_stmt* prepared_statement,
+                       QueryResults& results,
+                       const SQLiteDBInstanceRef& instance) {
+  // Do nothing with a null prepared_statement (eg, if the sql was just
+  // whitespace)
+  if (prepared_statement == nullptr) {
+    return Status::success();
+  }
+
+  auto s = stepRows(prepared_statement, results, instance);
+  if (!s.ok()) {
     sqlite3_finalize(prepared_statement);
     return s;
   }
 
-  rc = sqlite3_finalize(prepared_statement);
+  auto rc = sqlite3_finalize(prepared_statement);
   if (rc != SQLITE_OK) {
     return Status::failure(sqlite3_errmsg(instance->db()));
   }
@@ -656,15 +778,159 @@ Status readRows(sqlite3_stmt* prepared_statement,
   return Status::success();
 }
 
-Status queryInternal(const std::string& query,
-                     QueryDataTyped& results,
-                     const SQLiteDBInstanceRef& instance) {
+/// Copy the constraint sets xBestIndex planned for a statement.
+static std::vector<SQLitePlannedIndex> savePlans(
+    std::vector<SQLitePlannedIndex> plans) {
+  for (auto& plan : plans) {
+    auto& content = *plan.table;
+    auto constraints = content.constraints.find(plan.index);
+    if (constraints != content.constraints.end()) {
+      plan.constraints = constraints->second;
+    }
+    auto columns = content.colsUsed.find(plan.index);
+    if (columns != content.colsUsed.end()) {
+      plan.columns = columns->second;
+    }
+    auto bitset = content.colsUsedBitsets.find(plan.index);
+    if (bitset != content.colsUsedBitsets.end()) {
+      plan.columns_bitset = bitset->second;
+    }
+  }
+  return plans;
+}
+
+/// Step a statement owned by the statement cache, then return it.
+static Status readCachedRows(const std::string& sql,
+                             SQLiteCachedStatement statement,
+                             QueryResults& results,
+                             const SQLiteDBInstanceRef& instance) {
+  // Virtual tables forget their constraint sets after every query.
+  for (const auto& plan : statement.plans) {
+    auto& content = *plan.table;
+    content.constraints[plan.index] = plan.constraints;
+    content.colsUsed[plan.index] = plan.columns;
+    content.colsUsedBitsets[plan.index] = plan.columns_bitset;
+  }
+
+  // Other statements prepared on this connection leave their plans behind.
+  instance->takePlannedIndexes();
+  auto reprepared = sqlite3_stmt_status(
+      statement.stmt, SQLITE_STMTSTATUS_REPREPARE, 0);
+
+  auto s = stepRows(statement.stmt, results, instance);
+
+  // SQLite re-prepares a statement when the schema changed since it was
+  // prepared, which plans the virtual table scans again.
+  auto planned = instance->takePlannedIndexes();
+  if (!planned.empty() &&
+      sqlite3_stmt_status(statement.stmt, SQLITE_STMTSTATUS_REPREPARE, 0) !=
+          reprepared) {
+    statement.plans = savePlans(std::move(planned));
+  }
+
+  if (!s.ok()) {
+    sqlite3_finalize(statement.stmt);
+    return s;
+  }
+
+  sqlite3_reset(statement.stmt);
+  instance->statementCache()->put(sql, std::move(statement));
+  return Status::success();
+}
+
+/// Read the table name from a "no such table" prepare error.
+static bool getMissingTable(const char* error, std::string& name) {
+  const std::string prefix = "no such table: ";
+  if (error == nullptr || strncmp(error, prefix.c_str(), prefix.size()) != 0) {
+    return false;
+  }
+
+  // Tables are attached to the temp schema, drop any schema name.
+  name = error + prefix.size();
+  auto schema = name.find('.');
+  if (schema != std::string::npos) {
+    name = name.substr(schema + 1);
+  }
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  return !name.empty();
+}
+
+/**
+ * @brief Prepare a statement, attaching the tables it uses to lazy databases.
+ *
+ * Each table reported missing is attached once before preparing again.
+ */
+static int prepareStatement(const SQLiteDBInstanceRef& instance,
+                            const char* sql,
+                            int length,
+                            sqlite3_stmt** statement,
+                            const char** leftover_sql) {
+  std::set<std::string> attached;
+  while (true) {
+    int rc = sqlite3_prepare_v2(
+        instance->db(), sql, length, statement, leftover_sql);
+    if (rc == SQLITE_OK || !instance->lazyAttach()) {
+      return rc;
+    }
+
+    std::string name;
+    if (!getMissingTable(sqlite3_errmsg(instance->db()), name) ||
+        !attached.insert(name).second) {
+      return rc;
+    }
+
+    sqlite3_finalize(*statement);
+    *statement = nullptr;
+    attachVirtualTable(name, instance);
+  }
+}
+
+/// Check if only whitespace remains of the SQL text.
+static bool isBlank(const char* sql) {
+  while (isspace(sql[0])) {
+    sql++;
+  }
+  return sql[0] == '\0';
+}
+
+/// Receives the rows of each statement, including partial rows on failure.
+using StatementResults = std::function<Status(QueryResults&&)>;
+
+/// Emit the rows of a statement, preferring the statement's failure.
+static Status emitRows(const Status& status,
+                       QueryResults&& rows,
+                       const StatementResults& emit) {
+  auto s = emit(std::move(rows));
+  return status.ok() ? s : status;
+}
+
+static Status queryStatements(const std::string& query,
+                              const StatementResults& emit,
+                              const SQLiteDBInstanceRef& instance) {
   sqlite3_stmt* prepared_statement{nullptr}; /* Statement to execute. */
 
   int rc = SQLITE_OK; /* Return Code */
   const char* leftover_sql = nullptr; /* Tail of unprocessed SQL */
   const char* sql = query.c_str(); /* SQL to be processed */
 
+  // Only single statements on the primary database are cached.
+  auto* cache = instance->statementCache();
+  if (cache != nullptr && FLAGS_sql_statement_cache_size > 0) {
+    while (isspace(sql[0])) {
+      sql++;
+    }
+
+    SQLiteCachedStatement statement;
+    if (sql[0] != '\0' && cache->take(sql, statement)) {
+      const auto lock = instance->attachLock();
+      QueryResults results;
+      auto s = readCachedRows(sql, std::move(statement), results, instance);
+      return emitRows(s, std::move(results), emit);
+    }
+  } else {
+    cache = nullptr;
+  }
+
   /* The big while loop.  One iteration per statement */
   while ((sql[0] != '\0') && (SQLITE_OK == rc)) {
     const auto lock = instance->attachLock();
@@ -673,25 +939,87 @@ Status queryInternal(const std::string& query,
     while (isspace(sql[0])) {
       sql++;
     }
-    rc = sqlite3_prepare_v2(
-        instance->db(), sql, -1, &prepared_statement, &leftover_sql);
+
+    size_t generation = 0;
+    if (cache != nullptr) {
+      generation = cache->generation();
+      // Discard plans from statements that were not cached.
+      instance->takePlannedIndexes();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    rc = prepareStatement(
+        instance, sql, -1, &prepared_statement, &leftover_sql);
     if (rc != SQLITE_OK) {
       Status s = Status::failure(sqlite3_errmsg(instance->db()));
       sqlite3_finalize(prepared_statement);
       return s;
     }
 
+    // The last statement of the query text is cached by its own text.
+    if (cache != nullptr && prepared_statement != nullptr &&
+        isBlank(leftover_sql)) {
+      SQLiteCachedStatement statement;
+      statement.stmt = prepared_statement;
+      statement.prepare_time =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+      statement.plans = savePlans(instance->takePlannedIndexes());
+      statement.generation = generation;
+      QueryResults results;
+      auto s = readCachedRows(sql, std::move(statement), results, instance);
+      return emitRows(s, std::move(results), emit);
+    }
+
+    QueryResults results;
     Status s = readRows(prepared_statement, results, instance);
+    s = emitRows(s, std::move(results), emit);
     if (!s.ok()) {
       return s;
     }
 
     sql = leftover_sql;
   } /* end while */
-  sqlite3_db_release_memory(instance->db());
   return Status::success();
 }
 
+Status queryInternal(const std::string& query,
+                     QueryResults& results,
+                     const SQLiteDBInstanceRef& instance) {
+  // Statements of a query must select the same columns.
+  return queryStatements(query,
+                         [&results](QueryResults&& rows) {
+                           return results.append(std::move(rows));
+                         },
+                         instance);
+}
+
+Status queryInternal(const std::string& query,
+                     QueryDataTyped& results,
+                     const SQLiteDBInstanceRef& instance) {
+  return queryStatements(
+      query,
+      [&results](QueryResults&& rows) {
+        rows.appendTo(results);
+        return Status::success();
+      },
+      instance);
+}
+
+Status queryInternal(const std::string& query,
+                     QueryData& results,
+                     const SQLiteDBInstanceRef& instance) {
+  // Rows are converted to strings directly, without a typed copy.
+  return queryStatements(
+      query,
+      [&results](QueryResults&& rows) {
+        rows.appendTo(results);
+        return Status::success();
+      },
+      instance);
+}
+
 Status getQueryColumnsInternal(const std::string& q,
                                TableColumns& columns,
                                const SQLiteDBInstanceRef& instance) {
@@ -702,11 +1030,11 @@ Status getQueryColumnsInternal(const std::string& q,
 
     // Turn the query into a prepared statement
     sqlite3_stmt* stmt{nullptr};
-    auto rc = sqlite3_prepare_v2(instance->db(),
-                                 q.c_str(),
-                                 static_cast<int>(q.length() + 1),
-                                 &stmt,
-                                 nullptr);
+    auto rc = prepareStatement(instance,
+                               q.c_str(),
+                               static_cast<int>(q.length() + 1),
+                               &stmt,
+                               nullptr);
     if (rc != SQLITE_OK || stmt == nullptr) {
       auto s = Status::failure(sqlite3_errmsg(instance->db()));
       if (stmt != nullptr) {
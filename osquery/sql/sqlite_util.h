@@ -10,15 +10,21 @@
 #pragma once
 
 #include <atomic>
+#include <list>
 #include <map>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <sqlite3.h>
 
 #include <boost/filesystem.hpp>
 #include <boost/noncopyable.hpp>
 
+#include <osquery/core/sql/query_results.h>
 #include <osquery/sql/sql.h>
 
 #include <osquery/utils/mutex.h>
@@ -84,6 +90,101 @@ const std::unordered_set<std::string> kAllowedSQLitePragmas = {
 
 class SQLiteDBManager;
 
+/// A constraint set planned by xBestIndex for a virtual table.
+struct SQLitePlannedIndex {
+  /// The virtual table content holding the transient constraint sets.
+  std::shared_ptr<VirtualTableContent> table;
+
+  /// The idxNum assigned by xBestIndex and passed to xFilter.
+  size_t index{0};
+
+  ConstraintSet constraints;
+  UsedColumns columns;
+  UsedColumnsBitset columns_bitset;
+};
+
+/// A prepared statement that can be reset and stepped again.
+struct SQLiteCachedStatement {
+  sqlite3_stmt* stmt{nullptr};
+
+  /// Microseconds spent in sqlite3_prepare_v2 for this statement.
+  uint64_t prepare_time{0};
+
+  /**
+   * @brief The virtual table constraint sets the statement was planned with.
+   *
+   * Constraint sets are cleared from the virtual tables after every query.
+   * They are restored before the statement is stepped again.
+   */
+  std::vector<SQLitePlannedIndex> plans;
+
+  /// The cache generation when the statement was prepared.
+  size_t generation{0};
+};
+
+/// Counters describing the primary database's prepared statement cache.
+struct SQLiteStatementCacheStats {
+  size_t statements{0};
+  size_t capacity{0};
+  uint64_t hits{0};
+  uint64_t misses{0};
+
+  /// Microseconds of statement parsing and planning avoided by cache hits.
+  uint64_t prepare_time_saved{0};
+
+  /// Bytes of heap memory used by the cached statements.
+  uint64_t memory_used{0};
+};
+
+/**
+ * @brief An LRU cache of prepared statements keyed by their SQL text.
+ *
+ * Scheduled queries run the same SQL every interval, caching the prepared
+ * statements avoids parsing and planning them again on the primary database.
+ *
+ * A statement is removed from the cache while it is stepped and returned
+ * afterward, so re-entrant queries never share a statement. The cache is
+ * cleared when virtual tables are attached or detached and before the primary
+ * database is closed. Statements prepared before a clear are finalized when
+ * they are returned.
+ */
+class SQLiteStatementCache : private boost::noncopyable {
+ public:
+  ~SQLiteStatementCache();
+
+  /// Remove a statement from the cache, returns false on a cache miss.
+  bool take(const std::string& sql, SQLiteCachedStatement& statement);
+
+  /// Return a reset statement to the cache, or finalize it.
+  void put(const std::string& sql, SQLiteCachedStatement statement);
+
+  /// Finalize all cached statements.
+  void clear();
+
+  /// The generation to assign to newly prepared statements.
+  size_t generation() const;
+
+  SQLiteStatementCacheStats stats() const;
+
+ private:
+  using Entry = std::pair<std::string, SQLiteCachedStatement>;
+
+  /// Cached statements, the most recently used first.
+  std::list<Entry> statements_;
+
+  /// SQL text to the cached statement.
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  /// Incremented when the cache is cleared.
+  size_t generation_{0};
+
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  uint64_t prepare_time_saved_{0};
+
+  mutable Mutex mutex_;
+};
+
 /**
  * @brief An RAII wrapper around an `sqlite3` object.
  *
@@ -128,12 +229,28 @@ class SQLiteDBInstance : private boost::noncopyable {
   /// Check if a virtual table had been called already.
   bool tableCalled(VirtualTableContent const& table);
 
+  /// Allow a virtual table implementation to record a planned constraint set.
+  void addPlannedIndex(std::shared_ptr<VirtualTableContent> table,
+                       size_t index);
+
+  /// Remove and return the constraint sets planned since the last call.
+  std::vector<SQLitePlannedIndex> takePlannedIndexes();
+
+  /// The prepared statement cache, only the primary database has one.
+  SQLiteStatementCache* statementCache() const;
+
   /// Request that virtual tables use a warm cache for their results.
   void useCache(bool use_cache);
 
   /// Check if the query requested use of the warm query cache.
   bool useCache() const;
 
+  /// Request that virtual tables are attached when statements use them.
+  void lazyAttach(bool lazy_attach);
+
+  /// Check if virtual tables are attached when statements use them.
+  bool lazyAttach() const;
+
   /// Lock the database for attaching virtual tables.
   RecursiveLock attachLock() const;
 
@@ -156,6 +273,12 @@ class SQLiteDBInstance : private boost::noncopyable {
   /// True if this query should bypass table cache.
   bool use_cache_{false};
 
+  /// True if virtual tables have not all been attached.
+  bool lazy_attach_{false};
+
+  /// Constraint sets planned by xBestIndex, only recorded by the primary.
+  std::vector<SQLitePlannedIndex> planned_indexes_;
+
   /// Either the managed primary database or an ephemeral instance.
   sqlite3* db_{nullptr};
 
@@ -222,7 +345,8 @@ class SQLiteDBManager : private boost::noncopyable {
    * Note: osquery::initOsquery must be called before calling `get` in order
    * for virtual tables to be registered.
    *
-   * @return a SQLiteDBInstance with all virtual tables attached.
+   * @return a SQLiteDBInstance with all virtual tables attached, transient
+   * databases attach virtual tables when statements first use them.
    */
   static SQLiteDBInstanceRef get() {
     return getConnection();
@@ -251,6 +375,12 @@ class SQLiteDBManager : private boost::noncopyable {
    */
   static bool isDisabled(const std::string& table_name);
 
+  /// Finalize the primary database's cached prepared statements.
+  static void clearStatementCache();
+
+  /// Inspect the primary database's prepared statement cache.
+  static SQLiteStatementCacheStats getStatementCacheStats();
+
  protected:
   SQLiteDBManager();
   virtual ~SQLiteDBManager();
@@ -272,6 +402,9 @@ class SQLiteDBManager : private boost::noncopyable {
   /// A write mutex for initializing the primary database.
   Mutex create_mutex_;
 
+  /// Prepared statements for the primary database.
+  SQLiteStatementCache statements_;
+
   /// Member variable to hold set of disabled tables.
   std::unordered_set<std::string> disabled_tables_;
 
@@ -363,6 +496,23 @@ class QueryPlanner : private boost::noncopyable {
 /// Specific SQLite opcodes that change column/expression type.
 extern const std::map<std::string, QueryPlanner::Opcode> kSQLOpcodes;
 
+/**
+ * @brief SQLite Internal: Execute a query on a specific database
+ *
+ * This is the preferred way to read results, rows are stored without copies
+ * of the column names and without converting values to strings. All of the
+ * statements in q that return rows must select the same columns.
+ *
+ * @param q the query to execute
+ * @param results The column-major results to emit rows on query success.
+ * @param db the SQLite3 database to execute query q against
+ *
+ * @return A status indicating SQL query results.
+ */
+Status queryInternal(const std::string& q,
+                     QueryResults& results,
+                     const SQLiteDBInstanceRef& instance);
+
 /**
  * @brief SQLite Internal: Execute a query on a specific database
  *
@@ -418,7 +568,7 @@ Status getQueryColumnsInternal(const std::string& q,
 
 /**
  * @brief SQLInternal: like SQL, but backed by internal calls, and deals
- * with QueryDataTyped results.
+ * with columnar QueryResults.
  */
 class SQLInternal : private only_movable {
  public:
@@ -432,11 +582,11 @@ class SQLInternal : private only_movable {
 
  public:
   /**
-   * @brief Const accessor for the rows returned by the query.
+   * @brief Accessor for the rows returned by the query.
    *
-   * @return A QueryDataTyped object of the query results.
+   * @return A QueryResults object of the query results.
    */
-  QueryDataTyped& rowsTyped();
+  QueryResults& results();
 
   const Status& getStatus() const;
 
@@ -454,11 +604,11 @@ class SQLInternal : private only_movable {
   bool eventBased() const;
 
   /// ASCII escape the results of the query.
-  void escapeResults();
+  Status escapeResults();
 
  private:
   /// The internal member which holds the typed results of the query.
-  QueryDataTyped resultsTyped_;
+  QueryResults results_;
 
   /// The internal member which holds the status of the query.
   Status status_;
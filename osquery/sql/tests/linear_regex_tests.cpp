@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "osquery/sql/linear_regex.h"
+
+namespace osquery {
+
+const size_t kTestMaxInstructions = 16384;
+
+class LinearRegexTests : public testing::Test {
+ protected:
+  /// Search with std::regex, using the flags LinearRegex::search emulates.
+  static bool stdSearch(const std::string& pattern,
+                        const std::string& input,
+                        size_t start,
+                        bool continuous,
+                        bool not_null,
+                        LinearRegex::Submatches& submatches) {
+    auto flags = std::regex_constants::match_default;
+    if (start > 0) {
+      flags |= std::regex_constants::match_prev_avail;
+    }
+    if (continuous) {
+      flags |= std::regex_constants::match_continuous;
+    }
+    if (not_null) {
+      flags |= std::regex_constants::match_not_null;
+    }
+
+    std::regex regex(pattern);
+    std::smatch results;
+    submatches.clear();
+    if (!std::regex_search(
+            input.begin() + start, input.end(), results, regex, flags)) {
+      return false;
+    }
+
+    for (const auto& result : results) {
+      submatches.push_back(result.matched ? result.first - input.begin() : -1);
+      submatches.push_back(result.matched ? result.second - input.begin()
+                                          : -1);
+    }
+    return true;
+  }
+
+  /// Compare a search from every offset of the input with std::regex.
+  static void expectSameAsStd(const std::string& pattern,
+                              const std::vector<std::string>& inputs) {
+    std::unique_ptr<LinearRegex> regex;
+    auto status = LinearRegex::compile(pattern, kTestMaxInstructions, regex);
+    ASSERT_TRUE(status.ok()) << pattern << ": " << status.getMessage();
+
+    for (const auto& input : inputs) {
+      for (size_t start = 0; start <= input.size(); start++) {
+        for (auto continuous : {false, true}) {
+          for (auto not_null : {false, true}) {
+            LinearRegex::Submatches expected;
+            LinearRegex::Submatches actual;
+            auto expected_found = stdSearch(
+                pattern, input, start, continuous, not_null, expected);
+            auto found =
+                regex->search(input, start, continuous, not_null, actual);
+            EXPECT_EQ(found, expected_found)
+                << "/" << pattern << "/ on \"" << input << "\" from "
+                << start << (continuous ? " continuous" : "")
+                << (not_null ? " not null" : "");
+            if (found && expected_found) {
+              EXPECT_EQ(actual, expected)
+                  << "/" << pattern << "/ on \"" << input << "\" from "
+                  << start << (continuous ? " continuous" : "")
+                  << (not_null ? " not null" : "");
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Compare only where matches start with std::regex.
+   *
+   * For repetitions of a body that can match nothing, where the end of a
+   * match and the groups may differ, see LinearRegex.
+   */
+  static void expectSameStartAsStd(const std::string& pattern,
+                                   const std::vector<std::string>& inputs) {
+    std::unique_ptr<LinearRegex> regex;
+    auto status = LinearRegex::compile(pattern, kTestMaxInstructions, regex);
+    ASSERT_TRUE(status.ok()) << pattern << ": " << status.getMessage();
+
+    for (const auto& input : inputs) {
+      for (size_t start = 0; start <= input.size(); start++) {
+        for (auto continuous : {false, true}) {
+          for (auto not_null : {false, true}) {
+            LinearRegex::Submatches expected;
+            LinearRegex::Submatches actual;
+            auto expected_found = stdSearch(
+                pattern, input, start, continuous, not_null, expected);
+            auto found =
+                regex->search(input, start, continuous, not_null, actual);
+            EXPECT_EQ(found, expected_found)
+                << "/" << pattern << "/ on \"" << input << "\" from "
+                << start << (continuous ? " continuous" : "")
+                << (not_null ? " not null" : "");
+            if (found && expected_found) {
+              EXPECT_EQ(actual[0], expected[0])
+                  << "/" << pattern << "/ on \"" << input << "\" from "
+                  << start << (continuous ? " continuous" : "")
+                  << (not_null ? " not null" : "");
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /// Every match, advancing past empty matches the same as regex_iterator.
+  static std::vector<std::string> linearMatches(const std::string& pattern,
+                                                const std::string& input) {
+    std::unique_ptr<LinearRegex> regex;
+    auto status = LinearRegex::compile(pattern, kTestMaxInstructions, regex);
+    EXPECT_TRUE(status.ok()) << pattern << ": " << status.getMessage();
+
+    std::vector<std::string> matches;
+    LinearRegex::Submatches match;
+    if (regex == nullptr || !regex->search(input, 0, false, false, match)) {
+      return matches;
+    }
+
+    while (true) {
+      matches.push_back(input.substr(match[0], match[1] - match[0]));
+      size_t end = match[1];
+      bool found = false;
+      if (match[0] == match[1]) {
+        if (end == input.size()) {
+          break;
+        }
+        found = regex->search(input, end, true, true, match) ||
+                regex->search(input, end + 1, false, false, match);
+      } else {
+        found = regex->search(input, end, false, false, match);
+      }
+      if (!found) {
+        break;
+      }
+    }
+    return matches;
+  }
+
+  static std::vector<std::string> stdMatches(const std::string& pattern,
+                                             const std::string& input) {
+    std::regex regex(pattern);
+    std::vector<std::string> matches;
+    for (std::sregex_iterator it(input.begin(), input.end(), regex), end;
+         it != end;
+         ++it) {
+      matches.push_back(it->str());
+    }
+    return matches;
+  }
+};
+
+TEST_F(LinearRegexTests, test_character_classes) {
+  expectSameAsStd("[a-c]+", {"xxabcabx", "", "cba"});
+  expectSameAsStd("[^a-c]+", {"abxyzc", "abc"});
+  expectSameAsStd("\\d+\\.\\d*", {"v1.20 and 3.", "no digits"});
+  expectSameAsStd("\\w+\\s\\W", {"foo_1 !bar", "a b"});
+  expectSameAsStd("[\\d.-]+", {"ip 10.0.0-1 end"});
+  expectSameAsStd("[]a]", {"x]a"});
+  expectSameAsStd("a.c", {"abc a\nc axc"});
+}
+
+TEST_F(LinearRegexTests, test_bounded_repeats) {
+  expectSameAsStd("a{2}", {"a aa aaa"});
+  expectSameAsStd("a{2,}", {"a aa aaaaa"});
+  expectSameAsStd("a{1,3}b", {"aaaab ab b"});
+  expectSameAsStd("(ab){0,2}c", {"ababababc c abc"});
+  expectSameAsStd("x{0}y", {"xy y"});
+}
+
+TEST_F(LinearRegexTests, test_lazy_quantifiers) {
+  expectSameAsStd("<.+?>", {"<a><b>", "<>"});
+  expectSameAsStd("a*?b", {"aaab"});
+  expectSameAsStd("(a+?)(a*)", {"aaaa"});
+  expectSameAsStd("a{2,4}?", {"aaaaa"});
+  expectSameAsStd("(x?\?)(x*)", {"xx"});
+}
+
+TEST_F(LinearRegexTests, test_anchors) {
+  expectSameAsStd("^abc", {"abc", "xabc", "ab\nabc"});
+  expectSameAsStd("abc$", {"abc", "abcx", "abc\nx"});
+  expectSameAsStd("^$", {"", "x"});
+  expectSameAsStd("^a*", {"aab"});
+}
+
+TEST_F(LinearRegexTests, test_word_boundaries) {
+  expectSameAsStd("\\bfoo\\b", {"foo foobar barfoo (foo)", "foo"});
+  expectSameAsStd("\\Bo\\B", {"foo bob o"});
+  expectSameAsStd("\\b", {"a b", ""});
+}
+
+TEST_F(LinearRegexTests, test_alternation_and_groups) {
+  expectSameAsStd("cat|category", {"category"});
+  expectSameAsStd("(a|ab)(c|bcd)(d*)", {"abcd"});
+  expectSameAsStd("(?:x|y)+z", {"xyxz yz z"});
+  expectSameAsStd("(a)|(b)", {"b a"});
+  expectSameAsStd("(a*)+b", {"aab"});
+  expectSameAsStd("|a", {"a"});
+}
+
+TEST_F(LinearRegexTests, test_empty_iterations) {
+  const std::vector<std::string> inputs = {".ba a", "aab", "b", "", "xx"};
+  for (const auto& pattern : {"(.?\?)+", "(a*)*", "(|[^a]){2,}", "(a|)+"}) {
+    expectSameStartAsStd(pattern, inputs);
+  }
+
+  // An iteration that matches nothing ends the repetition.
+  std::unique_ptr<LinearRegex> regex;
+  LinearRegex::Submatches match;
+  ASSERT_TRUE(
+      LinearRegex::compile("(.?\?)+", kTestMaxInstructions, regex).ok());
+  ASSERT_TRUE(regex->search(".ba a", 0, false, true, match));
+  EXPECT_EQ(match, LinearRegex::Submatches({0, 5, 4, 5}));
+
+  ASSERT_TRUE(
+      LinearRegex::compile("(a*)*", kTestMaxInstructions, regex).ok());
+  ASSERT_TRUE(regex->search("aab", 0, false, false, match));
+  EXPECT_EQ(match, LinearRegex::Submatches({0, 2, 0, 2}));
+
+  ASSERT_TRUE(
+      LinearRegex::compile("(|[^a]){2,}", kTestMaxInstructions, regex).ok());
+  ASSERT_TRUE(regex->search(".ba a", 0, false, true, match));
+  EXPECT_EQ(match, LinearRegex::Submatches({0, 2, 1, 2}));
+}
+
+TEST_F(LinearRegexTests, test_empty_matches) {
+  // Iterating the matches skips ahead after an empty match, as splitting
+  // a string on a pattern does.
+  for (const auto& pattern : {"a*", "x*", "\\b", "(a|)", ",?", "$", "^"}) {
+    for (const auto& input :
+         std::vector<std::string>{"", "a", "baaac", "a,b,,c", "xx"}) {
+      EXPECT_EQ(linearMatches(pattern, input), stdMatches(pattern, input))
+          << "/" << pattern << "/ on \"" << input << "\"";
+    }
+  }
+}
+
+TEST_F(LinearRegexTests, test_unsupported) {
+  std::unique_ptr<LinearRegex> regex;
+  auto status = LinearRegex::compile("(a)\\1", kTestMaxInstructions, regex);
+  EXPECT_EQ(status.getCode(), LinearRegex::kUnsupported);
+
+  status = LinearRegex::compile("a(?=b)", kTestMaxInstructions, regex);
+  EXPECT_EQ(status.getCode(), LinearRegex::kUnsupported);
+
+  // Invalid patterns fail with another code.
+  status = LinearRegex::compile("(a", kTestMaxInstructions, regex);
+  EXPECT_FALSE(status.ok());
+  EXPECT_NE(status.getCode(), LinearRegex::kUnsupported);
+  EXPECT_NE(status.getCode(), LinearRegex::kTooComplex);
+}
+
+TEST_F(LinearRegexTests, test_instruction_budget) {
+  std::unique_ptr<LinearRegex> regex;
+  ASSERT_TRUE(LinearRegex::compile("a{100}", 1024, regex).ok());
+
+  // Each repeat copies the repeated program.
+  auto status = LinearRegex::compile("a{2000}", 1024, regex);
+  EXPECT_EQ(status.getCode(), LinearRegex::kTooComplex);
+
+  status =
+      LinearRegex::compile("((a{30}){30}){30}", kTestMaxInstructions, regex);
+  EXPECT_EQ(status.getCode(), LinearRegex::kTooComplex);
+}
+
+TEST_F(LinearRegexTests, test_linear_time) {
+  // A pattern that makes a backtracking engine take exponential time.
+  std::unique_ptr<LinearRegex> regex;
+  ASSERT_TRUE(
+      LinearRegex::compile("(a*)*b", kTestMaxInstructions, regex).ok());
+
+  LinearRegex::Submatches submatches;
+  EXPECT_FALSE(
+      regex->search(std::string(10000, 'a'), 0, false, false, submatches));
+}
+
+} // namespace osquery
@@ -81,6 +81,25 @@ TEST_F(SQLTests, test_raw_access_context) {
   EXPECT_EQ(results[0]["test_int"], "2");
 }
 
+TEST_F(SQLTests, test_sql_deadline) {
+  const std::string endless =
+      "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c) "
+      "SELECT count(*) FROM c";
+  {
+    SQLDeadline deadline(std::chrono::milliseconds(100));
+    SQL sql(endless);
+    EXPECT_FALSE(sql.ok());
+    EXPECT_TRUE(SQLDeadline::expired());
+  }
+
+  // Queries after the deadline is destroyed are not interrupted.
+  EXPECT_FALSE(SQLDeadline::expired());
+  SQL sql("SELECT count(*) AS c FROM (WITH RECURSIVE c(x) AS (SELECT 1 "
+          "UNION ALL SELECT x + 1 FROM c LIMIT 1000) SELECT x FROM c)");
+  ASSERT_TRUE(sql.ok());
+  EXPECT_EQ(sql.rows()[0]["c"], "1000");
+}
+
 TEST_F(SQLTests, test_sql_escape) {
   std::string input = "しかたがない";
   escapeNonPrintableBytesEx(input);
@@ -265,6 +284,36 @@ TEST_F(SQLTests, test_regex_match_too_big) {
             0);
 }
 
+TEST_F(SQLTests, test_regex_match_rows) {
+  QueryData d;
+  // The pattern is compiled once and reused for each row.
+  query(
+      "select regex_match(column1, '^([a-z]+)=(\\d+)$', 2) as test "
+      "from (values ('a=1'), ('bb=22'), ('c'))",
+      d);
+  ASSERT_EQ(d.size(), 3U);
+  EXPECT_EQ(d[0]["test"], "1");
+  EXPECT_EQ(d[1]["test"], "22");
+  EXPECT_EQ(d[2]["test"], "");
+}
+
+TEST_F(SQLTests, test_regex_match_backtracking) {
+  QueryData d;
+  // Without backtracking this does not take exponential time.
+  std::string input(64, 'a');
+  query("select regex_match('" + input + "', '(a*)*b', 0) as test", d);
+  ASSERT_EQ(d.size(), 1U);
+  EXPECT_EQ(d[0]["test"], "");
+}
+
+TEST_F(SQLTests, test_regex_match_backreference) {
+  QueryData d;
+  // Backreferences are still supported, using std::regex.
+  query("select regex_match('xabab', '(ab)\\1', 0) as test", d);
+  ASSERT_EQ(d.size(), 1U);
+  EXPECT_EQ(d[0]["test"], "abab");
+}
+
 /*
  * split
  */
@@ -78,6 +78,14 @@ std::vector<std::pair<std::string, QueryDataTyped>> getTestDBResultStream() {
   return results;
 }
 
+QueryResults getQueryResults(const QueryDataTyped& rows) {
+  QueryResults results;
+  for (const auto& row : rows) {
+    results.addRow(row);
+  }
+  return results;
+}
+
 ColumnNames getSerializedRowColumnNames(bool unordered_and_repeated) {
   ColumnNames cn;
   if (unordered_and_repeated) {
@@ -129,8 +137,8 @@ std::pair<std::string, QueryDataTyped> getSerializedQueryDataJSON() {
 std::pair<JSON, DiffResults> getSerializedDiffResults() {
   auto qd = getSerializedQueryData();
   DiffResults diff_results;
-  diff_results.added = qd.second;
-  diff_results.removed = qd.second;
+  diff_results.added = getQueryResults(qd.second);
+  diff_results.removed = getQueryResults(qd.second);
 
   JSON doc = JSON::newObject();
   doc.add("removed", qd.first.doc());
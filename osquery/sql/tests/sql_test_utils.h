@@ -26,6 +26,10 @@ std::vector<std::pair<std::string, QueryDataTyped>> getTestDBResultStream();
 // initially gets returned from createTestDB()
 QueryDataTyped getTestDBExpectedResults();
 
+// getQueryResults converts typed rows, which have the same columns, to
+// QueryResults
+QueryResults getQueryResults(const QueryDataTyped& rows);
+
 // getSerializedRowColumnNames returns a vector of test column names that
 // are in alphabetical order. If unordered_and_repeated is true, the
 // vector includes a repeated column name and is in non-alphabetical order
@@ -124,6 +124,26 @@ TEST_F(SQLiteUtilTests, test_direct_query_execution) {
   EXPECT_EQ(results, getTestDBExpectedResults());
 }
 
+TEST_F(SQLiteUtilTests, test_columnar_query_execution) {
+  auto dbc = getTestDBC();
+  QueryResults results;
+  auto status = queryInternal(kTestQuery, results, dbc);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(results.columnNames(), ColumnNames({"username", "age"}));
+
+  QueryDataTyped typed;
+  results.appendTo(typed);
+  EXPECT_EQ(typed, getTestDBExpectedResults());
+
+  // Statements returning rows must agree on the result columns.
+  results.clear();
+  status = queryInternal(
+      "select 1 as a; select 2 as a; select 3 as b", results, dbc);
+  EXPECT_FALSE(status.ok());
+  ASSERT_EQ(results.rows(), 2U);
+  EXPECT_EQ(results.integer(1, 0), 2);
+}
+
 TEST_F(SQLiteUtilTests, test_aggregate_query) {
   auto dbc = getTestDBC();
   QueryDataTyped results;
@@ -185,6 +205,95 @@ TEST_F(SQLiteUtilTests, test_affected_tables) {
   EXPECT_EQ(dbc->affected_tables_.size(), 0U);
 }
 
+TEST_F(SQLiteUtilTests, test_lazy_attach) {
+  auto dbc = SQLiteDBManager::getUnique();
+  EXPECT_TRUE(dbc->lazyAttach());
+
+  QueryData results;
+  auto tables_query =
+      "select name from sqlite_temp_master where type = 'table' order by name";
+  ASSERT_TRUE(queryInternal(tables_query, results, dbc).ok());
+  EXPECT_TRUE(results.empty());
+
+  // Only the tables referenced by a statement are attached.
+  results.clear();
+  auto status =
+      queryInternal("select * from time join osquery_info", results, dbc);
+  ASSERT_TRUE(status.ok());
+  EXPECT_EQ(results.size(), 1U);
+
+  results.clear();
+  ASSERT_TRUE(queryInternal(tables_query, results, dbc).ok());
+  ASSERT_EQ(results.size(), 2U);
+  EXPECT_EQ(results[0]["name"], "osquery_info");
+  EXPECT_EQ(results[1]["name"], "time");
+
+  // Unknown names may be table aliases, so every table is attached.
+  status = queryInternal("select * from not_a_table", results, dbc);
+  EXPECT_EQ(status.getMessage(), "no such table: not_a_table");
+  EXPECT_FALSE(dbc->lazyAttach());
+}
+
+TEST_F(SQLiteUtilTests, test_statement_cache) {
+  SQLiteDBManager::clearStatementCache();
+  auto before = SQLiteDBManager::getStatementCacheStats();
+
+  // The file table requires a path constraint, the constraints planned when
+  // the statement was prepared must be reused with the cached statement.
+  std::string query = "select path from file where path = '/'";
+  for (size_t i = 0; i < 3; i++) {
+    auto dbc = SQLiteDBManager::get();
+    ASSERT_TRUE(dbc->isPrimary());
+
+    QueryDataTyped results;
+    EXPECT_TRUE(queryInternal(query, results, dbc).ok());
+    dbc->clearAffectedTables();
+    ASSERT_EQ(results.size(), 1U);
+    EXPECT_EQ(boost::get<std::string>(results[0]["path"]), "/");
+  }
+
+  auto stats = SQLiteDBManager::getStatementCacheStats();
+  EXPECT_EQ(stats.statements, 1U);
+  EXPECT_EQ(stats.hits - before.hits, 2U);
+  EXPECT_EQ(stats.misses - before.misses, 1U);
+  EXPECT_GT(stats.memory_used, 0U);
+
+  // Transient instances do not cache statements.
+  auto dbc = getTestDBC();
+  QueryDataTyped results;
+  EXPECT_TRUE(queryInternal(query, results, dbc).ok());
+  EXPECT_EQ(SQLiteDBManager::getStatementCacheStats().misses, stats.misses);
+
+  // Resetting the primary database clears the cache.
+  SQLiteDBManager::resetPrimary();
+  EXPECT_EQ(SQLiteDBManager::getStatementCacheStats().statements, 0U);
+}
+
+TEST_F(SQLiteUtilTests, test_statement_cache_other_plans) {
+  SQLiteDBManager::clearStatementCache();
+
+  // Preparing other statements plans the same table with other constraints,
+  // a cached statement must keep the constraints it was planned with.
+  std::string query = "select path from file where path = '/'";
+  for (size_t i = 0; i < 3; i++) {
+    auto dbc = SQLiteDBManager::get();
+    ASSERT_TRUE(dbc->isPrimary());
+
+    QueryDataTyped results;
+    EXPECT_TRUE(queryInternal(query, results, dbc).ok());
+    ASSERT_EQ(results.size(), 1U);
+    EXPECT_EQ(boost::get<std::string>(results[0]["path"]), "/");
+
+    TableColumns columns;
+    EXPECT_TRUE(getQueryColumnsInternal(
+                    "select path from file where path = '/tmp'", columns, dbc)
+                    .ok());
+    dbc->clearAffectedTables();
+  }
+
+  EXPECT_EQ(SQLiteDBManager::getStatementCacheStats().statements, 1U);
+}
+
 TEST_F(SQLiteUtilTests, test_table_attributes_event_based) {
   {
     SQLInternal sql_internal("select * from process_events");
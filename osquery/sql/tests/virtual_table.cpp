@@ -7,10 +7,14 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <atomic>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include <osquery/core/core.h>
 #include <osquery/core/system.h>
+#include <osquery/core/table_cache.h>
 #include <osquery/database/database.h>
 #include <osquery/logger/logger.h>
 #include <osquery/registry/registry.h>
@@ -22,6 +26,8 @@
 namespace osquery {
 
 DECLARE_bool(table_exceptions);
+DECLARE_uint64(table_cache_max_bytes);
+DECLARE_string(table_cache_ttl);
 
 class VirtualTableTests : public testing::Test {
  public:
@@ -516,8 +522,9 @@ class tableCacheTablePlugin : public TablePlugin {
   }
 
   TableRows generate(QueryContext& ctx) override {
-    if (isCached(60, ctx)) {
-      return getCache();
+    TableRows cached;
+    if (getCache(60, ctx, cached)) {
+      return cached;
     }
 
     generates_++;
@@ -590,13 +597,149 @@ TEST_F(VirtualTableTests, test_table_results_cache) {
   EXPECT_EQ(results.size(), 1U);
   EXPECT_EQ(cache->generates_, 4U);
 
-  // Now with constraints that invalidate the cache results.
+  // The same columns are cached separately.
+  results.clear();
+  queryInternal(statement, results, dbc);
+  EXPECT_EQ(results.size(), 1U);
+  EXPECT_EQ(cache->generates_, 4U);
+
+  // Now with constraints that are not cached yet.
   results.clear();
   statement = "SELECT * from table_cache where i = '1';";
   queryInternal(statement, results, dbc);
   EXPECT_EQ(results.size(), 1U);
   // The table should NOT have used the cache.
   EXPECT_EQ(cache->generates_, 5U);
+
+  // The same constraints use the cache.
+  results.clear();
+  queryInternal(statement, results, dbc);
+  EXPECT_EQ(results.size(), 1U);
+  EXPECT_EQ(cache->generates_, 5U);
+
+  // Other constraints do not.
+  results.clear();
+  statement = "SELECT * from table_cache where i = '2';";
+  queryInternal(statement, results, dbc);
+  EXPECT_EQ(cache->generates_, 6U);
+}
+
+TEST_F(VirtualTableTests, test_table_result_cache) {
+  auto& cache = TableResultCache::get();
+  cache.clear();
+
+  // Constraints written in another order share a key.
+  QueryContext first;
+  first.constraints["a"].add(Constraint(EQUALS, "1"));
+  first.constraints["a"].add(Constraint(EQUALS, "2"));
+  first.constraints["b"];
+  QueryContext second;
+  second.constraints["a"].add(Constraint(EQUALS, "2"));
+  second.constraints["a"].add(Constraint(EQUALS, "1"));
+  second.constraints["a"].add(Constraint(EQUALS, "1"));
+  auto key = TableResultCache::key("t", first);
+  EXPECT_EQ(key, TableResultCache::key("t", second));
+
+  QueryContext other;
+  other.constraints["a"].add(Constraint(GREATER_THAN, "1"));
+  EXPECT_NE(key, TableResultCache::key("t", other));
+  EXPECT_NE(key, TableResultCache::key("u", first));
+
+  TableRows rows;
+  rows.push_back(make_table_row({{"name", "value"}}));
+
+  // Entries are fresh for the interval they were cached with.
+  cache.put("t", "one", 10, 5, rows);
+  TableRows results;
+  EXPECT_TRUE(cache.take("t", "one", 14, results));
+  ASSERT_EQ(results.size(), 1U);
+  EXPECT_EQ(static_cast<Row>(*results[0]).at("name"), "value");
+  EXPECT_FALSE(cache.take("t", "one", 15, results));
+
+  // A table TTL overrides the interval.
+  auto ttl_backup = FLAGS_table_cache_ttl;
+  FLAGS_table_cache_ttl = "t=2";
+  cache.put("t", "one", 10, 5, rows);
+  EXPECT_TRUE(cache.exists("t", "one", 11));
+  EXPECT_FALSE(cache.exists("t", "one", 12));
+  FLAGS_table_cache_ttl = ttl_backup;
+
+  // The least recently used entries are evicted to stay within the budget.
+  auto budget_backup = FLAGS_table_cache_max_bytes;
+  FLAGS_table_cache_max_bytes = 20;
+  cache.put("t", "one", 10, 5, rows);
+  cache.put("t", "two", 10, 5, rows);
+  EXPECT_TRUE(cache.take("t", "one", 10, results));
+  cache.put("t", "three", 10, 5, rows);
+  EXPECT_TRUE(cache.exists("t", "one", 10));
+  EXPECT_FALSE(cache.exists("t", "two", 10));
+  EXPECT_TRUE(cache.exists("t", "three", 10));
+  FLAGS_table_cache_max_bytes = budget_backup;
+
+  auto stats = cache.stats();
+  ASSERT_EQ(stats.size(), 1U);
+  EXPECT_EQ(stats[0].table, "t");
+  EXPECT_EQ(stats[0].entries, 2U);
+  EXPECT_EQ(stats[0].rows, 2U);
+  EXPECT_EQ(stats[0].hits, 2U);
+  EXPECT_EQ(stats[0].misses, 1U);
+  EXPECT_EQ(stats[0].evictions, 1U);
+  EXPECT_EQ(stats[0].memory_used, 18U);
+  cache.clear();
+}
+
+TEST_F(VirtualTableTests, test_table_single_flight) {
+  auto& single_flight = TableSingleFlight::get();
+  auto before = single_flight.stats();
+
+  // The first request waits in its generator until the second joins it.
+  std::atomic<size_t> generates{0};
+  auto generate = [&](TableRows& rows) {
+    generates++;
+    while (single_flight.stats().coalesced == before.coalesced) {
+      std::this_thread::yield();
+    }
+    rows.push_back(make_table_row({{"name", "value"}}));
+    return Status::success();
+  };
+
+  TableRows leader_rows;
+  bool leader_coalesced = true;
+  std::thread leader([&]() {
+    single_flight.run("key", generate, leader_rows, leader_coalesced);
+  });
+  while (generates == 0) {
+    std::this_thread::yield();
+  }
+
+  TableRows rows;
+  bool coalesced = false;
+  ASSERT_TRUE(single_flight.run("key", generate, rows, coalesced).ok());
+  leader.join();
+
+  EXPECT_EQ(generates, 1U);
+  EXPECT_FALSE(leader_coalesced);
+  EXPECT_TRUE(coalesced);
+  ASSERT_EQ(leader_rows.size(), 1U);
+  ASSERT_EQ(rows.size(), 1U);
+  EXPECT_EQ(static_cast<Row>(*rows[0]).at("name"), "value");
+
+  auto after = single_flight.stats();
+  EXPECT_EQ(after.generations, before.generations + 1);
+  EXPECT_EQ(after.coalesced, before.coalesced + 1);
+
+  // A generator requesting its own key generates again instead of waiting.
+  size_t depth = 0;
+  TableSingleFlight::Generator reentrant = [&](TableRows& results) {
+    if (++depth == 1) {
+      bool inner = false;
+      return single_flight.run("self", reentrant, results, inner);
+    }
+    return Status::success();
+  };
+  EXPECT_TRUE(single_flight.run("self", reentrant, rows, coalesced).ok());
+  EXPECT_FALSE(coalesced);
+  EXPECT_EQ(depth, 2U);
 }
 
 TEST_F(VirtualTableTests, test_table_results_cache_colcheck) {
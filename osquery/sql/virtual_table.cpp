@@ -13,9 +13,13 @@
 #include <osquery/core/core.h>
 #include <osquery/core/flags.h>
 #include <osquery/core/system.h>
+#include <osquery/core/table_cache.h>
+#include <osquery/extensions/extensions.h>
 #include <osquery/logger/logger.h>
+#include <osquery/numeric_monitoring/numeric_monitoring.h>
 #include <osquery/process/process.h>
 #include <osquery/registry/registry_factory.h>
+#include <osquery/sql/columnar_table_row.h>
 #include <osquery/sql/dynamic_table_row.h>
 #include <osquery/sql/virtual_table.h>
 #include <osquery/utils/conversions/tryto.h>
@@ -36,6 +40,11 @@ FLAG(bool,
 
 FLAG(bool, table_exceptions, false, "Allow tables to throw exceptions");
 
+FLAG(bool,
+     table_single_flight,
+     true,
+     "Share one generation between concurrent identical table scans");
+
 SHELL_FLAG(bool, planner, false, "Enable osquery runtime planner output");
 
 DECLARE_bool(disable_events);
@@ -293,6 +302,27 @@ static void plan(const std::string& output) {
   }
 }
 
+/// Generate rows, sharing the generation with identical concurrent scans.
+static Status generateRows(const std::string& name,
+                           const QueryContext& context,
+                           const TableSingleFlight::Generator& generate,
+                           TableRows& rows) {
+  if (!FLAGS_table_single_flight) {
+    return generate(rows);
+  }
+
+  bool coalesced = false;
+  auto key = TableResultCache::key(name, context);
+  auto status = TableSingleFlight::get().run(key, generate, rows, coalesced);
+  if (coalesced) {
+    plan("Shared an identical generation for table: " + name);
+    monitoring::record("table." + name + ".coalesced",
+                       1,
+                       monitoring::PreAggregationType::Sum);
+  }
+  return status;
+}
+
 int xOpen(sqlite3_vtab* tab, sqlite3_vtab_cursor** ppCursor) {
   auto* pCur = new BaseCursor;
   auto* pVtab = (VirtualTable*)tab;
@@ -836,6 +866,7 @@ static int xBestIndex(sqlite3_vtab* tab, sqlite3_index_info* pIdxInfo) {
   pVtab->content->constraints[pIdxInfo->idxNum] = std::move(constraints);
   pVtab->content->colsUsed[pIdxInfo->idxNum] = std::move(colsUsed);
   pVtab->content->colsUsedBitsets[pIdxInfo->idxNum] = colsUsedBitset;
+  pVtab->instance->addPlannedIndex(pVtab->content, pIdxInfo->idxNum);
   pIdxInfo->estimatedCost = cost;
 
   return SQLITE_OK;
@@ -1001,7 +1032,11 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
         }
         return SQLITE_OK;
       }
-      pCur->rows = table->generate(context);
+      auto generate = [&table, &context](TableRows& rows) {
+        rows = table->generate(context);
+        return Status::success();
+      };
+      generateRows(pVtab->content->name, context, generate, pCur->rows);
     } catch (const std::exception& e) {
       LOG(ERROR) << "Exception while executing table " << pVtab->content->name
                  << ": " << e.what();
@@ -1012,17 +1047,38 @@ static int xFilter(sqlite3_vtab_cursor* pVtabCursor,
       return SQLITE_ERROR;
     }
   } else {
-    PluginRequest request = {{"action", "generate"}};
-    TablePlugin::setRequestFromContext(context, request);
-    QueryData qd;
-    auto status = Registry::call("table", pVtab->content->name, request, qd);
+    const auto& name = pVtab->content->name;
+    auto generate = [&name, &context](TableRows& rows) {
+      PluginRequest request = {{"action", "generate"}};
+      TablePlugin::setRequestFromContext(context, request);
+
+      // Prefer typed columns, unless the extension predates generateTable.
+      auto external = Registry::get().registry("table")->getExternal();
+      auto route = external.find(name);
+      if (route != external.end()) {
+        TablePage page;
+        auto status =
+            generateExtensionTable(route->second, name, request, page);
+        if (status.getCode() != kExtensionUnsupportedCode) {
+          if (status.ok()) {
+            rows = tableRowsFromPage(std::move(page));
+          }
+          return status;
+        }
+      }
+
+      QueryData qd;
+      auto status = Registry::call("table", name, request, qd);
+      rows = tableRowsFromQueryData(std::move(qd));
+      return status;
+    };
+    auto status = generateRows(name, context, generate, pCur->rows);
     if (!status.ok()) {
       VLOG(1) << "Invalid response from the extension table. Error "
               << status.getCode() << ": " << status.getMessage();
       setTableErrorMessage(pVtabCursor->pVtab, status.getMessage());
       return SQLITE_ERROR;
     }
-    pCur->rows = tableRowsFromQueryData(std::move(qd));
   }
 
   // Set the number of rows.
@@ -1093,6 +1149,10 @@ Status attachTableInternal(const std::string& name,
   // Note, if the clientData API is used then this will save a registry call
   // within xCreate.
   auto lock(instance->attachLock());
+  if (instance->isPrimary()) {
+    // Cached statements may have planned around the previous schema.
+    SQLiteDBManager::clearStatementCache();
+  }
 
   int rc = sqlite3_create_module(
       instance->db(), name.c_str(), module, (void*)&(*instance));
@@ -1114,6 +1174,9 @@ Status attachTableInternal(const std::string& name,
 Status detachTableInternal(const std::string& name,
                            const SQLiteDBInstanceRef& instance) {
   auto lock(instance->attachLock());
+  if (instance->isPrimary()) {
+    SQLiteDBManager::clearStatementCache();
+  }
   auto format = "DROP TABLE IF EXISTS temp." + name;
   int rc = sqlite3_exec(instance->db(), format.c_str(), nullptr, nullptr, 0);
   if (rc != SQLITE_OK) {
@@ -1143,25 +1206,60 @@ Status attachFunctionInternal(
   return Status(rc);
 }
 
-void attachVirtualTables(const SQLiteDBInstanceRef& instance) {
+static void registerForeignTablesIfEnabled() {
   if (FLAGS_enable_foreign) {
 #if !defined(OSQUERY_EXTERNAL)
     // Foreign table schema is available for the shell and daemon only.
     registerForeignTables();
 #endif
   }
+}
 
+static Status attachVirtualTableByName(const std::string& name,
+                                       const SQLiteDBInstanceRef& instance) {
+  // Column information is nice for virtual table create call.
   PluginResponse response;
   bool is_extension = false;
+  auto status =
+      Registry::call("table", name, {{"action", "columns"}}, response);
+  if (!status.ok()) {
+    return status;
+  }
+
+  auto statement = columnDefinition(response, true, is_extension);
+  return attachTableInternal(name, statement, instance, is_extension);
+}
 
+void attachVirtualTables(const SQLiteDBInstanceRef& instance) {
+  registerForeignTablesIfEnabled();
   for (const auto& name : RegistryFactory::get().names("table")) {
-    // Column information is nice for virtual table create call.
-    auto status =
-        Registry::call("table", name, {{"action", "columns"}}, response);
-    if (status.ok()) {
-      auto statement = columnDefinition(response, true, is_extension);
-      attachTableInternal(name, statement, instance, is_extension);
-    }
+    attachVirtualTableByName(name, instance);
+  }
+}
+
+void attachVirtualTablesLazily(const SQLiteDBInstanceRef& instance) {
+  registerForeignTablesIfEnabled();
+  instance->lazyAttach(true);
+}
+
+Status attachVirtualTable(const std::string& name,
+                          const SQLiteDBInstanceRef& instance) {
+  auto lock(instance->attachLock());
+  if (!instance->lazyAttach()) {
+    return Status::failure("Tables are already attached");
+  }
+
+  if (!RegistryFactory::get().exists("table", name)) {
+    // The name may be a table alias, which is created as a view when its
+    // table is attached. Fall back to attaching every table.
+    instance->lazyAttach(false);
+    attachVirtualTables(instance);
+    return Status::success();
+  }
+
+  if (SQLiteDBManager::isDisabled(name)) {
+    return Status::failure("Table " + name + " is disabled");
   }
+  return attachVirtualTableByName(name, instance);
 }
 } // namespace osquery
@@ -95,6 +95,26 @@ Status attachFunctionInternal(
 /// Attach all table plugins to an in-memory SQLite database.
 void attachVirtualTables(const SQLiteDBInstanceRef& instance);
 
+/**
+ * @brief Attach table plugins to a database when statements reference them.
+ *
+ * Creating hundreds of virtual tables dominates the cost of a new connection,
+ * most statements only use a few. See attachVirtualTable.
+ */
+void attachVirtualTablesLazily(const SQLiteDBInstanceRef& instance);
+
+/**
+ * @brief Attach a table plugin referenced by a statement to a lazy database.
+ *
+ * A name that is not a registered table, such as a table alias, attaches all
+ * table plugins and ends lazy attachment for the database.
+ *
+ * @param name the table name reported missing while preparing a statement.
+ * @param instance a database created with attachVirtualTablesLazily.
+ */
+Status attachVirtualTable(const std::string& name,
+                          const SQLiteDBInstanceRef& instance);
+
 #if !defined(OSQUERY_EXTERNAL)
 /**
  * A generated foreign amalgamation file includes schema for all tables.
@@ -10,22 +10,18 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <regex>
+#include <sstream>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/property_tree/json_parser.hpp>
-#include <boost/asio.hpp>
 #include <boost/foreach.hpp>
 
-#if !defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
-#error Boost error: Local sockets not available
-#endif
-
 #include <osquery/core/flags.h>
 #include <osquery/core/tables.h>
 #include <osquery/logger/logger.h>
+#include <osquery/tables/applications/posix/docker_api.h>
 #include <osquery/utils/conversions/join.h>
 #include <osquery/utils/info/platform_type.h>
 #include <osquery/utils/json/json.h>
@@ -37,21 +33,8 @@
 #endif
 
 namespace pt = boost::property_tree;
-namespace local = boost::asio::local;
 
 namespace osquery {
-
-/**
- * @brief Docker UNIX domain socket path.
- *
- * By default docker creates UNIX domain socket at /var/run/docker.sock. If
- * docker domain is configured to use a different path specify that path.
- */
-FLAG(string,
-     docker_socket,
-     "/var/run/docker.sock",
-     "Docker UNIX domain socket path");
-
 namespace tables {
 
 /**
@@ -63,51 +46,18 @@ namespace tables {
  *         message.
  */
 Status dockerApi(const std::string& uri, pt::ptree& tree) {
-  static const std::regex httpOkRegex("HTTP/1\\.(0|1) 200 OK\\\r");
+  std::string body;
+  auto s = DockerApiClient::get().call(uri, body);
+  if (!s.ok()) {
+    return s;
+  }
 
   try {
-    local::stream_protocol::endpoint ep(FLAGS_docker_socket);
-    local::stream_protocol::iostream stream(ep);
-    if (!stream) {
-      return Status(
-          1, "Error connecting to docker sock: " + stream.error().message());
-    }
-
-    // Since keep-alive connections are not used, use HTTP/1.0
-    stream << "GET " << uri
-           << " HTTP/1.0\r\nAccept: */*\r\nConnection: close\r\n\r\n"
-           << std::flush;
-    if (stream.eof()) {
-      stream.close();
-      return Status(1, "Empty docker API response for: " + uri);
-    }
-
-    // All status responses are expected to be 200
-    std::string str;
-    getline(stream, str);
-
-    std::smatch match;
-    if (!std::regex_match(str, match, httpOkRegex)) {
-      stream.close();
-      return Status(1, "Invalid docker API response for " + uri + ": " + str);
-    }
-
-    // Skip empty line between header and body
-    while (!stream.eof() && str != "\r") {
-      getline(stream, str);
-    }
-
-    try {
-      pt::read_json(stream, tree);
-    } catch (const pt::ptree_error& e) {
-      stream.close();
-      return Status(
-          1, "Error reading docker API response for " + uri + ": " + e.what());
-    }
-
-    stream.close();
-  } catch (const std::exception& e) {
-    return Status(1, std::string("Error calling docker API: ") + e.what());
+    std::istringstream stream(body);
+    pt::read_json(stream, tree);
+  } catch (const pt::ptree_error& e) {
+    return Status(
+        1, "Error reading docker API response for " + uri + ": " + e.what());
   }
 
   return Status(0);
@@ -351,6 +301,23 @@ QueryData getLabels(QueryContext& context,
   return results;
 }
 
+/**
+ * @brief Utility method to join an array of strings from a docker response.
+ */
+std::string joinDockerStrings(const rapidjson::Value& value,
+                              const std::string& path) {
+  std::vector<std::string> items;
+  auto array = getDockerValue(value, path);
+  if (array != nullptr && array->IsArray()) {
+    for (const auto& item : array->GetArray()) {
+      if (item.IsString()) {
+        items.push_back(item.GetString());
+      }
+    }
+  }
+  return osquery::join(items, ", ");
+}
+
 /**
  * @brief Utility method to get containers tree.
  */
@@ -400,56 +367,44 @@ QueryData genContainers(QueryContext& context) {
     r["created"] = BIGINT(container.get<uint64_t>("Created", 0));
     r["state"] = container.get<std::string>("State", "");
     r["status"] = container.get<std::string>("Status", "");
+    results.push_back(r);
+  }
 
-    pt::ptree container_details;
-    s = dockerApi("/containers/" + r["id"] + "/json?stream=false",
-                  container_details);
-    if (s.ok()) {
-      r["pid"] =
-          BIGINT(container_details.get_child("State").get<pid_t>("Pid", -1));
-      r["started_at"] = container_details.get_child("State").get<std::string>(
-          "StartedAt", "");
-      r["finished_at"] = container_details.get_child("State").get<std::string>(
-          "FinishedAt", "");
-      r["privileged"] = container_details.get_child("HostConfig")
-                                .get<bool>("Privileged", false)
-                            ? INTEGER(1)
-                            : INTEGER(0);
-      r["readonly_rootfs"] = container_details.get_child("HostConfig")
-                                     .get<bool>("ReadonlyRootfs", false)
-                                 ? INTEGER(1)
-                                 : INTEGER(0);
-      r["path"] = container_details.get<std::string>("Path", "");
-
-      std::vector<std::string> entry_pts;
-      for (const auto& ent_pt :
-           container_details.get_child("Config.Entrypoint")) {
-        entry_pts.push_back(ent_pt.second.data());
-      }
-      r["config_entrypoint"] = osquery::join(entry_pts, ", ");
-
-      std::vector<std::string> sec_opts;
-      for (const auto& sec_opt :
-           container_details.get_child("HostConfig.SecurityOpt")) {
-        sec_opts.push_back(sec_opt.second.data());
-      }
-      r["security_options"] = osquery::join(sec_opts, ", ");
-
-      std::vector<std::string> env_vars;
-      for (const auto& env_var : container_details.get_child("Config.Env")) {
-        env_vars.push_back(env_var.second.data());
-      }
-      r["env_variables"] = osquery::join(env_vars, ", ");
+  // Inspect the containers concurrently, each handler fills its own row.
+  std::vector<std::string> uris;
+  for (const auto& r : results) {
+    uris.push_back("/containers/" + r.at("id") + "/json?stream=false");
+  }
 
-    } else {
+  auto inspect = [&results](size_t index, const Status& status, JSON& doc) {
+    auto& r = results[index];
+    if (!status.ok()) {
       VLOG(1) << "Failed to retrieve the inspect data for container "
               << r["id"];
+      return;
     }
 
+    const auto& details = doc.doc();
+    r["pid"] = BIGINT(getDockerInteger(details, "State.Pid", -1));
+    r["started_at"] = getDockerString(details, "State.StartedAt");
+    r["finished_at"] = getDockerString(details, "State.FinishedAt");
+    r["privileged"] =
+        INTEGER(getDockerBool(details, "HostConfig.Privileged") ? 1 : 0);
+    r["readonly_rootfs"] =
+        INTEGER(getDockerBool(details, "HostConfig.ReadonlyRootfs") ? 1 : 0);
+    r["path"] = getDockerString(details, "Path");
+    r["config_entrypoint"] = joinDockerStrings(details, "Config.Entrypoint");
+    r["security_options"] =
+        joinDockerStrings(details, "HostConfig.SecurityOpt");
+    r["env_variables"] = joinDockerStrings(details, "Config.Env");
+  };
+  dockerApiForEach(uris, inspect);
+
 // When building on linux, the extended schema of docker_containers will
 // add some additional columns to support user namespaces
 #ifdef __linux__
-    if (r["pid"] != "-1") {
+  for (auto& r : results) {
+    if (r.count("pid") > 0 && r["pid"] != "-1") {
       ProcessNamespaceList namespace_list;
       s = procGetProcessNamespaces(r["pid"], namespace_list);
       if (s.ok()) {
@@ -461,10 +416,8 @@ QueryData genContainers(QueryContext& context) {
                 << r["id"];
       }
     }
-#endif
-
-    results.push_back(r);
   }
+#endif
 
   return results;
 }
@@ -593,94 +546,127 @@ QueryData genContainerPorts(QueryContext& context) {
   return results;
 }
 
+/**
+ * @brief Utility method to get the valid container ids from the constraints.
+ */
+std::vector<std::string> getContainerIds(QueryContext& context) {
+  std::vector<std::string> ids;
+  for (const auto& id : context.constraints["id"].getAll(EQUALS)) {
+    if (checkConstraintValue(id)) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+/**
+ * @brief Utility method to concatenate rows generated for each container.
+ */
+QueryData joinContainerRows(std::vector<QueryData>& container_rows) {
+  QueryData results;
+  for (auto& rows : container_rows) {
+    std::move(rows.begin(), rows.end(), std::back_inserter(results));
+  }
+  return results;
+}
+
 /**
  * @brief Entry point for docker_container_processes table.
  */
 QueryData genContainerProcesses(QueryContext& context) {
-  QueryData results;
   std::string ps_args;
+  if (isPlatform(PlatformType::TYPE_OSX)) {
+    // osx: 19 fields
+    // currently OS X Docker API will only return
+    // "PID","USER","TIME","COMMAND" fields
+    ps_args =
+        "pid,state,uid,gid,svuid,svgid,rss,vsz,etime,ppid,pgid,wq,nice,user,"
+        "time,pcpu,pmem,comm,command";
+  } else if (isPlatform(PlatformType::TYPE_LINUX)) {
+    // linux: 21 fields
+    ps_args =
+        "pid,state,uid,gid,euid,egid,suid,sgid,rss,vsz,etime,ppid,pgrp,nlwp,"
+        "nice,user,time,pcpu,pmem,comm,cmd";
+  } else {
+    return {};
+  }
 
-  for (const auto& id : context.constraints["id"].getAll(EQUALS)) {
-    if (!checkConstraintValue(id)) {
-      continue;
-    }
+  auto ids = getContainerIds(context);
+  std::vector<std::string> uris;
+  for (const auto& id : ids) {
+    uris.push_back("/containers/" + id + "/top?ps_args=axwwo%20" + ps_args);
+  }
 
-    pt::ptree container;
-
-    if (isPlatform(PlatformType::TYPE_OSX)) {
-      // osx: 19 fields
-      // currently OS X Docker API will only return
-      // "PID","USER","TIME","COMMAND" fields
-      ps_args =
-          "pid,state,uid,gid,svuid,svgid,rss,vsz,etime,ppid,pgid,wq,nice,user,"
-          "time,pcpu,pmem,comm,command";
-    } else if (isPlatform(PlatformType::TYPE_LINUX)) {
-      // linux: 21 fields
-      ps_args =
-          "pid,state,uid,gid,euid,egid,suid,sgid,rss,vsz,etime,ppid,pgrp,nlwp,"
-          "nice,user,time,pcpu,pmem,comm,cmd";
-    } else {
-      continue;
+  std::vector<QueryData> container_rows(ids.size());
+  auto top = [&ids, &container_rows](
+                 size_t index, const Status& status, JSON& doc) {
+    const auto& id = ids[index];
+    if (!status.ok()) {
+      VLOG(1) << "Error getting docker container " << id << ": "
+              << status.what();
+      return;
     }
 
-    auto s = dockerApi("/containers/" + id + "/top?ps_args=axwwo%20" + ps_args,
-                       container);
-
-    if (!s.ok()) {
-      VLOG(1) << "Error getting docker container " << id << ": " << s.what();
-      continue;
+    auto processes = getDockerValue(doc.doc(), "Processes");
+    if (processes == nullptr || !processes->IsArray()) {
+      VLOG(1) << "Error getting docker container processes " << id;
+      return;
     }
 
-    try {
-      for (const auto& processes : container.get_child("Processes")) {
-        std::vector<std::string> vector;
-        for (const auto& v : processes.second) {
-          vector.push_back(v.second.data());
-        }
+    std::vector<std::string> vector;
+    for (const auto& process : processes->GetArray()) {
+      if (!process.IsArray()) {
+        continue;
+      }
 
-        Row r;
-        r["id"] = id;
-        r["pid"] = BIGINT(vector.at(0));
-        r["wired_size"] = BIGINT(0); // No support for unpagable counters
-        if (isPlatform(PlatformType::TYPE_OSX) && vector.size() == 4) {
-          r["uid"] = BIGINT(vector.at(1));
-          r["time"] = vector.at(2);
-          r["cmdline"] = vector.at(3);
-        } else if (isPlatform(PlatformType::TYPE_LINUX) &&
-                   vector.size() == 21) {
-          r["state"] = vector.at(1);
-          r["uid"] = BIGINT(vector.at(2));
-          r["gid"] = BIGINT(vector.at(3));
-          r["euid"] = BIGINT(vector.at(4));
-          r["egid"] = BIGINT(vector.at(5));
-          r["suid"] = BIGINT(vector.at(6));
-          r["sgid"] = BIGINT(vector.at(7));
-          r["resident_size"] = BIGINT(vector.at(8) + "000");
-          r["total_size"] = BIGINT(vector.at(9) + "000");
-          r["start_time"] = BIGINT(vector.at(10));
-          r["parent"] = BIGINT(vector.at(11));
-          r["pgroup"] = BIGINT(vector.at(12));
-          r["threads"] = INTEGER(vector.at(13));
-          r["nice"] = INTEGER(vector.at(14));
-          r["user"] = vector.at(15);
-          r["time"] = vector.at(16);
-          r["cpu"] = DOUBLE(vector.at(17));
-          r["mem"] = DOUBLE(vector.at(18));
-          r["name"] = vector.at(19);
-          r["cmdline"] = vector.at(20);
-        } else {
-          continue;
-        }
+      vector.clear();
+      for (const auto& v : process.GetArray()) {
+        vector.push_back(v.IsString() ? v.GetString() : "");
+      }
+      if (vector.empty()) {
+        continue;
+      }
 
-        results.push_back(r);
+      Row r;
+      r["id"] = id;
+      r["pid"] = BIGINT(vector.at(0));
+      r["wired_size"] = BIGINT(0); // No support for unpagable counters
+      if (isPlatform(PlatformType::TYPE_OSX) && vector.size() == 4) {
+        r["uid"] = BIGINT(vector.at(1));
+        r["time"] = vector.at(2);
+        r["cmdline"] = vector.at(3);
+      } else if (isPlatform(PlatformType::TYPE_LINUX) &&
+                 vector.size() == 21) {
+        r["state"] = vector.at(1);
+        r["uid"] = BIGINT(vector.at(2));
+        r["gid"] = BIGINT(vector.at(3));
+        r["euid"] = BIGINT(vector.at(4));
+        r["egid"] = BIGINT(vector.at(5));
+        r["suid"] = BIGINT(vector.at(6));
+        r["sgid"] = BIGINT(vector.at(7));
+        r["resident_size"] = BIGINT(vector.at(8) + "000");
+        r["total_size"] = BIGINT(vector.at(9) + "000");
+        r["start_time"] = BIGINT(vector.at(10));
+        r["parent"] = BIGINT(vector.at(11));
+        r["pgroup"] = BIGINT(vector.at(12));
+        r["threads"] = INTEGER(vector.at(13));
+        r["nice"] = INTEGER(vector.at(14));
+        r["user"] = vector.at(15);
+        r["time"] = vector.at(16);
+        r["cpu"] = DOUBLE(vector.at(17));
+        r["mem"] = DOUBLE(vector.at(18));
+        r["name"] = vector.at(19);
+        r["cmdline"] = vector.at(20);
+      } else {
+        continue;
       }
-    } catch (const pt::ptree_error& e) {
-      VLOG(1) << "Error getting docker container processes " << id << ": "
-              << e.what();
+
+      container_rows[index].push_back(std::move(r));
     }
-  }
+  };
+  dockerApiForEach(uris, top);
 
-  return results;
+  return joinContainerRows(container_rows);
 }
 
 /**
@@ -703,40 +689,50 @@ char getFsChangeType(int type_id) {
  * @brief Entry point for docker_container_fs_changes table.
  */
 QueryData genContainerFsChanges(QueryContext& context) {
-  QueryData results;
+  auto ids = getContainerIds(context);
+  std::vector<std::string> uris;
+  for (const auto& id : ids) {
+    uris.push_back("/containers/" + id + "/changes");
+  }
 
-  for (const auto& id : context.constraints["id"].getAll(EQUALS)) {
-    if (!checkConstraintValue(id)) {
-      continue;
+  std::vector<QueryData> container_rows(ids.size());
+  auto changes = [&ids, &container_rows](
+                     size_t index, const Status& status, JSON& doc) {
+    const auto& id = ids[index];
+    if (!status.ok()) {
+      VLOG(1) << "Error getting docker container fs changes" << id << ": "
+              << status.what();
+      return;
     }
 
-    pt::ptree tree;
-    auto s = dockerApi("/containers/" + id + "/changes", tree);
-    if (!s.ok()) {
-      VLOG(1) << "Error getting docker container fs changes" << id << ": "
-              << s.what();
-      continue;
+    // Docker returns null when a container has no changes.
+    if (!doc.doc().IsArray()) {
+      return;
     }
 
-    for (const auto& entry : tree) {
-      try {
-        const pt::ptree& node = entry.second;
-        char change_type = getFsChangeType(node.get<int>("Kind"));
-        if (change_type == ' ') {
-          continue;
-        }
-        Row r;
-        r["id"] = id;
-        r["path"] = node.get<std::string>("Path");
-        r["change_type"] = change_type;
-        results.push_back(r);
-      } catch (const pt::ptree_error& e) {
-        VLOG(1) << "Error getting docker container fs changes details: "
-                << e.what();
+    for (const auto& node : doc.doc().GetArray()) {
+      auto kind = getDockerValue(node, "Kind");
+      auto path = getDockerValue(node, "Path");
+      if (kind == nullptr || !kind->IsInt() || path == nullptr ||
+          !path->IsString()) {
+        VLOG(1) << "Error getting docker container fs changes details: " << id;
+        continue;
+      }
+
+      char change_type = getFsChangeType(kind->GetInt());
+      if (change_type == ' ') {
+        continue;
       }
+      Row r;
+      r["id"] = id;
+      r["path"] = path->GetString();
+      r["change_type"] = change_type;
+      container_rows[index].push_back(std::move(r));
     }
-  }
-  return results;
+  };
+  dockerApiForEach(uris, changes);
+
+  return joinContainerRows(container_rows);
 }
 
 /**
@@ -800,16 +796,17 @@ long diffNanos(const std::string& iso1, const std::string& iso2) {
  * @brief Utility method to get cumulative value for specified "op" from
  *        child node in provided "tree".
  *
- * @param tree Tree to iterate.
+ * @param tree Array to iterate.
  * @param op IO operation to look for in the child nodes.
  * @return Cumulative value for type "op".
  */
-std::string getIOBytes(const pt::ptree& tree, const std::string& op) {
+std::string getIOBytes(const rapidjson::Value* tree, const std::string& op) {
   uint64_t value = 0;
-  for (const auto& entry : tree) {
-    const pt::ptree& node = entry.second;
-    if (node.get<std::string>("op", "") == op) {
-      value += node.get<uint64_t>("value", 0);
+  if (tree != nullptr && tree->IsArray()) {
+    for (const auto& node : tree->GetArray()) {
+      if (getDockerString(node, "op") == op) {
+        value += getDockerUnsigned(node, "value");
+      }
     }
   }
 
@@ -820,14 +817,17 @@ std::string getIOBytes(const pt::ptree& tree, const std::string& op) {
  * @brief Utility method to get cumulative value for specified "key" from
  *        child node in provided "tree".
  *
- * @param tree Tree to iterate.
+ * @param tree Object to iterate.
  * @param key Key to look for in the child nodes.
  * @return Cumulative value for "key".
  */
-std::string getNetworkBytes(const pt::ptree& tree, const std::string& key) {
+std::string getNetworkBytes(const rapidjson::Value* tree,
+                            const std::string& key) {
   uint64_t value = 0;
-  for (const auto& node : tree) {
-    value += node.second.get<uint64_t>(key, 0);
+  if (tree != nullptr && tree->IsObject()) {
+    for (const auto& node : tree->GetObject()) {
+      value += getDockerUnsigned(node.value, key);
+    }
   }
 
   return BIGINT(value);
@@ -837,79 +837,80 @@ std::string getNetworkBytes(const pt::ptree& tree, const std::string& key) {
  * @brief Entry point for docker_container_stats table.
  */
 QueryData genContainerStats(QueryContext& context) {
-  QueryData results;
-  for (const auto& id : context.constraints["id"].getAll(EQUALS)) {
-    if (!checkConstraintValue(id)) {
-      continue;
-    }
+  auto ids = getContainerIds(context);
+  std::vector<std::string> uris;
+  for (const auto& id : ids) {
+    uris.push_back("/containers/" + id + "/stats?stream=false");
+  }
 
-    pt::ptree container;
-    Status s =
-        dockerApi("/containers/" + id + "/stats?stream=false", container);
-    if (!s.ok()) {
-      VLOG(1) << "Error getting docker container " << id << ": " << s.what();
-      continue;
+  std::vector<QueryData> container_rows(ids.size());
+  auto stats = [&ids, &container_rows](
+                   size_t index, const Status& status, JSON& doc) {
+    const auto& id = ids[index];
+    if (!status.ok()) {
+      VLOG(1) << "Error getting docker container " << id << ": "
+              << status.what();
+      return;
     }
 
-    try {
-      Row r;
-      r["id"] = id;
-      r["name"] = container.get<std::string>("name", "");
-      r["pids"] = INTEGER(container.get<int>("pids_stats.current", 0));
-      const std::string& read = container.get<std::string>("read", "");
-      long read_unix_time = getUnixTime(read, false);
-      r["read"] = BIGINT(read_unix_time);
-      const std::string& preread = container.get<std::string>("preread", "");
-      long preread_unix_time = getUnixTime(preread, false);
-      r["preread"] = BIGINT(preread_unix_time);
-      long intervalNanos = ((read_unix_time - preread_unix_time) * 1000000000) +
-                           diffNanos(read, preread);
-      r["interval"] = BIGINT(intervalNanos);
-      r["disk_read"] = getIOBytes(
-          container.get_child("blkio_stats.io_service_bytes_recursive"),
-          "Read");
-      r["disk_write"] = getIOBytes(
-          container.get_child("blkio_stats.io_service_bytes_recursive"),
-          "Write");
-      r["num_procs"] = INTEGER(container.get<int>("num_procs", 0));
-      r["cpu_total_usage"] =
-          BIGINT(container.get<uint64_t>("cpu_stats.cpu_usage.total_usage", 0));
-      r["cpu_kernelmode_usage"] = BIGINT(container.get<uint64_t>(
-          "cpu_stats.cpu_usage.usage_in_kernelmode", 0));
-      r["cpu_usermode_usage"] = BIGINT(
-          container.get<uint64_t>("cpu_stats.cpu_usage.usage_in_usermode", 0));
-      r["system_cpu_usage"] =
-          BIGINT(container.get<uint64_t>("cpu_stats.system_cpu_usage", 0));
-      r["online_cpus"] =
-          INTEGER(container.get<uint64_t>("cpu_stats.online_cpus", 0));
-      r["pre_cpu_total_usage"] = BIGINT(
-          container.get<uint64_t>("precpu_stats.cpu_usage.total_usage", 0));
-      r["pre_cpu_kernelmode_usage"] = BIGINT(container.get<uint64_t>(
-          "precpu_stats.cpu_usage.usage_in_kernelmode", 0));
-      r["pre_cpu_usermode_usage"] = BIGINT(container.get<uint64_t>(
-          "precpu_stats.cpu_usage.usage_in_usermode", 0));
-      r["pre_system_cpu_usage"] =
-          BIGINT(container.get<uint64_t>("precpu_stats.system_cpu_usage", 0));
-      r["pre_online_cpus"] =
-          INTEGER(container.get<uint64_t>("precpu_stats.online_cpus", 0));
-      r["memory_usage"] =
-          BIGINT(container.get<uint64_t>("memory_stats.usage", 0));
-      r["memory_max_usage"] =
-          BIGINT(container.get<uint64_t>("memory_stats.max_usage", 0));
-      r["memory_limit"] =
-          BIGINT(container.get<uint64_t>("memory_stats.limit", 0));
-      r["network_rx_bytes"] = getNetworkBytes(
-          container.get_child("networks", pt::ptree()), "rx_bytes");
-      r["network_tx_bytes"] = getNetworkBytes(
-          container.get_child("networks", pt::ptree()), "tx_bytes");
-      results.push_back(r);
-    } catch (const pt::ptree_error& e) {
-      VLOG(1) << "Error getting docker container stats " << id << ": "
-              << e.what();
+    const auto& container = doc.doc();
+    if (!container.IsObject()) {
+      VLOG(1) << "Error getting docker container stats " << id;
+      return;
     }
-  }
 
-  return results;
+    Row r;
+    r["id"] = id;
+    r["name"] = getDockerString(container, "name");
+    r["pids"] = INTEGER(getDockerInteger(container, "pids_stats.current"));
+    const auto read = getDockerString(container, "read");
+    long read_unix_time = getUnixTime(read, false);
+    r["read"] = BIGINT(read_unix_time);
+    const auto preread = getDockerString(container, "preread");
+    long preread_unix_time = getUnixTime(preread, false);
+    r["preread"] = BIGINT(preread_unix_time);
+    long intervalNanos = ((read_unix_time - preread_unix_time) * 1000000000) +
+                         diffNanos(read, preread);
+    r["interval"] = BIGINT(intervalNanos);
+    auto io_bytes = getDockerValue(
+        container, "blkio_stats.io_service_bytes_recursive");
+    r["disk_read"] = getIOBytes(io_bytes, "Read");
+    r["disk_write"] = getIOBytes(io_bytes, "Write");
+    r["num_procs"] = INTEGER(getDockerInteger(container, "num_procs"));
+    r["cpu_total_usage"] = BIGINT(
+        getDockerUnsigned(container, "cpu_stats.cpu_usage.total_usage"));
+    r["cpu_kernelmode_usage"] = BIGINT(getDockerUnsigned(
+        container, "cpu_stats.cpu_usage.usage_in_kernelmode"));
+    r["cpu_usermode_usage"] = BIGINT(
+        getDockerUnsigned(container, "cpu_stats.cpu_usage.usage_in_usermode"));
+    r["system_cpu_usage"] =
+        BIGINT(getDockerUnsigned(container, "cpu_stats.system_cpu_usage"));
+    r["online_cpus"] =
+        INTEGER(getDockerUnsigned(container, "cpu_stats.online_cpus"));
+    r["pre_cpu_total_usage"] = BIGINT(
+        getDockerUnsigned(container, "precpu_stats.cpu_usage.total_usage"));
+    r["pre_cpu_kernelmode_usage"] = BIGINT(getDockerUnsigned(
+        container, "precpu_stats.cpu_usage.usage_in_kernelmode"));
+    r["pre_cpu_usermode_usage"] = BIGINT(getDockerUnsigned(
+        container, "precpu_stats.cpu_usage.usage_in_usermode"));
+    r["pre_system_cpu_usage"] =
+        BIGINT(getDockerUnsigned(container, "precpu_stats.system_cpu_usage"));
+    r["pre_online_cpus"] =
+        INTEGER(getDockerUnsigned(container, "precpu_stats.online_cpus"));
+    r["memory_usage"] =
+        BIGINT(getDockerUnsigned(container, "memory_stats.usage"));
+    r["memory_max_usage"] =
+        BIGINT(getDockerUnsigned(container, "memory_stats.max_usage"));
+    r["memory_limit"] =
+        BIGINT(getDockerUnsigned(container, "memory_stats.limit"));
+    auto networks = getDockerValue(container, "networks");
+    r["network_rx_bytes"] = getNetworkBytes(networks, "rx_bytes");
+    r["network_tx_bytes"] = getNetworkBytes(networks, "tx_bytes");
+    container_rows[index].push_back(std::move(r));
+  };
+  dockerApiForEach(uris, stats);
+
+  return joinContainerRows(container_rows);
 }
 
 /**
@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <osquery/core/flags.h>
+#include <osquery/tables/applications/posix/docker_api.h>
+#include <osquery/utils/conversions/tokenizer.h>
+
+#if !defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#error Boost error: Local sockets not available
+#endif
+
+namespace osquery {
+
+/**
+ * @brief Docker UNIX domain socket path.
+ *
+ * By default docker creates UNIX domain socket at /var/run/docker.sock. If
+ * docker domain is configured to use a different path specify that path.
+ */
+FLAG(string,
+     docker_socket,
+     "/var/run/docker.sock",
+     "Docker UNIX domain socket path");
+
+FLAG(uint32,
+     docker_max_connections,
+     8,
+     "Maximum concurrent and idle connections to the docker socket");
+
+namespace tables {
+namespace {
+
+const std::string kHeaderEnd = "\r\n\r\n";
+
+/// Consume a CRLF terminated line from the buffer, without the CRLF.
+std::string readLine(boost::asio::local::stream_protocol::socket& socket,
+                     boost::asio::streambuf& buffer) {
+  auto size = boost::asio::read_until(socket, buffer, "\r\n");
+  std::string line(boost::asio::buffers_begin(buffer.data()),
+                   boost::asio::buffers_begin(buffer.data()) + size - 2);
+  buffer.consume(size);
+  return line;
+}
+
+/// Consume exactly size bytes from the buffer and append them to body.
+void readBody(boost::asio::local::stream_protocol::socket& socket,
+              boost::asio::streambuf& buffer,
+              size_t size,
+              std::string& body) {
+  if (buffer.size() < size) {
+    boost::asio::read(
+        socket, buffer, boost::asio::transfer_exactly(size - buffer.size()));
+  }
+  body.append(boost::asio::buffers_begin(buffer.data()),
+              boost::asio::buffers_begin(buffer.data()) + size);
+  buffer.consume(size);
+}
+
+} // namespace
+
+DockerApiClient& DockerApiClient::get() {
+  static DockerApiClient client;
+  return client;
+}
+
+Status DockerApiClient::acquire(std::unique_ptr<Socket>& socket,
+                                bool& reused) {
+  {
+    WriteLock lock(mutex_);
+    if (socket_path_ != FLAGS_docker_socket) {
+      // The socket path changed, the pooled connections are to the old path.
+      idle_.clear();
+      socket_path_ = FLAGS_docker_socket;
+    }
+
+    if (!idle_.empty()) {
+      socket = std::move(idle_.back());
+      idle_.pop_back();
+      reused = true;
+      return Status::success();
+    }
+  }
+
+  reused = false;
+  socket = std::make_unique<Socket>(io_context_);
+  boost::system::error_code ec;
+  socket->connect(
+      boost::asio::local::stream_protocol::endpoint(FLAGS_docker_socket), ec);
+  if (ec) {
+    return Status::failure("Error connecting to docker sock: " + ec.message());
+  }
+
+  opened_++;
+  return Status::success();
+}
+
+void DockerApiClient::release(std::unique_ptr<Socket> socket) {
+  WriteLock lock(mutex_);
+  if (idle_.size() < FLAGS_docker_max_connections &&
+      socket_path_ == FLAGS_docker_socket) {
+    idle_.push_back(std::move(socket));
+  }
+}
+
+Status DockerApiClient::request(Socket& socket,
+                                const std::string& uri,
+                                std::string& body,
+                                bool& keep_alive,
+                                bool& received) {
+  keep_alive = false;
+  received = false;
+  body.clear();
+
+  try {
+    auto request = "GET " + uri +
+                   " HTTP/1.1\r\nHost: docker\r\nAccept: */*\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(request));
+
+    boost::asio::streambuf buffer;
+    auto header_size = boost::asio::read_until(socket, buffer, kHeaderEnd);
+    received = true;
+    std::string headers(
+        boost::asio::buffers_begin(buffer.data()),
+        boost::asio::buffers_begin(buffer.data()) + header_size);
+    buffer.consume(header_size);
+
+    Tokenizer lines(headers, "\n");
+    std::string_view status_line;
+    lines.next(status_line);
+    // All status responses are expected to be 200.
+    if (status_line.size() < 12 ||
+        !boost::starts_with(status_line, "HTTP/1.") ||
+        status_line.substr(8, 4) != " 200") {
+      return Status::failure("Invalid docker API response for " + uri + ": " +
+                             std::string(status_line));
+    }
+    keep_alive = boost::starts_with(status_line, "HTTP/1.1");
+
+    bool chunked = false;
+    bool has_length = false;
+    size_t length = 0;
+    std::string_view line, name, value;
+    while (lines.next(line)) {
+      if (!splitKeyValue(line, ':', name, value)) {
+        continue;
+      }
+
+      if (boost::iequals(name, "Content-Length")) {
+        has_length = parseInteger(value, length);
+      } else if (boost::iequals(name, "Transfer-Encoding")) {
+        chunked = boost::icontains(value, "chunked");
+      } else if (boost::iequals(name, "Connection")) {
+        keep_alive = !boost::iequals(value, "close");
+      }
+    }
+
+    if (chunked) {
+      size_t size = 0;
+      do {
+        auto size_line = readLine(socket, buffer);
+        // Ignore chunk extensions after a semicolon.
+        auto hex = trimView(std::string_view(size_line).substr(
+            0, size_line.find(';')));
+        if (!parseInteger(hex, size, 16)) {
+          keep_alive = false;
+          return Status::failure("Invalid docker API chunk for " + uri);
+        }
+        if (size > 0) {
+          readBody(socket, buffer, size, body);
+          // The chunk data ends with CRLF.
+          readLine(socket, buffer);
+        } else {
+          // Skip optional trailers until the empty line ending the response.
+          while (!readLine(socket, buffer).empty()) {
+          }
+        }
+      } while (size > 0);
+    } else if (has_length) {
+      readBody(socket, buffer, length, body);
+    } else {
+      // The response body is delimited by closing the connection.
+      keep_alive = false;
+      boost::system::error_code ec;
+      boost::asio::read(socket, buffer, ec);
+      if (ec && ec != boost::asio::error::eof) {
+        return Status::failure("Error reading docker API response for " +
+                               uri + ": " + ec.message());
+      }
+      readBody(socket, buffer, buffer.size(), body);
+    }
+  } catch (const boost::system::system_error& e) {
+    keep_alive = false;
+    return Status::failure(std::string("Error calling docker API: ") +
+                           e.what());
+  }
+
+  return Status::success();
+}
+
+Status DockerApiClient::call(const std::string& uri, std::string& body) {
+  for (size_t attempt = 0; attempt < 2; attempt++) {
+    std::unique_ptr<Socket> socket;
+    bool reused = false;
+    auto status = acquire(socket, reused);
+    if (!status.ok()) {
+      return status;
+    }
+
+    bool keep_alive = false;
+    bool received = false;
+    status = request(*socket, uri, body, keep_alive, received);
+    if (keep_alive) {
+      release(std::move(socket));
+    }
+
+    // Docker may close an idle connection, retry those on a new connection.
+    if (status.ok() || !reused || received) {
+      return status;
+    }
+  }
+  return Status::failure("Error calling docker API: " + uri);
+}
+
+Status DockerApiClient::call(const std::string& uri, JSON& doc) {
+  std::string body;
+  auto status = call(uri, body);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = doc.fromString(body);
+  if (!status.ok()) {
+    return Status::failure("Error reading docker API response for " + uri +
+                           ": " + status.getMessage());
+  }
+  return Status::success();
+}
+
+void DockerApiClient::reset() {
+  WriteLock lock(mutex_);
+  idle_.clear();
+}
+
+size_t DockerApiClient::connectionsOpened() const {
+  return opened_;
+}
+
+Status dockerApi(const std::string& uri, JSON& doc) {
+  return DockerApiClient::get().call(uri, doc);
+}
+
+void dockerApiForEach(
+    const std::vector<std::string>& uris,
+    const std::function<void(size_t index, const Status& status, JSON& doc)>&
+        handler) {
+  std::atomic<size_t> next{0};
+  auto worker = [&uris, &handler, &next]() {
+    for (auto index = next++; index < uris.size(); index = next++) {
+      JSON doc;
+      auto status = dockerApi(uris[index], doc);
+      handler(index, status, doc);
+    }
+  };
+
+  size_t limit = std::max<size_t>(FLAGS_docker_max_connections, 1);
+  auto count = std::min(limit, uris.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < count; i++) {
+    workers.emplace_back(worker);
+  }
+  // The calling thread is also a worker.
+  worker();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+}
+
+const rapidjson::Value* getDockerValue(const rapidjson::Value& value,
+                                       const std::string& path) {
+  const rapidjson::Value* current = &value;
+  Tokenizer members(path, ".");
+  std::string_view member;
+  while (members.next(member)) {
+    if (!current->IsObject()) {
+      return nullptr;
+    }
+    auto it = current->FindMember(rapidjson::Value(
+        rapidjson::StringRef(member.data(), member.size())));
+    if (it == current->MemberEnd()) {
+      return nullptr;
+    }
+    current = &it->value;
+  }
+  return current;
+}
+
+std::string getDockerString(const rapidjson::Value& value,
+                            const std::string& path,
+                            const std::string& def) {
+  auto found = getDockerValue(value, path);
+  if (found == nullptr || !found->IsString()) {
+    return def;
+  }
+  return std::string(found->GetString(), found->GetStringLength());
+}
+
+int64_t getDockerInteger(const rapidjson::Value& value,
+                         const std::string& path,
+                         int64_t def) {
+  auto found = getDockerValue(value, path);
+  return (found != nullptr && found->IsInt64()) ? found->GetInt64() : def;
+}
+
+uint64_t getDockerUnsigned(const rapidjson::Value& value,
+                           const std::string& path,
+                           uint64_t def) {
+  auto found = getDockerValue(value, path);
+  return (found != nullptr && found->IsUint64()) ? found->GetUint64() : def;
+}
+
+bool getDockerBool(const rapidjson::Value& value, const std::string& path) {
+  auto found = getDockerValue(value, path);
+  return found != nullptr && found->IsBool() && found->GetBool();
+}
+
+} // namespace tables
+} // namespace osquery
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <osquery/utils/json/json.h>
+#include <osquery/utils/mutex.h>
+#include <osquery/utils/status/status.h>
+
+namespace osquery {
+namespace tables {
+
+/**
+ * @brief A pool of keep-alive HTTP connections to the docker UNIX socket.
+ *
+ * Each call borrows an idle connection, or opens one, and returns it to the
+ * pool when the response allows the connection to be reused. A call that
+ * fails on a pooled connection, which docker may have closed while idle, is
+ * retried once on a new connection.
+ */
+class DockerApiClient : private boost::noncopyable {
+ public:
+  static DockerApiClient& get();
+
+  /**
+   * @brief Make a GET request to the docker socket.
+   *
+   * @param uri Relative URI to invoke GET HTTP method.
+   * @param body The response body.
+   * @return Status with an error message if the response is not 200 OK.
+   */
+  Status call(const std::string& uri, std::string& body);
+
+  /// Make a GET request and parse the JSON response body.
+  Status call(const std::string& uri, JSON& doc);
+
+  /// Close the idle connections.
+  void reset();
+
+  /// The number of connections opened to the docker socket.
+  size_t connectionsOpened() const;
+
+ private:
+  DockerApiClient() = default;
+
+  using Socket = boost::asio::local::stream_protocol::socket;
+
+  /// Take an idle connection, or open a new one.
+  Status acquire(std::unique_ptr<Socket>& socket, bool& reused);
+
+  /// Return a connection to the pool.
+  void release(std::unique_ptr<Socket> socket);
+
+  /**
+   * @brief Send a request and read the response on a connection.
+   *
+   * @param keep_alive Set to false if the connection cannot be reused.
+   * @param received Set to true once any part of the response was read.
+   */
+  Status request(Socket& socket,
+                 const std::string& uri,
+                 std::string& body,
+                 bool& keep_alive,
+                 bool& received);
+
+ private:
+  boost::asio::io_context io_context_;
+
+  /// The socket path of the pooled connections.
+  std::string socket_path_;
+
+  std::vector<std::unique_ptr<Socket>> idle_;
+
+  std::atomic<size_t> opened_{0};
+
+  Mutex mutex_;
+};
+
+/// Make a GET request to the docker socket and parse the JSON response.
+Status dockerApi(const std::string& uri, JSON& doc);
+
+/**
+ * @brief Make GET requests for several URIs with bounded concurrency.
+ *
+ * At most --docker_max_connections requests are made at the same time. The
+ * handler is called from worker threads, at most once at a time for each
+ * index, and must only write state owned by that index.
+ *
+ * @param uris Relative URIs to invoke GET HTTP method.
+ * @param handler Called with the index of the URI and its parsed response.
+ */
+void dockerApiForEach(
+    const std::vector<std::string>& uris,
+    const std::function<void(size_t index, const Status& status, JSON& doc)>&
+        handler);
+
+/// Find a value by a dotted path of object members, or nullptr.
+const rapidjson::Value* getDockerValue(const rapidjson::Value& value,
+                                       const std::string& path);
+
+/// Get a string by a dotted path, or the default if missing.
+std::string getDockerString(const rapidjson::Value& value,
+                            const std::string& path,
+                            const std::string& def = "");
+
+/// Get an integer by a dotted path, or the default if missing.
+int64_t getDockerInteger(const rapidjson::Value& value,
+                         const std::string& path,
+                         int64_t def = 0);
+
+/// Get an unsigned integer by a dotted path, or the default if missing.
+uint64_t getDockerUnsigned(const rapidjson::Value& value,
+                           const std::string& path,
+                           uint64_t def = 0);
+
+/// Get a boolean by a dotted path, or false if missing.
+bool getDockerBool(const rapidjson::Value& value, const std::string& path);
+
+} // namespace tables
+} // namespace osquery
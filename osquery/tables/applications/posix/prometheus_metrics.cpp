@@ -13,63 +13,193 @@
 #include <osquery/remote/http_client.h>
 // clang-format on
 
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <set>
+#include <thread>
 
 #include <osquery/config/config.h>
 #include <plugins/config/parsers/prometheus_targets.h>
 #include <osquery/logger/logger.h>
 #include <osquery/core/tables.h>
 #include <osquery/tables/applications/posix/prometheus_metrics.h>
-#include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tokenizer.h>
+#include <osquery/utils/mutex.h>
 
 namespace osquery {
 namespace tables {
+namespace {
+
+/// The metrics of a target, reused within its TTL.
+struct PrometheusTargetMetrics {
+  std::chrono::steady_clock::time_point scraped;
+  QueryData rows;
+};
+
+Mutex kScrapeCacheMutex;
+std::map<std::string, PrometheusTargetMetrics> kScrapeCache;
+
+/**
+ * @brief Find the end of the metric name and its labels.
+ *
+ * Label values are quoted and may contain spaces, braces, and escaped quotes.
+ *
+ * @return npos if the labels are not closed.
+ */
+size_t metricNameEnd(std::string_view line) {
+  auto end = line.find_first_of(" \t{");
+  if (end == std::string_view::npos || line[end] != '{') {
+    return end;
+  }
+
+  bool quoted = false;
+  for (auto i = end + 1; i < line.size(); i++) {
+    if (quoted) {
+      if (line[i] == '\\') {
+        i++;
+      } else if (line[i] == '"') {
+        quoted = false;
+      }
+    } else if (line[i] == '"') {
+      quoted = true;
+    } else if (line[i] == '}') {
+      return i + 1;
+    }
+  }
+  return std::string_view::npos;
+}
+
+} // namespace
+
+void parsePrometheusMetrics(const std::string& target,
+                            std::string_view content,
+                            std::chrono::milliseconds timestampMS,
+                            QueryData& rows) {
+  auto timestamp = BIGINT(timestampMS.count());
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  while (lines.next(line)) {
+    if (line[0] == '#') {
+      continue;
+    }
+
+    auto end = metricNameEnd(line);
+    if (end == std::string_view::npos) {
+      continue;
+    }
+
+    std::string_view value;
+    if (Tokenizer(line.substr(end)).next(value)) {
+      Row r;
+      r[kColTargetName] = target;
+      r[kColTimeStamp] = timestamp;
+      r[kColMetric] = std::string(line.substr(0, end));
+      r[kColValue] = std::string(value);
+
+      rows.push_back(std::move(r));
+    }
+  }
+}
 
 void parseScrapeResults(
     const std::map<std::string, PrometheusResponseData>& scrapeResults,
     QueryData& rows) {
   for (auto const& target : scrapeResults) {
-    std::stringstream ss(target.second.content);
-    std::string dest;
-
-    while (std::getline(ss, dest)) {
-      if (!dest.empty() && dest[0] != '#') {
-        auto metric(osquery::split(dest, " "));
-
-        if (metric.size() > 1) {
-          Row r;
-          r[kColTargetName] = target.first;
-          r[kColTimeStamp] = BIGINT(target.second.timestampMS.count());
-          r[kColMetric] = metric[0];
-          r[kColValue] = metric[1];
-
-          rows.push_back(r);
-        }
+    parsePrometheusMetrics(target.first,
+                           target.second.content,
+                           target.second.timestampMS,
+                           rows);
+  }
+}
+
+void scrapeTargets(const std::vector<std::string>& urls,
+                   const PrometheusScrapeOptions& options,
+                   QueryData& rows) {
+  auto now = std::chrono::steady_clock::now();
+  std::vector<PrometheusTargetMetrics> targets(urls.size());
+  std::vector<size_t> pending;
+  {
+    WriteLock lock(kScrapeCacheMutex);
+    for (size_t i = 0; i < urls.size(); i++) {
+      auto cached = kScrapeCache.find(urls[i]);
+      if (options.ttl > 0 && cached != kScrapeCache.end() &&
+          now - cached->second.scraped < std::chrono::seconds(options.ttl)) {
+        targets[i] = cached->second;
+      } else {
+        pending.push_back(i);
       }
     }
   }
-}
 
-void scrapeTargets(std::map<std::string, PrometheusResponseData>& scrapeResults,
-                   size_t timeoutS) {
-  http::Client client(
-      http::Client::Options().follow_redirects(true).timeout(timeoutS));
+  // A scraped target is only reused if the scrape succeeded.
+  std::vector<char> scraped(urls.size(), false);
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    // The client is not shared between threads.
+    http::Client client(http::Client::Options()
+                            .follow_redirects(true)
+                            .timeout(options.timeout));
+    for (auto index = next++; index < pending.size(); index = next++) {
+      auto i = pending[index];
+      try {
+        http::Request request(urls[i]);
+        http::Response response(client.get(request));
+
+        auto timestampMS =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch());
+        targets[i].scraped = std::chrono::steady_clock::now();
+        parsePrometheusMetrics(
+            urls[i], response.body(), timestampMS, targets[i].rows);
+        scraped[i] = true;
+      } catch (std::exception& e) {
+        LOG(ERROR) << "Failed on scrape of target " << urls[i] << ": "
+                   << e.what();
+      }
+    }
+  };
 
-  for (auto& target : scrapeResults) {
-    try {
-      http::Request request(target.first);
-      http::Response response(client.get(request));
+  auto count = std::min(std::max<size_t>(options.maxConcurrency, 1),
+                        pending.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < count; i++) {
+    workers.emplace_back(worker);
+  }
+  // The calling thread is also a worker.
+  if (count > 0) {
+    worker();
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
 
-      target.second.timestampMS =
-          std::chrono::duration_cast<std::chrono::milliseconds>(
-              std::chrono::system_clock::now().time_since_epoch());
-      target.second.content = response.body();
+  if (options.ttl > 0) {
+    WriteLock lock(kScrapeCacheMutex);
+    for (size_t i = 0; i < urls.size(); i++) {
+      if (scraped[i]) {
+        kScrapeCache[urls[i]] = targets[i];
+      }
+    }
 
-    } catch (std::exception& e) {
-      LOG(ERROR) << "Failed on scrape of target " << target.first << ": "
-                 << e.what();
+    // Forget expired targets, which may no longer be configured.
+    for (auto it = kScrapeCache.begin(); it != kScrapeCache.end();) {
+      if (now - it->second.scraped >= std::chrono::seconds(options.ttl)) {
+        it = kScrapeCache.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
+
+  for (auto& target : targets) {
+    std::move(target.rows.begin(), target.rows.end(), std::back_inserter(rows));
+  }
+}
+
+void clearPrometheusScrapeCache() {
+  WriteLock lock(kScrapeCacheMutex);
+  kScrapeCache.clear();
 }
 
 QueryData genPrometheusMetrics(QueryContext& context) {
@@ -97,19 +227,26 @@ QueryData genPrometheusMetrics(QueryContext& context) {
     return result;
   }
 
-  std::map<std::string, PrometheusResponseData> sr;
   /* Below should be unreachable if there were no urls child node, but we set
    * handle with default value for consistency's sake and for added robustness.
    */
+  std::set<std::string> targets;
   const auto& urls = config["urls"];
   for (const auto& url : urls.GetArray()) {
-    sr[url.GetString()] = PrometheusResponseData{};
+    targets.insert(url.GetString());
   }
 
-  size_t timeout =
-      (!config.HasMember("timeout")) ? 1 : config["timeout"].GetUint64();
-  scrapeTargets(sr, timeout);
-  parseScrapeResults(sr, result);
+  PrometheusScrapeOptions options;
+  if (config.HasMember("timeout")) {
+    options.timeout = config["timeout"].GetUint64();
+  }
+  if (config.HasMember("max_concurrency")) {
+    options.maxConcurrency = config["max_concurrency"].GetUint64();
+  }
+  if (config.HasMember("ttl")) {
+    options.ttl = config["ttl"].GetUint64();
+  }
+  scrapeTargets({targets.begin(), targets.end()}, options, result);
 
   return result;
 }
@@ -12,6 +12,7 @@
 #include <chrono>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <osquery/core/tables.h>
@@ -29,6 +30,28 @@ struct PrometheusResponseData {
   std::chrono::milliseconds timestampMS;
 };
 
+struct PrometheusScrapeOptions {
+  /// Request timeout in seconds.
+  size_t timeout{1};
+
+  /// Maximum number of targets scraped at the same time.
+  size_t maxConcurrency{8};
+
+  /// Seconds to reuse the metrics of a target, 0 to scrape every query.
+  size_t ttl{0};
+};
+
+/**
+ * @brief parse an exposition format payload of a target line by line.
+ *
+ * Lines are read from the payload without copying it. Label values of a
+ * metric may contain spaces.
+ */
+void parsePrometheusMetrics(const std::string& target,
+                            std::string_view content,
+                            std::chrono::milliseconds timestampMS,
+                            QueryData& rows);
+
 /**
  * @brief parse raw payload returned by scraped targets into QueryData.
  *
@@ -41,16 +64,19 @@ void parseScrapeResults(
     QueryData& rows);
 
 /**
- * @brief Scrapes the Prometheus targets and returns response payload and
- * timestamp.
+ * @brief Scrapes the Prometheus targets and parses their metrics into rows.
  *
- * @param scrapeResults map where the key is the target url to be scraped and
- * value is the struct PrometheusResponseData where payload and timestamp are to
- * be written to.
+ * Targets are scraped concurrently, each response is parsed by the thread
+ * that received it and is not kept. Rows are ordered by target.
  *
- * @param int for request timeout in seconds.
+ * @param urls the target urls to be scraped.
+ * @param options the timeout, concurrency, and reuse of the scrapes.
  */
-void scrapeTargets(std::map<std::string, PrometheusResponseData>& scrapeResults,
-                   size_t timeoutS = 1);
+void scrapeTargets(const std::vector<std::string>& urls,
+                   const PrometheusScrapeOptions& options,
+                   QueryData& rows);
+
+/// Forget the metrics reused within the TTL of the targets.
+void clearPrometheusScrapeCache();
 }
 }
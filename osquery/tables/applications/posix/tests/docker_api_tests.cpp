@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <osquery/tables/applications/posix/docker_api.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+
+DECLARE_string(docker_socket);
+DECLARE_uint32(docker_max_connections);
+
+namespace tables {
+
+/**
+ * @brief A fake docker daemon serving keep-alive HTTP on a UNIX socket.
+ *
+ * "/chunked" responds with a chunked body, "/drop" closes the connection
+ * after responding as if it was idle for too long, and "/missing" responds
+ * with 404. Any other URI responds with {"uri": "<uri>"}.
+ */
+class FakeDockerServer {
+ public:
+  explicit FakeDockerServer(const std::string& path) : path_(path) {
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+    listen(fd_, 64);
+    thread_ = std::thread([this]() { accept(); });
+  }
+
+  ~FakeDockerServer() {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    thread_.join();
+    for (auto& connection : connections_) {
+      connection.join();
+    }
+    fs::remove(path_);
+  }
+
+ private:
+  void accept() {
+    while (true) {
+      int client = ::accept(fd_, nullptr, nullptr);
+      if (client < 0) {
+        return;
+      }
+      connections_.emplace_back([this, client]() { serve(client); });
+    }
+  }
+
+  void serve(int client) {
+    std::string buffer;
+    char data[4096];
+    while (true) {
+      auto end = buffer.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        auto size = read(client, data, sizeof(data));
+        if (size <= 0) {
+          break;
+        }
+        buffer.append(data, size);
+        continue;
+      }
+
+      auto request = buffer.substr(0, end);
+      buffer.erase(0, end + 4);
+      auto uri = request.substr(4, request.find(' ', 4) - 4);
+      auto body = "{\"uri\": \"" + uri + "\"}";
+
+      std::string response;
+      if (uri == "/missing") {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+      } else if (uri == "/chunked") {
+        // Chunk sizes are hex, the first chunk has an extension.
+        std::stringstream size;
+        size << std::hex << body.size() - 5;
+        response =
+            "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "5;name=value\r\n{\"uri\r\n" +
+            size.str() + "\r\n" + body.substr(5) + "\r\n0\r\n\r\n";
+      } else {
+        response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                   "Content-Length: " +
+                   std::to_string(body.size()) + "\r\n\r\n" + body;
+      }
+      write(client, response.data(), response.size());
+
+      if (uri == "/drop") {
+        break;
+      }
+    }
+    close(client);
+  }
+
+ private:
+  std::string path_;
+
+  int fd_{-1};
+
+  std::thread thread_;
+
+  /// Only modified by the accept thread, joined after it.
+  std::vector<std::thread> connections_;
+};
+
+class DockerApiTests : public testing::Test {
+ protected:
+  void SetUp() override {
+    socket_backup_ = FLAGS_docker_socket;
+    auto path =
+        fs::temp_directory_path() / fs::unique_path("osquery-docker-%%%%.sock");
+    FLAGS_docker_socket = path.string();
+    server_ = std::make_unique<FakeDockerServer>(FLAGS_docker_socket);
+  }
+
+  void TearDown() override {
+    DockerApiClient::get().reset();
+    server_.reset();
+    FLAGS_docker_socket = socket_backup_;
+  }
+
+  std::string socket_backup_;
+
+  std::unique_ptr<FakeDockerServer> server_;
+};
+
+TEST_F(DockerApiTests, test_keep_alive) {
+  auto& client = DockerApiClient::get();
+  auto opened = client.connectionsOpened();
+
+  for (size_t i = 0; i < 3; i++) {
+    JSON doc;
+    ASSERT_TRUE(dockerApi("/version", doc).ok());
+    EXPECT_EQ(getDockerString(doc.doc(), "uri"), "/version");
+  }
+
+  // Every request used the same connection.
+  EXPECT_EQ(client.connectionsOpened(), opened + 1);
+}
+
+TEST_F(DockerApiTests, test_chunked_response) {
+  JSON doc;
+  ASSERT_TRUE(dockerApi("/chunked", doc).ok());
+  EXPECT_EQ(getDockerString(doc.doc(), "uri"), "/chunked");
+
+  // The connection is still usable after the last chunk.
+  ASSERT_TRUE(dockerApi("/info", doc).ok());
+  EXPECT_EQ(getDockerString(doc.doc(), "uri"), "/info");
+}
+
+TEST_F(DockerApiTests, test_errors) {
+  JSON doc;
+  EXPECT_FALSE(dockerApi("/missing", doc).ok());
+
+  // A pooled connection closed by docker is retried on a new connection.
+  auto& client = DockerApiClient::get();
+  ASSERT_TRUE(dockerApi("/drop", doc).ok());
+  auto opened = client.connectionsOpened();
+  ASSERT_TRUE(dockerApi("/info", doc).ok());
+  EXPECT_EQ(client.connectionsOpened(), opened + 1);
+
+  FLAGS_docker_socket += ".missing";
+  EXPECT_FALSE(dockerApi("/info", doc).ok());
+}
+
+TEST_F(DockerApiTests, test_for_each) {
+  auto connections_backup = FLAGS_docker_max_connections;
+  FLAGS_docker_max_connections = 4;
+
+  std::vector<std::string> uris;
+  for (size_t i = 0; i < 50; i++) {
+    uris.push_back("/containers/" + std::to_string(i) + "/stats");
+  }
+
+  auto& client = DockerApiClient::get();
+  auto opened = client.connectionsOpened();
+  std::vector<std::string> results(uris.size());
+  std::atomic<size_t> failures{0};
+  dockerApiForEach(
+      uris, [&results, &failures](size_t index, const Status& s, JSON& doc) {
+        if (!s.ok()) {
+          failures++;
+          return;
+        }
+        results[index] = getDockerString(doc.doc(), "uri");
+      });
+
+  EXPECT_EQ(failures, 0U);
+  EXPECT_EQ(results, uris);
+  EXPECT_LE(client.connectionsOpened(), opened + 4);
+  FLAGS_docker_max_connections = connections_backup;
+}
+
+TEST_F(DockerApiTests, test_get_value) {
+  JSON doc;
+  ASSERT_TRUE(
+      doc.fromString(
+             "{\"State\": {\"Pid\": 42, \"Running\": true, \"Status\": \"up\"},"
+             " \"Size\": 18446744073709551615, \"Env\": null}")
+          .ok());
+
+  const auto& value = doc.doc();
+  EXPECT_EQ(getDockerInteger(value, "State.Pid", -1), 42);
+  EXPECT_EQ(getDockerInteger(value, "State.Missing", -1), -1);
+  EXPECT_EQ(getDockerString(value, "State.Status"), "up");
+  EXPECT_EQ(getDockerString(value, "State.Pid", "none"), "none");
+  EXPECT_TRUE(getDockerBool(value, "State.Running"));
+  EXPECT_FALSE(getDockerBool(value, "State.Status"));
+  EXPECT_EQ(getDockerUnsigned(value, "Size"), 18446744073709551615ULL);
+  EXPECT_EQ(getDockerValue(value, "Env.Path"), nullptr);
+}
+
+} // namespace tables
+} // namespace osquery
@@ -7,8 +7,19 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <osquery/tables/applications/posix/prometheus_metrics.h>
 
 namespace osquery {
@@ -411,5 +422,181 @@ TEST_F(PrometheusMetricsTest, happy_path_10_metrics_2_targets) {
 
   validate(sr, expected);
 }
+
+TEST_F(PrometheusMetricsTest, labels_with_spaces) {
+  std::chrono::milliseconds now(1000);
+  PrometheusResponseData r0 = PrometheusResponseData{
+      "# TYPE http_requests_total counter\r\n"
+      "http_requests_total{path=\"/a b\",code=\"200\"} 3 1600000000000\r\n"
+      "http_requests_total{path=\"}\\\" \"} 4\n"
+      "unterminated{path=\"/ 5\n",
+      now};
+  std::map<std::string, PrometheusResponseData> sr = {{"example1.com", r0}};
+
+  QueryData expected = {
+      {{kColTargetName, "example1.com"},
+       {kColMetric, "http_requests_total{path=\"/a b\",code=\"200\"}"},
+       {kColValue, "3"},
+       {kColTimeStamp, "1000"}},
+      {{kColTargetName, "example1.com"},
+       {kColMetric, "http_requests_total{path=\"}\\\" \"}"},
+       {kColValue, "4"},
+       {kColTimeStamp, "1000"}},
+  };
+
+  validate(sr, expected);
+}
+
+/**
+ * @brief A local HTTP target serving its request path as a metric.
+ *
+ * Each response is delayed, so concurrent scrapes overlap. The requests
+ * and the peak number of requests in flight are counted.
+ */
+class FakePrometheusTarget {
+ public:
+  explicit FakePrometheusTarget(std::chrono::milliseconds delay)
+      : delay_(delay) {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+    socklen_t size = sizeof(address);
+    getsockname(fd_, reinterpret_cast<struct sockaddr*>(&address), &size);
+    port_ = ntohs(address.sin_port);
+    listen(fd_, 64);
+    thread_ = std::thread([this]() { accept(); });
+  }
+
+  ~FakePrometheusTarget() {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    thread_.join();
+    for (auto& connection : connections_) {
+      connection.join();
+    }
+  }
+
+  std::string url(const std::string& path) const {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  std::atomic<size_t> requests{0};
+  std::atomic<size_t> peak{0};
+
+ private:
+  void accept() {
+    while (true) {
+      int client = ::accept(fd_, nullptr, nullptr);
+      if (client < 0) {
+        return;
+      }
+      connections_.emplace_back([this, client]() { serve(client); });
+    }
+  }
+
+  void serve(int client) {
+    auto current = ++in_flight_;
+    for (auto last = peak.load(); current > last;) {
+      peak.compare_exchange_weak(last, current);
+    }
+
+    std::string request;
+    char data[4096];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+      auto size = read(client, data, sizeof(data));
+      if (size <= 0) {
+        break;
+      }
+      request.append(data, size);
+    }
+    requests++;
+    std::this_thread::sleep_for(delay_);
+
+    // The metric is named after the request path.
+    auto path = request.substr(5, request.find(' ', 5) - 5);
+    auto body = "# TYPE " + path + " gauge\n" + path + " 1\n";
+    auto response = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                    std::to_string(body.size()) +
+                    "\r\nConnection: close\r\n\r\n" + body;
+    --in_flight_;
+    write(client, response.data(), response.size());
+    close(client);
+  }
+
+ private:
+  std::chrono::milliseconds delay_;
+
+  int fd_{-1};
+  unsigned short port_{0};
+
+  std::atomic<size_t> in_flight_{0};
+
+  std::thread thread_;
+
+  /// Only modified by the accept thread, joined after it.
+  std::vector<std::thread> connections_;
+};
+
+class PrometheusScrapeTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    clearPrometheusScrapeCache();
+  }
+};
+
+TEST_F(PrometheusScrapeTest, concurrent_targets) {
+  FakePrometheusTarget target(std::chrono::milliseconds(200));
+  std::vector<std::string> urls;
+  for (size_t i = 0; i < 8; i++) {
+    urls.push_back(target.url("/metric" + std::to_string(i)));
+  }
+
+  PrometheusScrapeOptions options;
+  options.timeout = 5;
+  options.maxConcurrency = 4;
+  QueryData rows;
+  scrapeTargets(urls, options, rows);
+
+  // Rows are ordered by target.
+  ASSERT_EQ(rows.size(), urls.size());
+  for (size_t i = 0; i < urls.size(); i++) {
+    EXPECT_EQ(rows[i][kColTargetName], urls[i]);
+    EXPECT_EQ(rows[i][kColMetric], "metric" + std::to_string(i));
+    EXPECT_EQ(rows[i][kColValue], "1");
+  }
+
+  EXPECT_EQ(target.requests, urls.size());
+  EXPECT_GT(target.peak, 1U);
+  EXPECT_LE(target.peak, options.maxConcurrency);
+}
+
+TEST_F(PrometheusScrapeTest, reuse_within_ttl) {
+  FakePrometheusTarget target(std::chrono::milliseconds(0));
+  std::vector<std::string> urls = {target.url("/metric"),
+                                   "http://127.0.0.1:1/missing"};
+
+  PrometheusScrapeOptions options;
+  options.ttl = 60;
+  QueryData first;
+  scrapeTargets(urls, options, first);
+
+  // A target that cannot be scraped has no rows.
+  ASSERT_EQ(first.size(), 1U);
+  EXPECT_EQ(first[0][kColMetric], "metric");
+
+  QueryData second;
+  scrapeTargets(urls, options, second);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(target.requests, 1U);
+
+  // Without a TTL every query scrapes the target.
+  options.ttl = 0;
+  QueryData third;
+  scrapeTargets(urls, options, third);
+  EXPECT_EQ(third.size(), 1U);
+  EXPECT_EQ(target.requests, 2U);
+}
 } // namespace tables
 } // namespace osquery
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include <osquery/config/config.h>
+#include <osquery/core/flags.h>
 #include <osquery/core/tables.h>
 #include <osquery/events/darwin/fsevents.h>
 #include <osquery/events/eventsubscriber.h>
@@ -21,6 +22,8 @@
 
 namespace osquery {
 
+DECLARE_uint64(file_events_coalesce_window);
+
 extern const std::set<std::string> kCommonFileColumns;
 
 /**
@@ -37,6 +40,11 @@ class FileEventSubscriber : public EventSubscriber<FSEventsEventPublisher> {
   /// Walk the configuration's file paths, create subscriptions.
   void configure() override;
 
+  /// Editors and build tools modify the same file in bursts.
+  size_t getCoalesceWindow() override {
+    return FLAGS_file_events_coalesce_window;
+  }
+
   /**
    * @brief This exports a single Callback for INotifyEventPublisher events.
    *
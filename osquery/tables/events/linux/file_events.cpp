@@ -11,8 +11,10 @@
 #include <vector>
 
 #include <osquery/config/config.h>
+#include <osquery/core/flags.h>
 #include <osquery/core/tables.h>
 #include <osquery/events/eventsubscriber.h>
+#include <osquery/events/linux/fanotify.h>
 #include <osquery/events/linux/inotify.h>
 #include <osquery/logger/logger.h>
 #include <osquery/registry/registry_factory.h>
@@ -20,6 +22,9 @@
 
 namespace osquery {
 
+DECLARE_bool(enable_file_events_fanotify);
+DECLARE_uint64(file_events_coalesce_window);
+
 /**
  * @brief Track time, action changes to /etc/passwd
  *
@@ -34,6 +39,27 @@ class FileEventSubscriber : public EventSubscriber<INotifyEventPublisher> {
   /// Walk the configuration's file paths, create subscriptions.
   void configure() override;
 
+  /**
+   * @brief Subscribe to fanotify when it replaces inotify.
+   *
+   * Both publishers share the inotify subscription and event contexts.
+   * If fanotify could not be initialized, inotify is used instead.
+   */
+  const std::string& getType() const override {
+    if (FLAGS_enable_file_events_fanotify &&
+        FanotifyEventPublisher::initialized()) {
+      static const std::string type =
+          EventFactory::getType<FanotifyEventPublisher>();
+      return type;
+    }
+    return EventSubscriber<INotifyEventPublisher>::getType();
+  }
+
+  /// Editors and build tools modify the same file in bursts.
+  size_t getCoalesceWindow() override {
+    return FLAGS_file_events_coalesce_window;
+  }
+
   /**
    * @brief This exports a single Callback for INotifyEventPublisher events.
    *
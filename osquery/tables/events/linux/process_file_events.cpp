@@ -239,9 +239,7 @@ bool EmitRowFromSyscallContext(
     const AuditdFimContext& fim_context,
     const AuditdFimSyscallContext& syscall_context) noexcept {
   auto L_IsPathIncluded = [&fim_context](const std::string& path) -> bool {
-    return (std::find(fim_context.included_path_list.begin(),
-                      fim_context.included_path_list.end(),
-                      path) != fim_context.included_path_list.end());
+    return !fim_context.included_paths.categories(path).empty();
   };
 
   row.clear();
@@ -1181,23 +1179,10 @@ Status ProcessFileEventSubscriber::init() {
 }
 
 void ProcessFileEventSubscriber::configure() {
-  auto parser = Config::getParser("file_paths");
-  Config::get().files([this](const std::string& category,
-                             const std::vector<std::string>& files) {
-    for (auto file : files) {
-      replaceGlobWildcards(file);
-
-      StringList solved_path_list = {};
-      resolveFilePattern(file, solved_path_list);
-
-      context_.included_path_list.reserve(context_.included_path_list.size() +
-                                          solved_path_list.size());
-
-      context_.included_path_list.insert(context_.included_path_list.end(),
-                                         solved_path_list.begin(),
-                                         solved_path_list.end());
-    }
-  });
+  // Compile the patterns instead of resolving them against the filesystem,
+  // so files created after configure are matched as well.
+  context_.included_paths.clear();
+  context_.included_paths.addConfigPaths();
 }
 
 Status ProcessFileEventSubscriber::Callback(const ECRef& event_context,
@@ -20,6 +20,7 @@
 
 #include <osquery/events/eventsubscriber.h>
 #include <osquery/events/linux/auditeventpublisher.h>
+#include <osquery/events/pathmatcher.h>
 
 namespace osquery {
 /// An inode descriptor, containing the file (or folder) path
@@ -155,8 +156,8 @@ using StringList = std::vector<std::string>;
 
 /// The fim context contains configuration and process state
 struct AuditdFimContext final {
-  /// The paths included in the audit fim events
-  StringList included_path_list;
+  /// The file_paths patterns included in the audit fim events
+  FilePathMatcher included_paths;
 
   /// The process map, containing an fd map for each process
   AuditdFimProcessMap process_map;
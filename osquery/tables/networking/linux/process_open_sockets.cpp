@@ -7,13 +7,133 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <netinet/tcp.h>
+
+#include <algorithm>
+
 #include <osquery/core/core.h>
 #include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/filesystem/linux/proc.h>
+#include <osquery/tables/networking/linux/sock_diag.h>
+#include <osquery/utils/conversions/tryto.h>
 
 namespace osquery {
 namespace tables {
+namespace {
+
+/// TCP request sockets, which are reported in the SYN_RECV state.
+const uint32_t kTcpNewSynRecv = 12;
+
+/**
+ * @brief The sockets a query may match, from its constraints.
+ *
+ * These filters never exclude a row the query could select, SQLite still
+ * applies the constraints to the results.
+ */
+struct SocketConstraints {
+  /// The families to list, empty for all of them.
+  std::set<int> families;
+
+  /// Rows without a TCP state may match.
+  bool stateless{true};
+
+  /// Rows without ports, the AF_UNIX sockets, may match.
+  bool portless{true};
+
+  /// Filters applied by the kernel to socket diagnostics dumps.
+  SockDiagFilter filter;
+
+  bool lists(int family, int protocol) const {
+    if (!families.empty() && families.count(family) == 0) {
+      return false;
+    }
+
+    if (family == AF_UNIX) {
+      return stateless && portless;
+    }
+    return stateless || protocol == IPPROTO_TCP;
+  }
+};
+
+/// Add the valid port values of an equality constraint, return true for 0.
+bool getPortConstraints(QueryContext& context,
+                        const std::string& column,
+                        std::set<uint16_t>& ports) {
+  if (!context.constraints[column].exists(EQUALS)) {
+    return true;
+  }
+
+  for (const auto& value : context.constraints[column].getAll(EQUALS)) {
+    auto port = tryTo<int>(value);
+    if (port && port.get() >= 0 && port.get() <= 65535) {
+      ports.insert(static_cast<uint16_t>(port.get()));
+    }
+  }
+  return ports.count(0) > 0;
+}
+
+SocketConstraints getSocketConstraints(QueryContext& context) {
+  SocketConstraints constraints;
+  for (const auto& value : context.constraints["family"].getAll(EQUALS)) {
+    auto family = tryTo<int>(value);
+    if (family) {
+      constraints.families.insert(family.get());
+    }
+  }
+
+  if (context.constraints["state"].exists(EQUALS)) {
+    auto states = context.constraints["state"].getAll(EQUALS);
+    constraints.stateless = states.count("") > 0;
+
+    uint32_t mask = 0;
+    for (const auto& state : states) {
+      auto it = std::find(tcp_states.begin(), tcp_states.end(), state);
+      if (state == "UNKNOWN") {
+        mask = ~0U;
+      } else if (it != tcp_states.end()) {
+        mask |= 1U << (it - tcp_states.begin());
+      }
+    }
+
+    if (mask & (1U << TCP_SYN_RECV)) {
+      mask |= 1U << kTcpNewSynRecv;
+    }
+    constraints.filter.states = mask;
+  }
+
+  auto local_portless =
+      getPortConstraints(context, "local_port", constraints.filter.local_ports);
+  auto remote_portless = getPortConstraints(
+      context, "remote_port", constraints.filter.remote_ports);
+  constraints.portless = local_portless && remote_portless;
+  return constraints;
+}
+
+/// List sockets with socket diagnostics, or from /proc if it fails.
+Status getSocketList(SockDiag* diag,
+                     int family,
+                     int protocol,
+                     ino_t net_ns,
+                     const std::string& pid,
+                     const SockDiagFilter& filter,
+                     SocketInfoList& result) {
+  if (diag != nullptr && (family == AF_UNIX || protocol == IPPROTO_TCP ||
+                          protocol == IPPROTO_UDP ||
+                          protocol == IPPROTO_UDPLITE)) {
+    auto status = diag->getSocketList(family, protocol, filter, result);
+    if (status.ok()) {
+      return status;
+    }
+
+    VLOG(1) << "Falling back to /proc to list sockets of family " << family
+            << " and protocol " << protocol << ": " << status.what();
+  }
+
+  return procGetSocketList(family, protocol, net_ns, pid, result);
+}
+
+} // namespace
 
 QueryData genOpenSockets(QueryContext& context) {
   Status status;
@@ -56,14 +176,16 @@ QueryData genOpenSockets(QueryContext& context) {
    * information.
    *
    * 3. Collect basic socket information for all sockets under a specifc network
-   * namespace. This is done by reading through files under /proc/<pid>/net for
-   * the first pid we find in a certain namespace. Notice this will collect
-   * information for all sockets on the namespace not only for sockets
-   * associated with the specific pid, therefore only needs to be run once. From
-   * this step we collect the inodes of each of the sockets, and will use that
-   * to correlate the socket information with the information collect on steps
-   * 1 and 2.
+   * namespace. This is done with a NETLINK_SOCK_DIAG dump within the namespace
+   * of the first pid we find in it, falling back to reading through files
+   * under /proc/<pid>/net. The kernel filters the dump using the state and
+   * port constraints of the query. Notice this will collect information for
+   * all sockets on the namespace not only for sockets associated with the
+   * specific pid, therefore only needs to be run once. From this step we
+   * collect the inodes of each of the sockets, and will use that to correlate
+   * the socket information with the information collect on steps 1 and 2.
    */
+  auto constraints = getSocketConstraints(context);
 
   /* Use a set to record the namespaces already processed */
   std::set<ino_t> netns_list;
@@ -99,30 +221,41 @@ QueryData genOpenSockets(QueryContext& context) {
       netns_list.insert(ns);
 
       /* Step 3 */
+      SockDiag diag;
+      status = diag.open(pid, ns);
+      if (!status.ok()) {
+        VLOG(1) << "Socket diagnostics are unavailable for pid " << pid
+                << ": " << status.what();
+      }
+
+      auto diag_ptr = status.ok() ? &diag : nullptr;
+      std::vector<std::pair<int, int>> lists;
       for (const auto& pair : kLinuxProtocolNames) {
-        status = procGetSocketList(AF_INET, pair.first, ns, pid, socket_list);
-        if (!status.ok()) {
-          VLOG(1)
-              << "Results for process_open_sockets might be incomplete. Failed "
-                 "to acquire basic socket information for AF_INET "
-              << pair.second << ": " << status.what();
+        lists.emplace_back(AF_INET, pair.first);
+        lists.emplace_back(AF_INET6, pair.first);
+      }
+      lists.emplace_back(AF_UNIX, IPPROTO_IP);
+
+      for (const auto& list : lists) {
+        if (!constraints.lists(list.first, list.second)) {
+          continue;
         }
 
-        status = procGetSocketList(AF_INET6, pair.first, ns, pid, socket_list);
+        status = getSocketList(diag_ptr,
+                               list.first,
+                               list.second,
+                               ns,
+                               pid,
+                               constraints.filter,
+                               socket_list);
         if (!status.ok()) {
           VLOG(1)
               << "Results for process_open_sockets might be incomplete. Failed "
-                 "to acquire basic socket information for AF_INET6 "
-              << pair.second << ": " << status.what();
+                 "to acquire basic socket information for family "
+              << list.first << " and protocol " << list.second << ": "
+              << status.what();
         }
       }
-      status = procGetSocketList(AF_UNIX, IPPROTO_IP, ns, pid, socket_list);
-      if (!status.ok()) {
-        VLOG(1)
-            << "Results for process_open_sockets might be incomplete. Failed "
-               "to acquire basic socket information for AF_UNIX: "
-            << status.what();
-      }
     }
   }
 
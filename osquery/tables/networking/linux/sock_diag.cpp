@@ -0,0 +1,344 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/unix_diag.h>
+#include <netinet/in.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <osquery/tables/networking/linux/inet_diag.h>
+#include <osquery/tables/networking/linux/sock_diag.h>
+
+namespace osquery {
+namespace {
+
+/// The size of each read of a dump, the kernel fills it with messages.
+const size_t kSockDiagBufferSize = 32768;
+
+/// Port filters with more values are only applied by SQLite.
+const size_t kSockDiagMaxPorts = 64;
+
+using Bytecode = std::vector<inet_diag_bc_op>;
+
+template <typename T>
+void appendBytes(std::string& buffer, const T& value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief A program accepting sockets with a port.
+ *
+ * Each operation jumps forward by yes or no bytes. Reaching the end of the
+ * program accepts a socket, and jumping 4 bytes past the end rejects it. The
+ * port is checked with >= and <=, which older kernels support.
+ */
+Bytecode portEquals(bool local, uint16_t port) {
+  unsigned char ge = local ? INET_DIAG_BC_S_GE : INET_DIAG_BC_D_GE;
+  unsigned char le = local ? INET_DIAG_BC_S_LE : INET_DIAG_BC_D_LE;
+  return {{ge, 8, 20}, {0, 0, port}, {le, 8, 12}, {0, 0, port}};
+}
+
+/// A program accepting sockets accepted by either program.
+Bytecode bytecodeOr(Bytecode a, const Bytecode& b) {
+  if (a.empty()) {
+    return b;
+  }
+
+  // The rejections of a jump past the end of a, to the start of b. The
+  // acceptances of a reach a jump over b.
+  auto length = b.size() * sizeof(inet_diag_bc_op);
+  a.push_back({INET_DIAG_BC_JMP, 4, static_cast<unsigned short>(length + 4)});
+  a.insert(a.end(), b.begin(), b.end());
+  return a;
+}
+
+/// A program accepting sockets accepted by both programs.
+Bytecode bytecodeAnd(Bytecode a, const Bytecode& b) {
+  if (a.empty() || b.empty()) {
+    return a.empty() ? b : a;
+  }
+
+  // The acceptances of a continue with b, its rejections must jump past b.
+  auto length = b.size() * sizeof(inet_diag_bc_op);
+  auto remaining = a.size() * sizeof(inet_diag_bc_op);
+  for (size_t i = 0; i < a.size(); i += a[i].yes / sizeof(inet_diag_bc_op)) {
+    auto& op = a[i];
+    if (op.no == remaining + 4) {
+      op.no = static_cast<unsigned short>(op.no + length);
+    }
+    remaining -= op.yes;
+  }
+
+  a.insert(a.end(), b.begin(), b.end());
+  return a;
+}
+
+Bytecode portsBytecode(bool local, const std::set<uint16_t>& ports) {
+  Bytecode bytecode;
+  if (ports.size() <= kSockDiagMaxPorts) {
+    for (const auto& port : ports) {
+      bytecode = bytecodeOr(std::move(bytecode), portEquals(local, port));
+    }
+  }
+  return bytecode;
+}
+
+std::string decodeAddress(int family, const __be32* address) {
+  char buffer[INET6_ADDRSTRLEN] = {0};
+  inet_ntop(family, address, buffer, sizeof(buffer));
+  return buffer;
+}
+
+} // namespace
+
+SockDiag::~SockDiag() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+Status SockDiag::open(const std::string& pid, ino_t net_ns) {
+  if (net_ns == 0) {
+    return Status::failure("Unknown network namespace for pid " + pid);
+  }
+
+  ino_t own_net_ns = 0;
+  procGetNamespaceInode(own_net_ns, "net", kLinuxProcPath + "/self/ns");
+
+  int error = 0;
+  if (net_ns == own_net_ns) {
+    fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    error = errno;
+  } else {
+    auto path = kLinuxProcPath + "/" + pid + "/ns/net";
+    auto ns_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (ns_fd < 0) {
+      return Status::failure("Could not open network namespace of pid " + pid);
+    }
+
+    // Sockets stay in the namespace they were created in. The namespace is
+    // entered by a short-lived thread, so this thread keeps its own.
+    std::thread([this, ns_fd, &error]() {
+      // We call the syscall directly because setns() has been added as a
+      // function from glibc 2.14 and on only.
+      if (syscall(SYS_setns, ns_fd, CLONE_NEWNET) != 0) {
+        error = errno;
+        return;
+      }
+
+      fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+      error = errno;
+    }).join();
+    ::close(ns_fd);
+  }
+
+  if (fd_ < 0) {
+    return Status::failure("Could not open a socket diagnostics socket: " +
+                           std::string(std::strerror(error)));
+  }
+
+  net_ns_ = net_ns;
+  return Status::success();
+}
+
+Status SockDiag::getSocketList(int family,
+                               int protocol,
+                               const SockDiagFilter& filter,
+                               SocketInfoList& result) {
+  if (fd_ < 0) {
+    return Status::failure("The socket diagnostics socket is not open");
+  }
+
+  SocketInfoList sockets;
+  std::string request;
+  std::function<void(const struct nlmsghdr*)> parser;
+
+  if (family == AF_UNIX) {
+    if (protocol != IPPROTO_IP) {
+      return Status::failure("Invalid protocol " + std::to_string(protocol) +
+                             " for AF_UNIX family");
+    }
+
+    struct unix_diag_req req = {};
+    req.sdiag_family = AF_UNIX;
+    req.udiag_states = ~0U;
+    req.udiag_show = UDIAG_SHOW_NAME;
+    appendBytes(request, req);
+
+    parser = [this, &sockets](const struct nlmsghdr* header) {
+      auto msg = static_cast<const unix_diag_msg*>(NLMSG_DATA(header));
+      if (header->nlmsg_len < NLMSG_LENGTH(sizeof(*msg))) {
+        return;
+      }
+
+      SocketInfo socket_info = {};
+      socket_info.socket = std::to_string(msg->udiag_ino);
+      socket_info.net_ns = net_ns_;
+      socket_info.family = AF_UNIX;
+      socket_info.protocol = IPPROTO_IP;
+
+      auto attr = reinterpret_cast<const struct rtattr*>(msg + 1);
+      int length = header->nlmsg_len - NLMSG_LENGTH(sizeof(*msg));
+      for (; RTA_OK(attr, length); attr = RTA_NEXT(attr, length)) {
+        if (attr->rta_type != UNIX_DIAG_NAME) {
+          continue;
+        }
+
+        // Abstract names are shown with '@' for NUL, as in /proc/net/unix.
+        std::string path(static_cast<const char*>(RTA_DATA(attr)),
+                         RTA_PAYLOAD(attr));
+        if (!path.empty() && path[0] == '\0') {
+          std::replace(path.begin(), path.end(), '\0', '@');
+        } else if (path.find('\0') != std::string::npos) {
+          path.erase(path.find('\0'));
+        }
+        socket_info.unix_socket_path = std::move(path);
+      }
+
+      sockets.push_back(std::move(socket_info));
+    };
+  } else {
+    if (family != AF_INET && family != AF_INET6) {
+      return Status::failure("Invalid family " + std::to_string(family));
+    }
+
+    if (protocol != IPPROTO_TCP && protocol != IPPROTO_UDP &&
+        protocol != IPPROTO_UDPLITE) {
+      return Status::failure("Unsupported protocol " +
+                             std::to_string(protocol));
+    }
+
+    struct inet_diag_req_v2 req = {};
+    req.sdiag_family = static_cast<__u8>(family);
+    req.sdiag_protocol = static_cast<__u8>(protocol);
+    req.idiag_states = (protocol == IPPROTO_TCP) ? filter.states : ~0U;
+    appendBytes(request, req);
+
+    auto bytecode =
+        bytecodeAnd(portsBytecode(true, filter.local_ports),
+                    portsBytecode(false, filter.remote_ports));
+    if (!bytecode.empty()) {
+      auto length = bytecode.size() * sizeof(inet_diag_bc_op);
+      struct rtattr attr = {};
+      attr.rta_len = static_cast<unsigned short>(RTA_LENGTH(length));
+      attr.rta_type = INET_DIAG_REQ_BYTECODE;
+      appendBytes(request, attr);
+      request.append(reinterpret_cast<const char*>(bytecode.data()), length);
+    }
+
+    parser = [this, family, protocol, &sockets](
+                 const struct nlmsghdr* header) {
+      auto msg = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+      if (header->nlmsg_len < NLMSG_LENGTH(sizeof(*msg))) {
+        return;
+      }
+
+      SocketInfo socket_info = {};
+      socket_info.socket = std::to_string(msg->idiag_inode);
+      socket_info.net_ns = net_ns_;
+      socket_info.family = family;
+      socket_info.protocol = protocol;
+      socket_info.local_address = decodeAddress(family, msg->id.idiag_src);
+      socket_info.local_port = ntohs(msg->id.idiag_sport);
+      socket_info.remote_address = decodeAddress(family, msg->id.idiag_dst);
+      socket_info.remote_port = ntohs(msg->id.idiag_dport);
+
+      if (protocol == IPPROTO_TCP) {
+        auto state = msg->idiag_state;
+        socket_info.state = (state == 0 || state >= tcp_states.size())
+                                ? "UNKNOWN"
+                                : tcp_states[state];
+      }
+
+      sockets.push_back(std::move(socket_info));
+    };
+  }
+
+  auto status = dump(request, parser);
+  if (!status.ok()) {
+    return status;
+  }
+
+  result.insert(result.end(),
+                std::make_move_iterator(sockets.begin()),
+                std::make_move_iterator(sockets.end()));
+  return Status::success();
+}
+
+Status SockDiag::dump(
+    const std::string& request,
+    const std::function<void(const struct nlmsghdr*)>& parser) {
+  struct nlmsghdr header = {};
+  header.nlmsg_len = NLMSG_LENGTH(request.size());
+  header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  header.nlmsg_seq = ++sequence_;
+
+  std::string message;
+  appendBytes(message, header);
+  message.append(request);
+
+  struct sockaddr_nl kernel = {};
+  kernel.nl_family = AF_NETLINK;
+  if (sendto(fd_,
+             message.data(),
+             message.size(),
+             0,
+             reinterpret_cast<const struct sockaddr*>(&kernel),
+             sizeof(kernel)) < 0) {
+    return Status::failure("Could not send socket diagnostics request: " +
+                           std::string(std::strerror(errno)));
+  }
+
+  std::vector<char> buffer(kSockDiagBufferSize);
+  while (true) {
+    auto bytes = recv(fd_, buffer.data(), buffer.size(), 0);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    } else if (bytes <= 0) {
+      return Status::failure("Could not read socket diagnostics reply: " +
+                             std::string(std::strerror(errno)));
+    }
+
+    auto length = static_cast<int>(bytes);
+    auto reply = reinterpret_cast<const struct nlmsghdr*>(buffer.data());
+    for (; NLMSG_OK(reply, length); reply = NLMSG_NEXT(reply, length)) {
+      if (reply->nlmsg_seq != sequence_) {
+        continue;
+      }
+
+      if (reply->nlmsg_type == NLMSG_ERROR ||
+          reply->nlmsg_type == NLMSG_DONE) {
+        // Both carry an error code, which is 0 for a complete dump.
+        auto error = static_cast<const int*>(NLMSG_DATA(reply));
+        if (reply->nlmsg_len >= NLMSG_LENGTH(sizeof(int)) && *error != 0) {
+          return Status::failure("Socket diagnostics dump failed: " +
+                                 std::string(std::strerror(-*error)));
+        }
+        return Status::success();
+      }
+
+      parser(reply);
+    }
+  }
+}
+
+} // namespace osquery
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include <osquery/filesystem/linux/proc.h>
+#include <osquery/utils/status/status.h>
+
+struct nlmsghdr;
+
+namespace osquery {
+
+/// Kernel-side filters for a socket dump, empty members do not filter.
+struct SockDiagFilter final {
+  /// The TCP states to dump, as a mask of (1 << state).
+  uint32_t states{~0U};
+
+  /// Only dump sockets with one of these local ports.
+  std::set<uint16_t> local_ports;
+
+  /// Only dump sockets with one of these remote ports.
+  std::set<uint16_t> remote_ports;
+};
+
+/**
+ * @brief A NETLINK_SOCK_DIAG socket, used to dump the sockets of a network
+ * namespace.
+ *
+ * The kernel reports sockets as binary messages, and applies the state and
+ * port filters before copying them. This is much cheaper than formatting and
+ * parsing /proc/<pid>/net when there are many sockets.
+ */
+class SockDiag : private boost::noncopyable {
+ public:
+  ~SockDiag();
+
+  /**
+   * @brief Open a socket in the network namespace of a process.
+   *
+   * Entering another network namespace requires CAP_SYS_ADMIN.
+   *
+   * @param pid a process within the namespace.
+   * @param net_ns the inode of the namespace.
+   */
+  Status open(const std::string& pid, ino_t net_ns);
+
+  /**
+   * @brief Add the sockets of a family and protocol to a list.
+   *
+   * The sockets are reported as procGetSocketList would. AF_INET and AF_INET6
+   * support IPPROTO_TCP, IPPROTO_UDP and IPPROTO_UDPLITE. AF_UNIX only
+   * supports IPPROTO_IP, and does not use the filter.
+   *
+   * @return failure if the kernel cannot dump this family and protocol, the
+   * list is unchanged in that case.
+   */
+  Status getSocketList(int family,
+                       int protocol,
+                       const SockDiagFilter& filter,
+                       SocketInfoList& result);
+
+ private:
+  /// Send a dump request and call the parser for each message in the reply.
+  Status dump(const std::string& request,
+              const std::function<void(const struct nlmsghdr*)>& parser);
+
+ private:
+  int fd_{-1};
+
+  ino_t net_ns_{0};
+
+  uint32_t sequence_{0};
+};
+
+} // namespace osquery
@@ -22,7 +22,10 @@ namespace tables {
 QueryData genListeningPorts(QueryContext& context) {
   QueryData results;
 
-  auto sockets = SQL::selectAllFrom("process_open_sockets");
+  // Listening sockets, and UNIX domain sockets, have a remote_port of 0. The
+  // constraint lets the table skip connected sockets when listing them.
+  auto sockets = SQL::selectAllFrom(
+      "process_open_sockets", "remote_port", EQUALS, "0");
 
   for (const auto& socket : sockets) {
     if (socket.at("family") == kAF_UNIX && socket.at("path").empty()) {
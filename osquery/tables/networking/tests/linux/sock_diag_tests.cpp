@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <osquery/tables/networking/linux/sock_diag.h>
+
+namespace osquery {
+
+class SockDiagTests : public testing::Test {
+ protected:
+  void SetUp() override {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd_, 0);
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto addr = reinterpret_cast<struct sockaddr*>(&address);
+    ASSERT_EQ(bind(fd_, addr, sizeof(address)), 0);
+    ASSERT_EQ(listen(fd_, 1), 0);
+
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(getsockname(fd_, addr, &length), 0);
+    port_ = ntohs(address.sin_port);
+
+    ino_t net_ns = 0;
+    ASSERT_TRUE(
+        procGetNamespaceInode(net_ns, "net", kLinuxProcPath + "/self/ns").ok());
+    ASSERT_TRUE(diag_.open(std::to_string(getpid()), net_ns).ok());
+  }
+
+  void TearDown() override {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+ protected:
+  int fd_{-1};
+
+  uint16_t port_{0};
+
+  SockDiag diag_;
+};
+
+TEST_F(SockDiagTests, test_listening_socket) {
+  SockDiagFilter filter;
+  filter.states = 1U << TCP_LISTEN;
+  filter.local_ports = {port_};
+
+  SocketInfoList sockets;
+  ASSERT_TRUE(
+      diag_.getSocketList(AF_INET, IPPROTO_TCP, filter, sockets).ok());
+  ASSERT_EQ(sockets.size(), 1U);
+
+  const auto& socket_info = sockets.front();
+  EXPECT_EQ(socket_info.family, AF_INET);
+  EXPECT_EQ(socket_info.protocol, IPPROTO_TCP);
+  EXPECT_EQ(socket_info.local_address, "127.0.0.1");
+  EXPECT_EQ(socket_info.local_port, port_);
+  EXPECT_EQ(socket_info.remote_port, 0U);
+  EXPECT_EQ(socket_info.state, "LISTEN");
+  EXPECT_NE(socket_info.socket, "0");
+}
+
+TEST_F(SockDiagTests, test_port_filters) {
+  // Any of the local ports matches, and every port filter must match.
+  SockDiagFilter filter;
+  filter.local_ports = {1, port_};
+  filter.remote_ports = {0};
+
+  SocketInfoList sockets;
+  ASSERT_TRUE(
+      diag_.getSocketList(AF_INET, IPPROTO_TCP, filter, sockets).ok());
+  ASSERT_EQ(sockets.size(), 1U);
+  EXPECT_EQ(sockets.front().local_port, port_);
+
+  filter.remote_ports = {1};
+  sockets.clear();
+  ASSERT_TRUE(
+      diag_.getSocketList(AF_INET, IPPROTO_TCP, filter, sockets).ok());
+  EXPECT_TRUE(sockets.empty());
+
+  // The state filter is applied by the kernel as well.
+  filter.remote_ports.clear();
+  filter.states = 1U << TCP_ESTABLISHED;
+  ASSERT_TRUE(
+      diag_.getSocketList(AF_INET, IPPROTO_TCP, filter, sockets).ok());
+  EXPECT_TRUE(sockets.empty());
+}
+
+} // namespace osquery
@@ -16,6 +16,7 @@
 #include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
+#include <osquery/tables/system/package_cache.h>
 #include <osquery/worker/ipc/platform_table_container_ipc.h>
 #include <osquery/worker/logging/glog/glog_logger.h>
 
@@ -204,8 +205,15 @@ QueryData genDebPackages(QueryContext& context) {
   if (hasNamespaceConstraint(context)) {
     return generateInNamespace(context, "deb_packages", genDebPackagesImpl);
   } else {
-    GLOGLogger logger;
-    return genDebPackagesImpl(context, logger);
+    // dpkg rewrites the status file, or journals to updates, on any change.
+    return PackageInventoryCache::get().generate(
+        "deb_packages",
+        "",
+        {kDPKGPath + "/status", kDPKGPath + "/updates"},
+        [&context]() {
+          GLOGLogger logger;
+          return genDebPackagesImpl(context, logger);
+        });
   }
 }
 } // namespace tables
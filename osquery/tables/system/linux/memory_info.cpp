@@ -8,14 +8,13 @@
  */
 
 #include <string>
-
-#include <boost/algorithm/string.hpp>
+#include <string_view>
+#include <vector>
 
 #include <osquery/core/core.h>
 #include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
-#include <osquery/utils/conversions/split.h>
-#include <osquery/utils/conversions/tryto.h>
+#include <osquery/utils/conversions/tokenizer.h>
 
 namespace osquery {
 namespace tables {
@@ -41,16 +40,17 @@ QueryData getMemoryInfo(QueryContext& context) {
   std::string meminfo_content;
   if (forensicReadFile(kMemInfoPath, meminfo_content).ok()) {
     // Able to read meminfo file, now grab info we want
-    for (const auto& line : split(meminfo_content, "\n")) {
-      std::vector<std::string> tokens;
-      boost::split(
-          tokens, line, boost::is_any_of("\t "), boost::token_compress_on);
+    Tokenizer lines(meminfo_content, "\n");
+    std::string_view line;
+    std::vector<std::string_view> tokens;
+    while (lines.next(line)) {
+      splitView(line, "\t ", tokens);
       // Look for mapping
       for (const auto& singleMap : kMemInfoMap) {
         if (line.find(singleMap.second) == 0) {
-          auto const value_exp = tryTo<long>(tokens[1], 10);
-          if (value_exp.isValue()) {
-            r[singleMap.first] = BIGINT(value_exp.get() * 1024l);
+          long value = 0;
+          if (tokens.size() > 1 && parseInteger(tokens[1], value)) {
+            r[singleMap.first] = BIGINT(value * 1024l);
           }
           break;
         }
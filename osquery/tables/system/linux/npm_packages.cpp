@@ -14,6 +14,7 @@
 #include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
+#include <osquery/tables/system/package_cache.h>
 #include <osquery/utils/json/json.h>
 #include <osquery/worker/ipc/platform_table_container_ipc.h>
 #include <osquery/worker/logging/glog/glog_logger.h>
@@ -99,16 +100,19 @@ void genPackageResults(const std::string& directory,
   }
 }
 
-QueryData genNPMPackagesImpl(QueryContext& context, Logger& logger) {
-  QueryData results;
-
+std::set<std::string> getNPMSearchDirectories(QueryContext& context) {
   std::set<std::string> search_directories = {kLinuxNodeModulesPath};
   if (context.constraints.count("directory") > 0 &&
       context.constraints.at("directory").exists(EQUALS)) {
     search_directories = context.constraints["directory"].getAll(EQUALS);
   }
+  return search_directories;
+}
 
-  for (const auto& directory : search_directories) {
+QueryData genNPMPackagesImpl(QueryContext& context, Logger& logger) {
+  QueryData results;
+
+  for (const auto& directory : getNPMSearchDirectories(context)) {
     genPackageResults(directory, results, logger);
   }
 
@@ -119,8 +123,22 @@ QueryData genNPMPackages(QueryContext& context) {
   if (hasNamespaceConstraint(context)) {
     return generateInNamespace(context, "npm_packages", genNPMPackagesImpl);
   } else {
-    GLOGLogger logger;
-    return genNPMPackagesImpl(context, logger);
+    // Installing or removing a package changes its node_modules directory,
+    // a package may also be updated by rewriting its manifest.
+    std::string key;
+    std::vector<std::string> sources;
+    for (const auto& directory : getNPMSearchDirectories(context)) {
+      key += directory + ";";
+      sources.push_back(directory + "/node_modules");
+      sources.push_back(directory + "/node_modules/%/package.json");
+      sources.push_back(directory + "/node_modules/@%/%/package.json");
+    }
+
+    return PackageInventoryCache::get().generate(
+        "npm_packages", key, sources, [&context]() {
+          GLOGLogger logger;
+          return genNPMPackagesImpl(context, logger);
+        });
   }
 }
 } // namespace tables
@@ -10,6 +10,7 @@
 #include <map>
 #include <regex>
 #include <string>
+#include <string_view>
 
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -26,7 +27,7 @@
 #include <osquery/logger/logger.h>
 #include <osquery/sql/dynamic_table_row.h>
 
-#include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tokenizer.h>
 #include <osquery/utils/system/uptime.h>
 
 #include <ctime>
@@ -163,36 +164,37 @@ void genProcessMap(const std::string& pid, QueryData& results) {
 
   std::string content;
   readFile(map, content);
-  for (auto& line : osquery::split(content, "\n")) {
-    auto fields = osquery::split(line, " ");
+
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  std::vector<std::string_view> fields;
+  while (lines.next(line)) {
     // If can't read address, not sure.
-    if (fields.size() < 5) {
+    if (splitView(line, " ", fields) < 5) {
       continue;
     }
 
     Row r;
     r["pid"] = pid;
     if (!fields[0].empty()) {
-      auto addresses = osquery::split(fields[0], "-");
-      if (addresses.size() >= 2) {
-        r["start"] = "0x" + addresses[0];
-        r["end"] = "0x" + addresses[1];
+      std::string_view start, end;
+      if (splitKeyValue(fields[0], '-', start, end)) {
+        r["start"] = "0x" + std::string(start);
+        r["end"] = "0x" + std::string(end);
       } else {
         // Problem with the address format.
         continue;
       }
     }
 
-    r["permissions"] = fields[1];
-    auto offset = tryTo<long long>(fields[2], 16);
-    r["offset"] = BIGINT((offset) ? offset.take() : -1);
-    r["device"] = fields[3];
-    r["inode"] = fields[4];
+    r["permissions"] = std::string(fields[1]);
+    long long offset = 0;
+    r["offset"] = BIGINT(parseInteger(fields[2], offset, 16) ? offset : -1);
+    r["device"] = std::string(fields[3]);
+    r["inode"] = std::string(fields[4]);
 
-    // Path name must be trimmed.
     if (fields.size() > 5) {
-      boost::trim(fields[5]);
-      r["path"] = fields[5];
+      r["path"] = std::string(fields[5]);
     }
 
     // BSS with name in pathname.
@@ -240,8 +242,9 @@ SimpleProcStat::SimpleProcStat(const std::string& pid) {
       return;
     }
 
-    auto details = osquery::split(content.substr(start + 2), " ");
-    if (details.size() <= 19) {
+    std::vector<std::string_view> details;
+    auto view = std::string_view(content).substr(start + 2);
+    if (splitView(view, " ", details) <= 19) {
       status = Status(1, "Invalid /proc/stat content");
       return;
     }
@@ -262,38 +265,39 @@ SimpleProcStat::SimpleProcStat(const std::string& pid) {
     return;
   }
 
-  for (const auto& line : osquery::split(content, "\n")) {
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  std::vector<std::string_view> ids;
+  while (lines.next(line)) {
     // Status lines are formatted: Key: Value....\n.
-    auto detail = osquery::split(line, ':', 1);
-    if (detail.size() != 2) {
+    std::string_view key, value;
+    if (!splitKeyValue(line, ':', key, value)) {
       continue;
     }
 
     // There are specific fields from each detail.
-    if (detail.at(0) == "Name") {
-      this->name = detail.at(1);
-    } else if (detail.at(0) == "VmRSS") {
-      detail[1].erase(detail.at(1).end() - 3, detail.at(1).end());
+    if (key == "Name") {
+      this->name = value;
+    } else if (key == "VmRSS" && value.size() >= 3) {
       // Memory is reported in kB.
-      this->resident_size = detail.at(1) + "000";
-    } else if (detail.at(0) == "VmSize") {
-      detail[1].erase(detail.at(1).end() - 3, detail.at(1).end());
+      value.remove_suffix(3);
+      this->resident_size = std::string(value) + "000";
+    } else if (key == "VmSize" && value.size() >= 3) {
       // Memory is reported in kB.
-      this->total_size = detail.at(1) + "000";
-    } else if (detail.at(0) == "Gid") {
+      value.remove_suffix(3);
+      this->total_size = std::string(value) + "000";
+    } else if (key == "Gid") {
       // Format is: R E - -
-      auto gid_detail = osquery::split(detail.at(1), "\t");
-      if (gid_detail.size() == 4) {
-        this->real_gid = gid_detail.at(0);
-        this->effective_gid = gid_detail.at(1);
-        this->saved_gid = gid_detail.at(2);
+      if (splitView(value, "\t", ids) == 4) {
+        this->real_gid = ids.at(0);
+        this->effective_gid = ids.at(1);
+        this->saved_gid = ids.at(2);
       }
-    } else if (detail.at(0) == "Uid") {
-      auto uid_detail = osquery::split(detail.at(1), "\t");
-      if (uid_detail.size() == 4) {
-        this->real_uid = uid_detail.at(0);
-        this->effective_uid = uid_detail.at(1);
-        this->saved_uid = uid_detail.at(2);
+    } else if (key == "Uid") {
+      if (splitView(value, "\t", ids) == 4) {
+        this->real_uid = ids.at(0);
+        this->effective_uid = ids.at(1);
+        this->saved_uid = ids.at(2);
       }
     }
   }
@@ -322,20 +326,22 @@ SimpleProcIo::SimpleProcIo(const std::string& pid) {
     return;
   }
 
-  for (const auto& line : osquery::split(content, "\n")) {
+  Tokenizer lines(content, "\n");
+  std::string_view line;
+  while (lines.next(line)) {
     // IO lines are formatted: Key: Value....\n.
-    auto detail = osquery::split(line, ':', 1);
-    if (detail.size() != 2) {
+    std::string_view key, value;
+    if (!splitKeyValue(line, ':', key, value)) {
       continue;
     }
 
     // There are specific fields from each detail
-    if (detail.at(0) == "read_bytes") {
-      this->read_bytes = detail.at(1);
-    } else if (detail.at(0) == "write_bytes") {
-      this->write_bytes = detail.at(1);
-    } else if (detail.at(0) == "cancelled_write_bytes") {
-      this->cancelled_write_bytes = detail.at(1);
+    if (key == "read_bytes") {
+      this->read_bytes = value;
+    } else if (key == "write_bytes") {
+      this->write_bytes = value;
+    } else if (key == "cancelled_write_bytes") {
+      this->cancelled_write_bytes = value;
     }
   }
 }
@@ -22,6 +22,7 @@
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
 #include <osquery/sql/dynamic_table_row.h>
+#include <osquery/tables/system/package_cache.h>
 #include <osquery/worker/ipc/platform_table_container_ipc.h>
 #include <osquery/worker/logging/glog/glog_logger.h>
 
@@ -39,6 +40,12 @@ namespace tables {
 // Maximum number of files per RPM.
 #define MAX_RPM_FILES (64 * 1024)
 
+/// Locations of the RPM database, newer distributions use sysimage.
+const std::vector<std::string> kRpmDatabasePaths = {
+    "/var/lib/rpm",
+    "/usr/lib/sysimage/rpm",
+};
+
 /**
  * @brief Return a string representation of the RPM tag type.
  *
@@ -187,8 +194,17 @@ QueryData genRpmPackages(QueryContext& context) {
   if (hasNamespaceConstraint(context)) {
     return generateInNamespace(context, "rpm_packages", genRpmPackagesImpl);
   } else {
-    GLOGLogger logger;
-    return genRpmPackagesImpl(context, logger);
+    // Only the first name is used to select packages.
+    std::string key;
+    if (context.constraints["name"].exists(EQUALS)) {
+      key = "name=" + *context.constraints["name"].getAll(EQUALS).begin();
+    }
+
+    return PackageInventoryCache::get().generate(
+        "rpm_packages", key, kRpmDatabasePaths, [&context]() {
+          GLOGLogger logger;
+          return genRpmPackagesImpl(context, logger);
+        });
   }
 }
 
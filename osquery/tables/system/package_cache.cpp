@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/filesystem.hpp>
+
+#include <osquery/core/flags.h>
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/tables/system/package_cache.h>
+#include <osquery/utils/system/time.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+
+FLAG(bool,
+     package_inventory_cache,
+     true,
+     "Cache package table rows until their databases or directories change");
+
+namespace tables {
+namespace {
+
+/// Maximum number of cached table and constraint combinations.
+const size_t kMaxPackageCacheEntries = 64;
+
+std::string fingerprintPath(const std::string& path) {
+  struct stat file;
+  if (::stat(path.c_str(), &file) != 0) {
+    return "-";
+  }
+
+  // Packages may be changed more than once within a second.
+  uint64_t nsec = 0;
+#if defined(__linux__)
+  nsec = file.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+  nsec = file.st_mtimespec.tv_nsec;
+#endif
+
+  return std::to_string(file.st_dev) + ':' + std::to_string(file.st_ino) +
+         ':' + std::to_string(file.st_mtime) + '.' + std::to_string(nsec) +
+         ':' + std::to_string(file.st_size);
+}
+
+} // namespace
+
+std::string fingerprintPackageSource(const std::string& path) {
+  if (path.find('%') != std::string::npos) {
+    // Manifests are edited in place without changing their directories.
+    std::vector<std::string> files;
+    resolveFilePattern(path, files, GLOB_FILES);
+    std::sort(files.begin(), files.end());
+
+    std::string fingerprint;
+    for (const auto& file : files) {
+      fingerprint += file;
+      fingerprint += '=';
+      fingerprint += fingerprintPath(file);
+      fingerprint += '\n';
+    }
+    return fingerprint;
+  }
+
+  auto fingerprint = fingerprintPath(path);
+
+  boost::system::error_code ec;
+  if (!fs::is_directory(path, ec)) {
+    return fingerprint;
+  }
+
+  // An updated package may replace a file without changing the directory.
+  std::vector<fs::path> entries;
+  for (fs::directory_iterator it(path, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    entries.push_back(it->path());
+  }
+  std::sort(entries.begin(), entries.end());
+
+  for (const auto& entry : entries) {
+    fingerprint += '\n';
+    fingerprint += entry.filename().string();
+    fingerprint += '=';
+    fingerprint += fingerprintPath(entry.string());
+  }
+  return fingerprint;
+}
+
+PackageInventoryCache& PackageInventoryCache::get() {
+  static PackageInventoryCache cache;
+  return cache;
+}
+
+QueryData PackageInventoryCache::generate(
+    const std::string& table,
+    const std::string& key,
+    const std::vector<std::string>& sources,
+    const Generator& generate) {
+  if (!FLAGS_package_inventory_cache) {
+    return generate();
+  }
+
+  std::vector<std::string> fingerprints;
+  fingerprints.reserve(sources.size());
+  for (const auto& source : sources) {
+    fingerprints.push_back(fingerprintPackageSource(source));
+  }
+
+  auto id = std::make_pair(table, key);
+  std::shared_ptr<const QueryData> cached;
+  {
+    WriteLock lock(mutex_);
+    auto entry = entries_.find(id);
+    if (entry != entries_.end()) {
+      if (entry->second.sources == sources &&
+          entry->second.fingerprints == fingerprints) {
+        entry->second.hits++;
+        cached = entry->second.rows;
+      } else {
+        entry->second.misses++;
+      }
+    }
+  }
+
+  if (cached != nullptr) {
+    return *cached;
+  }
+
+  auto results = generate();
+  auto rows = std::make_shared<const QueryData>(results);
+
+  WriteLock lock(mutex_);
+  auto entry = entries_.find(id);
+  if (entry == entries_.end()) {
+    if (entries_.size() >= kMaxPackageCacheEntries) {
+      // Forget the rows generated the longest time ago.
+      entries_.erase(std::min_element(
+          entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+            return a.second.generated < b.second.generated;
+          }));
+    }
+    entry = entries_.emplace(id, Entry()).first;
+    entry->second.misses++;
+  }
+
+  entry->second.sources = sources;
+  entry->second.fingerprints = std::move(fingerprints);
+  entry->second.rows = std::move(rows);
+  entry->second.generated = getUnixTime();
+  return results;
+}
+
+std::vector<PackageCacheStatus> PackageInventoryCache::status() const {
+  std::vector<PackageCacheStatus> status;
+  std::vector<std::vector<std::string>> fingerprints;
+  {
+    ReadLock lock(mutex_);
+    for (const auto& entry : entries_) {
+      PackageCacheStatus item;
+      item.table = entry.first.first;
+      item.key = entry.first.second;
+      item.sources = entry.second.sources;
+      item.rows = entry.second.rows->size();
+      item.hits = entry.second.hits;
+      item.misses = entry.second.misses;
+      item.generated = entry.second.generated;
+      status.push_back(std::move(item));
+      fingerprints.push_back(entry.second.fingerprints);
+    }
+  }
+
+  // Fingerprint the sources without holding the lock.
+  for (size_t i = 0; i < status.size(); i++) {
+    status[i].valid = true;
+    for (size_t j = 0; j < status[i].sources.size(); j++) {
+      if (fingerprintPackageSource(status[i].sources[j]) !=
+          fingerprints[i][j]) {
+        status[i].valid = false;
+        break;
+      }
+    }
+  }
+  return status;
+}
+
+void PackageInventoryCache::clear() {
+  WriteLock lock(mutex_);
+  entries_.clear();
+}
+
+QueryData genPackageInventoryCache(QueryContext& context) {
+  QueryData results;
+  for (const auto& entry : PackageInventoryCache::get().status()) {
+    Row r;
+    r["table_name"] = entry.table;
+    r["key"] = entry.key;
+    r["sources"] = boost::algorithm::join(entry.sources, ",");
+    r["rows"] = BIGINT(entry.rows);
+    r["valid"] = INTEGER(entry.valid ? 1 : 0);
+    r["hits"] = BIGINT(entry.hits);
+    r["misses"] = BIGINT(entry.misses);
+    r["generated_time"] = BIGINT(entry.generated);
+    results.push_back(std::move(r));
+  }
+  return results;
+}
+
+} // namespace tables
+} // namespace osquery
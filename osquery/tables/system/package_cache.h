@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <osquery/core/tables.h>
+#include <osquery/utils/mutex.h>
+
+namespace osquery {
+namespace tables {
+
+/**
+ * @brief Fingerprint a package source by its device, inode, mtime, and size.
+ *
+ * A directory also includes the fingerprint of each entry it contains, so
+ * packages added, removed, or replaced within it change the fingerprint.
+ * A missing source has a fingerprint too, so creating it is a change.
+ *
+ * A source with a '%' wildcard is resolved with resolveFilePattern and
+ * includes the fingerprint of each matching file. Use these for the manifests
+ * a generator reads, which may be rewritten without changing any directory.
+ */
+std::string fingerprintPackageSource(const std::string& path);
+
+/// The state of the cached rows for a package table and its constraints.
+struct PackageCacheStatus {
+  std::string table;
+
+  /// The constraints the rows were generated for, empty for all rows.
+  std::string key;
+
+  /// The package databases and directories the rows were read from.
+  std::vector<std::string> sources;
+
+  size_t rows{0};
+
+  /// True if no source changed since the rows were generated.
+  bool valid{false};
+
+  uint64_t hits{0};
+  uint64_t misses{0};
+
+  /// Unix time when the rows were generated.
+  uint64_t generated{0};
+};
+
+/**
+ * @brief A cache of package table rows, kept until their sources change.
+ *
+ * Package databases and manifests change rarely, but reading them is among
+ * the most expensive table generation. Instead of expiring the rows after
+ * an interval, each entry keeps the fingerprints of the sources it was
+ * generated from and is regenerated as soon as any of them changes.
+ */
+class PackageInventoryCache : private boost::noncopyable {
+ public:
+  using Generator = std::function<QueryData()>;
+
+  static PackageInventoryCache& get();
+
+  /**
+   * @brief Get the cached rows, or generate them if a source changed.
+   *
+   * The sources are fingerprinted before generating, so a change made while
+   * generating is detected by the next request.
+   *
+   * @param table The package table name.
+   * @param key The constraints that select the rows, empty for all rows.
+   * @param sources The paths or patterns the generator reads packages from.
+   * @param generate Called on a cache miss.
+   */
+  QueryData generate(const std::string& table,
+                     const std::string& key,
+                     const std::vector<std::string>& sources,
+                     const Generator& generate);
+
+  /// The state of each entry, checking if its sources changed.
+  std::vector<PackageCacheStatus> status() const;
+
+  /// Remove all entries.
+  void clear();
+
+ private:
+  PackageInventoryCache() = default;
+
+  struct Entry {
+    std::vector<std::string> sources;
+    std::vector<std::string> fingerprints;
+
+    /// Shared so the rows are copied without holding the lock.
+    std::shared_ptr<const QueryData> rows;
+
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t generated{0};
+  };
+
+  /// Table name and key to the cached rows.
+  std::map<std::pair<std::string, std::string>, Entry> entries_;
+
+  mutable Mutex mutex_;
+};
+
+} // namespace tables
+} // namespace osquery
@@ -15,6 +15,7 @@
 #include <osquery/core/tables.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/logger/logger.h>
+#include <osquery/tables/system/package_cache.h>
 #include <osquery/utils/conversions/split.h>
 #include <osquery/utils/info/platform_type.h>
 
@@ -121,8 +122,7 @@ void genWinPythonPackages(const std::string& keyGlob, QueryData& results) {
 #endif
 }
 
-QueryData genPythonPackages(QueryContext& context) {
-  QueryData results;
+std::vector<std::string> getPythonSiteDirectories(QueryContext& context) {
   std::set<std::string> paths;
   if (context.constraints.count("directory") > 0 &&
       context.constraints.at("directory").exists(EQUALS)) {
@@ -136,9 +136,7 @@ QueryData genPythonPackages(QueryContext& context) {
       }
     }
   }
-  for (const auto& key : paths) {
-    genSiteDirectories(key, results);
-  }
+  std::vector<std::string> sites(paths.begin(), paths.end());
 
   if (isPlatform(PlatformType::TYPE_OSX)) {
     for (const auto& dir : kDarwinPythonPath) {
@@ -156,10 +154,22 @@ QueryData genPythonPackages(QueryContext& context) {
 
         auto complete = version + "lib/python" +
                         version_path.filename().string() + "/site-packages";
-        genSiteDirectories(complete, results);
+        sites.push_back(complete);
       }
     }
-  } else if (isPlatform(PlatformType::TYPE_WINDOWS)) {
+  }
+  return sites;
+}
+
+QueryData genPythonPackages(QueryContext& context) {
+  QueryData results;
+  auto sites = getPythonSiteDirectories(context);
+
+  if (isPlatform(PlatformType::TYPE_WINDOWS)) {
+    for (const auto& site : sites) {
+      genSiteDirectories(site, results);
+    }
+
     // Enumerate any system installed python packages
     auto installPathKey = "HKEY_LOCAL_MACHINE\\" + kWinPythonInstallKey;
     genWinPythonPackages(installPathKey, results);
@@ -167,9 +177,29 @@ QueryData genPythonPackages(QueryContext& context) {
     // Enumerate any user installed python packages
     installPathKey = "HKEY_USERS\\%\\" + kWinPythonInstallKey;
     genWinPythonPackages(installPathKey, results);
+    return results;
   }
 
-  return results;
+  // Installing, upgrading, or removing a package replaces its metadata
+  // directory within the site directory, the metadata file itself may also
+  // be rewritten.
+  std::string key;
+  std::vector<std::string> sources;
+  for (const auto& site : sites) {
+    key += site + ";";
+    sources.push_back(site);
+    sources.push_back(site + "/%.dist-info/METADATA");
+    sources.push_back(site + "/%.egg-info/PKG-INFO");
+  }
+
+  return PackageInventoryCache::get().generate(
+      "python_packages", key, sources, [&sites]() {
+        QueryData rows;
+        for (const auto& site : sites) {
+          genSiteDirectories(site, rows);
+        }
+        return rows;
+      });
 }
 } // namespace tables
 } // namespace osquery
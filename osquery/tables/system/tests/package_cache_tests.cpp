@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/tables/system/package_cache.h>
+
+namespace fs = boost::filesystem;
+
+namespace osquery {
+
+DECLARE_bool(package_inventory_cache);
+
+namespace tables {
+
+class PackageCacheTests : public testing::Test {
+ protected:
+  void SetUp() override {
+    cache_backup_ = FLAGS_package_inventory_cache;
+    FLAGS_package_inventory_cache = true;
+
+    root_ = fs::temp_directory_path() /
+            fs::unique_path("osquery.tests.package_cache.%%%%.%%%%");
+    fs::create_directories(root_ / "site");
+    database_ = (root_ / "status").string();
+    site_ = (root_ / "site").string();
+    writeTextFile(database_, "Package: one\n");
+  }
+
+  void TearDown() override {
+    PackageInventoryCache::get().clear();
+    fs::remove_all(root_);
+    FLAGS_package_inventory_cache = cache_backup_;
+  }
+
+  /// Generate through the cache, counting calls to the generator.
+  QueryData generate(const std::string& key = "") {
+    return PackageInventoryCache::get().generate(
+        "test_packages", key, {database_, site_}, [this]() {
+          generated_++;
+          return QueryData{{{"name", std::to_string(generated_)}}};
+        });
+  }
+
+  bool cache_backup_{true};
+  fs::path root_;
+  std::string database_;
+  std::string site_;
+  size_t generated_{0};
+};
+
+TEST_F(PackageCacheTests, test_unchanged_sources) {
+  auto first = generate();
+  auto second = generate();
+  EXPECT_EQ(generated_, 1U);
+  EXPECT_EQ(second, first);
+
+  // Each key is cached separately.
+  generate("name=one");
+  EXPECT_EQ(generated_, 2U);
+
+  auto status = PackageInventoryCache::get().status();
+  ASSERT_EQ(status.size(), 2U);
+  EXPECT_EQ(status[0].table, "test_packages");
+  EXPECT_EQ(status[0].key, "");
+  EXPECT_EQ(status[0].rows, 1U);
+  EXPECT_EQ(status[0].hits, 1U);
+  EXPECT_EQ(status[0].misses, 1U);
+  EXPECT_TRUE(status[0].valid);
+}
+
+TEST_F(PackageCacheTests, test_changed_sources) {
+  generate();
+
+  // A rewritten database changes its inode, mtime, or size.
+  writeTextFile(database_, "Package: one\n\nPackage: two\n");
+  EXPECT_FALSE(PackageInventoryCache::get().status()[0].valid);
+  generate();
+  EXPECT_EQ(generated_, 2U);
+  EXPECT_TRUE(PackageInventoryCache::get().status()[0].valid);
+
+  // A package added to a directory.
+  fs::create_directory(root_ / "site" / "two-1.0.dist-info");
+  generate();
+  EXPECT_EQ(generated_, 3U);
+
+  // A package replaced within a directory.
+  writeTextFile((root_ / "site" / "three.egg-info").string(), "");
+  generate();
+  EXPECT_EQ(generated_, 4U);
+  fs::remove(root_ / "site" / "three.egg-info");
+  writeTextFile((root_ / "site" / "three.egg-info").string(), "Name: 3");
+  generate();
+  EXPECT_EQ(generated_, 5U);
+
+  // A missing source that is created.
+  fs::remove(database_);
+  generate();
+  generate();
+  EXPECT_EQ(generated_, 6U);
+  writeTextFile(database_, "");
+  generate();
+  EXPECT_EQ(generated_, 7U);
+
+  auto status = PackageInventoryCache::get().status();
+  ASSERT_EQ(status.size(), 1U);
+  EXPECT_EQ(status[0].hits, 1U);
+  EXPECT_EQ(status[0].misses, 7U);
+}
+
+TEST_F(PackageCacheTests, test_changed_manifests) {
+  auto modules = root_ / "node_modules";
+  fs::create_directories(modules / "one");
+  fs::create_directories(modules / "@scope" / "two");
+  writeTextFile((modules / "one" / "package.json").string(), "{}");
+  writeTextFile((modules / "@scope" / "two" / "package.json").string(), "{}");
+
+  std::vector<std::string> sources = {
+      modules.string(),
+      (modules / "%" / "package.json").string(),
+      (modules / "@%" / "%" / "package.json").string(),
+  };
+  auto generate = [this, &sources]() {
+    PackageInventoryCache::get().generate(
+        "test_manifests", "", sources, [this]() {
+          generated_++;
+          return QueryData{};
+        });
+  };
+
+  generate();
+  generate();
+  EXPECT_EQ(generated_, 1U);
+
+  // A manifest rewritten in place does not change the node_modules entries.
+  writeTextFile((modules / "one" / "package.json").string(), "{\"a\": 1}");
+  generate();
+  EXPECT_EQ(generated_, 2U);
+
+  // Nor does a manifest of a scoped package.
+  writeTextFile((modules / "@scope" / "two" / "package.json").string(),
+                "{\"a\": 1}");
+  generate();
+  EXPECT_EQ(generated_, 3U);
+
+  // Or a package added to a scope.
+  fs::create_directories(modules / "@scope" / "three");
+  writeTextFile((modules / "@scope" / "three" / "package.json").string(), "");
+  generate();
+  EXPECT_EQ(generated_, 4U);
+  generate();
+  EXPECT_EQ(generated_, 4U);
+}
+
+TEST_F(PackageCacheTests, test_disabled) {
+  FLAGS_package_inventory_cache = false;
+  generate();
+  generate();
+  EXPECT_EQ(generated_, 2U);
+  EXPECT_TRUE(PackageInventoryCache::get().status().empty());
+}
+
+} // namespace tables
+} // namespace osquery
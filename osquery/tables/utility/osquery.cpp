@@ -12,6 +12,7 @@
 #include <osquery/core/core.h>
 #include <osquery/core/flags.h>
 #include <osquery/core/system.h>
+#include <osquery/core/table_cache.h>
 #include <osquery/core/tables.h>
 #include <osquery/events/eventfactory.h>
 #include <osquery/events/eventpublisher.h>
@@ -22,6 +23,7 @@
 #include <osquery/process/process.h>
 #include <osquery/registry/registry.h>
 #include <osquery/sql/sql.h>
+#include <osquery/sql/sqlite_util.h>
 #include <osquery/utils/info/platform_type.h>
 #include <osquery/utils/info/version.h>
 #include <osquery/utils/macros/macros.h>
@@ -220,6 +222,8 @@ QueryData genOsqueryInfo(QueryContext& context) {
     r["watcher"] = "-1";
   }
   r["platform_mask"] = INTEGER(static_cast<uint64_t>(kPlatformType));
+  r["coalesced_generations"] =
+      BIGINT(TableSingleFlight::get().stats().coalesced);
 
   std::string uuid;
   r["uuid"] = (getHostUUID(uuid)) ? uuid : "";
@@ -244,10 +248,12 @@ QueryData genOsquerySchedule(QueryContext& context) {
         // Set default (0) values for each query if it has not yet executed.
         r["executions"] = "0";
         r["wall_time"] = "0";
+        r["wall_time_ms"] = "0";
         r["user_time"] = "0";
         r["system_time"] = "0";
         r["average_memory"] = "0";
         r["last_executed"] = "0";
+        r["output_rows"] = "0";
 
         // Report optional performance information.
         Config::get().getPerformanceStats(
@@ -255,9 +261,11 @@ QueryData genOsquerySchedule(QueryContext& context) {
               r["executions"] = BIGINT(perf.executions);
               r["last_executed"] = BIGINT(perf.last_executed);
               r["wall_time"] = BIGINT(perf.wall_time);
+              r["wall_time_ms"] = BIGINT(perf.wall_time_ms);
               r["user_time"] = BIGINT(perf.user_time);
               r["system_time"] = BIGINT(perf.system_time);
               r["average_memory"] = BIGINT(perf.average_memory);
+              r["output_rows"] = BIGINT(perf.output_rows);
             });
 
         results.push_back(r);
@@ -265,5 +273,37 @@ QueryData genOsquerySchedule(QueryContext& context) {
       true);
   return results;
 }
+
+QueryData genOsqueryStatementCache(QueryContext& context) {
+  auto stats = SQLiteDBManager::getStatementCacheStats();
+
+  Row r;
+  r["statements"] = INTEGER(stats.statements);
+  r["capacity"] = INTEGER(stats.capacity);
+  r["hits"] = BIGINT(stats.hits);
+  r["misses"] = BIGINT(stats.misses);
+  auto lookups = stats.hits + stats.misses;
+  r["hit_rate"] =
+      DOUBLE((lookups > 0) ? static_cast<double>(stats.hits) / lookups : 0);
+  r["prepare_time_saved"] = BIGINT(stats.prepare_time_saved);
+  r["memory_used"] = BIGINT(stats.memory_used);
+  return {r};
+}
+
+QueryData genOsqueryTableCache(QueryContext& context) {
+  QueryData results;
+  for (const auto& stats : TableResultCache::get().stats()) {
+    Row r;
+    r["name"] = stats.table;
+    r["entries"] = INTEGER(stats.entries);
+    r["rows"] = BIGINT(stats.rows);
+    r["hits"] = BIGINT(stats.hits);
+    r["misses"] = BIGINT(stats.misses);
+    r["evictions"] = BIGINT(stats.evictions);
+    r["memory_used"] = BIGINT(stats.memory_used);
+    results.push_back(std::move(r));
+  }
+  return results;
+}
 } // namespace tables
 } // namespace osquery
@@ -9,6 +9,7 @@
 
 #include <gtest/gtest.h>
 
+#include <osquery/core/flags.h>
 #include <osquery/filesystem/filesystem.h>
 #include <osquery/tables/yara/yara_utils.h>
 
@@ -20,6 +21,8 @@ namespace fs = boost::filesystem;
 
 namespace osquery {
 
+DECLARE_string(yara_rules_cache_path);
+
 const std::string alwaysTrue = "rule always_true { condition: true }";
 const std::string alwaysFalse = "rule always_false { condition: false }";
 
@@ -142,4 +145,99 @@ TEST_F(YARATest, test_match_string_false) {
   EXPECT_TRUE(r["count"] == "0");
 }
 
+TEST_F(YARATest, test_compiled_rules_cache) {
+  EXPECT_EQ(yr_initialize(), ERROR_SUCCESS);
+
+  auto cache_backup = FLAGS_yara_rules_cache_path;
+  const auto cache_dir = fs::temp_directory_path() /
+                         fs::unique_path("osquery.tests.yara.%%%%.%%%%");
+  FLAGS_yara_rules_cache_path = cache_dir.string();
+
+  const auto rule_file = fs::temp_directory_path() /
+                         fs::unique_path("osquery.tests.yara.%%%%.%%%%.sig");
+  writeTextFile(rule_file.string(), alwaysTrue);
+
+  // The first compile writes the rules to the cache, keyed by content.
+  YR_RULES* rules = nullptr;
+  EXPECT_TRUE(compileSingleFile(rule_file.string(), &rules).ok());
+  ASSERT_NE(rules, nullptr);
+  yr_rules_destroy(rules);
+
+  std::vector<std::string> cached;
+  listFilesInDirectory(cache_dir, cached);
+  ASSERT_EQ(cached.size(), 1U);
+  const auto true_cache = cached[0];
+
+  // The second compile loads the cached rules.
+  rules = nullptr;
+  EXPECT_TRUE(compileSingleFile(rule_file.string(), &rules).ok());
+  ASSERT_NE(rules, nullptr);
+  yr_rules_destroy(rules);
+
+  // Changing the content compiles and caches new rules.
+  writeTextFile(rule_file.string(), alwaysFalse);
+  rules = nullptr;
+  EXPECT_TRUE(compileSingleFile(rule_file.string(), &rules).ok());
+  ASSERT_NE(rules, nullptr);
+  yr_rules_destroy(rules);
+
+  cached.clear();
+  listFilesInDirectory(cache_dir, cached);
+  ASSERT_EQ(cached.size(), 2U);
+  const auto false_cache = (cached[0] == true_cache) ? cached[1] : cached[0];
+
+  // Cached rules compiled from other sources are not used, and are replaced.
+  boost::system::error_code ec;
+  fs::rename(false_cache, true_cache, ec);
+  ASSERT_FALSE(ec);
+  writeTextFile(rule_file.string(), alwaysTrue);
+  rules = nullptr;
+  EXPECT_TRUE(compileSingleFile(rule_file.string(), &rules).ok());
+  ASSERT_NE(rules, nullptr);
+  yr_rules_destroy(rules);
+
+  std::string content;
+  ASSERT_TRUE(readFile(true_cache, content).ok());
+  auto key = fs::path(true_cache).stem().string();
+  EXPECT_EQ(content.substr(0, key.size()), key);
+
+  // Only an include directive at the start of a line prevents caching.
+  writeTextFile(rule_file.string(),
+                "rule includes { strings: $a = \"include\" condition: $a }");
+  rules = nullptr;
+  EXPECT_TRUE(compileSingleFile(rule_file.string(), &rules).ok());
+  ASSERT_NE(rules, nullptr);
+  yr_rules_destroy(rules);
+
+  cached.clear();
+  listFilesInDirectory(cache_dir, cached);
+  EXPECT_EQ(cached.size(), 2U);
+
+  FLAGS_yara_rules_cache_path = cache_backup;
+  fs::remove_all(rule_file);
+  fs::remove_all(cache_dir);
+}
+
+TEST_F(YARATest, test_clean_scan) {
+  struct stat sb {};
+  sb.st_ino = 1;
+  sb.st_size = 5;
+  sb.st_mtime = 10;
+
+  EXPECT_FALSE(yaraIsCleanScan("group", "/bin/ls", sb));
+  yaraSetCleanScan("group", "/bin/ls", sb);
+  EXPECT_TRUE(yaraIsCleanScan("group", "/bin/ls", sb));
+
+  // Other rules have not scanned the file.
+  EXPECT_FALSE(yaraIsCleanScan("other", "/bin/ls", sb));
+
+  // A modified file is scanned again.
+  sb.st_mtime = 11;
+  EXPECT_FALSE(yaraIsCleanScan("group", "/bin/ls", sb));
+
+  yaraClearCleanScans();
+  sb.st_mtime = 10;
+  EXPECT_FALSE(yaraIsCleanScan("group", "/bin/ls", sb));
+}
+
 } // namespace osquery
@@ -12,6 +12,9 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <regex>
 #include <thread>
 
@@ -54,6 +57,16 @@ FLAG(uint32,
      "Time in ms to sleep after scan of each file (default 50) to reduce "
      "memory spikes");
 
+FLAG(uint32,
+     yara_scan_threads,
+     4,
+     "Maximum number of threads scanning files for the yara table");
+
+FLAG(bool,
+     yara_skip_unchanged,
+     false,
+     "Skip files unchanged since a yara table scan without matches");
+
 HIDDEN_FLAG(bool,
             enable_yara_string,
             false,
@@ -62,6 +75,9 @@ HIDDEN_FLAG(bool,
 
 namespace tables {
 
+/// YARA limits the number of threads concurrently scanning with a rule set.
+const size_t kMaxYaraScanThreads{16};
+
 using YaraRuleSet = std::set<std::string>;
 
 typedef enum { YC_NONE = 0, YC_GROUP, YC_FILE, YC_RULE, YC_URL } YaraRuleType;
@@ -155,9 +171,7 @@ Status getRuleFromURL(const std::string& url, std::string& rule) {
   return Status::success();
 }
 
-void doYARAScan(YR_RULES* rules,
-                const std::string& path,
-                QueryData& results,
+Row initYARARow(const std::string& path,
                 YaraRuleType yr_type,
                 const std::string& sigfile) {
   Row row;
@@ -191,12 +205,110 @@ void doYARAScan(YR_RULES* rules,
     break;
   }
 
-  // Perform the scan, using the static YARA subscriber callback.
-  int result = yr_rules_scan_file(
-      rules, path.c_str(), SCAN_FLAGS_FAST_MODE, YARACallback, (void*)&row, 0);
+  return row;
+}
+
+/// A set of compiled rules to scan every path with.
+struct YaraScanRules {
+  YaraRuleType type;
+  std::string sign;
+  std::string key;
+  YR_RULES* rules;
+};
+
+void doYARAScan(const YaraScanRules& scan_rules,
+                const std::string& path,
+                QueryData& results) {
+  auto row = initYARARow(path, scan_rules.type, scan_rules.sign);
+
+  // Rules from URLs may change between queries, they are always scanned.
+  struct stat sb;
+  bool cacheable = FLAGS_yara_skip_unchanged && scan_rules.type != YC_URL &&
+                   stat(path.c_str(), &sb) == 0;
+  if (cacheable && yaraIsCleanScan(scan_rules.key, path, sb)) {
+    results.push_back(std::move(row));
+    return;
+  }
+
+  // Perform the scan, using the static YARA subscriber callback. YARA maps
+  // the file into memory and the rules are shared, read-only, by all threads.
+  int result = yr_rules_scan_file(scan_rules.rules,
+                                  path.c_str(),
+                                  SCAN_FLAGS_FAST_MODE,
+                                  YARACallback,
+                                  (void*)&row,
+                                  0);
   if (result == ERROR_SUCCESS) {
+    if (cacheable && row["count"] == INTEGER(0)) {
+      yaraSetCleanScan(scan_rules.key, path, sb);
+    }
     results.push_back(std::move(row));
   }
+
+  // sleep between each file to help smooth out malloc spikes
+  std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_yara_delay));
+}
+
+/**
+ * Scan every path with every set of rules, using a bounded pool of threads.
+ *
+ * Rows are returned in path order, then rule order, as a serial scan would.
+ */
+void doYARAScans(const std::vector<YaraScanRules>& scan_rules,
+                 const std::set<std::string>& paths,
+                 QueryData& results) {
+  std::vector<std::string> path_list(paths.begin(), paths.end());
+  auto scan_count = path_list.size() * scan_rules.size();
+  if (scan_count == 0) {
+    return;
+  }
+
+  // Rows are kept with their scan index, which orders them by path.
+  using ScanRow = std::pair<size_t, Row>;
+  std::vector<ScanRow> scanned;
+
+  std::atomic<size_t> next_scan{0};
+  std::mutex results_mutex;
+  auto worker = [&]() {
+    std::vector<ScanRow> worker_results;
+    QueryData rows;
+    for (auto i = next_scan++; i < scan_count; i = next_scan++) {
+      doYARAScan(scan_rules[i % scan_rules.size()],
+                 path_list[i / scan_rules.size()],
+                 rows);
+      for (auto& row : rows) {
+        worker_results.emplace_back(i, std::move(row));
+      }
+      rows.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(results_mutex);
+    std::move(worker_results.begin(),
+              worker_results.end(),
+              std::back_inserter(scanned));
+  };
+
+  auto thread_count = std::max<size_t>(FLAGS_yara_scan_threads, 1);
+  thread_count = std::min({thread_count, kMaxYaraScanThreads, scan_count});
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::sort(scanned.begin(),
+            scanned.end(),
+            [](const ScanRow& a, const ScanRow& b) {
+              return a.first < b.first;
+            });
+  results.reserve(results.size() + scanned.size());
+  for (auto& row : scanned) {
+    results.push_back(std::move(row.second));
+  }
 }
 
 Status getYaraRules(YARAConfigParser parser,
@@ -363,24 +475,20 @@ QueryData genYara(QueryContext& context) {
         return status;
       }));
 
-  // Scan every path pair with the yara rules
+  // Resolve the compiled rules once, the scan threads only read them.
   auto& rules = yaraParser->rules();
-  for (const auto& path : paths) {
-    for (const auto& sign : scanContext) {
-      if (rules.count(hashStr(sign.second, sign.first)) > 0) {
-        doYARAScan(rules[hashStr(sign.second, sign.first)],
-                   path.c_str(),
-                   results,
-                   sign.first,
-                   sign.second);
-
-        // sleep between each file to help smooth out malloc spikes
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(FLAGS_yara_delay));
-      }
+  std::vector<YaraScanRules> scan_rules;
+  for (const auto& sign : scanContext) {
+    auto key = hashStr(sign.second, sign.first);
+    auto it = rules.find(key);
+    if (it != rules.end()) {
+      scan_rules.push_back({sign.first, sign.second, key, it->second});
     }
   }
 
+  // Scan every path pair with the yara rules
+  doYARAScans(scan_rules, paths, results);
+
   // Rule string is hashed before adding to the cache. There are
   // possibilities of collision when arbitrary queries are executed
   // with distributed API. Clear the hash string from the cache
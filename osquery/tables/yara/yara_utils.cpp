@@ -7,20 +7,287 @@
  * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <ctime>
 #include <map>
 #include <string>
+#include <unordered_map>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include <boost/filesystem.hpp>
 
 #include <osquery/config/config.h>
+#include <osquery/core/flags.h>
+#include <osquery/filesystem/filesystem.h>
+#include <osquery/hashing/hashing.h>
 #include <osquery/logger/logger.h>
 #include <osquery/registry/registry_factory.h>
 #include <osquery/tables/yara/yara_utils.h>
+#include <osquery/utils/mutex.h>
 
 #include <osquery/remote/uri.h>
 
+namespace fs = boost::filesystem;
+
 namespace osquery {
 
+FLAG(string,
+     yara_rules_cache_path,
+     OSQUERY_DB_HOME "yara/",
+     "Directory of compiled YARA rule files keyed by source content (empty "
+     "disables)");
+
 DECLARE_bool(enable_yara_string);
 
+namespace {
+
+/// Maximum number of compiled rule files kept in the cache directory.
+const size_t kMaxCachedRules{64};
+
+/// Maximum number of remembered clean scans before the set is reset.
+const size_t kMaxCleanScans{256 * 1024};
+
+/// The file identity at the time of a scan without matches.
+struct YaraCleanScan {
+  std::uint64_t device;
+  std::uint64_t inode;
+  std::uint64_t size;
+  std::uint64_t mtime;
+  std::uint64_t ctime;
+};
+
+Mutex kCleanScansMutex;
+std::unordered_map<std::string, YaraCleanScan> kCleanScans;
+
+std::string cleanScanKey(const std::string& rules_key,
+                         const std::string& path) {
+  return rules_key + '\0' + path;
+}
+
+/**
+ * Sources with include directives depend on files outside of the hash.
+ *
+ * A directive is the 'include' keyword at the start of a line, followed by
+ * whitespace or the quoted path.
+ */
+bool isCacheableSource(const std::string& content) {
+  static const std::string kInclude = "include";
+
+  size_t line = 0;
+  while (line < content.size()) {
+    auto start = content.find_first_not_of(" \t", line);
+    if (start != std::string::npos &&
+        content.compare(start, kInclude.size(), kInclude) == 0) {
+      auto next = start + kInclude.size();
+      if (next < content.size() &&
+          (content[next] == '"' ||
+           std::isspace(static_cast<unsigned char>(content[next])))) {
+        return false;
+      }
+    }
+
+    line = content.find('\n', line);
+    if (line == std::string::npos) {
+      break;
+    }
+    line++;
+  }
+  return true;
+}
+
+/**
+ * Hash the YARA version and each (path, content) rule source.
+ */
+std::string hashRuleSources(
+    const std::vector<std::pair<std::string, std::string>>& sources) {
+  std::string buffer = YR_VERSION;
+  for (const auto& source : sources) {
+    buffer.push_back('\0');
+    buffer += source.first;
+    buffer.push_back('\0');
+    buffer += source.second;
+  }
+  return hashFromBuffer(HASH_TYPE_SHA256, buffer.data(), buffer.size());
+}
+
+fs::path cachedRulesPath(const std::string& key) {
+  return fs::path(FLAGS_yara_rules_cache_path) / (key + ".yarc");
+}
+
+size_t readRulesStream(void* ptr, size_t size, size_t count, void* file) {
+  return std::fread(ptr, size, count, static_cast<FILE*>(file));
+}
+
+size_t writeRulesStream(const void* ptr,
+                        size_t size,
+                        size_t count,
+                        void* file) {
+  return std::fwrite(ptr, size, count, static_cast<FILE*>(file));
+}
+
+/**
+ * Load compiled rules from the cache.
+ *
+ * A cached file starts with the hash of the sources it was compiled from,
+ * followed by the rules saved by yr_rules_save_stream. It is only used if
+ * that hash is the key.
+ */
+bool loadCachedRules(const std::string& key, YR_RULES** rules) {
+  if (FLAGS_yara_rules_cache_path.empty()) {
+    return false;
+  }
+
+  auto path = cachedRulesPath(key);
+  FILE* file = std::fopen(path.string().c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+
+#ifndef WIN32
+  // Only trust compiled rules written by this user and not writable by others.
+  struct stat sb;
+  if (::fstat(::fileno(file), &sb) != 0 || sb.st_uid != ::geteuid() ||
+      (sb.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+    std::fclose(file);
+    return false;
+  }
+#endif
+
+  std::string source_hash(key.size(), '\0');
+  if (std::fread(&source_hash[0], 1, source_hash.size(), file) !=
+          source_hash.size() ||
+      source_hash != key) {
+    std::fclose(file);
+    VLOG(1) << "Ignoring compiled YARA rules with a different source hash: "
+            << path.string();
+    return false;
+  }
+
+  YR_STREAM stream;
+  stream.user_data = file;
+  stream.read = readRulesStream;
+  stream.write = writeRulesStream;
+  auto result = yr_rules_load_stream(&stream, rules);
+  std::fclose(file);
+  if (result != ERROR_SUCCESS) {
+    return false;
+  }
+
+  // Touch the file, the least recently used files are removed first.
+  boost::system::error_code ec;
+  fs::last_write_time(path, std::time(nullptr), ec);
+  VLOG(1) << "Loaded compiled YARA rules from " << path.string();
+  return true;
+}
+
+void pruneCachedRules() {
+  std::vector<std::pair<std::time_t, fs::path>> cached;
+
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(FLAGS_yara_rules_cache_path, ec), end;
+       !ec && it != end;
+       it.increment(ec)) {
+    if (it->path().extension() == ".yarc") {
+      cached.emplace_back(fs::last_write_time(it->path(), ec), it->path());
+    }
+  }
+
+  if (cached.size() <= kMaxCachedRules) {
+    return;
+  }
+
+  std::sort(cached.begin(), cached.end());
+  for (size_t i = 0; i < cached.size() - kMaxCachedRules; i++) {
+    fs::remove(cached[i].second, ec);
+  }
+}
+
+void saveCachedRules(const std::string& key, YR_RULES* rules) {
+  if (FLAGS_yara_rules_cache_path.empty()) {
+    return;
+  }
+
+  boost::system::error_code ec;
+  fs::create_directories(FLAGS_yara_rules_cache_path, ec);
+  if (ec) {
+    VLOG(1) << "Cannot create the YARA rules cache: " << ec.message();
+    return;
+  }
+  fs::permissions(FLAGS_yara_rules_cache_path, fs::owner_all, ec);
+
+  // Write to a temporary file and rename, readers never see a partial file.
+  auto path = cachedRulesPath(key);
+  auto temp_path = path.string() + fs::unique_path(".%%%%%%%%").string();
+  FILE* file = std::fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return;
+  }
+
+  YR_STREAM stream;
+  stream.user_data = file;
+  stream.read = readRulesStream;
+  stream.write = writeRulesStream;
+  bool saved = std::fwrite(key.data(), 1, key.size(), file) == key.size() &&
+               yr_rules_save_stream(rules, &stream) == ERROR_SUCCESS;
+  if (std::fclose(file) != 0 || !saved) {
+    fs::remove(temp_path, ec);
+    return;
+  }
+
+  fs::rename(temp_path, path, ec);
+  if (ec) {
+    fs::remove(temp_path, ec);
+    return;
+  }
+
+  pruneCachedRules();
+}
+
+} // namespace
+
+bool yaraIsCleanScan(const std::string& rules_key,
+                     const std::string& path,
+                     const struct stat& sb) {
+  ReadLock lock(kCleanScansMutex);
+  auto it = kCleanScans.find(cleanScanKey(rules_key, path));
+  if (it == kCleanScans.end()) {
+    return false;
+  }
+
+  const auto& scan = it->second;
+  return scan.device == static_cast<std::uint64_t>(sb.st_dev) &&
+         scan.inode == static_cast<std::uint64_t>(sb.st_ino) &&
+         scan.size == static_cast<std::uint64_t>(sb.st_size) &&
+         scan.mtime == static_cast<std::uint64_t>(sb.st_mtime) &&
+         scan.ctime == static_cast<std::uint64_t>(sb.st_ctime);
+}
+
+void yaraSetCleanScan(const std::string& rules_key,
+                      const std::string& path,
+                      const struct stat& sb) {
+  WriteLock lock(kCleanScansMutex);
+  if (kCleanScans.size() >= kMaxCleanScans) {
+    kCleanScans.clear();
+  }
+
+  kCleanScans[cleanScanKey(rules_key, path)] = {
+      static_cast<std::uint64_t>(sb.st_dev),
+      static_cast<std::uint64_t>(sb.st_ino),
+      static_cast<std::uint64_t>(sb.st_size),
+      static_cast<std::uint64_t>(sb.st_mtime),
+      static_cast<std::uint64_t>(sb.st_ctime)};
+}
+
+void yaraClearCleanScans() {
+  WriteLock lock(kCleanScansMutex);
+  kCleanScans.clear();
+}
+
 bool yaraShouldSkipFile(const std::string& path, mode_t st_mode) {
   // avoid special files /dev/x , /proc/x, FIFO's named-pipes, etc.
   if ((st_mode & S_IFMT) != S_IFREG) {
@@ -72,6 +339,36 @@ Status yaraFinalize(void) {
   return Status::success();
 }
 
+/**
+ * Add a rule file's source to a compiler.
+ *
+ * Cacheable sources are compiled from the content that was hashed, others are
+ * compiled from the file so includes resolve relative to it.
+ */
+static Status addRuleSource(YR_COMPILER* compiler,
+                            const std::string& path,
+                            const std::string& content) {
+  int errors = 0;
+  if (isCacheableSource(content)) {
+    errors = yr_compiler_add_string(compiler, content.c_str(), nullptr);
+  } else {
+    FILE* rule_file = fopen(path.c_str(), "r");
+    if (rule_file == nullptr) {
+      return Status(1, "Could not open file: " + path);
+    }
+
+    errors = yr_compiler_add_file(compiler, rule_file, nullptr, path.c_str());
+    fclose(rule_file);
+  }
+
+  if (errors > 0) {
+    // Errors printed via callback.
+    VLOG(1) << "YARA compilation errors in " << path;
+    return Status::failure("Compilation errors");
+  }
+  return Status::success();
+}
+
 /**
  * Compile a single rule file and load it into rule pointer.
  */
@@ -87,6 +384,7 @@ Status compileSingleFile(const std::string& file, YR_RULES** rules) {
   yr_compiler_set_callback(compiler, YARACompilerCallback, nullptr);
 
   bool compiled = false;
+  std::string cache_key;
   YR_RULES* tmp_rules;
   VLOG(1) << "Loading YARA signature file: " << file;
 
@@ -103,25 +401,26 @@ Status compileSingleFile(const std::string& file, YR_RULES** rules) {
   } else if (result == ERROR_SUCCESS) {
     *rules = tmp_rules;
   } else {
-    compiled = true;
-    // Try to compile the rules.
-    FILE* rule_file = fopen(file.c_str(), "r");
-
-    if (rule_file == nullptr) {
+    std::string content;
+    if (!readFile(file, content).ok()) {
       yr_compiler_destroy(compiler);
       return Status(1, "Could not open file: " + file);
     }
 
-    int errors =
-        yr_compiler_add_file(compiler, rule_file, nullptr, file.c_str());
-
-    fclose(rule_file);
-    rule_file = nullptr;
+    // Reuse the rules compiled from identical content in a previous run.
+    if (isCacheableSource(content)) {
+      cache_key = hashRuleSources({{file, content}});
+      if (loadCachedRules(cache_key, rules)) {
+        yr_compiler_destroy(compiler);
+        return Status::success();
+      }
+    }
 
-    if (errors > 0) {
+    compiled = true;
+    auto status = addRuleSource(compiler, file, content);
+    if (!status.ok()) {
       yr_compiler_destroy(compiler);
-      // Errors printed via callback.
-      return Status::failure("Compilation errors");
+      return status;
     }
   }
 
@@ -133,6 +432,10 @@ Status compileSingleFile(const std::string& file, YR_RULES** rules) {
       yr_compiler_destroy(compiler);
       return Status::failure("Insufficient memory to get YARA rules");
     }
+
+    if (!cache_key.empty()) {
+      saveCachedRules(cache_key, *rules);
+    }
   }
 
   if (compiler != nullptr) {
@@ -204,7 +507,7 @@ Status handleRuleFiles(const std::string& category,
 
   yr_compiler_set_callback(compiler, YARACompilerCallback, nullptr);
 
-  bool compiled = false;
+  std::vector<std::pair<std::string, std::string>> sources;
   for (const auto& item : rule_files.GetArray()) {
     if (!item.IsString()) {
       continue;
@@ -243,30 +546,38 @@ Status handleRuleFiles(const std::string& category,
 
       rules[category] = tmp_rules;
     } else {
-      compiled = true;
-      // Try to compile the rules.
-      FILE* rule_file = fopen(rule.c_str(), "r");
-
-      if (rule_file == nullptr) {
+      std::string content;
+      if (!readFile(rule, content).ok()) {
         yr_compiler_destroy(compiler);
         return Status(1, "Could not open file: " + rule);
       }
+      sources.emplace_back(rule, std::move(content));
+    }
+  }
 
-      int errors =
-          yr_compiler_add_file(compiler, rule_file, nullptr, rule.c_str());
-
-      fclose(rule_file);
-      rule_file = nullptr;
+  if (!sources.empty()) {
+    bool cacheable = std::all_of(
+        sources.begin(), sources.end(), [](const auto& source) {
+          return isCacheableSource(source.second);
+        });
+
+    // Reuse the rules compiled from identical content in a previous run.
+    auto cache_key = hashRuleSources(sources);
+    YR_RULES* cached_rules = nullptr;
+    if (cacheable && loadCachedRules(cache_key, &cached_rules)) {
+      rules[category] = cached_rules;
+      yr_compiler_destroy(compiler);
+      return Status::success();
+    }
 
-      if (errors > 0) {
+    for (const auto& source : sources) {
+      auto status = addRuleSource(compiler, source.first, source.second);
+      if (!status.ok()) {
         yr_compiler_destroy(compiler);
-        // Errors printed via callback.
-        return Status(1, "Compilation errors");
+        return status;
       }
     }
-  }
 
-  if (compiled) {
     // All the rules for this category have been compiled, save them in the map.
     result = yr_compiler_get_rules(compiler, &rules[category]);
 
@@ -274,6 +585,10 @@ Status handleRuleFiles(const std::string& category,
       yr_compiler_destroy(compiler);
       return Status(1, "Insufficient memory to get YARA rules");
     }
+
+    if (cacheable) {
+      saveCachedRules(cache_key, rules[category]);
+    }
   }
 
   if (compiler != nullptr) {
@@ -368,6 +683,9 @@ Status YARAConfigParserPlugin::update(const std::string& source,
       data_.copyFrom(signatures, obj);
       data_.add("signatures", obj);
 
+      // Signature groups are recompiled, earlier clean scans may not apply.
+      yaraClearCleanScans();
+
       for (const auto& element : data_.doc()["signatures"].GetObject()) {
         std::string category = element.name.GetString();
         if (!element.value.IsArray()) {
@@ -51,6 +51,25 @@ Status handleRuleFiles(const std::string& category,
  */
 bool yaraShouldSkipFile(const std::string& path, mode_t st_mode);
 
+/**
+ * @brief Check if a file is unchanged since a scan without matches.
+ *
+ * @param rules_key The signature group, file, or hashed rule scanned with.
+ * @param path The scanned file.
+ * @param sb The current stat of the file.
+ */
+bool yaraIsCleanScan(const std::string& rules_key,
+                     const std::string& path,
+                     const struct stat& sb);
+
+/// Remember the identity of a file, stat'd before a scan without matches.
+void yaraSetCleanScan(const std::string& rules_key,
+                      const std::string& path,
+                      const struct stat& sb);
+
+/// Forget all clean scans, for example when rules are recompiled.
+void yaraClearCleanScans();
+
 int YARACallback(YR_SCAN_CONTEXT* context,
                  int message,
                  void* message_data,
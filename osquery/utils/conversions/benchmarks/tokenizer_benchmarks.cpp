@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tokenizer.h>
+
+namespace osquery {
+namespace {
+
+/// Captured from /proc/net/tcp.
+const std::string kProcNetTcp =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when "
+    "retrnsmt   uid  timeout inode\n"
+    "   0: 0100007F:BC8F 00000000:0000 0A 00000000:00000000 00:00000000 "
+    "00000000     0        0 903 1 0000000000000000 100 0 0 10 0\n"
+    "   1: 00000000:07E8 00000000:0000 0A 00000000:00000000 00:00000000 "
+    "00000000     0        0 662 1 0000000000000000 100 0 0 10 0\n"
+    "   2: 0100007F:BC8F 0100007F:C0AA 01 00000000:00000000 00:00000000 "
+    "00000000     0        0 47426 1 0000000000000000 20 4 30 10 -1\n";
+
+/// Captured from /proc/<pid>/maps.
+const std::string kProcMaps =
+    "5648ddfe0000-5648ddfe2000 r--p 00000000 fe:00 467394                     "
+    "/usr/bin/head\n"
+    "5648ddfe2000-5648ddfe8000 r-xp 00002000 fe:00 467394                     "
+    "/usr/bin/head\n"
+    "5648eb60e000-5648eb62f000 rw-p 00000000 00:00 0                          "
+    "[heap]\n"
+    "7f89f6e6d000-7f89f6e70000 rw-p 00000000 00:00 0 \n";
+
+/// Captured from /proc/<pid>/status.
+const std::string kProcStatus =
+    "Name:\tcat\n"
+    "Umask:\t0022\n"
+    "State:\tR (running)\n"
+    "Tgid:\t13015\n"
+    "PPid:\t13005\n"
+    "Uid:\t0\t0\t0\t0\n"
+    "Gid:\t0\t0\t0\t0\n"
+    "VmSize:\t    2640 kB\n"
+    "VmRSS:\t    1140 kB\n"
+    "Threads:\t1\n";
+
+/// Repeat a capture, without its header, to simulate a busy system.
+std::string repeat(const std::string& capture, size_t times) {
+  auto header = capture.substr(0, capture.find('\n') + 1);
+  auto body = capture.substr(header.size());
+
+  auto content = header;
+  for (size_t i = 0; i < times; i++) {
+    content += body;
+  }
+  return content;
+}
+
+} // namespace
+
+static void TOKENIZER_split_fields(benchmark::State& state,
+                                   const std::string& capture) {
+  auto content = repeat(capture, static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    size_t count = 0;
+    for (const auto& line : split(content, "\n")) {
+      count += split(line, " ").size();
+    }
+    benchmark::DoNotOptimize(count);
+  }
+}
+
+static void TOKENIZER_split_view_fields(benchmark::State& state,
+                                        const std::string& capture) {
+  auto content = repeat(capture, static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    size_t count = 0;
+    Tokenizer lines(content, "\n");
+    std::string_view line;
+    std::vector<std::string_view> fields;
+    while (lines.next(line)) {
+      count += splitView(line, " ", fields);
+    }
+    benchmark::DoNotOptimize(count);
+  }
+}
+
+BENCHMARK_CAPTURE(TOKENIZER_split_fields, net_tcp, kProcNetTcp)
+    ->Arg(1)
+    ->Arg(1000);
+BENCHMARK_CAPTURE(TOKENIZER_split_view_fields, net_tcp, kProcNetTcp)
+    ->Arg(1)
+    ->Arg(1000);
+BENCHMARK_CAPTURE(TOKENIZER_split_fields, maps, kProcMaps)->Arg(100);
+BENCHMARK_CAPTURE(TOKENIZER_split_view_fields, maps, kProcMaps)->Arg(100);
+
+static void TOKENIZER_split_key_values(benchmark::State& state) {
+  for (auto _ : state) {
+    size_t count = 0;
+    for (const auto& line : split(kProcStatus, "\n")) {
+      count += split(line, ':', 1).size();
+    }
+    benchmark::DoNotOptimize(count);
+  }
+}
+
+BENCHMARK(TOKENIZER_split_key_values);
+
+static void TOKENIZER_split_view_key_values(benchmark::State& state) {
+  for (auto _ : state) {
+    size_t count = 0;
+    Tokenizer lines(kProcStatus, "\n");
+    std::string_view line, key, value;
+    while (lines.next(line)) {
+      count += splitKeyValue(line, ':', key, value) ? 2 : 1;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+}
+
+BENCHMARK(TOKENIZER_split_view_key_values);
+
+} // namespace osquery
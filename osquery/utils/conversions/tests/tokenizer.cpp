@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <osquery/utils/conversions/split.h>
+#include <osquery/utils/conversions/tokenizer.h>
+
+namespace osquery {
+
+class TokenizerTests : public testing::Test {};
+
+TEST_F(TokenizerTests, test_split_view_matches_split) {
+  const std::vector<std::pair<std::string, std::string>> inputs = {
+      {"a b\tc", "\t "},
+      {" a b   c", "\t "},
+      {"  a     b   c", "\t "},
+      {"line one\n\nline two \n", "\n"},
+      {"  :a:: b :", ":"},
+      {" \t ", " "},
+      {"", " "},
+  };
+
+  std::vector<std::string_view> tokens;
+  for (const auto& input : inputs) {
+    splitView(input.first, input.second, tokens);
+    std::vector<std::string> copies(tokens.begin(), tokens.end());
+    EXPECT_EQ(copies, split(input.first, input.second)) << input.first;
+  }
+}
+
+TEST_F(TokenizerTests, test_tokenizer_rest) {
+  Tokenizer tokenizer("Name:\t kworker/0:1 :\n", ":");
+
+  std::string_view token;
+  ASSERT_TRUE(tokenizer.next(token));
+  EXPECT_EQ(token, "Name");
+  EXPECT_EQ(tokenizer.rest(), "kworker/0:1");
+
+  ASSERT_TRUE(tokenizer.next(token));
+  EXPECT_EQ(token, "kworker/0");
+  ASSERT_TRUE(tokenizer.next(token));
+  EXPECT_EQ(token, "1");
+  EXPECT_TRUE(tokenizer.rest().empty());
+}
+
+TEST_F(TokenizerTests, test_split_key_value) {
+  std::string_view key, value;
+  ASSERT_TRUE(splitKeyValue("VmRSS:\t    1234 kB", ':', key, value));
+  EXPECT_EQ(key, "VmRSS");
+  EXPECT_EQ(value, "1234 kB");
+
+  ASSERT_TRUE(splitKeyValue("T: 'S:S'", ':', key, value));
+  EXPECT_EQ(key, "T");
+  EXPECT_EQ(value, "'S:S'");
+
+  EXPECT_FALSE(splitKeyValue("Key:  ", ':', key, value));
+  EXPECT_FALSE(splitKeyValue("", ':', key, value));
+}
+
+TEST_F(TokenizerTests, test_split_key_value_differs_from_split) {
+  // The value is kept as it is within the line, split joins its tokens.
+  const std::vector<std::pair<std::string, std::string>> inputs = {
+      {"k: a::b", "a::b"},
+      {"k: x : y", "x : y"},
+      {"k: : x", "x"},
+  };
+
+  std::string_view key, value;
+  for (const auto& input : inputs) {
+    ASSERT_TRUE(splitKeyValue(input.first, ':', key, value)) << input.first;
+    EXPECT_EQ(key, "k");
+    EXPECT_EQ(value, input.second) << input.first;
+    EXPECT_NE(split(input.first, ':', 1).at(1), input.second) << input.first;
+  }
+
+  // Both drop empty tokens before the key and trim the ends of the value.
+  for (const auto& line : {"a::b", "::a:b:", "k: x:"}) {
+    ASSERT_TRUE(splitKeyValue(line, ':', key, value)) << line;
+    auto fields = split(line, ':', 1);
+    ASSERT_EQ(fields.size(), 2U) << line;
+    EXPECT_EQ(key, fields[0]) << line;
+    EXPECT_EQ(value, fields[1]) << line;
+  }
+}
+
+TEST_F(TokenizerTests, test_parse_integer) {
+  int value = 0;
+  EXPECT_TRUE(parseInteger("1234", value));
+  EXPECT_EQ(value, 1234);
+  EXPECT_TRUE(parseInteger("-12", value));
+  EXPECT_EQ(value, -12);
+
+  unsigned short port = 0;
+  EXPECT_TRUE(parseInteger("0016", port, 16));
+  EXPECT_EQ(port, 22);
+
+  EXPECT_FALSE(parseInteger("", value));
+  EXPECT_FALSE(parseInteger(" 12", value));
+  EXPECT_FALSE(parseInteger("12kB", value));
+  EXPECT_FALSE(parseInteger("10000", port, 16));
+}
+
+} // namespace osquery
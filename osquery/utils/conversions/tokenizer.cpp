@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include "tokenizer.h"
+
+#include <cstring>
+
+namespace osquery {
+namespace {
+
+/// The characters trimmed by boost::algorithm::trim in the C locale.
+const std::string_view kWhitespace = " \t\n\v\f\r";
+
+/// Find the first delimiter at or after pos, or the size of the text.
+size_t findDelimiter(std::string_view text,
+                     size_t pos,
+                     std::string_view delims) {
+  if (delims.size() == 1) {
+    auto found = std::memchr(text.data() + pos, delims[0], text.size() - pos);
+    return (found == nullptr)
+               ? text.size()
+               : static_cast<size_t>(static_cast<const char*>(found) -
+                                     text.data());
+  }
+
+  for (; pos < text.size(); pos++) {
+    if (delims.find(text[pos]) != std::string_view::npos) {
+      break;
+    }
+  }
+  return pos;
+}
+
+std::string_view trimCharacters(std::string_view text,
+                                std::string_view characters) {
+  auto start = text.find_first_not_of(characters);
+  if (start == std::string_view::npos) {
+    return std::string_view();
+  }
+
+  auto end = text.find_last_not_of(characters);
+  return text.substr(start, end - start + 1);
+}
+
+} // namespace
+
+bool Tokenizer::next(std::string_view& token) {
+  while (pos_ < text_.size()) {
+    auto end = findDelimiter(text_, pos_, delims_);
+    auto length = end - pos_;
+    auto start = pos_;
+    pos_ = (end < text_.size()) ? end + 1 : end;
+
+    // Empty tokens are skipped before trimming, as in split.
+    if (length > 0) {
+      token = trimView(text_.substr(start, length));
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string_view Tokenizer::rest() const {
+  // Remove delimiters and whitespace until neither remains at the ends.
+  auto text = text_.substr(pos_);
+  size_t size = 0;
+  do {
+    size = text.size();
+    text = trimCharacters(trimView(text), delims_);
+  } while (text.size() != size);
+  return text;
+}
+
+std::string_view trimView(std::string_view text) {
+  return trimCharacters(text, kWhitespace);
+}
+
+size_t splitView(std::string_view text,
+                 std::string_view delims,
+                 std::vector<std::string_view>& tokens) {
+  tokens.clear();
+
+  Tokenizer tokenizer(text, delims);
+  std::string_view token;
+  while (tokenizer.next(token)) {
+    tokens.push_back(token);
+  }
+  return tokens.size();
+}
+
+bool splitKeyValue(std::string_view line,
+                   char delim,
+                   std::string_view& key,
+                   std::string_view& value) {
+  Tokenizer tokenizer(line, std::string_view(&delim, 1));
+  if (!tokenizer.next(key) || key.empty()) {
+    return false;
+  }
+
+  value = tokenizer.rest();
+  return !value.empty();
+}
+
+} // namespace osquery
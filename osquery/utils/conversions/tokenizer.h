@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace osquery {
+
+/**
+ * @brief Split text into tokens without copying it.
+ *
+ * Tokens are separated by any of the delimiter characters. Empty tokens are
+ * skipped and whitespace is trimmed from each token, the same as split. The
+ * tokens are views into the text, and the text and the delimiters must
+ * outlive the tokenizer.
+ *
+ * Searching for a single delimiter uses memchr, which the C library
+ * vectorizes, so prefer a single delimiter when splitting lines.
+ */
+class Tokenizer {
+ public:
+  explicit Tokenizer(std::string_view text, std::string_view delims = "\t ")
+      : text_(text), delims_(delims) {}
+
+  /// Get the next token, return false at the end of the text.
+  bool next(std::string_view& token);
+
+  /// The text after the last token, without surrounding delimiters.
+  std::string_view rest() const;
+
+ private:
+  std::string_view text_;
+
+  std::string_view delims_;
+
+  size_t pos_{0};
+};
+
+/// Trim whitespace from both ends of text.
+std::string_view trimView(std::string_view text);
+
+/**
+ * @brief Split text into views, the same as split.
+ *
+ * @param text the text to split.
+ * @param delims the delimiter characters.
+ * @param tokens the output tokens, reusing the capacity of the vector.
+ *
+ * @return the number of tokens.
+ */
+size_t splitView(std::string_view text,
+                 std::string_view delims,
+                 std::vector<std::string_view>& tokens);
+
+/**
+ * @brief Split a line formatted as "Key: Value" into its key and value.
+ *
+ * The key is the first token, and the value is the rest of the line with
+ * delimiters and whitespace trimmed from its ends. Unlike split(line, delim,
+ * 1), the value is not split and joined again, so delimiters and whitespace
+ * within it are kept: "k: a::b" has the value "a::b" and "k: x : y" has the
+ * value "x : y", where split returns "a:b" and "x:y".
+ *
+ * @return false if the key or the value is empty.
+ */
+bool splitKeyValue(std::string_view line,
+                   char delim,
+                   std::string_view& key,
+                   std::string_view& value);
+
+/**
+ * @brief Parse a whole token as an integer, without copying it.
+ *
+ * Unlike tryTo, whitespace, signs for unsigned types, and trailing
+ * characters are not accepted.
+ */
+template <typename T>
+bool parseInteger(std::string_view token, T& value, int base = 10) {
+  auto end = token.data() + token.size();
+  auto result = std::from_chars(token.data(), end, value, base);
+  return result.ec == std::errc() && result.ptr == end && !token.empty();
+}
+
+} // namespace osquery
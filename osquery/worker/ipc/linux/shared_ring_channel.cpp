@@ -0,0 +1,441 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include "shared_ring_channel.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace osquery {
+
+namespace {
+
+const uint32_t kSharedRingMagic{0x6f737172};
+
+const uint32_t kSharedRingVersion{1};
+
+/// Messages start after the header, on their own page.
+const size_t kSharedRingDataOffset{4096};
+
+/// A wait rechecks the other process at least this often.
+const std::chrono::milliseconds kSharedRingWaitSlice{100};
+
+/// The largest message accepted from the other process.
+const uint64_t kSharedRingMaxMessageSize{1ULL << 30};
+
+/// The memfd_create flag, missing from older headers.
+const unsigned int kMemfdCloexec{1U};
+
+const uint32_t kWriterClosed{1U};
+const uint32_t kReaderClosed{2U};
+
+} // namespace
+
+struct SharedRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t capacity;
+  uint64_t timeout_ms;
+  int32_t reader_pid;
+  std::atomic<int32_t> writer_pid;
+  std::atomic<uint32_t> closed;
+
+  /// Bytes written, and a futex word bumped on each write.
+  alignas(64) std::atomic<uint64_t> head;
+  std::atomic<uint32_t> head_seq;
+
+  /// Bytes read, and a futex word bumped on each read.
+  alignas(64) std::atomic<uint64_t> tail;
+  std::atomic<uint32_t> tail_seq;
+};
+
+static_assert(sizeof(SharedRingHeader) <= kSharedRingDataOffset,
+              "The shared ring header must fit before the data");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Futex words must be plain 32-bit integers");
+
+static void futexWait(std::atomic<uint32_t>& word,
+                      uint32_t expected,
+                      std::chrono::milliseconds timeout) {
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+  syscall(SYS_futex,
+          reinterpret_cast<uint32_t*>(&word),
+          FUTEX_WAIT,
+          expected,
+          &ts,
+          nullptr,
+          0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex,
+          reinterpret_cast<uint32_t*>(&word),
+          FUTEX_WAKE,
+          INT_MAX,
+          nullptr,
+          nullptr,
+          0);
+}
+
+static bool processExists(pid_t pid) {
+  if (pid <= 0) {
+    return true;
+  }
+  if (kill(pid, 0) != 0 && errno != EPERM) {
+    return false;
+  }
+
+  // An exited child of the other process is a zombie until it is reaped.
+  auto path = "/proc/" + std::to_string(pid) + "/stat";
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return true;
+  }
+  char stat[512];
+  auto size = ::read(fd, stat, sizeof(stat) - 1);
+  ::close(fd);
+  if (size <= 0) {
+    return true;
+  }
+  stat[size] = '\0';
+  const char* name_end = std::strrchr(stat, ')');
+  return name_end == nullptr || name_end[1] != ' ' || name_end[2] != 'Z';
+}
+
+SharedRingChannel::SharedRingChannel(const std::string& table_name,
+                                     int fd,
+                                     void* mapping,
+                                     size_t mapping_size,
+                                     bool writer)
+    : TableChannelBase<SharedRingChannel>(table_name),
+      fd_(fd),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      header_(static_cast<SharedRingHeader*>(mapping)),
+      data_(static_cast<char*>(mapping) + kSharedRingDataOffset),
+      // The other process can write to the header, read it only once.
+      capacity_(mapping_size - kSharedRingDataOffset),
+      timeout_(header_->timeout_ms),
+      writer_(writer) {}
+
+SharedRingChannel::~SharedRingChannel() {
+  if (writer_) {
+    closeWriter();
+  } else {
+    closeReader();
+  }
+  munmap(mapping_, mapping_size_);
+  ::close(fd_);
+}
+
+Status SharedRingChannel::create(const std::string& table_name,
+                                 size_t capacity,
+                                 std::chrono::milliseconds timeout,
+                                 std::unique_ptr<SharedRingChannel>& channel) {
+#ifdef SYS_memfd_create
+  if (capacity == 0 ||
+      capacity > std::numeric_limits<size_t>::max() - kSharedRingDataOffset) {
+    return Status::failure("Invalid shared ring capacity " +
+                           std::to_string(capacity));
+  }
+
+  int fd = static_cast<int>(
+      syscall(SYS_memfd_create, "osquery_shared_ring", kMemfdCloexec));
+  if (fd < 0) {
+    return Status::failure(errno,
+                           "Failed to create the shared ring of table " +
+                               table_name + ", errno " + std::to_string(errno));
+  }
+
+  auto mapping_size = kSharedRingDataOffset + capacity;
+  if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+    auto error = errno;
+    ::close(fd);
+    return Status::failure(error,
+                           "Failed to size the shared ring of table " +
+                               table_name + ", errno " + std::to_string(error));
+  }
+
+  auto mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    auto error = errno;
+    ::close(fd);
+    return Status::failure(error,
+                           "Failed to map the shared ring of table " +
+                               table_name + ", errno " + std::to_string(error));
+  }
+
+  // The memfd is zero filled, the atomics start at 0.
+  auto header = static_cast<SharedRingHeader*>(mapping);
+  header->magic = kSharedRingMagic;
+  header->version = kSharedRingVersion;
+  header->capacity = capacity;
+  header->timeout_ms = static_cast<uint64_t>(timeout.count());
+  header->reader_pid = static_cast<int32_t>(getpid());
+
+  channel.reset(
+      new SharedRingChannel(table_name, fd, mapping, mapping_size, false));
+  return Status::success();
+#else
+  return Status::failure("Shared rings require memfd_create");
+#endif
+}
+
+Status SharedRingChannel::open(const std::string& table_name,
+                               pid_t pid,
+                               int fd,
+                               std::unique_ptr<SharedRingChannel>& channel) {
+  // Reopen the reader's memfd, as the writer does not share its descriptors.
+  auto path = "/proc/" + std::to_string(pid) + "/fd/" + std::to_string(fd);
+  int local_fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (local_fd < 0) {
+    return Status::failure(errno,
+                           "Failed to open the shared ring of table " +
+                               table_name + ", errno " + std::to_string(errno));
+  }
+
+  struct stat st;
+  if (fstat(local_fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) <= kSharedRingDataOffset) {
+    ::close(local_fd);
+    return Status::failure("Invalid shared ring of table " + table_name);
+  }
+
+  auto mapping_size = static_cast<size_t>(st.st_size);
+  auto mapping = mmap(
+      nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, local_fd, 0);
+  if (mapping == MAP_FAILED) {
+    auto error = errno;
+    ::close(local_fd);
+    return Status::failure(error,
+                           "Failed to map the shared ring of table " +
+                               table_name + ", errno " + std::to_string(error));
+  }
+
+  auto header = static_cast<SharedRingHeader*>(mapping);
+  if (header->magic != kSharedRingMagic ||
+      header->version != kSharedRingVersion ||
+      header->capacity != mapping_size - kSharedRingDataOffset ||
+      header->reader_pid != static_cast<int32_t>(pid)) {
+    munmap(mapping, mapping_size);
+    ::close(local_fd);
+    return Status::failure("Invalid shared ring of table " + table_name);
+  }
+
+  int32_t no_writer = 0;
+  if (!header->writer_pid.compare_exchange_strong(
+          no_writer, static_cast<int32_t>(getpid()))) {
+    munmap(mapping, mapping_size);
+    ::close(local_fd);
+    return Status::failure("The shared ring of table " + table_name +
+                           " already has a writer");
+  }
+
+  channel.reset(
+      new SharedRingChannel(table_name, local_fd, mapping, mapping_size, true));
+  return Status::success();
+}
+
+void SharedRingChannel::closeWriter() {
+  header_->closed.fetch_or(kWriterClosed);
+  header_->head_seq.fetch_add(1);
+  futexWake(header_->head_seq);
+}
+
+void SharedRingChannel::closeReader() {
+  header_->closed.fetch_or(kReaderClosed);
+  header_->tail_seq.fetch_add(1);
+  futexWake(header_->tail_seq);
+}
+
+Status SharedRingChannel::checkPeer() const {
+  auto closed = header_->closed.load();
+  if (writer_ && (closed & kReaderClosed)) {
+    return Status::failure(
+        EPIPE, "The shared ring of table " + table_name_ + " was closed");
+  }
+  if (!writer_ && (closed & kWriterClosed)) {
+    return Status::failure(
+        2, "Shared ring of table " + table_name_ + " closed while reading");
+  }
+
+  auto pid = writer_ ? header_->reader_pid : header_->writer_pid.load();
+  if (!processExists(static_cast<pid_t>(pid))) {
+    return Status::failure(2,
+                           "The process sharing the ring of table " +
+                               table_name_ + " exited");
+  }
+  return Status::success();
+}
+
+Status SharedRingChannel::write(const char* data, size_t size) {
+  auto waited = std::chrono::milliseconds(0);
+
+  while (size > 0) {
+    auto seq = header_->tail_seq.load();
+    auto head = header_->head.load(std::memory_order_relaxed);
+    auto tail = header_->tail.load(std::memory_order_acquire);
+    if (head - tail > capacity_) {
+      return Status::failure("The shared ring of table " + table_name_ +
+                             " is corrupt");
+    }
+    auto space = capacity_ - (head - tail);
+
+    if (space == 0) {
+      // The ring is full, wait for the reader.
+      auto status = checkPeer();
+      if (!status.ok()) {
+        return status;
+      }
+      if (waited >= timeout_) {
+        return Status::failure(
+            ETIMEDOUT,
+            "Timed out writing to the shared ring of table " + table_name_);
+      }
+      futexWait(header_->tail_seq, seq, kSharedRingWaitSlice);
+      waited += kSharedRingWaitSlice;
+      continue;
+    }
+
+    if (header_->closed.load() & kReaderClosed) {
+      return checkPeer();
+    }
+
+    auto count = static_cast<size_t>(std::min<uint64_t>(space, size));
+    auto offset = static_cast<size_t>(head % capacity_);
+    auto first = std::min(count, capacity_ - offset);
+    memcpy(data_ + offset, data, first);
+    memcpy(data_, data + first, count - first);
+
+    header_->head.store(head + count, std::memory_order_release);
+    header_->head_seq.fetch_add(1);
+    futexWake(header_->head_seq);
+
+    data += count;
+    size -= count;
+    waited = std::chrono::milliseconds(0);
+  }
+  return Status::success();
+}
+
+Status SharedRingChannel::read(char* data, size_t size) {
+  auto waited = std::chrono::milliseconds(0);
+
+  while (size > 0) {
+    auto seq = header_->head_seq.load();
+    auto tail = header_->tail.load(std::memory_order_relaxed);
+    auto head = header_->head.load(std::memory_order_acquire);
+    auto available = head - tail;
+    if (available > capacity_) {
+      // The writer moved head past the data it could have written.
+      return Status::failure("The shared ring of table " + table_name_ +
+                             " is corrupt");
+    }
+
+    if (available == 0) {
+      // The ring is empty, wait for the writer.
+      auto status = checkPeer();
+      if (!status.ok()) {
+        // The writer may have written its last bytes and closed the ring
+        // after head was loaded, read them before failing.
+        if (header_->head.load(std::memory_order_acquire) != tail) {
+          continue;
+        }
+        return status;
+      }
+      if (waited >= timeout_) {
+        return Status::failure(
+            ETIMEDOUT,
+            "Timed out reading from the shared ring of table " + table_name_);
+      }
+      futexWait(header_->head_seq, seq, kSharedRingWaitSlice);
+      waited += kSharedRingWaitSlice;
+      continue;
+    }
+
+    auto count = static_cast<size_t>(std::min<uint64_t>(available, size));
+    auto offset = static_cast<size_t>(tail % capacity_);
+    auto first = std::min(count, capacity_ - offset);
+    memcpy(data, data_ + offset, first);
+    memcpy(data + first, data_, count - first);
+
+    header_->tail.store(tail + count, std::memory_order_release);
+    header_->tail_seq.fetch_add(1);
+    futexWake(header_->tail_seq);
+
+    data += count;
+    size -= count;
+    waited = std::chrono::milliseconds(0);
+  }
+  return Status::success();
+}
+
+Status SharedRingChannel::sendStringMessageImpl(const std::string& message) {
+  if (!writer_) {
+    return Status::failure("Cannot send through the reading end of a ring");
+  }
+
+  if (message.size() == 0 || message.size() > kSharedRingMaxMessageSize) {
+    return Status::failure("Cannot send a message of " +
+                           std::to_string(message.size()) + " bytes");
+  }
+
+  const uint64_t message_size = message.size();
+  auto status = write(reinterpret_cast<const char*>(&message_size),
+                      sizeof(message_size));
+  if (!status.ok()) {
+    return status;
+  }
+  return write(message.data(), message.size());
+}
+
+Status SharedRingChannel::recvStringMessageImpl(std::string& message) {
+  if (writer_) {
+    return Status::failure("Cannot receive from the writing end of a ring");
+  }
+
+  uint64_t message_size = 0;
+  auto status =
+      read(reinterpret_cast<char*>(&message_size), sizeof(message_size));
+  if (!status.ok()) {
+    return status;
+  }
+
+  if (message_size == 0 || message_size > kSharedRingMaxMessageSize) {
+    return Status::failure("Invalid message size of " +
+                           std::to_string(message_size) + " bytes");
+  }
+
+  try {
+    message.resize(static_cast<size_t>(message_size));
+  } catch (const std::exception& e) {
+    return Status::failure("Cannot receive a message of " +
+                           std::to_string(message_size) +
+                           " bytes: " + e.what());
+  }
+  return read(&message[0], message.size());
+}
+
+} // namespace osquery
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <osquery/utils/status/status.h>
+
+#include "osquery/worker/ipc/table_channel_base.h"
+
+namespace osquery {
+
+struct SharedRingHeader;
+
+/**
+ * @brief A one-way channel through a ring buffer in shared memory.
+ *
+ * The reading process creates the ring in a memfd and passes the descriptor
+ * to the writing process, which opens it through /proc. Messages are copied
+ * into the mapping once and read from it once, instead of being copied
+ * through the kernel.
+ *
+ * A writer waits while the ring is full and a reader waits while it is
+ * empty. A wait fails when the other side closed the ring, when the other
+ * process exited without closing it, or after the timeout without progress.
+ *
+ * The reader does not trust the shared header: the capacity and timeout are
+ * read once, positions past the written data and messages over 1 GiB fail.
+ */
+class SharedRingChannel : public TableChannelBase<SharedRingChannel> {
+ public:
+  /// Create a ring with capacity bytes of messages, to be read from.
+  static Status create(const std::string& table_name,
+                       size_t capacity,
+                       std::chrono::milliseconds timeout,
+                       std::unique_ptr<SharedRingChannel>& channel);
+
+  /// Open the ring created by process pid with descriptor fd, to write to.
+  static Status open(const std::string& table_name,
+                     pid_t pid,
+                     int fd,
+                     std::unique_ptr<SharedRingChannel>& channel);
+
+  ~SharedRingChannel();
+
+  /// The memfd to pass to the writing process.
+  int fd() const {
+    return fd_;
+  }
+
+  /**
+   * @brief Stop waiting for the writer.
+   *
+   * The reader calls this when it knows the writer is done, such as after
+   * the writer's process answered a control message without opening the
+   * ring. Messages already written can still be read.
+   */
+  void closeWriter();
+
+  /// Stop writing, and fail the writer's waits, from the reading side.
+  void closeReader();
+
+ private:
+  SharedRingChannel(const std::string& table_name,
+                    int fd,
+                    void* mapping,
+                    size_t mapping_size,
+                    bool writer);
+
+  friend TableChannelBase<SharedRingChannel>;
+
+  Status sendStringMessageImpl(const std::string& message);
+  Status recvStringMessageImpl(std::string& message);
+
+  /// Copy size bytes into the ring, waiting for space.
+  Status write(const char* data, size_t size);
+
+  /// Copy size bytes out of the ring, waiting for them to be written.
+  Status read(char* data, size_t size);
+
+  /// Fail with a reason if the other side closed or exited.
+  Status checkPeer() const;
+
+ private:
+  int fd_{-1};
+  void* mapping_{nullptr};
+  size_t mapping_size_{0};
+  SharedRingHeader* header_{nullptr};
+  char* data_{nullptr};
+
+  /// Bytes of messages the ring holds, from the size of the mapping.
+  size_t capacity_{0};
+
+  /// How long to wait without progress, as the reader created the ring.
+  std::chrono::milliseconds timeout_{0};
+
+  bool writer_{false};
+};
+
+} // namespace osquery
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include <osquery/core/sql/table_page.h>
+#include <osquery/worker/ipc/linux/shared_ring_channel.h>
+
+namespace osquery {
+class SharedRingChannelTest : public testing::Test {
+ protected:
+  std::unique_ptr<SharedRingChannel> createRing(size_t capacity) {
+    std::unique_ptr<SharedRingChannel> channel;
+    auto status = SharedRingChannel::create(
+        "test", capacity, std::chrono::milliseconds(5000), channel);
+    EXPECT_TRUE(status.ok()) << status.getMessage();
+    return channel;
+  }
+};
+
+TEST_F(SharedRingChannelTest, test_ring_read_after_exit) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+  auto parent = getpid();
+  auto fd = reader->fd();
+
+  int pid = fork();
+
+  ASSERT_NE(pid, -1);
+
+  if (pid == 0) {
+    // Child
+    std::unique_ptr<SharedRingChannel> writer;
+    auto status = SharedRingChannel::open("test", parent, fd, writer);
+    if (!status.ok()) {
+      std::exit(1);
+    }
+    status = writer->sendStringMessage("Hello World!");
+    std::exit(status.ok() ? 0 : 1);
+  } else {
+    // Parent
+    int wexit;
+    waitpid(pid, &wexit, 0);
+    ASSERT_EQ(WEXITSTATUS(wexit), 0);
+
+    // We are able to read a message even after the child exited
+    std::string message;
+    auto status = reader->recvStringMessage(message);
+    ASSERT_TRUE(status.ok()) << status.getMessage();
+    EXPECT_EQ(message, "Hello World!");
+
+    // The child closed its side when it exited
+    status = reader->recvStringMessage(message);
+    EXPECT_FALSE(status.ok());
+  }
+}
+
+TEST_F(SharedRingChannelTest, test_ring_page_larger_than_capacity) {
+  const size_t rows = 10000;
+  TablePage page;
+  page.addColumn("pid", TablePage::Storage::Integer);
+  page.addColumn("name", TablePage::Storage::Text);
+  page.addColumn("load", TablePage::Storage::Double);
+  auto& pids = page.columns()[0];
+  auto& names = page.columns()[1];
+  auto& loads = page.columns()[2];
+  for (size_t row = 0; row < rows; ++row) {
+    pids.integers.push_back(static_cast<int64_t>(row));
+    names.text.push_back("process_" + std::to_string(row));
+    loads.doubles.push_back(static_cast<double>(row) / 4);
+  }
+  names.nulls.resize(rows, false);
+  names.nulls[7] = true;
+  page.setRows(rows);
+
+  // The encoded page is many times the ring, the writer waits for the reader
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+  auto parent = getpid();
+  auto fd = reader->fd();
+
+  int pid = fork();
+
+  ASSERT_NE(pid, -1);
+
+  if (pid == 0) {
+    // Child
+    std::unique_ptr<SharedRingChannel> writer;
+    auto status = SharedRingChannel::open("test", parent, fd, writer);
+    for (size_t row = 0; status.ok() && row < rows; row += 1000) {
+      std::string buffer;
+      page.encode(row, row + 1000, buffer);
+      status = writer->sendStringMessage(buffer);
+    }
+    std::exit(status.ok() ? 0 : 1);
+  } else {
+    // Parent
+    TablePage received;
+    for (size_t chunk = 0; chunk < rows / 1000; ++chunk) {
+      std::string message;
+      auto status = reader->recvStringMessage(message);
+      ASSERT_TRUE(status.ok()) << status.getMessage();
+      status = received.decode(message);
+      ASSERT_TRUE(status.ok()) << status.getMessage();
+    }
+
+    int wexit;
+    waitpid(pid, &wexit, 0);
+    ASSERT_EQ(WEXITSTATUS(wexit), 0);
+
+    ASSERT_TRUE(received.validate().ok());
+    ASSERT_EQ(received.rows(), rows);
+    for (auto row : {size_t{0}, size_t{7}, size_t{4242}, rows - 1}) {
+      EXPECT_EQ(received.toRow(row), page.toRow(row));
+    }
+  }
+}
+
+TEST_F(SharedRingChannelTest, test_ring_writer_exit_while_reading) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+  auto parent = getpid();
+  auto fd = reader->fd();
+
+  int pid = fork();
+
+  ASSERT_NE(pid, -1);
+
+  if (pid == 0) {
+    // Child, exit without closing the ring
+    std::unique_ptr<SharedRingChannel> writer;
+    auto status = SharedRingChannel::open("test", parent, fd, writer);
+    _exit(status.ok() ? 0 : 1);
+  } else {
+    // Parent
+    std::string message;
+    auto status = reader->recvStringMessage(message);
+    ASSERT_FALSE(status.ok());
+    EXPECT_NE(status.getCode(), ETIMEDOUT);
+
+    int wexit;
+    waitpid(pid, &wexit, 0);
+    ASSERT_EQ(WEXITSTATUS(wexit), 0);
+  }
+}
+
+TEST_F(SharedRingChannelTest, test_ring_read_after_writer_closed) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+
+  std::unique_ptr<SharedRingChannel> writer;
+  auto status = SharedRingChannel::open("test", getpid(), reader->fd(), writer);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+
+  // The writer finishes and closes the ring before the reader starts.
+  ASSERT_TRUE(writer->sendStringMessage("first").ok());
+  ASSERT_TRUE(writer->sendStringMessage("last").ok());
+  writer->closeWriter();
+
+  std::string message;
+  status = reader->recvStringMessage(message);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  EXPECT_EQ(message, "first");
+  status = reader->recvStringMessage(message);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  EXPECT_EQ(message, "last");
+
+  // Only an empty ring fails once the writer closed it.
+  status = reader->recvStringMessage(message);
+  ASSERT_FALSE(status.ok());
+  EXPECT_NE(status.getCode(), ETIMEDOUT);
+}
+
+TEST_F(SharedRingChannelTest, test_ring_reader_closed) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+  reader->closeReader();
+
+  std::unique_ptr<SharedRingChannel> writer;
+  auto status = SharedRingChannel::open("test", getpid(), reader->fd(), writer);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+
+  status = writer->sendStringMessage(std::string(8192, 'x'));
+  ASSERT_FALSE(status.ok());
+  EXPECT_EQ(status.getCode(), EPIPE);
+}
+
+TEST_F(SharedRingChannelTest, test_ring_corrupt_header) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+
+  // A writer moves the write position past the end of the ring, the write
+  // position starts the header's second cache line.
+  auto mapping =
+      mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, reader->fd(), 0);
+  ASSERT_NE(mapping, MAP_FAILED);
+  memset(static_cast<char*>(mapping) + 64, 0x7f, 8);
+  munmap(mapping, 4096);
+
+  std::string message;
+  auto status = reader->recvStringMessage(message);
+  ASSERT_FALSE(status.ok());
+  EXPECT_NE(status.getCode(), ETIMEDOUT);
+}
+
+TEST_F(SharedRingChannelTest, test_ring_open_invalid) {
+  auto reader = createRing(4096);
+  ASSERT_NE(reader, nullptr);
+
+  // A descriptor that is not a ring
+  std::unique_ptr<SharedRingChannel> writer;
+  auto status = SharedRingChannel::open("test", getpid(), 0, writer);
+  EXPECT_FALSE(status.ok());
+
+  // Only one writer may open the ring
+  status = SharedRingChannel::open("test", getpid(), reader->fd(), writer);
+  ASSERT_TRUE(status.ok()) << status.getMessage();
+  std::unique_ptr<SharedRingChannel> second;
+  status = SharedRingChannel::open("test", getpid(), reader->fd(), second);
+  EXPECT_FALSE(status.ok());
+}
+} // namespace osquery
@@ -40,7 +40,9 @@ TEST_F(osquerySchedule, test_sanity) {
   //      {"last_executed", IntType}
   //      {"denylisted", IntType}
   //      {"output_size", IntType}
+  //      {"output_rows", IntType}
   //      {"wall_time", IntType}
+  //      {"wall_time_ms", IntType}
   //      {"user_time", IntType}
   //      {"system_time", IntType}
   //      {"average_memory", IntType}
@@ -0,0 +1,42 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+// Sanity check integration test for osquery_statement_cache
+// Spec file: specs/utility/osquery_statement_cache.table
+
+#include <osquery/tests/integration/tables/helper.h>
+
+namespace osquery {
+namespace table_tests {
+
+class osqueryStatementCache : public testing::Test {
+ protected:
+  void SetUp() override {
+    setUpEnvironment();
+  }
+};
+
+TEST_F(osqueryStatementCache, test_sanity) {
+  auto const data = execute_query("select * from osquery_statement_cache");
+  ASSERT_EQ(data.size(), 1ul);
+
+  ValidationMap row_map = {
+      {"statements", NonNegativeInt},
+      {"capacity", NonNegativeInt},
+      {"hits", NonNegativeInt},
+      {"misses", NonNegativeInt},
+      {"hit_rate", NonEmptyString},
+      {"prepare_time_saved", NonNegativeInt},
+      {"memory_used", NonNegativeInt},
+  };
+  validate_rows(data, row_map);
+}
+
+} // namespace table_tests
+} // namespace osquery
@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+// Sanity check integration test for osquery_table_cache
+// Spec file: specs/utility/osquery_table_cache.table
+
+#include <osquery/tests/integration/tables/helper.h>
+
+namespace osquery {
+namespace table_tests {
+
+class osqueryTableCache : public testing::Test {
+ protected:
+  void SetUp() override {
+    setUpEnvironment();
+  }
+};
+
+TEST_F(osqueryTableCache, test_sanity) {
+  auto const data = execute_query("select * from osquery_table_cache");
+
+  ValidationMap row_map = {
+      {"name", NonEmptyString},
+      {"entries", NonNegativeInt},
+      {"rows", NonNegativeInt},
+      {"hits", NonNegativeInt},
+      {"misses", NonNegativeInt},
+      {"evictions", NonNegativeInt},
+      {"memory_used", NonNegativeInt},
+  };
+  validate_rows(data, row_map);
+}
+
+} // namespace table_tests
+} // namespace osquery
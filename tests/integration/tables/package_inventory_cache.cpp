@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2014-present, The osquery authors
+ *
+ * This source code is licensed as defined by the LICENSE file found in the
+ * root directory of this source tree.
+ *
+ * SPDX-License-Identifier: (Apache-2.0 OR GPL-2.0-only)
+ */
+
+// Sanity check integration test for package_inventory_cache
+// Spec file: specs/package_inventory_cache.table
+
+#include <osquery/tests/integration/tables/helper.h>
+
+namespace osquery {
+namespace table_tests {
+
+class packageInventoryCache : public testing::Test {
+ protected:
+  void SetUp() override {
+    setUpEnvironment();
+  }
+};
+
+TEST_F(packageInventoryCache, test_sanity) {
+  // Populate the cache, the site directories may not exist.
+  execute_query("select * from python_packages");
+  auto const data = execute_query("select * from package_inventory_cache");
+
+  ValidationMap row_map = {
+      {"table_name", NonEmptyString},
+      {"key", NormalType},
+      {"sources", NormalType},
+      {"rows", NonNegativeInt},
+      {"valid", Bool},
+      {"hits", NonNegativeInt},
+      {"misses", NonNegativeInt},
+      {"generated_time", NonNegativeInt},
+  };
+  validate_rows(data, row_map);
+}
+
+} // namespace table_tests
+} // namespace osquery
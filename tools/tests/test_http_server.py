@@ -19,7 +19,7 @@ import _thread
 import threading
 
 # Create a simple TLS/HTTP server.
-from http.server import BaseHTTPRequestHandler, HTTPServer
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
 from urllib.parse import parse_qs
 
 # Script run directory, used for default values
@@ -132,6 +132,10 @@ ENROLL_RESPONSE = {"node_key": "this_is_a_node_secret"}
 RECEIVED_REQUESTS = []
 FILE_CARVE_DIR = '/tmp/'
 FILE_CARVE_MAP = {}
+FILE_CARVE_LOCK = threading.Lock()
+
+# Carve blocks with an id at or above this value are dropped, if set.
+FILE_CARVE_DROP = {"from": None}
 
 
 def debug(response):
@@ -200,6 +204,8 @@ class RealSimpleHandler(BaseHTTPRequestHandler):
             self.start_carve(request)
         elif self.path == '/carve_block':
             self.continue_carve(request)
+        elif self.path == '/carve_drop_blocks':
+            self.drop_carve_blocks(request)
         else:
             self._reply(TEST_POST_RESPONSE)
 
@@ -272,6 +278,8 @@ class RealSimpleHandler(BaseHTTPRequestHandler):
 
     # Initial endpoint, used to start a carve request
     def start_carve(self, request):
+        self._push_request('carve_init', dict(request))
+
         # The osqueryd agent expects the first endpoint to return a
         # 'session id' through which they'll communicate in future POSTs.
         # We use this internally to connect the request to the person
@@ -285,13 +293,14 @@ class RealSimpleHandler(BaseHTTPRequestHandler):
         # to identify this specific carve. We check all of these numbers
         # against predefined maximums to ensure that agents aren't able
         # to DOS our endpoints, and that carves are a reasonable size.
-        FILE_CARVE_MAP[sid] = {
-            'block_count': int(request['block_count']),
-            'block_size': int(request['block_size']),
-            'blocks_received': {},
-            'carve_size': int(request['carve_size']),
-            'carve_guid': request['carve_id'],
-        }
+        with FILE_CARVE_LOCK:
+            FILE_CARVE_MAP[sid] = {
+                'block_count': int(request['block_count']),
+                'block_size': int(request['block_size']),
+                'blocks_received': {},
+                'carve_size': int(request['carve_size']),
+                'carve_guid': request['carve_id'],
+            }
 
         # Lastly we let the agent know that the carve is good to start,
         # and send the session id back
@@ -300,39 +309,60 @@ class RealSimpleHandler(BaseHTTPRequestHandler):
     # Endpoint where the blocks of the carve are received, and
     # susequently reassembled.
     def continue_carve(self, request):
+        block_id = int(request['block_id'])
+        drop_from = FILE_CARVE_DROP['from']
+        if drop_from is not None and block_id >= drop_from:
+            # Close the connection without a response, as a network failure.
+            self.close_connection = True
+            return
+
+        self._push_request('carve_block', {
+            'block_id': block_id,
+            'session_id': request['session_id'],
+        })
+        with FILE_CARVE_LOCK:
+            self._store_carve_block(request['session_id'], block_id,
+                                    request['data'])
+        self._reply({})
+
+    def _store_carve_block(self, session_id, block_id, data):
+        # Ignore blocks of unknown or reassembled carves
+        carve = FILE_CARVE_MAP.get(session_id)
+        if not carve:
+            return
+
         # First check if we have already received this block
-        if request['block_id'] in FILE_CARVE_MAP[request['session_id']][
-                'blocks_received']:
+        if block_id in carve['blocks_received']:
             return
 
         # Store block data to be reassembled later
-        FILE_CARVE_MAP[request['session_id']]['blocks_received'][int(
-            request['block_id'])] = request['data']
+        carve['blocks_received'][block_id] = data
 
         # Are we expecting to receive more blocks?
-        if len(FILE_CARVE_MAP[request['session_id']]['blocks_received']
-               ) < FILE_CARVE_MAP[request['session_id']]['block_count']:
+        if len(carve['blocks_received']) < carve['block_count']:
             return
 
         # If not, let's reassemble everything
-        out_file_name = FILE_CARVE_DIR + FILE_CARVE_MAP[request['session_id']]['carve_guid']
+        out_file_name = FILE_CARVE_DIR + carve['carve_guid']
 
         # Check the first four bytes for the zstd header. If not no
         # compression was used, it's an uncompressed .tar
-        if (base64.standard_b64decode(FILE_CARVE_MAP[request['session_id']][
-                'blocks_received'][0])[0:4] == b'\x28\xB5\x2F\xFD'):
+        if (base64.standard_b64decode(
+                carve['blocks_received'][0])[0:4] == b'\x28\xB5\x2F\xFD'):
             out_file_name += '.zst'
         else:
             out_file_name += '.tar'
         f = open(out_file_name, 'wb')
-        for x in range(0,
-                       FILE_CARVE_MAP[request['session_id']]['block_count']):
-            f.write(
-                base64.standard_b64decode(FILE_CARVE_MAP[request['session_id']]
-                                          ['blocks_received'][x]))
+        for x in range(0, carve['block_count']):
+            f.write(base64.standard_b64decode(carve['blocks_received'][x]))
         f.close()
         debug("File successfully carved to: %s" % out_file_name)
-        FILE_CARVE_MAP[request['session_id']] = {}
+        FILE_CARVE_MAP[session_id] = {}
+
+    # Testing endpoint that simulates network failures of carve blocks.
+    def drop_carve_blocks(self, request):
+        FILE_CARVE_DROP['from'] = request.get('from')
+        self._reply({})
 
     def _push_request(self, command, request):
         # Archive the http command and the request body so that unit tests
@@ -381,7 +411,8 @@ def run_http_server(bind_port=80, **kwargs):
     if not ARGS['persist']:
         reset_timeout()
 
-    httpd = HTTPServer(('localhost', bind_port), RealSimpleHandler)
+    # Requests are handled concurrently, clients may keep connections alive.
+    httpd = ThreadingHTTPServer(('localhost', bind_port), RealSimpleHandler)
     if ARGS['tls']:
         httpd.socket = ssl.wrap_socket(
             httpd.socket,